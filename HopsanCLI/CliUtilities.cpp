@@ -309,6 +309,18 @@ void readExternalLibsFromTxtFile(const std::string filePath, std::vector<std::st
 }
 
 
+//! @brief Read the entire contents of a file
+//! @param[in] rFilePath The file to read from
+//! @returns The file contents or empty string if the file can not be opened
+std::string readFileContents(const std::string &rFilePath)
+{
+    std::ifstream file(rFilePath.c_str(), std::ios::binary);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+
 //! @brief Return the path to the current executable (HopsanCLI most likely)
 //! @returns The path or empty string if path can not be found
 string getCurrentExecPath()
@@ -61,5 +61,6 @@ bool compareVectors(const std::vector<double> &rVec, const std::vector<double> &
 
 // ===== Read File Functions =====
 void readExternalLibsFromTxtFile(const std::string filePath, std::vector<std::string> &rExtLibFileNames);
+std::string readFileContents(const std::string &rFilePath);
 
 #endif // CLIUTILITIES_H
@@ -0,0 +1,400 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+//!
+//! @file   HopsanCLI/ModelSweep.cpp
+//!
+//! @brief Contains design of experiments sweep functions for CLI
+//!
+//$Id$
+
+#ifdef USEOPS
+
+#include "ModelSweep.h"
+#include "core_cli.h"
+#include "CliUtilities.h"
+#include "ModelUtilities.h"
+
+#include "HopsanEssentials.h"
+#include "OpsMessageHandler.h"
+#include "OpsSweepRunner.h"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <mutex>
+#include <limits>
+#include <cmath>
+
+using namespace hopsan;
+using namespace std;
+
+enum SweepStatisticT {FinalValue, MinValue, MaxValue, MeanValue, RmsValue};
+
+class SweepOutput
+{
+public:
+    string component;
+    string port;
+    string variable;
+    string statisticName;
+    SweepStatisticT statistic;
+};
+
+class SweepMessageHandler : public Ops::MessageHandler
+{
+public:
+    SweepMessageHandler(bool silent)
+    {
+        mNumRuns = 0;
+        mSilent = silent;
+        mLastPercent = 0;
+    }
+
+    void setNumberOfRuns(size_t numRuns)
+    {
+        mNumRuns = numRuns;
+    }
+
+    void printMessage(const char *msg)
+    {
+        ::printMessage(msg, mSilent);
+    }
+
+    void stepCompleted(size_t numFinishedRuns)
+    {
+        const size_t percent = 100*numFinishedRuns/std::max<size_t>(mNumRuns, 1);
+        if(percent > mLastPercent)
+        {
+            mLastPercent = percent;
+            ::printMessage("Sweep progress: "+to_string(numFinishedRuns)+"/"+to_string(mNumRuns)+" ("+to_string(percent)+"%)", mSilent);
+        }
+    }
+
+private:
+    size_t mNumRuns;
+    size_t mLastPercent;
+    bool mSilent;
+};
+
+//! @brief Simulates one run of a sweep in one of the loaded models and computes scalar outputs from the logged data
+class SweepModelEvaluator : public Ops::SweepEvaluator
+{
+public:
+    SweepModelEvaluator(const vector<ComponentSystem*> &rSystems, const vector<string> &rParameterNames,
+                        const vector<SweepOutput> &rOutputs, double startTime, double stopTime)
+    {
+        mSystems = rSystems;
+        mParameterNames = rParameterNames;
+        mOutputs = rOutputs;
+        mStartTime = startTime;
+        mStopTime = stopTime;
+    }
+
+    size_t getNumberOfContexts() const
+    {
+        return mSystems.size();
+    }
+
+    vector<string> getOutputNames() const
+    {
+        vector<string> names;
+        for(const SweepOutput &rOutput : mOutputs)
+        {
+            names.push_back(rOutput.component+"#"+rOutput.port+"#"+rOutput.variable+"#"+rOutput.statisticName);
+        }
+        return names;
+    }
+
+    bool evaluateRun(const vector<double> &rParameters, size_t context, vector<double> &rOutputs)
+    {
+        ComponentSystem *pSystem = mSystems[context];
+        {
+            //Parameter changes and initialization are not thread safe in the core, only the simulations run in parallel
+            lock_guard<mutex> lock(mInitializeMutex);
+            for(size_t i=0; i<rParameters.size(); ++i)
+            {
+                stringstream value;
+                value.precision(numeric_limits<double>::max_digits10);
+                value << rParameters[i];
+                if(!pSystem->setParameterValue(HString(mParameterNames[i].c_str()), HString(value.str().c_str())))
+                {
+                    throw runtime_error("Parameter "+mParameterNames[i]+" not found in model");
+                }
+            }
+            if(!pSystem->initialize(mStartTime, mStopTime))
+            {
+                pSystem->finalize();
+                return false;
+            }
+        }
+
+        pSystem->simulate(mStopTime);
+
+        bool ok = !pSystem->wasSimulationAborted();
+        for(size_t o=0; o<mOutputs.size() && ok; ++o)
+        {
+            ok = computeOutput(pSystem, mOutputs[o], rOutputs[o]);
+        }
+
+        lock_guard<mutex> lock(mInitializeMutex);
+        pSystem->finalize();
+        return ok;
+    }
+
+private:
+    bool computeOutput(ComponentSystem *pSystem, const SweepOutput &rOutput, double &rValue)
+    {
+        Component *pComponent = pSystem->getSubComponent(rOutput.component.c_str());
+        Port *pPort = pComponent ? pComponent->getPort(rOutput.port.c_str()) : nullptr;
+        const int variableId = pPort ? pPort->getNodeDataIdFromName(rOutput.variable.c_str()) : -1;
+        if(variableId < 0)
+        {
+            throw runtime_error("Output variable "+rOutput.component+"#"+rOutput.port+"#"+rOutput.variable+" not found in model");
+        }
+
+        if(rOutput.statistic == FinalValue)
+        {
+            rValue = pPort->readNode(size_t(variableId));
+            return true;
+        }
+
+        const vector<vector<double> > *pLogData = pPort->getLogDataVectorPtr();
+        const size_t numSamples = pSystem->getNumActuallyLoggedSamples();
+        if(!pLogData || pLogData->size() < numSamples || numSamples == 0)
+        {
+            return false;
+        }
+        double min = (*pLogData)[0][variableId];
+        double max = min;
+        double sum = 0, sumSquares = 0;
+        for(size_t t=0; t<numSamples; ++t)
+        {
+            const double value = (*pLogData)[t][variableId];
+            min = std::min(min, value);
+            max = std::max(max, value);
+            sum += value;
+            sumSquares += value*value;
+        }
+        switch(rOutput.statistic)
+        {
+        case MinValue:
+            rValue = min;
+            break;
+        case MaxValue:
+            rValue = max;
+            break;
+        case MeanValue:
+            rValue = sum/numSamples;
+            break;
+        default:
+            rValue = sqrt(sumSquares/numSamples);
+        }
+        return true;
+    }
+
+    vector<ComponentSystem*> mSystems;
+    vector<string> mParameterNames;
+    vector<SweepOutput> mOutputs;
+    double mStartTime, mStopTime;
+    mutex mInitializeMutex;
+};
+
+
+//! @brief Runs a design of experiments sweep described by a sweep script
+//! @details The script contains one setting per line:
+//! design <fullfactorial|latinhypercube|sobol|halton|random>, nruns <n>, seed <n>, nmodels <n>,
+//! parameter <name> <min> <max> [levels], output <component> <port> <variable> <final|min|max|mean|rms>,
+//! resultfile <path> and noresume. Lines starting with # are ignored.
+//! @param[in] rScriptPath Path to the sweep script
+//! @param[in] rModelPath Path to the model file
+//! @param[in] rParameterImportPath Optional parameter file to import before the sweep
+//! @param[in] silent Suppress output messages
+//! @returns True if the sweep could be executed
+bool runSweepScript(const std::string &rScriptPath, const std::string &rModelPath, const std::string &rParameterImportPath, bool silent)
+{
+    ifstream scriptFile(rScriptPath.c_str());
+    if(!scriptFile.is_open())
+    {
+        printErrorMessage("Unable to open file: "+rScriptPath, silent);
+        return false;
+    }
+
+    Ops::DesignT design = Ops::DesignSobol;
+    size_t numRuns = 100;
+    unsigned int seed = 0;
+    size_t numModels = getNumAvailibleCores();
+    vector<string> parameterNames;
+    vector<double> parameterMin, parameterMax;
+    vector<size_t> parameterLevels;
+    vector<SweepOutput> outputs;
+    string resultFile = "sweep.csv";
+    bool resume = true;
+
+    string line;
+    while(getline(scriptFile, line))
+    {
+        if(!line.empty() && line[line.size()-1] == '\r')
+        {
+            line.erase(line.size()-1);
+        }
+        vector<string> words;
+        splitStringOnDelimiter(line, ' ', words);
+        if(line.empty() || words.empty() || words[0].empty() || words[0][0] == '#')
+        {
+            continue;
+        }
+
+        if(words.size() == 2 && words[0] == "design")
+        {
+            if(words[1] == "fullfactorial") design = Ops::DesignFullFactorial;
+            else if(words[1] == "latinhypercube") design = Ops::DesignLatinHypercube;
+            else if(words[1] == "sobol") design = Ops::DesignSobol;
+            else if(words[1] == "halton") design = Ops::DesignHalton;
+            else if(words[1] == "random") design = Ops::DesignRandom;
+            else
+            {
+                printErrorMessage("Unknown design: "+words[1], silent);
+                return false;
+            }
+        }
+        else if(words.size() == 2 && words[0] == "nruns")
+        {
+            numRuns = stoul(words[1]);
+        }
+        else if(words.size() == 2 && words[0] == "seed")
+        {
+            seed = static_cast<unsigned int>(stoul(words[1]));
+        }
+        else if(words.size() == 2 && words[0] == "nmodels")
+        {
+            numModels = std::max<size_t>(stoul(words[1]), 1);
+        }
+        else if((words.size() == 4 || words.size() == 5) && words[0] == "parameter")
+        {
+            parameterNames.push_back(words[1]);
+            parameterMin.push_back(stod(words[2]));
+            parameterMax.push_back(stod(words[3]));
+            parameterLevels.push_back((words.size() == 5) ? stoul(words[4]) : 2);
+        }
+        else if(words.size() == 5 && words[0] == "output")
+        {
+            SweepOutput output;
+            output.component = words[1];
+            output.port = words[2];
+            output.variable = words[3];
+            output.statisticName = words[4];
+            if(words[4] == "final") output.statistic = FinalValue;
+            else if(words[4] == "min") output.statistic = MinValue;
+            else if(words[4] == "max") output.statistic = MaxValue;
+            else if(words[4] == "mean") output.statistic = MeanValue;
+            else if(words[4] == "rms") output.statistic = RmsValue;
+            else
+            {
+                printErrorMessage("Unknown output statistic: "+words[4], silent);
+                return false;
+            }
+            outputs.push_back(output);
+        }
+        else if(words.size() == 2 && words[0] == "resultfile")
+        {
+            resultFile = words[1];
+        }
+        else if(words.size() == 1 && words[0] == "noresume")
+        {
+            resume = false;
+        }
+        else
+        {
+            printWarningMessage("Unhandled line in sweep script: "+line, silent);
+        }
+    }
+
+    if(parameterNames.empty() || outputs.empty())
+    {
+        printErrorMessage("Sweep script must contain at least one parameter and one output.", silent);
+        return false;
+    }
+
+    //Only keep the log if statistics over time are requested
+    bool needLog = false;
+    for(const SweepOutput &rOutput : outputs)
+    {
+        needLog = needLog || (rOutput.statistic != FinalValue);
+    }
+
+    printMessage("Loading Hopsan Model File: "+rModelPath, silent);
+    double startTime=0, stopTime=2;
+    vector<ComponentSystem*> systems;
+    for(size_t m=0; m<numModels; ++m)
+    {
+        ComponentSystem *pSystem = gHopsanCore.loadHMFModelFile(rModelPath.c_str(), startTime, stopTime);
+        if(!pSystem)
+        {
+            printErrorMessage("Could not load model file: "+rModelPath, silent);
+            for(ComponentSystem *pLoadedSystem : systems)
+            {
+                delete pLoadedSystem;
+            }
+            return false;
+        }
+        if(!rParameterImportPath.empty())
+        {
+            importParameterValuesFromCSV(rParameterImportPath, pSystem);
+        }
+        if(!needLog)
+        {
+            pSystem->disableLog();
+        }
+        systems.push_back(pSystem);
+    }
+    printWaitingMessages(false, silent);
+
+    SweepModelEvaluator evaluator(systems, parameterNames, outputs, startTime, stopTime);
+    SweepMessageHandler messageHandler(silent);
+    Ops::SweepRunner runner(&evaluator, &messageHandler);
+    Ops::ExperimentDesign &rDesign = runner.getDesign();
+    rDesign.setDesign(design);
+    rDesign.setNumberOfParameters(parameterNames.size());
+    for(size_t i=0; i<parameterNames.size(); ++i)
+    {
+        rDesign.setParameterLimits(i, parameterMin[i], parameterMax[i]);
+        rDesign.setNumberOfLevels(i, parameterLevels[i]);
+    }
+    rDesign.setNumberOfRuns(numRuns);
+    rDesign.setRandomSeed(seed);
+
+    messageHandler.setNumberOfRuns(rDesign.getNumberOfRuns());
+    runner.setParameterNames(parameterNames);
+    runner.setResultFile(resultFile);
+    runner.setResume(resume);
+    const bool ok = runner.run();
+
+    for(ComponentSystem *pSystem : systems)
+    {
+        delete pSystem;
+    }
+    return ok && (runner.getNumberOfFailedRuns() == 0);
+}
+
+#endif
@@ -569,4 +569,155 @@ void saveResultsToCSV(ComponentSystem *pRootSystem, const string &rFileName, con
     }
 }
 
+//! @brief Returns the log sample frequency of a system, or 0 if less than two samples have been logged
+static double logSampleFrequency(ComponentSystem *pSystem)
+{
+    const vector<double> *pLogTimeVector = pSystem->getLogTimeVector();
+    const size_t numLoggedSamples = std::min(pSystem->getNumActuallyLoggedSamples(), pLogTimeVector->size());
+    if (numLoggedSamples < 2) {
+        return 0;
+    }
+    const double duration = (*pLogTimeVector)[numLoggedSamples-1] - (*pLogTimeVector)[0];
+    return (duration > 0) ? double(numLoggedSamples-1)/duration : 0;
+}
+
+//! @brief Save the power spectral density (Welch's method) of logged results to CSV format
+//! @details Each system gets a Frequency row followed by one row per variable, in the same layout as the full results CSV
+//! @param [in] pRootSystem Pointer to component system
+//! @param [in] rFileName File name for output file
+//! @param [in] segmentLength The Welch segment length in samples, 0 = automatic
+//! @param [in] overlap The fraction of overlap between segments
+//! @param [in] window The window applied to each segment
+//! @param [in] includeFilter list of full port names or variables names to include (excluding all others)
+void saveSpectrumToCSV(ComponentSystem *pRootSystem, const string &rFileName, const size_t segmentLength, const double overlap,
+                       const SpectralWindowT window, const std::vector<string>& includeFilter)
+{
+    if (pRootSystem)
+    {
+        ofstream outfile;
+        outfile.open(rFileName.c_str());
+        if (outfile.good()) {
+
+            auto addFrequencyVariable = [&outfile, segmentLength](ComponentSystem* pSystem) {
+                const double fs = logSampleFrequency(pSystem);
+                if (fs > 0) {
+                    const size_t nSegment = welchSegmentLength(pSystem->getNumActuallyLoggedSamples(), segmentLength);
+                    outfile << generateFullSubSystemHierarchyName(pSystem,"$").c_str() << "Frequency,,Hz";
+                    for (size_t k=0; k<nSegment/2+1; ++k) {
+                        outfile << "," << std::scientific << k*fs/nSegment;
+                    }
+                    outfile << endl;
+                }
+            };
+
+            auto addVariable = [&outfile, segmentLength, overlap, window](const ComponentSystem* pSystem, const Component* pComponent, const Port* pPort, size_t variableIndex) {
+                ComponentSystem *pParentSystem = const_cast<ComponentSystem*>(pSystem);
+                const double fs = logSampleFrequency(pParentSystem);
+                const vector< vector<double> > *pLogData = pPort->getLogDataVectorPtr();
+                const size_t numLoggedSamples = std::min(pParentSystem->getNumActuallyLoggedSamples(), pLogData ? pLogData->size() : 0);
+                if (fs > 0 && numLoggedSamples > 1) {
+                    vector<double> data(numLoggedSamples), frequency, density;
+                    for (size_t t=0; t<numLoggedSamples; ++t) {
+                        data[t] = (*pLogData)[t][variableIndex];
+                    }
+                    if (!welchPowerSpectralDensity(data, fs, segmentLength, overlap, window, frequency, density)) {
+                        return;
+                    }
+
+                    const NodeDataDescription& variable = *pPort->getNodeDataDescription(variableIndex);
+                    const HString fullVarName = generateFullSubSystemHierarchyName(pSystem,"$") + pComponent->getName() + "#" + pPort->getName() + "#" + variable.name;
+                    outfile << fullVarName.c_str() << "," << pPort->getVariableAlias(variableIndex).c_str() << ",(" << variable.unit.c_str() << ")^2/Hz";
+                    for (const double value : density) {
+                        outfile << "," << std::scientific << value;
+                    }
+                    outfile << endl;
+                }
+            };
+
+            saveResultsTo(pRootSystem, includeFilter, addFrequencyVariable, addVariable);
+        }
+        else {
+            printErrorMessage("Could not open: " + rFileName + " for writing!");
+        }
+
+        outfile.close();
+    }
+}
+
+//! @brief Save statistics (mean, RMS, min, max, integral) of logged results to CSV format
+//! @details One row per variable after a header row. If a steady-state tolerance and window are given, the time from which the variable
+//! remains in steady-state (rectangular window test) is included, the column is empty if the variable does not reach steady-state.
+//! @param [in] pRootSystem Pointer to component system
+//! @param [in] rFileName File name for output file
+//! @param [in] minTime The start of the time range to compute statistics for
+//! @param [in] maxTime The end of the time range to compute statistics for
+//! @param [in] steadyStateTolerance The largest allowed difference between max and min within the window, 0 = skip steady-state
+//! @param [in] steadyStateWindow The length of the moving window in time
+//! @param [in] includeFilter list of full port names or variables names to include (excluding all others)
+void saveStatisticsToCSV(ComponentSystem *pRootSystem, const string &rFileName, const double minTime, const double maxTime,
+                         const double steadyStateTolerance, const double steadyStateWindow, const std::vector<string>& includeFilter)
+{
+    if (pRootSystem)
+    {
+        ofstream outfile;
+        outfile.open(rFileName.c_str());
+        if (outfile.good()) {
+            const bool withSteadyState = (steadyStateTolerance > 0) && (steadyStateWindow > 0);
+            outfile << "Name,Alias,Unit,Samples,Mean,RMS,Min,Max,Integral";
+            if (withSteadyState) {
+                outfile << ",SteadyStateTime";
+            }
+            outfile << endl;
+
+            auto addTimeVariable = [](ComponentSystem* pSystem) {
+                HOPSAN_UNUSED(pSystem)
+            };
+
+            auto addVariable = [&outfile, minTime, maxTime, withSteadyState, steadyStateTolerance, steadyStateWindow]
+                    (const ComponentSystem* pSystem, const Component* pComponent, const Port* pPort, size_t variableIndex) {
+                ComponentSystem *pParentSystem = const_cast<ComponentSystem*>(pSystem);
+                const vector<double> *pLogTimeVector = pParentSystem->getLogTimeVector();
+                const vector< vector<double> > *pLogData = pPort->getLogDataVectorPtr();
+                const size_t numLoggedSamples = std::min(pParentSystem->getNumActuallyLoggedSamples(),
+                                                         std::min(pLogTimeVector->size(), pLogData ? pLogData->size() : 0));
+                if (numLoggedSamples == 0) {
+                    return;
+                }
 
+                // The log data is stored per sample, gather the variable into a contiguous vector for the statistics kernels
+                vector<double> data(numLoggedSamples);
+                for (size_t t=0; t<numLoggedSamples; ++t) {
+                    data[t] = (*pLogData)[t][variableIndex];
+                }
+                SignalStatistics statistics;
+                if (!computeSignalStatistics(pLogTimeVector->data(), data.data(), numLoggedSamples, minTime, maxTime, statistics)) {
+                    return;
+                }
+
+                const NodeDataDescription& variable = *pPort->getNodeDataDescription(variableIndex);
+                const HString fullVarName = generateFullSubSystemHierarchyName(pSystem,"$") + pComponent->getName() + "#" + pPort->getName() + "#" + variable.name;
+                outfile << fullVarName.c_str() << "," << pPort->getVariableAlias(variableIndex).c_str() << "," << variable.unit.c_str();
+                outfile << "," << statistics.numSamples << std::scientific << "," << statistics.mean << "," << statistics.rms;
+                outfile << "," << statistics.min << "," << statistics.max << "," << statistics.integral;
+                if (withSteadyState) {
+                    vector<double> steadyState;
+                    identifySteadyState(RectangularWindowSteadyState, pLogTimeVector->data(), data.data(), numLoggedSamples,
+                                        steadyStateTolerance, steadyStateWindow, 0, 0, 0, 0, steadyState);
+                    const size_t startIndex = steadyStateStartIndex(steadyState);
+                    outfile << ",";
+                    if (startIndex < numLoggedSamples) {
+                        outfile << (*pLogTimeVector)[startIndex];
+                    }
+                }
+                outfile << std::defaultfloat << endl;
+            };
+
+            saveResultsTo(pRootSystem, includeFilter, addTimeVariable, addVariable);
+        }
+        else {
+            printErrorMessage("Could not open: " + rFileName + " for writing!");
+        }
+
+        outfile.close();
+    }
+}
@@ -35,6 +35,8 @@
 #include <vector>
 #include "core_cli.h"
 #include "HopsanEssentials.h"
+#include "ComponentUtilities/SpectralAnalysis.h"
+#include "ComponentUtilities/SignalStatistics.h"
 
 void printTsInfo(const hopsan::ComponentSystem* pSystem);
 void printSystemParams(hopsan::ComponentSystem* pSystem);
@@ -46,6 +48,10 @@ void printComponentHierarchy(hopsan::ComponentSystem *pSystem, std::string prefi
 enum SaveResults {Final, Full};
 void saveResultsToCSV(hopsan::ComponentSystem *pRootSystem, const std::string &rFileName, const SaveResults howMany, const std::vector<std::string>& includeFilter);
 void saveResultsToHDF5(hopsan::ComponentSystem *pRootSystem, const std::string &rFileName, const std::vector<std::string>& includeFilter, const SaveResults howMany);
+void saveSpectrumToCSV(hopsan::ComponentSystem *pRootSystem, const std::string &rFileName, const size_t segmentLength, const double overlap,
+                       const hopsan::SpectralWindowT window, const std::vector<std::string>& includeFilter);
+void saveStatisticsToCSV(hopsan::ComponentSystem *pRootSystem, const std::string &rFileName, const double minTime, const double maxTime,
+                         const double steadyStateTolerance, const double steadyStateWindow, const std::vector<std::string>& includeFilter);
 
 void transposeCSVresults(const std::string &rFileName);
 void exportParameterValuesToCSV(const std::string &rFileName, hopsan::ComponentSystem* pSystem, std::string prefix="", std::ofstream *pFile=0);
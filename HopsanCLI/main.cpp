@@ -31,6 +31,7 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <limits>
 
 #include <tclap/CmdLine.h>
 
@@ -44,10 +45,14 @@
 #include "CliUtilities.h"
 #include "ModelValidation.h"
 #include "BuildUtilities.h"
+#include "ModelSweep.h"
 
 #ifdef USEOPS
+#include <atomic>
+#include <mutex>
 #include "OpsWorker.h"
 #include "OpsEvaluator.h"
+#include "OpsParallelEvaluator.h"
 #include "OpsMessageHandler.h"
 #include "OpsWorkerNelderMead.h"
 #include "OpsWorkerComplexRF.h"
@@ -110,7 +115,7 @@ private:
     bool mSilent;
 };
 
-class OptimizationEvaluator : public Ops::Evaluator
+class OptimizationEvaluator : public Ops::ParallelEvaluator
 {
 public:
     OptimizationEvaluator(vector<ComponentSystem *> rootSystemPtrs,
@@ -122,6 +127,7 @@ public:
                           vector<double> parMax,
                           double startTime,
                           double stopTime)
+        : Ops::ParallelEvaluator(rootSystemPtrs.size())
     {
         mRootSystemPtrs = rootSystemPtrs;
         mParNames = parNames;
@@ -135,79 +141,41 @@ public:
         mStopTime = stopTime;
     }
 
-    //! @todo Make evaluateAll... work in parallel
-
-    //void evaluateAllPoints();
-    void evaluateCandidate(size_t idx)
+    //! @brief Evaluates one parameter set in one of the loaded models, called concurrently for different models
+    double evaluateParameters(const std::vector<double> &rParameters, size_t context)
     {
-        for(size_t i=0; i<mpWorker->getNumberOfParameters(); ++i)
+        ComponentSystem *pSystem = mRootSystemPtrs.at(context);
         {
-            double par = mpWorker->getCandidateParameter(idx, i);
-            if(!mRootSystemPtrs.at(0)->setParameterValue(HString(mParNames[i].c_str()), HString(std::to_string(par).c_str())))
+            //Parameter changes and initialization are not thread safe in the core, only the simulations run in parallel
+            std::lock_guard<std::mutex> lock(mInitializeMutex);
+            for(size_t i=0; i<rParameters.size(); ++i)
             {
-                cout << "Error: Parameter " << mParNames[i] << " not found in model." << endl;
+                if(!pSystem->setParameterValue(HString(mParNames[i].c_str()), HString(std::to_string(rParameters[i]).c_str())))
+                {
+                    cout << "Error: Parameter " << mParNames[i] << " not found in model." << endl;
+                }
             }
+            pSystem->initialize(mStartTime,mStopTime);
         }
 
-        mRootSystemPtrs.at(0)->initialize(mStartTime,mStopTime);
-        mRootSystemPtrs.at(0)->simulate(mStopTime);
+        pSystem->simulate(mStopTime);
 
         double obj = 0.0;
         for(size_t i=0; i<mObjComps.size(); ++i)
         {
             int portId = 0;
-            Component *pComp = mRootSystemPtrs.at(0)->getSubComponent(mObjComps[i].c_str());
+            Component *pComp = pSystem->getSubComponent(mObjComps[i].c_str());
             Port *pPort = pComp->getPort(mObjPorts[i].c_str());
             double data = *pPort->getNodeDataPtr(portId);
             obj += mObjWeights[i]*data;
         }
-        mpWorker->setCandidateObjectiveValue(idx, obj);
 
         ++mEvaulationCounter;
-    }
-
-    void evaluateAllCandidates()
-    {
-        for(size_t c=0; c<mpWorker->getNumberOfCandidates(); ++c)
-        {
-            for(size_t i=0; i<mpWorker->getNumberOfParameters(); ++i)
-            {
-                double par = mpWorker->getCandidateParameter(c, i);
-                if(!mRootSystemPtrs.at(c)->setParameterValue(HString(mParNames[i].c_str()), HString(std::to_string(par).c_str())))
-                {
-                    cout << "Error: Parameter " << mParNames[i] << " not found in model." << endl;
-                }
-            }
-        }
-
-        int  threads = mpWorker->getNumberOfCandidates();
-        if(threads == 1)
-        {
-            threads = -1;
-        }
-
-        gHopsanCore.getSimulationHandler()->initializeSystem(mStartTime,mStopTime,mRootSystemPtrs);
-        gHopsanCore.getSimulationHandler()->simulateSystem(mStartTime,mStopTime,threads,mRootSystemPtrs);
-
-        for(size_t c=0; c<mpWorker->getNumberOfCandidates(); ++c)
-        {
-            double obj = 0.0;
-            for(size_t i=0; i<mObjComps.size(); ++i)
-            {
-                int portId = 0;
-                Component *pComp = mRootSystemPtrs.at(c)->getSubComponent(mObjComps[i].c_str());
-                Port *pPort = pComp->getPort(mObjPorts[i].c_str());
-                double data = *pPort->getNodeDataPtr(portId);
-                obj += mObjWeights[i]*data;
-            }
-            mpWorker->setCandidateObjectiveValue(c, obj);
-            ++mEvaulationCounter;
-        }
+        return obj;
     }
 
     size_t getNumberOfEvaluations() { return mEvaulationCounter; }
 
-    //void evaluateAllCandidates();
 private:
     vector<ComponentSystem *> mRootSystemPtrs;
     vector<string> mParNames;
@@ -216,7 +184,8 @@ private:
     vector<double> mObjWeights;
     vector<double> mParMin;
     vector<double> mParMax;
-    size_t mEvaulationCounter;
+    std::atomic<size_t> mEvaulationCounter;
+    std::mutex mInitializeMutex;
     double mStartTime;
     double mStopTime;
 };
@@ -246,6 +215,13 @@ int main(int argc, char *argv[])
         TCLAP::ValueArg<std::string> resultsCSVSortOption("", "resultsCSVSort", "Export results in columns or in rows: [rows, cols]", false, "rows", "string", cmd);
         TCLAP::ValueArg<std::string> resultsFinalCSVOption("", "resultsFinalCSV", "Export the results (only final values)", false, "", "Path to file", cmd);
         TCLAP::ValueArg<std::string> resultsFullCSVOption("", "resultsFullCSV", "Export the results (all logged data) to CSV", false, "", "Path to file", cmd);
+        TCLAP::ValueArg<std::string> resultsSpectrumCSVOption("", "resultsSpectrumCSV", "Export the power spectral density (Welch's method) of the logged results to CSV", false, "", "Path to file", cmd);
+        TCLAP::ValueArg<std::string> spectrumSegmentLengthOption("", "spectrumSegmentLength", "Segment length in samples for --resultsSpectrumCSV, 0 means automatic", false, "0", "integer", cmd);
+        TCLAP::ValueArg<std::string> spectrumOverlapOption("", "spectrumOverlap", "Fraction of overlap between segments for --resultsSpectrumCSV", false, "0.5", "double", cmd);
+        TCLAP::ValueArg<std::string> spectrumWindowOption("", "spectrumWindow", "Window for --resultsSpectrumCSV: [rectangular, hann, flattop]", false, "hann", "string", cmd);
+        TCLAP::ValueArg<std::string> resultsStatisticsCSVOption("", "resultsStatisticsCSV", "Export statistics (mean, rms, min, max, integral) of the logged results to CSV", false, "", "Path to file", cmd);
+        TCLAP::ValueArg<std::string> statisticsTimeRangeOption("", "statisticsTimeRange", "Time range for --resultsStatisticsCSV, as: start,stop", false, "", "string", cmd);
+        TCLAP::ValueArg<std::string> steadyStateOption("", "steadyState", "Add the time when each variable reaches steady-state to --resultsStatisticsCSV (max-min within the window below the tolerance), as: tolerance,window", false, "", "string", cmd);
         TCLAP::ValueArg<std::string> resultsFinalHDF5Option("", "resultsFinalHDF5", "Exeport the results (only final values) to HDF5", false, "", "Path to file", cmd);
         TCLAP::ValueArg<std::string> resultsFullHDF5Option("", "resultsFullHDF5", "Exeport the results (all logged data) to HDF5", false, "", "Path to file", cmd);
         TCLAP::ValueArg<std::string> parameterExportOption("", "parameterExport", "CSV file with exported parameter values", false, "", "Path to file", cmd);
@@ -256,9 +232,11 @@ int main(int argc, char *argv[])
         TCLAP::ValueArg<std::string> simulateOption("s","simulate","Specify simulation time as: [hmf] or [start,ts,stop] or [ts,stop] or [stop]",false,"","Comma separated string", cmd);
         TCLAP::ValueArg<std::string> parallelOption("p","parallel","Enable parallel simulation with specified number of threads. 0 threads  means auto-detect number of procssors.",false,"0","integer", cmd);
         TCLAP::ValueArg<std::string> extLibsFileOption("","externalLibsFile","A text file containing the external libs to load",false,"","Path to file", cmd);
+        TCLAP::ValueArg<std::string> modelCacheOption("","modelCache","Directory for the binary model cache, speeds up repeated loading of the same model",false,"","Path to directory", cmd);
         TCLAP::MultiArg<std::string> extLibPathsOption("e","externalLib","Path to a .dll/.so/.dylib externalComponentLib. Can be given multiple times",false,"Path to file", cmd);
         TCLAP::MultiArg<std::string> optimizationOption("o","optScript","Optimization scripts",false,"Path to files", cmd);
         TCLAP::MultiArg<std::string> optimizationSettings("","optSettings","Optimization settings",false,"Settings", cmd);
+        TCLAP::ValueArg<std::string> sweepOption("","sweepScript","Design of experiments sweep script, results are streamed to a CSV file and interrupted sweeps are resumed",false,"","Path to file", cmd);
         TCLAP::ValueArg<std::string> hmfPathOption("m","hmf","The Hopsan model file to load",false,"","Path to file", cmd);
 
         // Parse the argv array.
@@ -295,6 +273,11 @@ int main(int argc, char *argv[])
         string libpath = getCurrentExecPath()+"/"+default_library;
         gHopsanCore.loadExternalComponentLib(libpath.c_str());
 #endif
+        if (modelCacheOption.isSet())
+        {
+            gHopsanCore.setModelCacheDirectory(modelCacheOption.getValue().c_str());
+        }
+
         // Print initial core messages
         printWaitingMessages(printDebugOption.getValue(), silentOption.getValue());
 
@@ -443,6 +426,12 @@ int main(int argc, char *argv[])
             double CR = 0.5;
             bool printDebugFile = false;
             bool silent = false;
+            bool asynchronous = false;
+            bool useCache = false;
+            std::string cacheFile;
+            std::string surrogateModel;
+            size_t surrogateInterval = 10;
+            double screeningFraction = 0.5;
 
             string line;
             stringstream scriptStream(script);
@@ -484,6 +473,31 @@ int main(int argc, char *argv[])
                 {
                     silent = true;
                 }
+                else if(words.size() == 1 && words[0] == "asynchronous")
+                {
+                    asynchronous = true;
+                }
+                else if(words.size() == 1 && words[0] == "cache")
+                {
+                    useCache = true;
+                }
+                else if(words.size() == 2 && words[0] == "cachefile")
+                {
+                    useCache = true;
+                    cacheFile = words[1];
+                }
+                else if((words.size() == 2 || words.size() == 3) && words[0] == "surrogate")
+                {
+                    surrogateModel = words[1];
+                    if(words.size() == 3)
+                    {
+                        surrogateInterval = std::stoul(words[2]);
+                    }
+                }
+                else if(words.size() == 2 && words[0] == "screening")
+                {
+                    screeningFraction = std::stod(words[1]);
+                }
                 else if(words.size() == 2 && words[0] == "npoints")
                 {
                     nPoints = std::stoul(words[1]);
@@ -636,6 +650,31 @@ int main(int argc, char *argv[])
                     OptimizationEvaluator *pEvaluator = new OptimizationEvaluator(rootSystemPtrs, parNames, objComps, objPorts,
                                                                                   objWeights, parMin, parMax, startTime, stopTime);
 
+                    //Setup evaluation cache, the model hash covers everything that affects the objective value
+                    if(useCache)
+                    {
+                        std::stringstream hashData;
+                        hashData << readFileContents(hmfPathOption.getValue());
+                        if(parameterImportOption.isSet())
+                        {
+                            hashData << readFileContents(parameterImportOption.getValue());
+                        }
+                        for(size_t i=0; i<objComps.size(); ++i)
+                        {
+                            hashData << "\n" << objComps[i] << " " << objPorts[i] << " " << objWeights[i];
+                        }
+                        for(const std::string &parName : parNames)
+                        {
+                            hashData << "\n" << parName;
+                        }
+                        pEvaluator->setUseCache(true);
+                        pEvaluator->getCache().setModelHash(Ops::EvaluationCache::computeHash(hashData.str()));
+                        if(!cacheFile.empty() && pEvaluator->getCache().load(cacheFile))
+                        {
+                            printMessage("Loaded "+std::to_string(pEvaluator->getCache().size())+" cached evaluations from: "+cacheFile, silentOption.getValue());
+                        }
+                    }
+
                     //Initialize base worker
                     Ops::Worker *pBaseWorker;
                     Ops::MessageHandler *pOpsMessages;
@@ -684,6 +723,12 @@ int main(int argc, char *argv[])
                     }
                     pBaseWorker->setTolerance(tolerance);
                     pBaseWorker->setSamplingMethod(Ops::SamplingLatinHypercube);
+                    if(!surrogateModel.empty())
+                    {
+                        pEvaluator->setSurrogateModel(surrogateModel == "radialbasis" ? Ops::SurrogateRadialBasis : Ops::SurrogateQuadratic);
+                        pEvaluator->setScreeningFraction(screeningFraction);
+                        pBaseWorker->setUseSurrogateModel(surrogateInterval);
+                    }
 
                     //Set algorithm-specific parameters
                     if(algorithm == "neldermead")
@@ -736,6 +781,7 @@ int main(int argc, char *argv[])
                         Ops::WorkerDifferentialEvolution *pWorker = dynamic_cast<Ops::WorkerDifferentialEvolution*>(pBaseWorker);
                         pWorker->setDifferentialWeight(F);
                         pWorker->setCrossoverProbability(CR);
+                        pWorker->setAsynchronous(asynchronous);
                     }
                     else if(algorithm == "pso")
                     {
@@ -745,6 +791,7 @@ int main(int argc, char *argv[])
                         pWorker->setC1(C1);
                         pWorker->setC2(C2);
                         pWorker->setVmax(vmax);
+                        pWorker->setAsynchronous(asynchronous);
                     }
                     else if(algorithm == "genetic")
                     {
@@ -769,6 +816,16 @@ int main(int argc, char *argv[])
                     pBaseWorker->initialize();
                     pBaseWorker->run();
 
+                    if(useCache)
+                    {
+                        printMessage("Evaluation cache hits: "+std::to_string(pOpsMessages->getNumberOfCacheHits())+
+                                     ", misses: "+std::to_string(pOpsMessages->getNumberOfCacheMisses()), silentOption.getValue());
+                        if(!cacheFile.empty() && !pEvaluator->getCache().save(cacheFile))
+                        {
+                            printErrorMessage("Could not write evaluation cache file: "+cacheFile, silentOption.getValue());
+                        }
+                    }
+
                     //Print results
                     if(printDebugFile)
                     {
@@ -806,7 +863,14 @@ int main(int argc, char *argv[])
         }
 #endif
 
-        if(hmfPathOption.isSet() && !createHvcTestOption.getValue() && !optimizationOption.isSet())
+#ifdef USEOPS
+        if(sweepOption.isSet() && hmfPathOption.isSet())
+        {
+            returnSuccess = runSweepScript(sweepOption.getValue(), hmfPathOption.getValue(), parameterImportOption.getValue(), silentOption.getValue());
+        }
+#endif
+
+        if(hmfPathOption.isSet() && !createHvcTestOption.getValue() && !optimizationOption.isSet() && !sweepOption.isSet())
         {
             returnSuccess=false;
             printWaitingMessages(printDebugOption.getValue(), silentOption.getValue());
@@ -1033,6 +1097,79 @@ int main(int argc, char *argv[])
                     }
                 }
 
+                if (resultsSpectrumCSVOption.isSet())
+                {
+                    hopsan::SpectralWindowT window = hopsan::HannSpectralWindow;
+                    bool windowOK = true;
+                    if (spectrumWindowOption.getValue() == "rectangular")
+                    {
+                        window = hopsan::RectangularSpectralWindow;
+                    }
+                    else if (spectrumWindowOption.getValue() == "flattop")
+                    {
+                        window = hopsan::FlatTopSpectralWindow;
+                    }
+                    else if (spectrumWindowOption.getValue() != "hann")
+                    {
+                        printErrorMessage("Unknown spectrum window: " + spectrumWindowOption.getValue(), silentOption.getValue());
+                        windowOK = false;
+                    }
+
+                    if (windowOK)
+                    {
+                        cout << "Saving spectrum of results to file: " << destinationPath+resultsSpectrumCSVOption.getValue() << endl;
+                        const int segmentLength = std::max(atoi(spectrumSegmentLengthOption.getValue().c_str()), 0);
+                        const double overlap = atof(spectrumOverlapOption.getValue().c_str());
+                        saveSpectrumToCSV(pRootSystem, destinationPath+resultsSpectrumCSVOption.getValue(), size_t(segmentLength), overlap, window, logOnlyPortsOrVariables);
+                        if (resultsCSVSortOption.getValue() == "cols")
+                        {
+                            cout << "Transposing CSV file" << endl;
+                            transposeCSVresults(destinationPath+resultsSpectrumCSVOption.getValue());
+                        }
+                    }
+                }
+
+                if (resultsStatisticsCSVOption.isSet())
+                {
+                    double minTime = -std::numeric_limits<double>::max();
+                    double maxTime = std::numeric_limits<double>::max();
+                    double steadyStateTolerance = 0;
+                    double steadyStateWindow = 0;
+                    bool argsOK = true;
+                    if (statisticsTimeRangeOption.isSet())
+                    {
+                        std::vector<std::string> range;
+                        splitStringOnDelimiter(statisticsTimeRangeOption.getValue(), ',', range);
+                        argsOK = (range.size() == 2);
+                        if (argsOK)
+                        {
+                            minTime = atof(range[0].c_str());
+                            maxTime = atof(range[1].c_str());
+                        }
+                    }
+                    if (steadyStateOption.isSet())
+                    {
+                        std::vector<std::string> steadyState;
+                        splitStringOnDelimiter(steadyStateOption.getValue(), ',', steadyState);
+                        argsOK = argsOK && (steadyState.size() == 2);
+                        if (argsOK)
+                        {
+                            steadyStateTolerance = atof(steadyState[0].c_str());
+                            steadyStateWindow = atof(steadyState[1].c_str());
+                        }
+                    }
+
+                    if (argsOK)
+                    {
+                        cout << "Saving statistics of results to file: " << destinationPath+resultsStatisticsCSVOption.getValue() << endl;
+                        saveStatisticsToCSV(pRootSystem, destinationPath+resultsStatisticsCSVOption.getValue(), minTime, maxTime,
+                                            steadyStateTolerance, steadyStateWindow, logOnlyPortsOrVariables);
+                    }
+                    else
+                    {
+                        printErrorMessage("Could not parse --statisticsTimeRange or --steadyState, expected two comma separated values", silentOption.getValue());
+                    }
+                }
 
                 if(resultsFullHDF5Option.isSet()) {
                     cout << "Saving full results to file: " << destinationPath+resultsFullHDF5Option.getValue() << endl;
@@ -150,6 +150,7 @@ SOURCES += \
     src/CoreUtilities/LoadExternal.cpp \
     src/CoreUtilities/HopsanCoreMessageHandler.cpp \
     src/CoreUtilities/HmfLoader.cpp \
+    src/CoreUtilities/HmfModelCache.cpp \
     src/ComponentUtilities/WhiteGaussianNoise.cpp \
     src/ComponentUtilities/SecondOrderTransferFunction.cpp \
     src/ComponentUtilities/matrix.cpp \
@@ -167,6 +168,8 @@ SOURCES += \
     src/ComponentUtilities/LookupTable.cpp \
     src/ComponentUtilities/PLOParser.cpp \
     src/ComponentUtilities/TempDirectoryHandle.cpp \
+    src/ComponentUtilities/SpectralAnalysis.cpp \
+    src/ComponentUtilities/SignalStatistics.cpp \
     $${PWD}/dependencies/indexingcsvparser/src/indexingcsvparser.cpp \
     src/Quantities.cpp \
     src/CoreUtilities/NumHopHelper.cpp \
@@ -192,6 +195,7 @@ HEADERS += \
     include/CoreUtilities/LoadExternal.h \
     include/CoreUtilities/HopsanCoreMessageHandler.h \
     include/CoreUtilities/HmfLoader.h \
+    include/CoreUtilities/HmfModelCache.h \
     include/CoreUtilities/ClassFactoryStatusCheck.hpp \
     include/CoreUtilities/ClassFactory.hpp \
     include/ComponentUtilities/WhiteGaussianNoise.h \
@@ -200,6 +204,7 @@ HEADERS += \
     include/ComponentUtilities/SecondOrderTransferFunction.h \
     include/ComponentUtilities/num2string.hpp \
     include/ComponentUtilities/matrix.h \
+    include/ComponentUtilities/FixedMatrix.hpp \
     include/ComponentUtilities/ludcmp.h \
     include/ComponentUtilities/IntegratorLimited.h \
     include/ComponentUtilities/Integrator.h \
@@ -211,6 +216,8 @@ HEADERS += \
     include/ComponentUtilities/AuxiliarySimulationFunctions.h \
     include/ComponentUtilities/AuxiliaryMathematicaWrapperFunctions.h \
     include/ComponentUtilities/TempDirectoryHandle.h \
+    include/ComponentUtilities/SpectralAnalysis.h \
+    include/ComponentUtilities/SignalStatistics.h \
     include/Parameters.h \
     include/Components/DummyComponent.hpp \
     include/ComponentUtilities/EquationSystemSolver.h \
@@ -39,6 +39,7 @@
 #include "ComponentUtilities/ValveHysteresis.h"
 #include "ComponentUtilities/ludcmp.h"
 #include "ComponentUtilities/matrix.h"
+#include "ComponentUtilities/FixedMatrix.hpp"
 #include "ComponentUtilities/CSVParser.h"
 #include "ComponentUtilities/PLOParser.h"
 #include "ComponentUtilities/AuxiliarySimulationFunctions.h"
@@ -48,4 +49,6 @@
 #include "ComponentUtilities/EquationSystemSolver.h"
 #include "ComponentUtilities/LookupTable.h"
 #include "ComponentUtilities/TempDirectoryHandle.h"
+#include "ComponentUtilities/SpectralAnalysis.h"
+#include "ComponentUtilities/SignalStatistics.h"
 #endif // COMPONENTUTILITIES_H_INCLUDED
@@ -46,6 +46,28 @@ class IndexingCSVParser;
 
 namespace hopsan {
 
+// Forward declaration
+class CSVMappedBuffer;
+
+//! @ingroup ComponentUtilityClasses
+//! @brief Column oriented numeric data produced by CSVParserNG::parseMappedData()
+class HOPSANCORE_DLLAPI CSVColumnData
+{
+public:
+    void clear();
+    size_t getNumRows() const;
+    size_t getNumCols() const;
+    bool isColumnOK(const size_t columnIdx) const;
+    const std::vector<double> &getColumn(const size_t columnIdx) const;
+    bool takeColumn(const size_t columnIdx, std::vector<double> &rColumn);
+
+private:
+    friend class CSVParserNG;
+    std::vector< std::vector<double> > mColumns;
+    std::vector<char> mBadColumns;
+    size_t mNumRows = 0;
+};
+
 //! @ingroup ComponentUtilityClasses
 //! @brief The CSV file parser utility
 class HOPSANCORE_DLLAPI CSVParserNG
@@ -79,10 +101,19 @@ public:
     bool copyEveryNthFromColumn(const size_t columnIdx, const size_t stepSize, std::vector<double> &rColumn);
     bool copyEveryNthFromColumnRange(const size_t columnIdx, const size_t startRow, const size_t numRows, const size_t stepSize, std::vector<double> &rColumn);
 
+    bool mapFile(const HString &rFilepath);
+    bool mapText(const HString &rText);
+    bool parseMappedData(CSVColumnData &rData, size_t numThreads=0);
+    void unmapFile();
+
 protected:
     indcsvp::IndexingCSVParser *mpCsvParser;
+    CSVMappedBuffer *mpMappedBuffer;
     HString mErrorString;
     bool mConvertDecimalSeparator;
+    char mSeparatorChar;
+    char mCommentChar;
+    size_t mNumLinesToSkip;
 };
 
 }
@@ -37,8 +37,10 @@
 #include "Component.h"
 #include "matrix.h"
 #include "ludcmp.h"
+#include "FixedMatrix.hpp"
 
 #include <vector>
+#include <cmath>
 
 namespace hopsan {
 
@@ -49,11 +51,29 @@ public:
 
     EquationSystemSolver(Component *pParentComponent, int n);
     EquationSystemSolver(Component *pParentComponent, int n, Matrix *pJacobian, Vec *pEquations, Vec *pVariables);
-    void solve(Matrix &jacobian, Vec &equations, Vec &variables, int iteration);
-    void solve(Matrix &jacobian, Vec &equations, Vec &variables);
-    void solve();
+    bool solve(Matrix &jacobian, Vec &equations, Vec &variables, int iteration);
+    bool solve(Matrix &jacobian, Vec &equations, Vec &variables);
+    bool solve();
+
+    template<int N> bool solve(FixedMatrix<N> &jacobian, FixedVec<N> &equations, FixedVec<N> &variables, int iteration);
+    template<int N> bool solve(FixedMatrix<N> &jacobian, FixedVec<N> &equations, FixedVec<N> &variables);
+
+    void setJacobianReuse(bool reuse, double stallRatio=0.5, int maxJacobianAge=20);
+    void setResidualTolerance(double tolerance);
+    void invalidateJacobian();
+
+    size_t getNumIterations() const;
+    size_t getNumFactorizations() const;
+    size_t getNumEarlyExits() const;
+    void resetCounters();
 
 private:
+    enum StepActionEnum {SkipUpdate, ReuseFactorization, Factorize};
+
+    void init(Component *pParentComponent, int n);
+    template<typename VecT> StepActionEnum beginIteration(const VecT &equations, int iteration);
+    void factorizationFailed();
+
     Component *mpParentComponent;
     double mSystemEquationWeight[4];
     int *mpOrder;
@@ -64,9 +84,137 @@ private:
     Matrix *mpJacobian;
     Vec *mpEquations;
     Vec *mpVariables;
+
+    // Modified Newton (Jacobian reuse) and convergence control
+    bool mReuseJacobian;
+    double mStallRatio;
+    int mMaxJacobianAge;
+    double mResidualTolerance;
+    Matrix mLU;
+    bool mHaveLU;
+    int mJacobianAge;
+    double mPrevResidual;
+
+    size_t mNumIterations;
+    size_t mNumFactorizations;
+    size_t mNumEarlyExits;
 };
 
 
+//! @brief Decides how the current Newton iteration shall be performed, based on the residual of the system equations
+//! @param equations Vector of system equations (residuals) evaluated at the current state
+//! @param iteration How many times the solver has been executed before in the same time step
+//! @returns What to do in this iteration
+template<typename VecT>
+inline EquationSystemSolver::StepActionEnum EquationSystemSolver::beginIteration(const VecT &equations, int iteration)
+{
+    ++mNumIterations;
+
+    double residual = 0;
+    for(int i=0; i<mnVars; ++i)
+    {
+        const double r = fabs(equations[i]);
+        residual = (r > residual) ? r : residual;
+    }
+
+    if(mResidualTolerance > 0 && residual <= mResidualTolerance)
+    {
+        ++mNumEarlyExits;
+        mPrevResidual = residual;
+        return SkipUpdate;
+    }
+
+    if(!mReuseJacobian)
+    {
+        ++mNumFactorizations;
+        return Factorize;
+    }
+
+    // Refactorize if the stored factorization did not reduce the residual enough in the previous iteration,
+    // or if it has been used for too many iterations
+    const bool stalled = (iteration > 1) && (residual > mStallRatio*mPrevResidual);
+    mPrevResidual = residual;
+    if(!mHaveLU || stalled || mJacobianAge >= mMaxJacobianAge)
+    {
+        ++mNumFactorizations;
+        mJacobianAge = 1;
+        return Factorize;
+    }
+    ++mJacobianAge;
+    return ReuseFactorization;
+}
+
+
+//! @brief Solves a fixed size system of equations without heap allocation
+//! @param jacobian Jacobian matrix
+//! @param equations Vector of system equations
+//! @param variables Vector of state variables
+//! @param iteration How many times the solver has been executed before in the same time step
+//! @returns True if the residual was already within tolerance and the state variables were left unchanged
+template<int N>
+inline bool EquationSystemSolver::solve(FixedMatrix<N> &jacobian, FixedVec<N> &equations, FixedVec<N> &variables, int iteration)
+{
+    FixedVec<N> deltaStateVar;
+
+    const StepActionEnum action = beginIteration(equations, iteration);
+    if(action == SkipUpdate)
+    {
+        return true;
+    }
+    else if(action == Factorize)
+    {
+        //Stop simulation if LU decomposition failed due to singularity
+        if(!ludcmp(jacobian, mpOrder))
+        {
+            factorizationFailed();
+        }
+        else if(mReuseJacobian)
+        {
+            for(int r=0; r<N; ++r)
+            {
+                for(int c=0; c<N; ++c)
+                {
+                    mLU[r][c] = jacobian[r][c];
+                }
+            }
+            mHaveLU = true;
+        }
+    }
+    else
+    {
+        for(int r=0; r<N; ++r)
+        {
+            for(int c=0; c<N; ++c)
+            {
+                jacobian[r][c] = mLU[r][c];
+            }
+        }
+    }
+
+    //Solve system using L and U matrices
+    solvlu(jacobian, equations, deltaStateVar, mpOrder);
+
+    //Calculate new system variables
+    for(int i=0; i<N; ++i)
+    {
+        variables[i] = variables[i] - mSystemEquationWeight[iteration - 1] * deltaStateVar[i];
+    }
+    return false;
+}
+
+
+//! @brief Solves a fixed size system of equations with just one iteration
+//! @param jacobian Jacobian matrix
+//! @param equations Vector of system equations
+//! @param variables Vector of state variables
+//! @returns True if the residual was already within tolerance and the state variables were left unchanged
+template<int N>
+inline bool EquationSystemSolver::solve(FixedMatrix<N> &jacobian, FixedVec<N> &equations, FixedVec<N> &variables)
+{
+    return solve(jacobian, equations, variables, 1);
+}
+
+
 //! @ingroup ComponentUtilityClasses
 class HOPSANCORE_DLLAPI NumericalIntegrationSolver
 {
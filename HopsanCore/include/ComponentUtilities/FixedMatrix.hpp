@@ -0,0 +1,201 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+
+//!
+//! @file   FixedMatrix.hpp
+//!
+//! @brief Contains compile-time sized matrix and vector classes and LU-decomposition for them
+//!
+//! These classes have the same element access as Matrix and Vec but store their elements inline, so they never allocate
+//! heap memory. The LU-decomposition uses the same algorithm as ludcmp() and solvlu(), but with compile-time loop bounds
+//! so that the compiler can unroll the loops for the small systems found in generated components.
+//!
+//$Id$
+
+#ifndef FIXEDMATRIX_HPP_INCLUDED
+#define FIXEDMATRIX_HPP_INCLUDED
+
+#include <cmath>
+
+namespace hopsan {
+
+//! @brief A vector of doubles with compile-time size
+//! @ingroup ComponentUtilityClasses
+template<int N>
+class FixedVec
+{
+public:
+    FixedVec() { set(0.0); }
+    //! returns the length (number of elements) of the vector
+    int length() const { return N; }
+    //! set to constant value
+    FixedVec &set(double v) { for (int i=0; i<N; ++i) body[i] = v; return *this; }
+    //! subscript operator (non-const object)
+    double &operator[](int n) { return body[n]; }
+    //! subscript operator (const object)
+    const double &operator[](int n) const { return body[n]; }
+
+private:
+    double body[N];
+};
+
+//! @brief A two-dimensional matrix of doubles with compile-time size
+//! @ingroup ComponentUtilityClasses
+template<int R, int C=R>
+class FixedMatrix
+{
+public:
+    FixedMatrix() { set(0.0); }
+    int rows() const { return R; } //!< returns the number of rows
+    int cols() const { return C; } //!< returns the number of columns
+    //! set Matrix elements to v
+    FixedMatrix &set(double v) { for (int i=0; i<R; ++i) for (int j=0; j<C; ++j) body[i][j] = v; return *this; }
+    //! returns a pointer to a matrix row
+    double *operator[](int n) { return body[n]; }
+    //! returns a const pointer to a matrix row
+    const double *operator[](int n) const { return body[n]; }
+    //! swap rows
+    void swaprows(int i, int j)
+    {
+        for (int k=0; k<C; ++k)
+        {
+            const double tmp = body[i][k];
+            body[i][k] = body[j][k];
+            body[j][k] = tmp;
+        }
+    }
+
+private:
+    double body[R][C];
+};
+
+
+//! @brief Find pivot element, see pivot()
+template<int N>
+inline bool pivot(FixedMatrix<N> &a, int order[], int jcol)
+{
+    int ipvt = jcol;
+    double big = fabs(a[ipvt][ipvt]);
+    for (int i=ipvt+1; i<N; ++i)
+    {
+        const double anext = fabs(a[i][jcol]);
+        if (anext>big)
+        {
+            big = anext;
+            ipvt = i;
+        }
+    }
+
+    if(!(fabs(big) > 0))
+    {
+        return false;
+    }
+
+    if (ipvt==jcol) return true;
+    a.swaprows(jcol,ipvt);
+    const int i = order[jcol];
+    order[jcol] = order[ipvt];
+    order[ipvt] = i;
+    return true;
+}
+
+//! @brief Finds LU decomposition of a fixed size matrix, see ludcmp()
+//! @param [in,out] a The N by N matrix of coefficients, replaced by its LU decomposition
+//! @param [out] order Integer vector (length N) holding row order after pivoting
+//! @returns False if the matrix is singular
+template<int N>
+inline bool ludcmp(FixedMatrix<N> &a, int order[])
+{
+    const int nm1 = N - 1;
+
+    for (int i=0; i<N; ++i) order[i] = i;
+
+    // Do pivoting for first column and check for singularity
+    if (!pivot(a,order,0)) return false;
+
+    double diag = 1.0/a[0][0];
+    for (int i=1; i<N; ++i) a[0][i] *= diag;
+
+    // Compute a column of L's, pivot, and then compute a row of U's
+    for (int j=1; j<nm1; ++j)
+    {
+        for (int i=j; i<N; ++i)
+        {
+            double sum = 0.0;
+            for (int k=0; k<j; ++k) sum += a[i][k]*a[k][j];
+            a[i][j] -= sum;
+        }
+        if(!pivot(a,order,j)) return false;
+        diag = 1.0/a[j][j];
+        for (int k=j+1; k<N; ++k)
+        {
+            double sum = 0.0;
+            for (int i=0; i<j; ++i) sum += a[j][i]*a[i][k];
+            a[j][k] = (a[j][k]-sum)*diag;
+        }
+    }
+
+    // Last element in L matrix
+    double sum = 0.0;
+    for (int k=0; k<nm1; ++k) sum += a[nm1][k]*a[k][nm1];
+    a[nm1][nm1] -= sum;
+
+    return true;
+}
+
+//! @brief Solves A x = b after LU decomposition of A, see solvlu()
+//! @param [in] a The LU decomposition of the coefficient matrix
+//! @param [in] b The right hand side
+//! @param [out] x The solution vector
+//! @param [in] order Row order from ludcmp()
+template<int N>
+inline void solvlu(const FixedMatrix<N> &a, const FixedVec<N> &b, FixedVec<N> &x, const int order[])
+{
+    for (int i=0; i<N; ++i)
+    {
+        x[i] = b[order[i]];
+    }
+
+    // Forward substitution
+    x[0] /= a[0][0];
+    for (int i=1; i<N; ++i)
+    {
+        double sum = 0.0;
+        for (int j=0; j<i; ++j) sum += a[i][j]*x[j];
+        x[i] = (x[i]-sum)/a[i][i];
+    }
+
+    // Back substitution, x[N-1] is already done
+    for (int i=N-2; i>=0; --i)
+    {
+        double sum = 0.0;
+        for (int j=i+1; j<N; ++j) sum += a[i][j]*x[j];
+        x[i] -= sum;
+    }
+}
+
+}
+
+#endif // FIXEDMATRIX_HPP_INCLUDED
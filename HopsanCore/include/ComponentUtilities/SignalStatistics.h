@@ -0,0 +1,71 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+//!
+//! @file   SignalStatistics.h
+//!
+//! @brief Contains the Core Utility signal statistics and steady-state identification functions
+//!
+//$Id$
+
+#ifndef SIGNALSTATISTICS_H_INCLUDED
+#define SIGNALSTATISTICS_H_INCLUDED
+
+#include "win32dll.h"
+#include <vector>
+#include <cstddef>
+
+namespace hopsan {
+
+enum SteadyStateMethodT {RectangularWindowSteadyState, VarianceRatioSteadyState, MovingAverageVarianceRatioSteadyState};
+
+//! @ingroup ComponentUtilityClasses
+//! @brief Statistics of a signal over a range of samples, see computeSignalStatistics()
+struct HOPSANCORE_DLLAPI SignalStatistics
+{
+    size_t firstIndex;
+    size_t numSamples;
+    double mean;
+    double rms;
+    double min;
+    double max;
+    size_t minIndex;
+    size_t maxIndex;
+    double integral;
+};
+
+HOPSANCORE_DLLAPI void signalSampleRange(const double *pTime, const size_t n, const double minTime, const double maxTime,
+                                         size_t &rFirst, size_t &rEnd);
+HOPSANCORE_DLLAPI bool computeSignalStatistics(const double *pTime, const double *pData, const size_t first, const size_t end,
+                                               SignalStatistics &rStatistics);
+HOPSANCORE_DLLAPI bool computeSignalStatistics(const double *pTime, const double *pData, const size_t n, const double minTime,
+                                               const double maxTime, SignalStatistics &rStatistics);
+
+HOPSANCORE_DLLAPI bool identifySteadyState(const SteadyStateMethodT method, const double *pTime, const double *pData, const size_t n,
+                                           const double tolerance, const double window, const double noiseStdDev,
+                                           const double lambda1, const double lambda2, const double lambda3, std::vector<double> &rSteadyState);
+HOPSANCORE_DLLAPI size_t steadyStateStartIndex(const std::vector<double> &rSteadyState);
+
+}
+
+#endif // SIGNALSTATISTICS_H_INCLUDED
@@ -0,0 +1,104 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+//!
+//! @file   SpectralAnalysis.h
+//!
+//! @brief Contains the Core Utility spectral analysis functions (FFT and power spectral density)
+//!
+//$Id$
+
+#ifndef SPECTRALANALYSIS_H_INCLUDED
+#define SPECTRALANALYSIS_H_INCLUDED
+
+#include "win32dll.h"
+#include <complex>
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+namespace hopsan {
+
+enum SpectralWindowT {RectangularSpectralWindow, HannSpectralWindow, FlatTopSpectralWindow};
+
+//! @ingroup ComponentUtilityClasses
+//! @brief Precomputed forward complex FFT of a fixed length
+//! @details The length is factored into radix 4, 2, 3 and 5 stages (other prime factors use a generic, slower, stage)
+//! and transformed with a Stockham auto-sort algorithm, so no bit reversal pass is needed and all stages access memory
+//! sequentially. A plan is immutable once created and can be used from several threads at once.
+class HOPSANCORE_DLLAPI FFTPlan
+{
+public:
+    FFTPlan(const size_t n);
+    size_t getSize() const;
+    void forward(std::complex<double> *pData, std::vector< std::complex<double> > &rWork) const;
+    void forward(std::complex<double> *pData, std::complex<double> *pWork) const;
+
+private:
+    struct Stage
+    {
+        size_t radix;
+        size_t length;
+        size_t twiddleOffset;
+        size_t rootOffset;
+    };
+
+    std::vector<Stage> mStages;
+    std::vector< std::complex<double> > mTwiddles;
+    std::vector< std::complex<double> > mRoots;
+    size_t mSize;
+};
+
+//! @ingroup ComponentUtilityClasses
+//! @brief Precomputed forward FFT of real valued data of a fixed length
+//! @details Even lengths are transformed as a complex FFT of half the length. Only the n/2+1 non-redundant bins are produced.
+class HOPSANCORE_DLLAPI RealFFTPlan
+{
+public:
+    static std::shared_ptr<const RealFFTPlan> get(const size_t n);
+
+    RealFFTPlan(const size_t n);
+    size_t getSize() const;
+    size_t getNumBins() const;
+    void forward(const double *pInput, std::complex<double> *pOutput) const;
+    void forward(const double *pInput, std::complex<double> *pOutput, std::vector< std::complex<double> > &rWork) const;
+
+private:
+    FFTPlan mComplexPlan;
+    std::vector< std::complex<double> > mPostTwiddles;
+    size_t mSize;
+};
+
+HOPSANCORE_DLLAPI void forwardRealFFTBatch(const RealFFTPlan &rPlan, const std::vector<const double*> &rInputs,
+                                           const std::vector< std::complex<double>* > &rOutputs, size_t numThreads=0);
+
+HOPSANCORE_DLLAPI size_t largestEfficientFFTSize(const size_t n);
+HOPSANCORE_DLLAPI void generateSpectralWindow(const SpectralWindowT window, const size_t n, std::vector<double> &rWindow);
+HOPSANCORE_DLLAPI size_t welchSegmentLength(const size_t dataLength, const size_t requestedLength);
+HOPSANCORE_DLLAPI bool welchPowerSpectralDensity(const std::vector<double> &rData, const double sampleFrequency, size_t segmentLength,
+                                                 const double overlap, const SpectralWindowT window,
+                                                 std::vector<double> &rFrequency, std::vector<double> &rDensity, size_t numThreads=0);
+
+}
+
+#endif // SPECTRALANALYSIS_H_INCLUDED
@@ -57,7 +57,7 @@ void HOPSANCORE_DLLAPI autoPrependSelfToParameterExpressions(Component* pCompone
 HVector<HString> HOPSANCORE_DLLAPI findValuesNeedingPrependSelfInEmbeddedInitScript(ComponentSystem* pSystem);
 void HOPSANCORE_DLLAPI autoPrependSelfToEmbeddedInitScript(ComponentSystem* pSystem);
 
-ComponentSystem* loadHopsanModelFile(const HString &rFilePath, HopsanEssentials* pHopsanEssentials, double &rStartTime, double &rStopTime);
+ComponentSystem* loadHopsanModelFile(const HString &rFilePath, HopsanEssentials* pHopsanEssentials, double &rStartTime, double &rStopTime, const HString &rCacheDirectory="");
 ComponentSystem* loadHopsanModel(const std::vector<unsigned char> xmlVector, HopsanEssentials* pHopsanEssentials);
 ComponentSystem* loadHopsanModel(const char* xmlStr, HopsanEssentials* pHopsanEssentials, double &rStartTime, double &rStopTime);
 ComponentSystem* loadHopsanModel(char* xmlStr, HopsanEssentials* pHopsanEssentials, double &rStartTime, double &rStopTime);
@@ -0,0 +1,92 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+
+//!
+//! @file   HmfModelCache.h
+//!
+//! @brief Contains the HopsanCore binary model cache used to speed up HMF loading
+//!
+//$Id$
+
+#ifndef HMFMODELCACHE_H_INCLUDED
+#define HMFMODELCACHE_H_INCLUDED
+
+#include <string>
+#include "HopsanTypes.h"
+
+namespace hopsan {
+
+//Forward declaration
+class ComponentSystem;
+class HopsanEssentials;
+
+//! @brief Records the resolved load operations performed by the HMF loader
+//! @details The recording contains the model after old version fix-ups and parameter name resolution, so that it can be
+//! replayed by loadHopsanModelCache() without parsing the XML again. Models that can not be reproduced from the recording
+//! alone (such as models with external subsystems or missing components) are marked as not cachable.
+class HmfModelCacheRecorder
+{
+public:
+    HmfModelCacheRecorder();
+
+    void recordRootSystem(const double startTime, const double stopTime);
+    void recordSubsystemBegin(const HString &rTypeName);
+    void recordSubsystemEnd();
+    void recordSystemSettings(const HString &rName, const bool disabled, const double timestep, const bool inheritTimestep, const double logStartTime, const size_t numLogSamples);
+    void recordSystemParameter(const HString &rName, const HString &rValue, const HString &rType, const HString &rDescription, const HString &rQuantityOrUnit);
+    void recordPrependSelfToSystemParameters();
+    void recordNumHopScript(const HString &rScript);
+    void recordPrependSelfToNumHopScript();
+    void recordComponent(const HString &rTypeName, const HString &rSubTypeName, const HString &rName, const bool disabled);
+    void recordComponentParameter(const HString &rName, const HString &rValue);
+    void recordPrependSelfToComponentParameters();
+    void recordPortQuantity(const HString &rPortName, const HString &rQuantity);
+    void recordSystemPort(const HString &rName);
+    void recordConnection(const HString &rStartComponent, const HString &rStartPort, const HString &rEndComponent, const HString &rEndPort);
+    void recordVariableAlias(const HString &rAlias, const HString &rComponent, const HString &rPort, const HString &rVariable);
+
+    void setNotCachable();
+    bool isCachable() const;
+    const std::string &getData() const;
+
+private:
+    void writeOp(const int op);
+    void writeString(const HString &rString);
+    void writeDouble(const double value);
+    void writeInt(const long int value);
+
+    std::string mData;
+    bool mIsCachable;
+};
+
+HString getHmfModelCacheKey(const char* pHmfData, const size_t size, HopsanEssentials* pHopsanEssentials);
+HString getHmfModelCacheFilePath(const HString &rCacheDirectory, const HString &rKey);
+bool readHmfModelCacheFile(const HString &rCacheFilePath, const HString &rKey, std::string &rData);
+bool writeHmfModelCacheFile(const HString &rCacheFilePath, const HString &rKey, const std::string &rData);
+ComponentSystem* loadHopsanModelCache(const std::string &rData, HopsanEssentials* pHopsanEssentials, double &rStartTime, double &rStopTime);
+
+}
+
+#endif // HMFMODELCACHE_H_INCLUDED
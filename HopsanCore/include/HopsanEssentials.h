@@ -59,6 +59,7 @@ private:
     LoadExternal* mpExternalLoader;
     SimulationHandler mSimulationHandler;
     QuantityRegister* mpQuantityRegister;
+    HString mModelCacheDirectory;
     static size_t mInstanceCounter;
 
 public:
@@ -112,6 +113,8 @@ public:
     ComponentSystem* loadHMFModelFile(const char* filePath, double &rStartTime, double &rStopTime);
     ComponentSystem* loadHMFModel(const std::vector<unsigned char> xmlVector);
     ComponentSystem* loadHMFModel(const char* xmlString, double &rStartTime, double &rStopTime);
+    void setModelCacheDirectory(const char* dirPath);
+    const char* getModelCacheDirectory() const;
 
     // Running simulation
     SimulationHandler *getSimulationHandler();
@@ -34,26 +34,388 @@
 #include "indexingcsvparser/indexingcsvparser.h"
 
 #include "ComponentUtilities/CSVParser.h"
+#include "ComponentUtilities/num2string.hpp"
 #include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <algorithm>
 
 #ifdef _WIN32
 #include "windows.h"
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 
 using namespace hopsan;
 
+namespace hopsan {
+
+//! @brief A read-only view of a memory mapped file, or of an owned copy of a text
+class CSVMappedBuffer
+{
+public:
+    ~CSVMappedBuffer()
+    {
+#ifdef _WIN32
+        if (mpView) {
+            UnmapViewOfFile(mpView);
+        }
+        if (mMapping) {
+            CloseHandle(mMapping);
+        }
+        if (mFile != INVALID_HANDLE_VALUE) {
+            CloseHandle(mFile);
+        }
+#else
+        if (mpView) {
+            munmap(mpView, mSize);
+        }
+#endif
+    }
+
+    bool mapFile(const HString &rFilepath)
+    {
+#ifdef _WIN32
+        mFile = CreateFileA(rFilepath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (mFile == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(mFile, &size)) {
+            return false;
+        }
+        mSize = size_t(size.QuadPart);
+        if (mSize > 0) {
+            mMapping = CreateFileMappingA(mFile, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (!mMapping) {
+                return false;
+            }
+            mpView = MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+            if (!mpView) {
+                return false;
+            }
+        }
+#else
+        int fd = open(rFilepath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            return false;
+        }
+        mSize = size_t(st.st_size);
+        if (mSize > 0) {
+            void *pView = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (pView == MAP_FAILED) {
+                close(fd);
+                return false;
+            }
+            mpView = pView;
+            madvise(mpView, mSize, MADV_SEQUENTIAL);
+        }
+        // The mapping remains valid after the file descriptor is closed
+        close(fd);
+#endif
+        mpBegin = static_cast<const char*>(mpView);
+        return true;
+    }
+
+    void setText(const HString &rText)
+    {
+        mText = rText;
+        mpBegin = mText.c_str();
+        mSize = mText.size();
+    }
+
+    const char *begin() const
+    {
+        return mpBegin;
+    }
+
+    const char *end() const
+    {
+        return mpBegin+mSize;
+    }
+
+private:
+    HString mText;
+    const char *mpBegin = nullptr;
+    size_t mSize = 0;
+    void *mpView = nullptr;
+#ifdef _WIN32
+    HANDLE mFile = INVALID_HANDLE_VALUE;
+    HANDLE mMapping = NULL;
+#endif
+};
+
+}
+
+namespace {
+
+inline bool isBlank(const char c)
+{
+    return (c == ' ') || (c == '\t') || (c == '\r');
+}
+
+inline const char *findLineEnd(const char *p, const char *pEnd)
+{
+    const void *pNewline = std::memchr(p, '\n', size_t(pEnd-p));
+    return pNewline ? static_cast<const char*>(pNewline) : pEnd;
+}
+
+inline bool isBlankLine(const char *p, const char *pLineEnd)
+{
+    while (p != pLineEnd) {
+        if (!isBlank(*p)) {
+            return false;
+        }
+        ++p;
+    }
+    return true;
+}
+
+//! @brief Parse a double from a (not null terminated) field
+//! @details Numbers with at most 19 significant digits and a small exponent are converted exactly using the
+//! Clinger fast path, anything else (and inf, nan) falls back to strtod on a null terminated copy
+bool parseDouble(const char *pBegin, const char *pEnd, const bool allowDecimalComma, double &rValue)
+{
+    while ((pBegin != pEnd) && isBlank(*pBegin)) {
+        ++pBegin;
+    }
+    while ((pEnd != pBegin) && isBlank(*(pEnd-1))) {
+        --pEnd;
+    }
+    if (pBegin == pEnd) {
+        return false;
+    }
+
+    static const double powersOf10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char *p = pBegin;
+    bool isNegative = false;
+    if ((*p == '-') || (*p == '+')) {
+        isNegative = (*p == '-');
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int numSignificantDigits = 0, exponent = 0, numDigits = 0;
+    bool isExact = true;
+    while ((p != pEnd) && (*p >= '0') && (*p <= '9')) {
+        if (numSignificantDigits < 19) {
+            mantissa = mantissa*10 + uint64_t(*p-'0');
+            numSignificantDigits += (mantissa != 0);
+        }
+        else {
+            ++exponent;
+            isExact = false;
+        }
+        ++numDigits;
+        ++p;
+    }
+    if ((p != pEnd) && ((*p == '.') || (allowDecimalComma && (*p == ',')))) {
+        ++p;
+        while ((p != pEnd) && (*p >= '0') && (*p <= '9')) {
+            if (numSignificantDigits < 19) {
+                mantissa = mantissa*10 + uint64_t(*p-'0');
+                numSignificantDigits += (mantissa != 0);
+                --exponent;
+            }
+            else {
+                isExact = false;
+            }
+            ++numDigits;
+            ++p;
+        }
+    }
+    if ((numDigits > 0) && (p != pEnd) && ((*p == 'e') || (*p == 'E'))) {
+        ++p;
+        bool isExpNegative = false;
+        if ((p != pEnd) && ((*p == '-') || (*p == '+'))) {
+            isExpNegative = (*p == '-');
+            ++p;
+        }
+        int exp = 0;
+        bool haveExpDigits = false;
+        while ((p != pEnd) && (*p >= '0') && (*p <= '9')) {
+            exp = (exp < 100000) ? exp*10 + (*p-'0') : exp;
+            haveExpDigits = true;
+            ++p;
+        }
+        isExact = isExact && haveExpDigits;
+        exponent += isExpNegative ? -exp : exp;
+    }
+
+    if (isExact && (numDigits > 0) && (p == pEnd) && (mantissa <= (uint64_t(1) << 53)) && (exponent >= -22) && (exponent <= 22)) {
+        double value = double(mantissa);
+        value = (exponent < 0) ? value/powersOf10[-exponent] : value*powersOf10[exponent];
+        rValue = isNegative ? -value : value;
+        return true;
+    }
+
+    // Slow path
+    char buffer[128];
+    const size_t length = size_t(pEnd-pBegin);
+    if (length >= sizeof(buffer)) {
+        return false;
+    }
+    std::memcpy(buffer, pBegin, length);
+    buffer[length] = '\0';
+    if (allowDecimalComma) {
+        char *pComma = std::strchr(buffer, ',');
+        if (pComma) {
+            *pComma = '.';
+        }
+    }
+    char *pParseEnd;
+    rValue = std::strtod(buffer, &pParseEnd);
+    return (pParseEnd == buffer+length);
+}
+
+inline bool isCommentLine(const char *p, const char *pLineEnd, const char commentChar)
+{
+    return (commentChar != '\0') && (p != pLineEnd) && (*p == commentChar);
+}
+
+//! @brief Count the fields on a line, a trailing separator does not start a new field
+size_t countFields(const char *p, const char *pLineEnd, const char separator)
+{
+    while ((pLineEnd != p) && isBlank(*(pLineEnd-1))) {
+        --pLineEnd;
+    }
+    if ((pLineEnd != p) && (*(pLineEnd-1) == separator)) {
+        --pLineEnd;
+    }
+    size_t n=1;
+    while (p != pLineEnd) {
+        n += (*p == separator);
+        ++p;
+    }
+    return n;
+}
+
+//! @brief Count the data lines in a chunk, blank and comment lines are not counted
+//! @param[out] rMaxNumFields The largest number of fields on any data line in the chunk
+size_t countDataLines(const char *p, const char *pEnd, const char separator, const char commentChar, size_t &rMaxNumFields)
+{
+    size_t n=0;
+    rMaxNumFields = 0;
+    while (p < pEnd) {
+        const char *pLineEnd = findLineEnd(p, pEnd);
+        if (!isBlankLine(p, pLineEnd) && !isCommentLine(p, pLineEnd, commentChar)) {
+            rMaxNumFields = std::max(rMaxNumFields, countFields(p, pLineEnd, separator));
+            ++n;
+        }
+        p = pLineEnd+1;
+    }
+    return n;
+}
+
+//! @brief Parse all data lines in a chunk, writing to the columns beginning at firstRow
+//! @details Fields that are missing or not numeric are set to NaN and their column is marked in rBadColumns.
+//! Fields beyond the number of columns are ignored.
+void parseDataLines(const char *p, const char *pEnd, const char separator, const char commentChar, const bool allowDecimalComma,
+                    std::vector< std::vector<double> > &rColumns, const size_t firstRow, std::vector<char> &rBadColumns)
+{
+    const size_t numCols = rColumns.size();
+    size_t row = 0;
+    while (p < pEnd) {
+        const char *pLineEnd = findLineEnd(p, pEnd);
+        if (!isBlankLine(p, pLineEnd) && !isCommentLine(p, pLineEnd, commentChar)) {
+            const char *pField = p;
+            for (size_t c=0; c<numCols; ++c) {
+                double &rValue = rColumns[c][firstRow+row];
+                if (pField > pLineEnd) {
+                    rValue = std::numeric_limits<double>::quiet_NaN();
+                    rBadColumns[c] = true;
+                    continue;
+                }
+                const char *pFieldEnd = pField;
+                while ((pFieldEnd != pLineEnd) && (*pFieldEnd != separator)) {
+                    ++pFieldEnd;
+                }
+                if (!parseDouble(pField, pFieldEnd, allowDecimalComma, rValue)) {
+                    rValue = std::numeric_limits<double>::quiet_NaN();
+                    rBadColumns[c] = true;
+                }
+                pField = pFieldEnd+1;
+            }
+            ++row;
+        }
+        p = pLineEnd+1;
+    }
+}
+
+}
+
+void CSVColumnData::clear()
+{
+    mColumns.clear();
+    mBadColumns.clear();
+    mNumRows = 0;
+}
+
+size_t CSVColumnData::getNumRows() const
+{
+    return mNumRows;
+}
+
+size_t CSVColumnData::getNumCols() const
+{
+    return mColumns.size();
+}
+
+//! @brief Check if all values in a column could be parsed, columnIdx must be in range
+bool CSVColumnData::isColumnOK(const size_t columnIdx) const
+{
+    return !mBadColumns[columnIdx];
+}
+
+//! @brief Access one column, columnIdx must be in range
+//! @details Values that could not be parsed are NaN, see isColumnOK()
+const std::vector<double> &CSVColumnData::getColumn(const size_t columnIdx) const
+{
+    return mColumns[columnIdx];
+}
+
+//! @brief Move a column into rColumn without copying, the column in this object will be left empty
+//! @param[in] columnIdx The column index
+//! @param[out] rColumn The destination, its previous contents are discarded
+//! @returns False if the column index is out of range or if the column has values that could not be parsed
+bool CSVColumnData::takeColumn(const size_t columnIdx, std::vector<double> &rColumn)
+{
+    if ((columnIdx < mColumns.size()) && !mBadColumns[columnIdx]) {
+        rColumn.clear();
+        rColumn.swap(mColumns[columnIdx]);
+        return true;
+    }
+    return false;
+}
+
 CSVParserNG::CSVParserNG(const char separator_char, size_t linesToSkip)
 {
     mpCsvParser = new indcsvp::IndexingCSVParser();
     mpCsvParser->setSeparatorChar(separator_char);
     mpCsvParser->setNumLinesToSkip(linesToSkip);
+    mpMappedBuffer = nullptr;
+    mSeparatorChar = separator_char;
+    mCommentChar = '\0';
+    mNumLinesToSkip = linesToSkip;
 }
 
 CSVParserNG::~CSVParserNG()
 {
     mpCsvParser->closeFile();
     delete mpCsvParser;
+    unmapFile();
 }
 
 bool CSVParserNG::openText(HString text)
@@ -116,26 +478,31 @@ bool CSVParserNG::takeOwnershipOfFile(FILE* pFile)
 void CSVParserNG::closeFile()
 {
     mpCsvParser->closeFile();
+    unmapFile();
 }
 
 void CSVParserNG::setCommentChar(char commentChar)
 {
     mpCsvParser->setCommentChar(commentChar);
+    mCommentChar = commentChar;
 }
 
 void CSVParserNG::setLinesToSkip(size_t linesToSkip)
 {
     mpCsvParser->setNumLinesToSkip(linesToSkip);
+    mNumLinesToSkip = linesToSkip;
 }
 
 void CSVParserNG::setFieldSeparator(const char sep)
 {
     mpCsvParser->setSeparatorChar(sep);
+    mSeparatorChar = sep;
 }
 
 char CSVParserNG::autoSetFieldSeparator(std::vector<char> &rAlternatives)
 {
-    return mpCsvParser->autoSetSeparatorChar(rAlternatives);
+    mSeparatorChar = mpCsvParser->autoSetSeparatorChar(rAlternatives);
+    return mSeparatorChar;
 }
 
 void CSVParserNG::indexFile()
@@ -249,3 +616,127 @@ bool CSVParserNG::copyEveryNthFromColumnRange(const size_t columnIdx, const size
         return false;
     }
 }
+
+//! @brief Memory map a file for use with parseMappedData()
+//! @details This is an alternative to openFile() and indexFile() for large purely numeric files
+//! @param[in] rFilepath The file to map
+//! @returns True if the file could be mapped
+bool CSVParserNG::mapFile(const HString &rFilepath)
+{
+    unmapFile();
+    mpMappedBuffer = new CSVMappedBuffer();
+    if (!mpMappedBuffer->mapFile(rFilepath)) {
+        mErrorString = "Could not map file: "+rFilepath;
+        unmapFile();
+        return false;
+    }
+    return true;
+}
+
+//! @brief Use a copy of a text for use with parseMappedData()
+bool CSVParserNG::mapText(const HString &rText)
+{
+    unmapFile();
+    mpMappedBuffer = new CSVMappedBuffer();
+    mpMappedBuffer->setText(rText);
+    return true;
+}
+
+void CSVParserNG::unmapFile()
+{
+    delete mpMappedBuffer;
+    mpMappedBuffer = nullptr;
+}
+
+//! @brief Parse all numeric data in a mapped file or text into columns
+//! @details Lines are indexed and parsed in parallel, directly from the mapped memory. Lines to skip are skipped, blank
+//! lines and comment lines are ignored. As with the indexing parser, rows may have different numbers of columns and
+//! columns may contain non-numeric values, such values are set to NaN and the column is marked as not OK in rData.
+//! @param[out] rData The parsed data, with as many columns as the longest row
+//! @param[in] numThreads The number of threads to use, 0 = use the number of hardware threads
+//! @returns False if nothing is mapped or if there are no data rows, see getErrorString()
+bool CSVParserNG::parseMappedData(CSVColumnData &rData, size_t numThreads)
+{
+    rData.clear();
+    if (!mpMappedBuffer) {
+        mErrorString = "No file or text is mapped";
+        return false;
+    }
+
+    const char *p = mpMappedBuffer->begin();
+    const char *pEnd = mpMappedBuffer->end();
+
+    // Skip header lines
+    for (size_t l=0; (l<mNumLinesToSkip) && (p<pEnd); ++l) {
+        p = findLineEnd(p, pEnd)+1;
+    }
+    if (p >= pEnd) {
+        mErrorString = "No data rows found";
+        return false;
+    }
+
+    const bool allowDecimalComma = (mSeparatorChar != ',');
+
+    // Split into chunks at line boundaries, small inputs are not worth the thread overhead
+    if (numThreads == 0) {
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    const size_t minChunkSize = 1 << 20;
+    numThreads = std::max(std::min(numThreads, size_t(pEnd-p)/minChunkSize), size_t(1));
+    std::vector<const char*> chunkBegins(numThreads+1, pEnd);
+    chunkBegins[0] = p;
+    for (size_t t=1; t<numThreads; ++t) {
+        const char *pSplit = std::max(p+(pEnd-p)*t/numThreads, chunkBegins[t-1]);
+        chunkBegins[t] = (pSplit < pEnd) ? std::min(findLineEnd(pSplit, pEnd)+1, pEnd) : pEnd;
+    }
+
+    // Count rows and columns in each chunk, then allocate all columns once
+    std::vector<size_t> chunkFirstRow(numThreads+1, 0);
+    std::vector<size_t> chunkNumCols(numThreads, 0);
+    {
+        std::vector<std::thread> threads;
+        for (size_t t=1; t<numThreads; ++t) {
+            threads.push_back(std::thread([&, t](){
+                chunkFirstRow[t+1] = countDataLines(chunkBegins[t], chunkBegins[t+1], mSeparatorChar, mCommentChar, chunkNumCols[t]); }));
+        }
+        chunkFirstRow[1] = countDataLines(chunkBegins[0], chunkBegins[1], mSeparatorChar, mCommentChar, chunkNumCols[0]);
+        for (std::thread &rThread : threads) {
+            rThread.join();
+        }
+    }
+    for (size_t t=1; t<=numThreads; ++t) {
+        chunkFirstRow[t] += chunkFirstRow[t-1];
+    }
+    const size_t numRows = chunkFirstRow[numThreads];
+    const size_t numCols = *std::max_element(chunkNumCols.begin(), chunkNumCols.end());
+    if (numRows == 0) {
+        mErrorString = "No data rows found";
+        return false;
+    }
+    rData.mColumns.resize(numCols);
+    for (std::vector<double> &rColumn : rData.mColumns) {
+        rColumn.resize(numRows);
+    }
+
+    // Parse each chunk directly into its part of the columns, each chunk marks its own bad columns
+    std::vector< std::vector<char> > chunkBadColumns(numThreads, std::vector<char>(numCols, false));
+    {
+        std::vector<std::thread> threads;
+        for (size_t t=1; t<numThreads; ++t) {
+            threads.push_back(std::thread([&, t](){
+                parseDataLines(chunkBegins[t], chunkBegins[t+1], mSeparatorChar, mCommentChar, allowDecimalComma, rData.mColumns, chunkFirstRow[t], chunkBadColumns[t]); }));
+        }
+        parseDataLines(chunkBegins[0], chunkBegins[1], mSeparatorChar, mCommentChar, allowDecimalComma, rData.mColumns, chunkFirstRow[0], chunkBadColumns[0]);
+        for (std::thread &rThread : threads) {
+            rThread.join();
+        }
+    }
+    rData.mBadColumns.assign(numCols, false);
+    for (size_t t=0; t<numThreads; ++t) {
+        for (size_t c=0; c<numCols; ++c) {
+            rData.mBadColumns[c] = rData.mBadColumns[c] || chunkBadColumns[t][c];
+        }
+    }
+    rData.mNumRows = numRows;
+    return true;
+}
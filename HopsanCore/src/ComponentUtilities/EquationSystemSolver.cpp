@@ -67,18 +67,10 @@ using namespace hopsan;
 //! @param n Number of states
 EquationSystemSolver::EquationSystemSolver(Component *pParentComponent, int n)
 {
-    mpParentComponent = pParentComponent;
-
-    // Weights for equations, used when running several iterations
-    mSystemEquationWeight[0]=1;
-    mSystemEquationWeight[1]=0.67;
-    mSystemEquationWeight[2]=0.5;
-    mSystemEquationWeight[3]=0.5;
-
-    mnVars = n;
-    mpOrder = new int[n];                   //Used to keep track of the order of the equations
-    mpDeltaStateVar = new Vec(n);           //Difference between nwe state variables and the previous ones
-    mSingular = false;                      //Tells whether or not the Jacobian is singular
+    init(pParentComponent, n);
+    mpJacobian = 0;
+    mpEquations = 0;
+    mpVariables = 0;
 }
 
 
@@ -90,19 +82,7 @@ EquationSystemSolver::EquationSystemSolver(Component *pParentComponent, int n)
 //! @param pVariables Pointer to vector with state variables
 EquationSystemSolver::EquationSystemSolver(Component *pParentComponent, int n, Matrix *pJacobian, Vec *pEquations, Vec *pVariables)
 {
-    mpParentComponent = pParentComponent;
-
-    // Weights for equations, used when running several iterations
-    mSystemEquationWeight[0]=1;
-    mSystemEquationWeight[1]=0.67;
-    mSystemEquationWeight[2]=0.5;
-    mSystemEquationWeight[3]=0.5;
-
-    mnVars = n;
-    mpOrder = new int[n];                   //Used to keep track of the order of the equations
-    mpDeltaStateVar = new Vec(n);           //Difference between nwe state variables and the previous ones
-    mSingular = false;                      //Tells whether or not the Jacobian is singular
-
+    init(pParentComponent, n);
     mpJacobian = pJacobian;
     mpEquations = pEquations;
     mpVariables = pVariables;
@@ -114,23 +94,49 @@ EquationSystemSolver::EquationSystemSolver(Component *pParentComponent, int n, M
 //! @param equations Vector of system equations
 //! @param variables Vector of state variables
 //! @param iteration How many times the solver has been executed before in the same time step
-void EquationSystemSolver::solve(Matrix &jacobian, Vec &equations, Vec &variables, int iteration)
+//! @returns True if the residual was already within tolerance and the state variables were left unchanged
+bool EquationSystemSolver::solve(Matrix &jacobian, Vec &equations, Vec &variables, int iteration)
 {
-    //Stop simulation if LU decomposition failed due to singularity
-    if(!ludcmp(jacobian, mpOrder) && mpParentComponent)
+    const StepActionEnum action = beginIteration(equations, iteration);
+    if(action == SkipUpdate)
     {
-        mpParentComponent->addErrorMessage("Unable to perform LU-decomposition: Jacobian matrix is probably singular.");
-        mpParentComponent->stopSimulation();
+        return true;
+    }
+
+    Matrix *pLU = &jacobian;
+    if(action == Factorize)
+    {
+        //Stop simulation if LU decomposition failed due to singularity
+        if(!ludcmp(jacobian, mpOrder))
+        {
+            factorizationFailed();
+        }
+        else if(mReuseJacobian)
+        {
+            for(int r=0; r<mnVars; ++r)
+            {
+                for(int c=0; c<mnVars; ++c)
+                {
+                    mLU[r][c] = jacobian[r][c];
+                }
+            }
+            mHaveLU = true;
+        }
+    }
+    else
+    {
+        pLU = &mLU;
     }
 
     //Solve system using L and U matrices
-    solvlu(jacobian,equations,*mpDeltaStateVar,mpOrder);
+    solvlu(*pLU,equations,*mpDeltaStateVar,mpOrder);
 
     //Calculate new system variables
     for(int i=0; i<mnVars; ++i)
     {
         variables[i] = variables[i] - mSystemEquationWeight[iteration - 1] * (*mpDeltaStateVar)[i];
     }
+    return false;
 }
 
 
@@ -139,45 +145,131 @@ void EquationSystemSolver::solve(Matrix &jacobian, Vec &equations, Vec &variable
 //! @param jacobian Jacobian matrix
 //! @param equations Vector of system equations
 //! @param variables Vector of state variables
-void EquationSystemSolver::solve(Matrix &jacobian, Vec &equations, Vec &variables)
+//! @returns True if the residual was already within tolerance and the state variables were left unchanged
+bool EquationSystemSolver::solve(Matrix &jacobian, Vec &equations, Vec &variables)
 {
-    //Stop simulation if LU decomposition failed due to singularity
-    if(!ludcmp(jacobian, mpOrder) && mpParentComponent)
-    {
-        mpParentComponent->addErrorMessage("Unable to perform LU-decomposition: Jacobian matrix is probably singular.");
-        mpParentComponent->stopSimulation();
-    }
+    return solve(jacobian, equations, variables, 1);
+}
 
-    //Solve system using L and U matrices
-    solvlu(jacobian,equations,*mpDeltaStateVar,mpOrder);
 
-    //Calculate new system variables
-    for(int i=0; i<mnVars; ++i)
+
+
+//! @brief Solves a system of equations. Requires pre-defined pointers to jacobian, equations and state variables.
+//! @returns True if the residual was already within tolerance and the state variables were left unchanged
+bool EquationSystemSolver::solve()
+{
+    return solve(*mpJacobian, *mpEquations, *mpVariables, 1);
+}
+
+
+//! @brief Enables or disables reuse of the LU factorization of the Jacobian (modified Newton iteration)
+//! @details When enabled, the factorization is kept across iterations and time steps. A new factorization is made
+//! when the residual is not reduced by at least stallRatio between two iterations in the same time step,
+//! or when the stored factorization has been used maxJacobianAge times.
+//! The Jacobian must still be evaluated before each call, it is only factorized when needed.
+//! @param reuse Enable or disable Jacobian reuse
+//! @param stallRatio Maximum allowed ratio between the residual of two consecutive iterations
+//! @param maxJacobianAge Maximum number of iterations that may use the same factorization
+void EquationSystemSolver::setJacobianReuse(bool reuse, double stallRatio, int maxJacobianAge)
+{
+    mReuseJacobian = reuse;
+    mStallRatio = stallRatio;
+    mMaxJacobianAge = (maxJacobianAge > 0) ? maxJacobianAge : 1;
+    if(mReuseJacobian && (mLU.rows() != mnVars))
     {
-        variables[i] = variables[i] - (*mpDeltaStateVar)[i];
+        mLU.create(mnVars, mnVars);
     }
+    invalidateJacobian();
 }
 
 
+//! @brief Sets the residual tolerance for early exit
+//! @details If the max norm of the system equations is below this tolerance, solve() returns true without
+//! updating the state variables. The caller may then break its iteration loop. A tolerance <= 0 disables early exit.
+//! @param tolerance The residual tolerance
+void EquationSystemSolver::setResidualTolerance(double tolerance)
+{
+    mResidualTolerance = tolerance;
+}
 
 
-//! @brief Solves a system of equations. Requires pre-defined pointers to jacobian, equations and state variables.
-void EquationSystemSolver::solve()
+//! @brief Forces a new factorization of the Jacobian in the next iteration
+//! @details Should be called when the system changes discontinuously, for example after a mode switch
+void EquationSystemSolver::invalidateJacobian()
 {
-    //Stop simulation if LU decomposition failed due to singularity
-    if(!ludcmp(*mpJacobian, mpOrder) && mpParentComponent)
-    {
-        mpParentComponent->addErrorMessage("Unable to perform LU-decomposition: Jacobian matrix is probably singular.");
-        mpParentComponent->stopSimulation();
-    }
+    mHaveLU = false;
+    mJacobianAge = 0;
+    mPrevResidual = 0;
+}
 
-    //Solve system using L and U matrices
-    solvlu(*mpJacobian,*mpEquations,*mpDeltaStateVar,mpOrder);
 
-    //Calculate new system variables
-    for(int i=0; i<mnVars; ++i)
+//! @brief Returns the number of Newton iterations (calls to solve) since construction or last reset
+size_t EquationSystemSolver::getNumIterations() const
+{
+    return mNumIterations;
+}
+
+
+//! @brief Returns the number of LU factorizations since construction or last reset
+size_t EquationSystemSolver::getNumFactorizations() const
+{
+    return mNumFactorizations;
+}
+
+
+//! @brief Returns the number of iterations that exited early due to the residual tolerance since construction or last reset
+size_t EquationSystemSolver::getNumEarlyExits() const
+{
+    return mNumEarlyExits;
+}
+
+
+//! @brief Resets the iteration, factorization and early exit counters
+void EquationSystemSolver::resetCounters()
+{
+    mNumIterations = 0;
+    mNumFactorizations = 0;
+    mNumEarlyExits = 0;
+}
+
+
+//! @brief Common initialization for the constructors
+//! @param pParentComponent Pointer to parent component
+//! @param n Number of states
+void EquationSystemSolver::init(Component *pParentComponent, int n)
+{
+    mpParentComponent = pParentComponent;
+
+    // Weights for equations, used when running several iterations
+    mSystemEquationWeight[0]=1;
+    mSystemEquationWeight[1]=0.67;
+    mSystemEquationWeight[2]=0.5;
+    mSystemEquationWeight[3]=0.5;
+
+    mnVars = n;
+    mpOrder = new int[n];                   //Used to keep track of the order of the equations
+    mpDeltaStateVar = new Vec(n);           //Difference between nwe state variables and the previous ones
+    mSingular = false;                      //Tells whether or not the Jacobian is singular
+
+    // Jacobian reuse and early exit are disabled by default
+    mReuseJacobian = false;
+    mStallRatio = 0.5;
+    mMaxJacobianAge = 20;
+    mResidualTolerance = 0;
+    invalidateJacobian();
+    resetCounters();
+}
+
+
+//! @brief Reports a failed LU decomposition and stops the simulation
+void EquationSystemSolver::factorizationFailed()
+{
+    mHaveLU = false;
+    mSingular = true;
+    if(mpParentComponent)
     {
-        (*mpVariables)[i] = (*mpVariables)[i] - (*mpDeltaStateVar)[i];
+        mpParentComponent->addErrorMessage("Unable to perform LU-decomposition: Jacobian matrix is probably singular.");
+        mpParentComponent->stopSimulation();
     }
 }
 
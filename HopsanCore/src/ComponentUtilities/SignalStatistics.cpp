@@ -0,0 +1,324 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+//!
+//! @file   SignalStatistics.cpp
+//!
+//! @brief Contains the Core Utility signal statistics and steady-state identification functions
+//!
+//$Id$
+
+#include "ComponentUtilities/SignalStatistics.h"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <random>
+
+using namespace hopsan;
+
+namespace {
+
+//! @brief Adds normally distributed noise to the data, the statistical steady-state tests need some noise to be well defined
+void addNoise(const double *pData, const size_t n, const double stdDev, std::vector<double> &rNoisy)
+{
+    rNoisy.resize(n);
+    if (stdDev > 0)
+    {
+        std::mt19937 generator(std::random_device{}());
+        std::normal_distribution<double> noise(0.0, stdDev);
+        for (size_t i=0; i<n; ++i)
+        {
+            rNoisy[i] = pData[i] + noise(generator);
+        }
+    }
+    else
+    {
+        std::copy(pData, pData+n, rNoisy.begin());
+    }
+}
+
+//! @brief Returns the number of samples in the moving window, the window contains the samples logged before time reaches the window length
+size_t numWindowSamples(const double *pTime, const size_t n, const double window)
+{
+    return size_t(std::lower_bound(pTime, pTime+n, window) - pTime);
+}
+
+//! @brief Ratio of the two variance estimates, guarded against division by zero
+inline double varianceRatio(const double s1, const double s2)
+{
+    return std::fmax(std::numeric_limits<double>::min(), std::fabs(s1)) / std::fmax(std::numeric_limits<double>::min(), std::fabs(s2));
+}
+
+//! @brief Steady if max-min of the previous nw samples is below the tolerance
+//! @details The window minimum and maximum are tracked with monotonic queues, so each sample is pushed and popped at most once
+void rectangularWindowTest(const double *pData, const size_t n, const size_t nw, const double tolerance, std::vector<double> &rSteadyState)
+{
+    if (nw == 0)
+    {
+        std::fill(rSteadyState.begin(), rSteadyState.end(), (0.0 < tolerance) ? 1.0 : 0.0);
+        return;
+    }
+
+    // Each index is pushed once, so plain arrays with head and tail positions are enough as queues
+    std::vector<size_t> maxQueue(n), minQueue(n);
+    size_t maxHead=0, maxTail=0, minHead=0, minTail=0;
+    for (size_t j=0; j+1<n; ++j)
+    {
+        const double x = pData[j];
+        while (maxTail > maxHead && pData[maxQueue[maxTail-1]] <= x)
+        {
+            --maxTail;
+        }
+        maxQueue[maxTail++] = j;
+        while (minTail > minHead && pData[minQueue[minTail-1]] >= x)
+        {
+            --minTail;
+        }
+        minQueue[minTail++] = j;
+
+        // The window for sample i=j+1 is [i-nw, i-1]
+        const size_t i = j+1;
+        if (i < nw)
+        {
+            continue;
+        }
+        while (maxQueue[maxHead]+nw < i)
+        {
+            ++maxHead;
+        }
+        while (minQueue[minHead]+nw < i)
+        {
+            ++minHead;
+        }
+        rSteadyState[i] = (pData[maxQueue[maxHead]]-pData[minQueue[minHead]] < tolerance) ? 1.0 : 0.0;
+    }
+}
+
+//! @brief Steady if the ratio between the window variance and the variance estimated from successive differences is below the tolerance
+//! @details Running sums of the (shifted) values, squared values and squared differences are updated as the window moves, and are
+//! recomputed from scratch once per window length to keep the rounding errors bounded.
+void varianceRatioTest(const std::vector<double> &rX, const size_t nw, const double tolerance, std::vector<double> &rSteadyState)
+{
+    const size_t n = rX.size();
+    if (nw < 2)
+    {
+        // Both variance estimates are undefined, which the original formulation treats as a ratio of one
+        std::fill(rSteadyState.begin()+std::min(nw, n), rSteadyState.end(), (1.0 < tolerance) ? 1.0 : 0.0);
+        return;
+    }
+
+    // Shift by a representative value to avoid cancellation in sumSq - sum^2/nw
+    const double shift = rX[0];
+    double sum=0, sumSq=0, sumDiffSq=0;
+    for (size_t i=nw; i<n; ++i)
+    {
+        const size_t first = i-nw;
+        if ((first % nw) == 0)
+        {
+            sum = sumSq = sumDiffSq = 0;
+            for (size_t j=first; j<i; ++j)
+            {
+                const double x = rX[j]-shift;
+                sum += x;
+                sumSq += x*x;
+            }
+            for (size_t j=first; j+1<i; ++j)
+            {
+                const double d = rX[j+1]-rX[j];
+                sumDiffSq += d*d;
+            }
+        }
+        else
+        {
+            // Move the window one step, rX[i-1] enters and rX[first-1] leaves
+            const double in = rX[i-1]-shift;
+            const double out = rX[first-1]-shift;
+            sum += in-out;
+            sumSq += in*in-out*out;
+            const double dIn = rX[i-1]-rX[i-2];
+            const double dOut = rX[first]-rX[first-1];
+            sumDiffSq += dIn*dIn-dOut*dOut;
+        }
+
+        const double s1 = (sumSq-sum*sum/double(nw))/(nw-1.0);
+        const double s2 = sumDiffSq/(nw-1.0);
+        rSteadyState[i] = (varianceRatio(s1, s2) < tolerance) ? 1.0 : 0.0;
+    }
+}
+
+//! @brief Variance ratio test using exponentially weighted moving averages instead of a window
+void movingAverageVarianceRatioTest(const std::vector<double> &rX, const double tolerance, const double l1, const double l2,
+                                    const double l3, std::vector<double> &rSteadyState)
+{
+    double xf = 0;
+    double df = 0;
+    double xold = rX[0];
+    for (size_t i=1; i<rX.size(); ++i)
+    {
+        const double x = rX[i];
+        const double vf = l2*(x-xf)*(x-xf);
+        xf = l1*x+(1.0-l1)*xf;
+        const double s1 = (2.0-l1)/2.0*vf;
+        df = l3*(x-xold)*(x-xold) + (1-l3)*df;
+        const double s2 = df/2.0;
+        rSteadyState[i] = (varianceRatio(s1, s2) < tolerance) ? 1.0 : 0.0;
+        xold = x;
+    }
+}
+
+}
+
+//! @brief Finds the samples with time in [minTime, maxTime]
+//! @param[in] pTime The (sorted) time vector
+//! @param[in] n The number of samples
+//! @param[in] minTime The start of the range
+//! @param[in] maxTime The end of the range
+//! @param[out] rFirst The first sample in the range
+//! @param[out] rEnd One past the last sample in the range
+void hopsan::signalSampleRange(const double *pTime, const size_t n, const double minTime, const double maxTime, size_t &rFirst, size_t &rEnd)
+{
+    rFirst = size_t(std::lower_bound(pTime, pTime+n, minTime) - pTime);
+    rEnd = size_t(std::upper_bound(pTime+rFirst, pTime+n, maxTime) - pTime);
+}
+
+//! @brief Computes mean, RMS, min, max and the trapezoidal integral of a signal in one pass
+//! @param[in] pTime The time vector, if 0 the integral is computed with unit sample spacing
+//! @param[in] pData The data vector
+//! @param[in] first The first sample to include
+//! @param[in] end One past the last sample to include
+//! @param[out] rStatistics The result
+//! @returns false if the range is empty
+bool hopsan::computeSignalStatistics(const double *pTime, const double *pData, const size_t first, const size_t end, SignalStatistics &rStatistics)
+{
+    rStatistics.firstIndex = first;
+    rStatistics.numSamples = (end > first) ? end-first : 0;
+    if (rStatistics.numSamples == 0)
+    {
+        return false;
+    }
+
+    double sum=0, sumSq=0, integral=0;
+    double min=pData[first], max=pData[first];
+    size_t minIndex=first, maxIndex=first;
+    double prevX=pData[first];
+    double prevT=pTime ? pTime[first] : 0;
+    for (size_t i=first; i<end; ++i)
+    {
+        const double x = pData[i];
+        sum += x;
+        sumSq += x*x;
+        if (x < min)
+        {
+            min = x;
+            minIndex = i;
+        }
+        if (x > max)
+        {
+            max = x;
+            maxIndex = i;
+        }
+        const double t = pTime ? pTime[i] : double(i-first);
+        integral += 0.5*(t-prevT)*(x+prevX);
+        prevT = t;
+        prevX = x;
+    }
+
+    rStatistics.mean = sum/double(rStatistics.numSamples);
+    rStatistics.rms = std::sqrt(sumSq/double(rStatistics.numSamples));
+    rStatistics.min = min;
+    rStatistics.max = max;
+    rStatistics.minIndex = minIndex;
+    rStatistics.maxIndex = maxIndex;
+    rStatistics.integral = integral;
+    return true;
+}
+
+//! @brief Computes mean, RMS, min, max and the trapezoidal integral of a signal over a time range
+//! @param[in] pTime The (sorted) time vector
+//! @param[in] pData The data vector
+//! @param[in] n The number of samples
+//! @param[in] minTime The start of the range
+//! @param[in] maxTime The end of the range
+//! @param[out] rStatistics The result
+//! @returns false if no samples are in the range
+bool hopsan::computeSignalStatistics(const double *pTime, const double *pData, const size_t n, const double minTime, const double maxTime,
+                                     SignalStatistics &rStatistics)
+{
+    size_t first, end;
+    signalSampleRange(pTime, n, minTime, maxTime, first, end);
+    return computeSignalStatistics(pTime, pData, first, end, rStatistics);
+}
+
+//! @brief Identifies steady-state conditions of a signal
+//! @details All methods run in O(n) time regardless of the window length. The result is 1 for samples considered steady and 0 otherwise.
+//! @param[in] method Steady-state identification method to use
+//! @param[in] pTime The (sorted) time vector
+//! @param[in] pData The data vector
+//! @param[in] n The number of samples
+//! @param[in] tolerance Tolerance for steady-state
+//! @param[in] window Length of moving window in time (used by the rectangular window and variance ratio methods)
+//! @param[in] noiseStdDev Standard deviation of white noise added to the data (used by the variance ratio methods)
+//! @param[in] lambda1 Filter coefficient (used by the moving average variance ratio method)
+//! @param[in] lambda2 Filter coefficient (used by the moving average variance ratio method)
+//! @param[in] lambda3 Filter coefficient (used by the moving average variance ratio method)
+//! @param[out] rSteadyState The result, one value per sample
+//! @returns false if the method is unknown
+bool hopsan::identifySteadyState(const SteadyStateMethodT method, const double *pTime, const double *pData, const size_t n,
+                                 const double tolerance, const double window, const double noiseStdDev,
+                                 const double lambda1, const double lambda2, const double lambda3, std::vector<double> &rSteadyState)
+{
+    rSteadyState.assign(n, 0.0);
+    if (n == 0)
+    {
+        return true;
+    }
+
+    std::vector<double> noisy;
+    switch (method)
+    {
+    case RectangularWindowSteadyState:
+        rectangularWindowTest(pData, n, numWindowSamples(pTime, n, window), tolerance, rSteadyState);
+        return true;
+    case VarianceRatioSteadyState:
+        addNoise(pData, n, noiseStdDev, noisy);
+        varianceRatioTest(noisy, numWindowSamples(pTime, n, window), tolerance, rSteadyState);
+        return true;
+    case MovingAverageVarianceRatioSteadyState:
+        addNoise(pData, n, noiseStdDev, noisy);
+        movingAverageVarianceRatioTest(noisy, tolerance, lambda1, lambda2, lambda3, rSteadyState);
+        return true;
+    }
+    return false;
+}
+
+//! @brief Returns the first sample from which the signal remains in steady-state, or the number of samples if the last sample is not steady
+//! @param[in] rSteadyState The result from identifySteadyState()
+size_t hopsan::steadyStateStartIndex(const std::vector<double> &rSteadyState)
+{
+    size_t i = rSteadyState.size();
+    while (i > 0 && rSteadyState[i-1] > 0.5)
+    {
+        --i;
+    }
+    return i;
+}
@@ -0,0 +1,525 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+//!
+//! @file   SpectralAnalysis.cpp
+//!
+//! @brief Contains the Core Utility spectral analysis functions (FFT and power spectral density)
+//!
+//$Id$
+
+#include "ComponentUtilities/SpectralAnalysis.h"
+// For MSVC we need this define to get access to M_PI
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <thread>
+
+using namespace hopsan;
+
+namespace {
+
+typedef std::complex<double> Complex;
+
+// std::complex multiplication is slow unless compiled with fast-math, due to its inf/nan handling
+inline Complex mul(const Complex &a, const Complex &b)
+{
+    return Complex(a.real()*b.real()-a.imag()*b.imag(), a.real()*b.imag()+a.imag()*b.real());
+}
+
+// Multiplication by -i
+inline Complex mulNegI(const Complex &a)
+{
+    return Complex(a.imag(), -a.real());
+}
+
+// In each stage the input consists of s interleaved sequences of length l = m*radix, element k of sequence q is at x[q+s*k].
+// The butterflies combine the elements j+m*t (t<radix) and the result is written so that the next stage (with stride
+// s*radix) reads it in order, see e.g. Van Loan, "Computational Frameworks for the Fast Fourier Transform".
+
+void radix2(const Complex *x, Complex *y, const size_t m, const size_t s, const Complex *pTw)
+{
+    for (size_t j=0; j<m; ++j) {
+        const Complex w1 = pTw[j];
+        const Complex *x0 = x+s*j, *x1 = x+s*(j+m);
+        Complex *y0 = y+s*2*j, *y1 = y0+s;
+        for (size_t q=0; q<s; ++q) {
+            const Complex a0 = x0[q], a1 = x1[q];
+            y0[q] = a0+a1;
+            y1[q] = mul(a0-a1, w1);
+        }
+    }
+}
+
+void radix3(const Complex *x, Complex *y, const size_t m, const size_t s, const Complex *pTw)
+{
+    const double sin60 = 0.86602540378443864676;
+    for (size_t j=0; j<m; ++j) {
+        const Complex w1 = pTw[2*j], w2 = pTw[2*j+1];
+        const Complex *x0 = x+s*j, *x1 = x+s*(j+m), *x2 = x+s*(j+2*m);
+        Complex *y0 = y+s*3*j, *y1 = y0+s, *y2 = y1+s;
+        for (size_t q=0; q<s; ++q) {
+            const Complex a0 = x0[q], a1 = x1[q], a2 = x2[q];
+            const Complex t = a1+a2;
+            const Complex u = a0-0.5*t;
+            const Complex v = mulNegI(sin60*(a1-a2));
+            y0[q] = a0+t;
+            y1[q] = mul(u+v, w1);
+            y2[q] = mul(u-v, w2);
+        }
+    }
+}
+
+void radix4(const Complex *x, Complex *y, const size_t m, const size_t s, const Complex *pTw)
+{
+    for (size_t j=0; j<m; ++j) {
+        const Complex w1 = pTw[3*j], w2 = pTw[3*j+1], w3 = pTw[3*j+2];
+        const Complex *x0 = x+s*j, *x1 = x+s*(j+m), *x2 = x+s*(j+2*m), *x3 = x+s*(j+3*m);
+        Complex *y0 = y+s*4*j, *y1 = y0+s, *y2 = y1+s, *y3 = y2+s;
+        for (size_t q=0; q<s; ++q) {
+            const Complex a0 = x0[q], a1 = x1[q], a2 = x2[q], a3 = x3[q];
+            const Complex t0 = a0+a2, t1 = a0-a2, t2 = a1+a3, t3 = mulNegI(a1-a3);
+            y0[q] = t0+t2;
+            y1[q] = mul(t1+t3, w1);
+            y2[q] = mul(t0-t2, w2);
+            y3[q] = mul(t1-t3, w3);
+        }
+    }
+}
+
+void radix5(const Complex *x, Complex *y, const size_t m, const size_t s, const Complex *pTw)
+{
+    const double c1 = 0.30901699437494742410, c2 = -0.80901699437494742410;
+    const double s1 = 0.95105651629515357212, s2 = 0.58778525229247312917;
+    for (size_t j=0; j<m; ++j) {
+        const Complex w1 = pTw[4*j], w2 = pTw[4*j+1], w3 = pTw[4*j+2], w4 = pTw[4*j+3];
+        const Complex *x0 = x+s*j, *x1 = x+s*(j+m), *x2 = x+s*(j+2*m), *x3 = x+s*(j+3*m), *x4 = x+s*(j+4*m);
+        Complex *y0 = y+s*5*j, *y1 = y0+s, *y2 = y1+s, *y3 = y2+s, *y4 = y3+s;
+        for (size_t q=0; q<s; ++q) {
+            const Complex a0 = x0[q], a1 = x1[q], a2 = x2[q], a3 = x3[q], a4 = x4[q];
+            const Complex t1 = a1+a4, t2 = a2+a3, t3 = a1-a4, t4 = a2-a3;
+            const Complex u1 = a0+c1*t1+c2*t2, u2 = a0+c2*t1+c1*t2;
+            const Complex v1 = mulNegI(s1*t3+s2*t4), v2 = mulNegI(s2*t3-s1*t4);
+            y0[q] = a0+t1+t2;
+            y1[q] = mul(u1+v1, w1);
+            y2[q] = mul(u2+v2, w2);
+            y3[q] = mul(u2-v2, w3);
+            y4[q] = mul(u1-v1, w4);
+        }
+    }
+}
+
+void radixGeneric(const Complex *x, Complex *y, const size_t radix, const size_t m, const size_t s, const Complex *pTw, const Complex *pRoots)
+{
+    std::vector<Complex> a(radix);
+    for (size_t j=0; j<m; ++j) {
+        for (size_t q=0; q<s; ++q) {
+            for (size_t k=0; k<radix; ++k) {
+                a[k] = x[q+s*(j+k*m)];
+            }
+            for (size_t t=0; t<radix; ++t) {
+                Complex sum = a[0];
+                size_t r = 0;
+                for (size_t k=1; k<radix; ++k) {
+                    r += t;
+                    if (r >= radix) {
+                        r -= radix;
+                    }
+                    sum += mul(a[k], pRoots[r]);
+                }
+                y[q+s*(radix*j+t)] = (t == 0) ? sum : mul(sum, pTw[(radix-1)*j+t-1]);
+            }
+        }
+    }
+}
+
+size_t numThreadsToUse(size_t numThreads, const size_t numTasks)
+{
+    if (numThreads == 0) {
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    return std::max(std::min(numThreads, numTasks), size_t(1));
+}
+
+}
+
+
+//! @brief Create an FFT plan
+//! @param[in] n The transform length, any length is supported but lengths with only the prime factors 2, 3 and 5 are the fastest
+FFTPlan::FFTPlan(const size_t n)
+{
+    mSize = n;
+
+    // Factor the length, radix 4 first as it needs the fewest operations per element
+    std::vector<size_t> factors;
+    size_t rest = n;
+    while ((rest > 1) && (rest % 4 == 0)) {
+        factors.push_back(4);
+        rest /= 4;
+    }
+    while ((rest > 1) && (rest % 2 == 0)) {
+        factors.push_back(2);
+        rest /= 2;
+    }
+    for (size_t f=3; f*f<=rest; f+=2) {
+        while (rest % f == 0) {
+            factors.push_back(f);
+            rest /= f;
+        }
+    }
+    if (rest > 1) {
+        factors.push_back(rest);
+    }
+
+    // Precompute the twiddle factors w^t, w = exp(-2*pi*i*j/l), for each stage, and the roots of unity for generic stages
+    size_t length = n;
+    for (const size_t radix : factors) {
+        Stage stage;
+        stage.radix = radix;
+        stage.length = length;
+        stage.twiddleOffset = mTwiddles.size();
+        stage.rootOffset = mRoots.size();
+        const size_t m = length/radix;
+        for (size_t j=0; j<m; ++j) {
+            for (size_t t=1; t<radix; ++t) {
+                mTwiddles.push_back(std::polar(1.0, -2.0*M_PI*double(j*t)/double(length)));
+            }
+        }
+        if (radix > 5) {
+            for (size_t r=0; r<radix; ++r) {
+                mRoots.push_back(std::polar(1.0, -2.0*M_PI*double(r)/double(radix)));
+            }
+        }
+        mStages.push_back(stage);
+        length = m;
+    }
+}
+
+size_t FFTPlan::getSize() const
+{
+    return mSize;
+}
+
+//! @brief Transform data in-place
+//! @param[in,out] pData Pointer to getSize() values
+//! @param[in,out] rWork Work space, resized if needed, reuse it between calls to avoid reallocation
+void FFTPlan::forward(std::complex<double> *pData, std::vector<std::complex<double> > &rWork) const
+{
+    if (rWork.size() < mSize) {
+        rWork.resize(mSize);
+    }
+    forward(pData, rWork.data());
+}
+
+//! @brief Transform data in-place
+//! @param[in,out] pData Pointer to getSize() values
+//! @param[in,out] pWork Work space of (at least) getSize() values
+void FFTPlan::forward(std::complex<double> *pData, std::complex<double> *pWork) const
+{
+    Complex *pX = pData;
+    Complex *pY = pWork;
+    size_t s = 1;
+    for (const Stage &rStage : mStages) {
+        const size_t m = rStage.length/rStage.radix;
+        const Complex *pTw = mTwiddles.data()+rStage.twiddleOffset;
+        switch (rStage.radix) {
+        case 2:
+            radix2(pX, pY, m, s, pTw);
+            break;
+        case 3:
+            radix3(pX, pY, m, s, pTw);
+            break;
+        case 4:
+            radix4(pX, pY, m, s, pTw);
+            break;
+        case 5:
+            radix5(pX, pY, m, s, pTw);
+            break;
+        default:
+            radixGeneric(pX, pY, rStage.radix, m, s, pTw, mRoots.data()+rStage.rootOffset);
+        }
+        s *= rStage.radix;
+        std::swap(pX, pY);
+    }
+    if (pX != pData) {
+        std::copy(pX, pX+mSize, pData);
+    }
+}
+
+
+//! @brief Returns a shared plan for the given length, plans are cached so that repeated transforms of the same length reuse them
+std::shared_ptr<const RealFFTPlan> RealFFTPlan::get(const size_t n)
+{
+    static std::mutex cacheMutex;
+    static std::map<size_t, std::shared_ptr<const RealFFTPlan> > cache;
+    const size_t maxNumCachedPlans = 32;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(n);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    if (cache.size() >= maxNumCachedPlans) {
+        cache.clear();
+    }
+    std::shared_ptr<const RealFFTPlan> pPlan = std::make_shared<const RealFFTPlan>(n);
+    cache.insert(std::make_pair(n, pPlan));
+    return pPlan;
+}
+
+//! @brief Create a real input FFT plan, prefer RealFFTPlan::get() to reuse plans
+//! @param[in] n The number of real input values
+RealFFTPlan::RealFFTPlan(const size_t n) : mComplexPlan((n % 2 == 0) ? n/2 : n)
+{
+    mSize = n;
+    if (n % 2 == 0) {
+        for (size_t k=0; k<=n/2; ++k) {
+            mPostTwiddles.push_back(std::polar(1.0, -2.0*M_PI*double(k)/double(n)));
+        }
+    }
+}
+
+size_t RealFFTPlan::getSize() const
+{
+    return mSize;
+}
+
+//! @brief Returns the number of frequency bins produced, n/2+1 (from 0 up to and including the Nyquist frequency for even n)
+size_t RealFFTPlan::getNumBins() const
+{
+    return mSize/2+1;
+}
+
+void RealFFTPlan::forward(const double *pInput, std::complex<double> *pOutput) const
+{
+    std::vector<Complex> work;
+    forward(pInput, pOutput, work);
+}
+
+//! @brief Transform real data
+//! @param[in] pInput Pointer to getSize() values
+//! @param[out] pOutput Pointer to getNumBins() values
+//! @param[in,out] rWork Work space, resized if needed, reuse it between calls to avoid reallocation
+void RealFFTPlan::forward(const double *pInput, std::complex<double> *pOutput, std::vector<std::complex<double> > &rWork) const
+{
+    if (mSize == 0) {
+        return;
+    }
+
+    // Odd lengths are transformed as complex data
+    if (mSize % 2 == 1) {
+        if (rWork.size() < 2*mSize) {
+            rWork.resize(2*mSize);
+        }
+        Complex *pData = rWork.data();
+        for (size_t i=0; i<mSize; ++i) {
+            pData[i] = Complex(pInput[i], 0.0);
+        }
+        mComplexPlan.forward(pData, pData+mSize);
+        std::copy(pData, pData+getNumBins(), pOutput);
+        return;
+    }
+
+    // Pack even and odd samples as real and imaginary parts, the output has room for the n/2 packed values
+    const size_t half = mSize/2;
+    for (size_t k=0; k<half; ++k) {
+        pOutput[k] = Complex(pInput[2*k], pInput[2*k+1]);
+    }
+    mComplexPlan.forward(pOutput, rWork);
+
+    // Separate the transforms of the even (E) and odd (O) samples, X[k] = E[k] + exp(-2*pi*i*k/n)*O[k]
+    // Bins k and half-k depend on the same two values so they are computed together (in-place)
+    const Complex z0 = pOutput[0];
+    pOutput[0] = Complex(z0.real()+z0.imag(), 0.0);
+    pOutput[half] = Complex(z0.real()-z0.imag(), 0.0);
+    for (size_t k=1; k<=half/2; ++k) {
+        const Complex zk = pOutput[k];
+        const Complex znk = std::conj(pOutput[half-k]);
+        const Complex ek = 0.5*(zk+znk);
+        const Complex ok = mulNegI(0.5*(zk-znk));
+        const Complex enk = std::conj(ek);
+        const Complex onk = std::conj(ok);
+        pOutput[k] = ek+mul(mPostTwiddles[k], ok);
+        pOutput[half-k] = enk+mul(mPostTwiddles[half-k], onk);
+    }
+}
+
+
+//! @brief Transform several real vectors of the same length in parallel
+//! @param[in] rPlan The plan to use for all transforms
+//! @param[in] rInputs Pointers to the input data, each with rPlan.getSize() values
+//! @param[out] rOutputs Pointers to the output data, each with room for rPlan.getNumBins() values
+//! @param[in] numThreads The number of threads to use, 0 = use all available cores
+void hopsan::forwardRealFFTBatch(const RealFFTPlan &rPlan, const std::vector<const double *> &rInputs, const std::vector<std::complex<double> *> &rOutputs, size_t numThreads)
+{
+    const size_t numTransforms = std::min(rInputs.size(), rOutputs.size());
+    numThreads = numThreadsToUse(numThreads, numTransforms);
+
+    auto transformRange = [&](const size_t t) {
+        std::vector<Complex> work;
+        for (size_t i=t; i<numTransforms; i+=numThreads) {
+            rPlan.forward(rInputs[i], rOutputs[i], work);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t=1; t<numThreads; ++t) {
+        threads.push_back(std::thread(transformRange, t));
+    }
+    transformRange(0);
+    for (std::thread &rThread : threads) {
+        rThread.join();
+    }
+}
+
+//! @brief Returns the largest length <= n that only has the prime factors 2, 3 and 5 (the most efficient FFT lengths)
+size_t hopsan::largestEfficientFFTSize(const size_t n)
+{
+    size_t best = 0;
+    for (size_t p2=1; p2<=n; p2*=2) {
+        for (size_t p3=p2; p3<=n; p3*=3) {
+            size_t p5=p3;
+            while (p5*5 <= n) {
+                p5 *= 5;
+            }
+            best = std::max(best, p5);
+        }
+    }
+    return best;
+}
+
+//! @brief Generate a window function for spectral analysis
+//! @details The windows are periodic (DFT-even), which is the appropriate form for averaged spectra
+//! @param[in] window The window type
+//! @param[in] n The window length
+//! @param[out] rWindow The window values
+void hopsan::generateSpectralWindow(const SpectralWindowT window, const size_t n, std::vector<double> &rWindow)
+{
+    rWindow.assign(n, 1.0);
+    for (size_t i=0; i<n; ++i) {
+        const double x = 2.0*M_PI*double(i)/double(n);
+        if (window == HannSpectralWindow) {
+            rWindow[i] = 0.5*(1.0-cos(x));
+        }
+        else if (window == FlatTopSpectralWindow) {
+            // Coefficients according to ISO 18431-2
+            rWindow[i] = 1.0-1.933*cos(x)+1.286*cos(2.0*x)-0.388*cos(3.0*x)+0.0322*cos(4.0*x);
+        }
+    }
+}
+
+//! @brief Returns the segment length used by welchPowerSpectralDensity()
+//! @param[in] dataLength The number of data samples
+//! @param[in] requestedLength The requested segment length, 0 = automatic (256 samples or 1/8 of the data if longer)
+//! @returns The segment length, limited to the data length
+size_t hopsan::welchSegmentLength(const size_t dataLength, size_t requestedLength)
+{
+    if (requestedLength == 0) {
+        requestedLength = largestEfficientFFTSize(std::max(dataLength/8, size_t(256)));
+    }
+    return std::max(std::min(requestedLength, dataLength), size_t(2));
+}
+
+//! @brief Estimate the one-sided power spectral density using Welch's method of averaged, overlapping and windowed periodograms
+//! @details The mean of each segment is removed before it is windowed. The segments are transformed in parallel.
+//! @param[in] rData The data, assumed to be sampled with a constant sample frequency
+//! @param[in] sampleFrequency The sample frequency [Hz]
+//! @param[in] segmentLength The segment length, 0 = automatic, see welchSegmentLength()
+//! @param[in] overlap The fraction of each segment that overlaps the next, in [0, 1)
+//! @param[in] window The window applied to each segment
+//! @param[out] rFrequency The frequency of each bin [Hz]
+//! @param[out] rDensity The power spectral density of each bin [unit^2/Hz]
+//! @param[in] numThreads The number of threads to use, 0 = use all available cores
+//! @returns False if the arguments are invalid
+bool hopsan::welchPowerSpectralDensity(const std::vector<double> &rData, const double sampleFrequency, size_t segmentLength, const double overlap,
+                                       const SpectralWindowT window, std::vector<double> &rFrequency, std::vector<double> &rDensity, size_t numThreads)
+{
+    rFrequency.clear();
+    rDensity.clear();
+    const size_t n = rData.size();
+    if ((n < 2) || !(sampleFrequency > 0) || !(overlap >= 0.0 && overlap < 1.0)) {
+        return false;
+    }
+    segmentLength = welchSegmentLength(n, segmentLength);
+    const size_t step = std::max(segmentLength-size_t(overlap*double(segmentLength)+0.5), size_t(1));
+    const size_t numSegments = (n-segmentLength)/step+1;
+
+    std::vector<double> windowValues;
+    generateSpectralWindow(window, segmentLength, windowValues);
+    double windowPower = 0;
+    for (const double w : windowValues) {
+        windowPower += w*w;
+    }
+
+    std::shared_ptr<const RealFFTPlan> pPlan = RealFFTPlan::get(segmentLength);
+    const size_t numBins = pPlan->getNumBins();
+
+    // Each thread accumulates the periodograms of its own share of the segments
+    numThreads = numThreadsToUse(numThreads, numSegments);
+    std::vector< std::vector<double> > partialSums(numThreads, std::vector<double>(numBins, 0.0));
+    auto accumulateSegments = [&](const size_t t) {
+        std::vector<double> segment(segmentLength);
+        std::vector<Complex> bins(numBins), work;
+        std::vector<double> &rSum = partialSums[t];
+        for (size_t s=t*numSegments/numThreads; s<(t+1)*numSegments/numThreads; ++s) {
+            const double *pBegin = rData.data()+s*step;
+            double mean = 0;
+            for (size_t i=0; i<segmentLength; ++i) {
+                mean += pBegin[i];
+            }
+            mean /= double(segmentLength);
+            for (size_t i=0; i<segmentLength; ++i) {
+                segment[i] = (pBegin[i]-mean)*windowValues[i];
+            }
+            pPlan->forward(segment.data(), bins.data(), work);
+            for (size_t k=0; k<numBins; ++k) {
+                rSum[k] += std::norm(bins[k]);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t=1; t<numThreads; ++t) {
+        threads.push_back(std::thread(accumulateSegments, t));
+    }
+    accumulateSegments(0);
+    for (std::thread &rThread : threads) {
+        rThread.join();
+    }
+
+    // Scale to density, all bins except DC (and Nyquist for even lengths) are doubled to include the negative frequencies
+    const double scale = 1.0/(double(numSegments)*sampleFrequency*windowPower);
+    rFrequency.resize(numBins);
+    rDensity.assign(numBins, 0.0);
+    for (size_t k=0; k<numBins; ++k) {
+        for (size_t t=0; t<numThreads; ++t) {
+            rDensity[k] += partialSums[t][k];
+        }
+        const bool isNyquist = (segmentLength % 2 == 0) && (k == numBins-1);
+        rDensity[k] *= ((k == 0) || isNyquist) ? scale : 2.0*scale;
+        rFrequency[k] = double(k)*sampleFrequency/double(segmentLength);
+    }
+    return true;
+}
@@ -35,6 +35,7 @@
 #include <cassert>
 #include <cstring>
 #include "CoreUtilities/HmfLoader.h"
+#include "CoreUtilities/HmfModelCache.h"
 #include "CoreUtilities/HopsanCoreMessageHandler.h"
 #include "CoreUtilities/NumHopHelper.h"
 #include "ComponentUtilities/num2string.hpp"
@@ -556,7 +557,7 @@ void hopsan::autoPrependSelfToEmbeddedInitScript(ComponentSystem* pSystem) {
 
 
 //! @brief This help function loads a component
-void loadComponent(rapidxml::xml_node<> *pComponentNode, ComponentSystem* pSystem, HopsanEssentials *pHopsanEssentials)
+void loadComponent(rapidxml::xml_node<> *pComponentNode, ComponentSystem* pSystem, HopsanEssentials *pHopsanEssentials, HmfModelCacheRecorder *pRecorder)
 {
     HString typeName = readStringAttribute(pComponentNode, "typename", "ERROR_NO_TYPE_GIVEN").c_str();
     HString subTypeName = readStringAttribute(pComponentNode, "subtypename", "").c_str();
@@ -571,6 +572,10 @@ void loadComponent(rapidxml::xml_node<> *pComponentNode, ComponentSystem* pSyste
         pComp->setSubTypeName(subTypeName.c_str());
         pComp->setDisabled(disabled);
         pSystem->addComponent(pComp);
+        if (pRecorder)
+        {
+            pRecorder->recordComponent(typeName, subTypeName, displayName, disabled);
+        }
 
         // Load parameters
         //! @todo should be able to load parameters and system parameters with same help function
@@ -602,12 +607,19 @@ void loadComponent(rapidxml::xml_node<> *pComponentNode, ComponentSystem* pSyste
                 {
                     pComp->addWarningMessage("Failed to set parameter: "+paramName+"="+val);
                 }
+                if (pRecorder)
+                {
+                    pRecorder->recordComponentParameter(paramName, val);
+                }
 
                 pParam = pParam->next_sibling("parameter");
             }
 
             if (isVersionAGreaterThanB("2.14.0", coreVersionOfModelFile)) {
                 autoPrependSelfToParameterExpressions(pComp);
+                if (pRecorder) {
+                    pRecorder->recordPrependSelfToComponentParameters();
+                }
             }
         }
 
@@ -626,17 +638,26 @@ void loadComponent(rapidxml::xml_node<> *pComponentNode, ComponentSystem* pSyste
                     if (pPort)
                     {
                         pPort->setSignalNodeQuantityOrUnit(quantity);
+                        if (pRecorder)
+                        {
+                            pRecorder->recordPortQuantity(portName, quantity);
+                        }
                     }
                 }
                 pXmlPort = pXmlPort->next_sibling("port");
             }
         }
     }
+    else if (pRecorder)
+    {
+        // Do not cache models with missing components, the error must be reported on every load
+        pRecorder->setNotCachable();
+    }
 }
 
 
 //! @brief This help function loads a connection
-void loadConnection(rapidxml::xml_node<> *pConnectNode, ComponentSystem* pSystem)
+void loadConnection(rapidxml::xml_node<> *pConnectNode, ComponentSystem* pSystem, HmfModelCacheRecorder *pRecorder)
 {
     string startcomponent = readStringAttribute(pConnectNode, "startcomponent", "ERROR_NOSTARTCOMPNAME_GIVEN");
     string startport = readStringAttribute(pConnectNode, "startport", "ERROR_NOSTARTPORTNAME_GIVEN");
@@ -649,17 +670,25 @@ void loadConnection(rapidxml::xml_node<> *pConnectNode, ComponentSystem* pSystem
     santizeName(endport.c_str());
 
     pSystem->connect(startcomponent.c_str(), startport.c_str(), endcomponent.c_str(), endport.c_str());
+    if (pRecorder)
+    {
+        pRecorder->recordConnection(startcomponent.c_str(), startport.c_str(), endcomponent.c_str(), endport.c_str());
+    }
 }
 
 //! @brief This help function loads a SystemPort
-void loadSystemPort(rapidxml::xml_node<> *pSysPortNode, ComponentSystem* pSystem)
+void loadSystemPort(rapidxml::xml_node<> *pSysPortNode, ComponentSystem* pSystem, HmfModelCacheRecorder *pRecorder)
 {
     string name = readStringAttribute(pSysPortNode, "name", "ERROR_NO_NAME_GIVEN");
     pSystem->addSystemPort(name.c_str());
+    if (pRecorder)
+    {
+        pRecorder->recordSystemPort(name.c_str());
+    }
 }
 
 //! @brief Help function to load system parameters
-void loadSystemParameters(rapidxml::xml_node<> *pSysNode, ComponentSystem* pSystem)
+void loadSystemParameters(rapidxml::xml_node<> *pSysNode, ComponentSystem* pSystem, HmfModelCacheRecorder *pRecorder)
 {
     // Load system parameters
     rapidxml::xml_node<> *pParameters = pSysNode->first_node("parameters");
@@ -685,17 +714,24 @@ void loadSystemParameters(rapidxml::xml_node<> *pSysNode, ComponentSystem* pSyst
             {
                 pSystem->addErrorMessage(HString("Failed to load parameter: ")+(paramName+"="+val).c_str());
             }
+            if (pRecorder)
+            {
+                pRecorder->recordSystemParameter(paramName.c_str(), val.c_str(), type.c_str(), description.c_str(), quantityORunit.c_str());
+            }
 
             pParameter = pParameter->next_sibling("parameter");
         }
 
         if (isVersionAGreaterThanB("2.14.0", coreVersionOfModelFile)) {
             autoPrependSelfToParameterExpressions(pSystem);
+            if (pRecorder) {
+                pRecorder->recordPrependSelfToSystemParameters();
+            }
         }
     }
 }
 
-void loadAliases(rapidxml::xml_node<> *pAliasesNode, ComponentSystem* pSystem)
+void loadAliases(rapidxml::xml_node<> *pAliasesNode, ComponentSystem* pSystem, HmfModelCacheRecorder *pRecorder)
 {
     rapidxml::xml_node<> *pAlias = pAliasesNode->first_node("alias");
     while(pAlias)
@@ -712,6 +748,10 @@ void loadAliases(rapidxml::xml_node<> *pAliasesNode, ComponentSystem* pSystem)
         {
             //! @todo check bool and display warning if false
             pSystem->getAliasHandler().setVariableAlias(alias.c_str(), comp.c_str(), port.c_str(), var.c_str());
+            if (pRecorder)
+            {
+                pRecorder->recordVariableAlias(alias, comp, port, var);
+            }
         }
 
 
@@ -721,7 +761,7 @@ void loadAliases(rapidxml::xml_node<> *pAliasesNode, ComponentSystem* pSystem)
 
 
 //! @brief This function loads a subsystem
-void loadSystemContents(rapidxml::xml_node<> *pSysNode, ComponentSystem* pSystem, HopsanEssentials* pHopsanEssentials, const HString rootFilePath="")
+void loadSystemContents(rapidxml::xml_node<> *pSysNode, ComponentSystem* pSystem, HopsanEssentials* pHopsanEssentials, const HString rootFilePath="", HmfModelCacheRecorder *pRecorder=0)
 {
     string typeName = readStringAttribute(pSysNode, "typename", "ERROR_NO_TYPE_GIVEN");
     string displayName = readStringAttribute(pSysNode, "name", typeName );
@@ -744,14 +784,22 @@ void loadSystemContents(rapidxml::xml_node<> *pSysNode, ComponentSystem* pSystem
     {
         pSystem->setNumLogSamples(readIntAttribute(pSysNode, "logsamples", pSystem->getNumLogSamples()));
     }
+    if (pRecorder)
+    {
+        pRecorder->recordSystemSettings(displayName.c_str(), componentDisabled, Ts, pSystem->doesInheritTimestep(), pSystem->getLogStartTime(), pSystem->getNumLogSamples());
+    }
 
     //! @todo we really need defines for allof these "strings"
 
     // Load system parameters (needed before objects are loaded as they may be using sys-parameters)
-    loadSystemParameters(pSysNode, pSystem);
+    loadSystemParameters(pSysNode, pSystem, pRecorder);
 
     // Load NumHop script
     pSystem->setNumHopScript(readStringNodeValue(pSysNode->first_node("numhopscript"), "").c_str());
+    if (pRecorder)
+    {
+        pRecorder->recordNumHopScript(pSystem->getNumHopScript());
+    }
 
     // Load contents
     rapidxml::xml_node<> *pObjects = pSysNode->first_node("objects");
@@ -763,7 +811,7 @@ void loadSystemContents(rapidxml::xml_node<> *pSysNode, ComponentSystem* pSystem
             if (strcmp(pObject->name(), "component")==0)
             {
                 updateOldModelFileComponent(pObject, readStringAttribute(pObject->document()->first_node(), "hopsancoreversion", "").c_str());
-                loadComponent(pObject, pSystem, pHopsanEssentials);
+                loadComponent(pObject, pSystem, pHopsanEssentials, pRecorder);
             }
             else if (strcmp(pObject->name(), "system")==0)
             {
@@ -772,6 +820,11 @@ void loadSystemContents(rapidxml::xml_node<> *pSysNode, ComponentSystem* pSystem
 
                 if (isExternal)
                 {
+                    // The external model file is not part of the cache key, so this model can not be cached
+                    if (pRecorder)
+                    {
+                        pRecorder->setNotCachable();
+                    }
                     double dummy1,dummy2;
                     HString externalPath = stripFilenameFromPath(rootFilePath) + readStringAttribute(pObject,"external_path","").c_str();
                     cout << "externalPath: " << externalPath.c_str() << endl;
@@ -781,7 +834,7 @@ void loadSystemContents(rapidxml::xml_node<> *pSysNode, ComponentSystem* pSystem
                         // Add new system to parent
                         pSystem->addComponent(pSys);
                         // load overwriten parameter values
-                        loadSystemParameters(pObject, pSys);
+                        loadSystemParameters(pObject, pSys, 0);
                         // Overwrite name
                         string displayNameExt = readStringAttribute(pObject, "name", typeName );
                         pSys->setName(displayNameExt.c_str());
@@ -805,17 +858,29 @@ void loadSystemContents(rapidxml::xml_node<> *pSysNode, ComponentSystem* pSystem
                     else
                     {
                         //! @todo don't know how to report this error, but it is unlikely to happen
+                        if (pRecorder)
+                        {
+                            pRecorder->setNotCachable();
+                        }
                         return;
                     }
                     // Add new system to parent
                     pSystem->addComponent(pSys);
                     // Load system contents
-                    loadSystemContents(pObject, pSys, pHopsanEssentials, rootFilePath);
+                    if (pRecorder)
+                    {
+                        pRecorder->recordSubsystemBegin(newTypeName.c_str());
+                    }
+                    loadSystemContents(pObject, pSys, pHopsanEssentials, rootFilePath, pRecorder);
+                    if (pRecorder)
+                    {
+                        pRecorder->recordSubsystemEnd();
+                    }
                 }
             }
             else if (strcmp(pObject->name(), "systemport")==0)
             {
-                loadSystemPort(pObject,pSystem);
+                loadSystemPort(pObject, pSystem, pRecorder);
             }
 
             pObject = pObject->next_sibling();
@@ -831,7 +896,7 @@ void loadSystemContents(rapidxml::xml_node<> *pSysNode, ComponentSystem* pSystem
         {
             if (strcmp(pConnection->name(), "connect")==0)
             {
-                loadConnection(pConnection, pSystem);
+                loadConnection(pConnection, pSystem, pRecorder);
             }
             pConnection = pConnection->next_sibling();
         }
@@ -839,24 +904,28 @@ void loadSystemContents(rapidxml::xml_node<> *pSysNode, ComponentSystem* pSystem
 
     // Load system parameters again in case we have c-component subsystems with startvalues
     //! @todo this is an ugly hack to be forced to load again
-    loadSystemParameters(pSysNode, pSystem);
+    loadSystemParameters(pSysNode, pSystem, pRecorder);
 
     // Load aliases
     rapidxml::xml_node<> *pAliases = pSysNode->first_node("aliases");
     if (pAliases)
     {
-        loadAliases(pAliases, pSystem);
+        loadAliases(pAliases, pSystem, pRecorder);
     }
 
     const HString coreVersionOfModelFile = readStringAttribute(pSysNode->document()->first_node(), "hopsancoreversion").c_str();
     if (isVersionAGreaterThanB("2.14.0", coreVersionOfModelFile)) {
         // Note! This will destory the formating of the script, but for load-only core simualtion that is OK
         autoPrependSelfToEmbeddedInitScript(pSystem);
+        if (pRecorder)
+        {
+            pRecorder->recordPrependSelfToNumHopScript();
+        }
     }
 }
 
 // The actual model load function
-ComponentSystem* loadHopsanModelFileActual(const rapidxml::xml_document<> &rDoc, const HString &rFilePath, HopsanEssentials* pHopsanEssentials, double &rStartTime, double &rStopTime)
+ComponentSystem* loadHopsanModelFileActual(const rapidxml::xml_document<> &rDoc, const HString &rFilePath, HopsanEssentials* pHopsanEssentials, double &rStartTime, double &rStopTime, HmfModelCacheRecorder *pRecorder=0)
 {
     try
     {
@@ -884,7 +953,11 @@ ComponentSystem* loadHopsanModelFileActual(const rapidxml::xml_document<> &rDoc,
                 rStartTime = readDoubleAttribute(pSimtimeNode, "start", 0);
                 rStopTime = readDoubleAttribute(pSimtimeNode, "stop", 2);
                 ComponentSystem * pSys = pHopsanEssentials->createComponentSystem(); //Create root system
-                loadSystemContents(pSysNode, pSys, pHopsanEssentials, rFilePath);
+                if (pRecorder)
+                {
+                    pRecorder->recordRootSystem(rStartTime, rStopTime);
+                }
+                loadSystemContents(pSysNode, pSys, pHopsanEssentials, rFilePath, pRecorder);
 
                 pSys->addSearchPath(stripFilenameFromPath(rFilePath));
                 return pSys;
@@ -1029,18 +1102,50 @@ int hopsan::compareHopsanVersions(const HString& versionA, const HString& versio
 //! @param [in] filePath The name (path) of the HMF file
 //! @param [out] rStartTime A reference to the starttime variable
 //! @param [out] rStopTime A reference to the stoptime variable
+//! @param [in] rCacheDirectory Directory for the binary model cache, if empty the cache is not used
 //! @returns A pointer to the rootsystem of the loaded model
 //! @todo if possible merge the two differen main load functions
-ComponentSystem* hopsan::loadHopsanModelFile(const HString &rFilePath, HopsanEssentials* pHopsanEssentials, double &rStartTime, double &rStopTime)
+ComponentSystem* hopsan::loadHopsanModelFile(const HString &rFilePath, HopsanEssentials* pHopsanEssentials, double &rStartTime, double &rStopTime, const HString &rCacheDirectory)
 {
     addCoreLogMessage("hopsan::loadHopsanModelFile("+rFilePath+")");
     try
     {
         rapidxml::file<> hmfFile(rFilePath.c_str());
+
+        if (rCacheDirectory.empty())
+        {
+            rapidxml::xml_document<> doc;
+            doc.parse<0>(hmfFile.data());
+            return loadHopsanModelFileActual(doc, rFilePath, pHopsanEssentials, rStartTime, rStopTime);
+        }
+
+        // Try to load the resolved model from the cache, skipping xml parsing and old version fix-ups
+        const HString cacheKey = getHmfModelCacheKey(hmfFile.data(), hmfFile.size(), pHopsanEssentials);
+        const HString cacheFilePath = getHmfModelCacheFilePath(rCacheDirectory, cacheKey);
+        std::string cacheData;
+        if (readHmfModelCacheFile(cacheFilePath, cacheKey, cacheData))
+        {
+            ComponentSystem *pSys = loadHopsanModelCache(cacheData, pHopsanEssentials, rStartTime, rStopTime);
+            if (pSys)
+            {
+                pSys->addSearchPath(stripFilenameFromPath(rFilePath));
+                pHopsanEssentials->getCoreMessageHandler()->addDebugMessage("Loaded model from cache: "+cacheFilePath);
+                return pSys;
+            }
+        }
+
         rapidxml::xml_document<> doc;
         doc.parse<0>(hmfFile.data());
-
-        return loadHopsanModelFileActual(doc, rFilePath, pHopsanEssentials, rStartTime, rStopTime);
+        HmfModelCacheRecorder recorder;
+        ComponentSystem *pSys = loadHopsanModelFileActual(doc, rFilePath, pHopsanEssentials, rStartTime, rStopTime, &recorder);
+        if (pSys && recorder.isCachable())
+        {
+            if (!writeHmfModelCacheFile(cacheFilePath, cacheKey, recorder.getData()))
+            {
+                pHopsanEssentials->getCoreMessageHandler()->addDebugMessage("Could not write model cache file: "+cacheFilePath);
+            }
+        }
+        return pSys;
     }
     catch(std::exception &e)
     {
@@ -0,0 +1,618 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+
+//!
+//! @file   HmfModelCache.cpp
+//!
+//! @brief Contains the HopsanCore binary model cache used to speed up HMF loading
+//!
+//$Id$
+
+#include <fstream>
+#include <set>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include "CoreUtilities/HmfModelCache.h"
+#include "CoreUtilities/HmfLoader.h"
+#include "CoreUtilities/HopsanCoreMessageHandler.h"
+#include "ComponentUtilities/num2string.hpp"
+#include "HopsanEssentials.h"
+#include "HopsanCoreVersion.h"
+
+using namespace hopsan;
+
+/*
+ * Cache file layout
+ *
+ * Magic    FormatVersion   KeyLength   Key     Operations...
+ * 4-byte   4-byte          4-byte      bytes
+ *
+ * Each operation is a 1-byte op code followed by its arguments. Strings are stored as a 4-byte length followed by the
+ * characters, doubles and integers are stored as 8-byte values in native byte order.
+ *
+ * */
+
+#define HMFCACHEMAGIC "HMFC"
+#define HMFCACHEFORMATVERSION 1
+
+namespace {
+
+enum HmfCacheOpT {RootSystemOp=1, SubsystemBeginOp, SubsystemEndOp, SystemSettingsOp, SystemParameterOp, PrependSelfToSystemParametersOp,
+                  NumHopScriptOp, PrependSelfToNumHopScriptOp, ComponentOp, ComponentParameterOp, PrependSelfToComponentParametersOp,
+                  PortQuantityOp, SystemPortOp, ConnectionOp, VariableAliasOp};
+
+//! @brief 64-bit FNV-1a hash
+unsigned long long hashBytes(const char* pData, const size_t size, unsigned long long hash=14695981039346656037ULL)
+{
+    for (size_t i=0; i<size; ++i)
+    {
+        hash ^= static_cast<unsigned char>(pData[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+HString toHexString(unsigned long long value)
+{
+    const char *digits = "0123456789abcdef";
+    HString hex;
+    for (int i=15; i>=0; --i)
+    {
+        hex.append(digits[(value >> (4*i)) & 0xF]);
+    }
+    return hex;
+}
+
+//! @brief Help class for reading operations from cache data, all reads are bounds checked
+class CacheReader
+{
+public:
+    CacheReader(const std::string &rData) : mpData(rData.data()), mSize(rData.size()), mPos(0), mOK(true) {}
+
+    bool atEnd() const
+    {
+        return !mOK || (mPos >= mSize);
+    }
+
+    bool isOK() const
+    {
+        return mOK;
+    }
+
+    int readOp()
+    {
+        unsigned char op=0;
+        readBytes(reinterpret_cast<char*>(&op), 1);
+        return op;
+    }
+
+    HString readString()
+    {
+        unsigned int length=0;
+        readBytes(reinterpret_cast<char*>(&length), 4);
+        HString str;
+        if (mOK && (length <= mSize-mPos))
+        {
+            str = std::string(mpData+mPos, length).c_str();
+            mPos += length;
+        }
+        else
+        {
+            mOK = false;
+        }
+        return str;
+    }
+
+    double readDouble()
+    {
+        double value=0;
+        readBytes(reinterpret_cast<char*>(&value), sizeof(double));
+        return value;
+    }
+
+    long int readInt()
+    {
+        long long value=0;
+        readBytes(reinterpret_cast<char*>(&value), 8);
+        return static_cast<long int>(value);
+    }
+
+private:
+    void readBytes(char *pDst, const size_t n)
+    {
+        if (mOK && (n <= mSize-mPos))
+        {
+            memcpy(pDst, mpData+mPos, n);
+            mPos += n;
+        }
+        else
+        {
+            mOK = false;
+        }
+    }
+
+    const char *mpData;
+    size_t mSize, mPos;
+    bool mOK;
+};
+
+}
+
+HmfModelCacheRecorder::HmfModelCacheRecorder()
+{
+    mIsCachable = true;
+}
+
+void HmfModelCacheRecorder::recordRootSystem(const double startTime, const double stopTime)
+{
+    writeOp(RootSystemOp);
+    writeDouble(startTime);
+    writeDouble(stopTime);
+}
+
+void HmfModelCacheRecorder::recordSubsystemBegin(const HString &rTypeName)
+{
+    writeOp(SubsystemBeginOp);
+    writeString(rTypeName);
+}
+
+void HmfModelCacheRecorder::recordSubsystemEnd()
+{
+    writeOp(SubsystemEndOp);
+}
+
+void HmfModelCacheRecorder::recordSystemSettings(const HString &rName, const bool disabled, const double timestep, const bool inheritTimestep, const double logStartTime, const size_t numLogSamples)
+{
+    writeOp(SystemSettingsOp);
+    writeString(rName);
+    writeInt(disabled);
+    writeDouble(timestep);
+    writeInt(inheritTimestep);
+    writeDouble(logStartTime);
+    writeInt(long(numLogSamples));
+}
+
+void HmfModelCacheRecorder::recordSystemParameter(const HString &rName, const HString &rValue, const HString &rType, const HString &rDescription, const HString &rQuantityOrUnit)
+{
+    writeOp(SystemParameterOp);
+    writeString(rName);
+    writeString(rValue);
+    writeString(rType);
+    writeString(rDescription);
+    writeString(rQuantityOrUnit);
+}
+
+void HmfModelCacheRecorder::recordPrependSelfToSystemParameters()
+{
+    writeOp(PrependSelfToSystemParametersOp);
+}
+
+void HmfModelCacheRecorder::recordNumHopScript(const HString &rScript)
+{
+    writeOp(NumHopScriptOp);
+    writeString(rScript);
+}
+
+void HmfModelCacheRecorder::recordPrependSelfToNumHopScript()
+{
+    writeOp(PrependSelfToNumHopScriptOp);
+}
+
+void HmfModelCacheRecorder::recordComponent(const HString &rTypeName, const HString &rSubTypeName, const HString &rName, const bool disabled)
+{
+    writeOp(ComponentOp);
+    writeString(rTypeName);
+    writeString(rSubTypeName);
+    writeString(rName);
+    writeInt(disabled);
+}
+
+void HmfModelCacheRecorder::recordComponentParameter(const HString &rName, const HString &rValue)
+{
+    writeOp(ComponentParameterOp);
+    writeString(rName);
+    writeString(rValue);
+}
+
+void HmfModelCacheRecorder::recordPrependSelfToComponentParameters()
+{
+    writeOp(PrependSelfToComponentParametersOp);
+}
+
+void HmfModelCacheRecorder::recordPortQuantity(const HString &rPortName, const HString &rQuantity)
+{
+    writeOp(PortQuantityOp);
+    writeString(rPortName);
+    writeString(rQuantity);
+}
+
+void HmfModelCacheRecorder::recordSystemPort(const HString &rName)
+{
+    writeOp(SystemPortOp);
+    writeString(rName);
+}
+
+void HmfModelCacheRecorder::recordConnection(const HString &rStartComponent, const HString &rStartPort, const HString &rEndComponent, const HString &rEndPort)
+{
+    writeOp(ConnectionOp);
+    writeString(rStartComponent);
+    writeString(rStartPort);
+    writeString(rEndComponent);
+    writeString(rEndPort);
+}
+
+void HmfModelCacheRecorder::recordVariableAlias(const HString &rAlias, const HString &rComponent, const HString &rPort, const HString &rVariable)
+{
+    writeOp(VariableAliasOp);
+    writeString(rAlias);
+    writeString(rComponent);
+    writeString(rPort);
+    writeString(rVariable);
+}
+
+//! @brief Mark the recording as not possible to replay, it will not be written to the cache
+void HmfModelCacheRecorder::setNotCachable()
+{
+    mIsCachable = false;
+}
+
+bool HmfModelCacheRecorder::isCachable() const
+{
+    return mIsCachable;
+}
+
+const std::string &HmfModelCacheRecorder::getData() const
+{
+    return mData;
+}
+
+void HmfModelCacheRecorder::writeOp(const int op)
+{
+    mData.push_back(static_cast<char>(op));
+}
+
+void HmfModelCacheRecorder::writeString(const HString &rString)
+{
+    const unsigned int length = static_cast<unsigned int>(rString.size());
+    mData.append(reinterpret_cast<const char*>(&length), 4);
+    mData.append(rString.c_str(), length);
+}
+
+void HmfModelCacheRecorder::writeDouble(const double value)
+{
+    mData.append(reinterpret_cast<const char*>(&value), sizeof(double));
+}
+
+void HmfModelCacheRecorder::writeInt(const long int value)
+{
+    const long long value64 = value;
+    mData.append(reinterpret_cast<const char*>(&value64), 8);
+}
+
+
+//! @brief Compute the cache key for a model
+//! @details The key depends on the model file contents, the core version and the loaded component libraries (path, size and modification time)
+//! @param [in] pHmfData The contents of the model file
+//! @param [in] size The size of the model file contents
+//! @param [in] pHopsanEssentials The HopsanEssentials object with the loaded libraries
+//! @returns The cache key
+HString hopsan::getHmfModelCacheKey(const char* pHmfData, const size_t size, HopsanEssentials* pHopsanEssentials)
+{
+    HString key = toHexString(hashBytes(pHmfData, size));
+    key.append(";");
+    key.append(HOPSANCOREVERSION);
+    key.append(";");
+    key.append(DEBUGRELEASECOMPILED);
+
+    std::set<std::string> libPaths;
+    const std::vector<HString> componentTypes = pHopsanEssentials->getRegisteredComponentTypes();
+    for (size_t i=0; i<componentTypes.size(); ++i)
+    {
+        HString libPath;
+        pHopsanEssentials->getLibPathForComponentType(componentTypes[i], libPath);
+        if (!libPath.empty())
+        {
+            libPaths.insert(libPath.c_str());
+        }
+    }
+
+    for (std::set<std::string>::iterator it=libPaths.begin(); it!=libPaths.end(); ++it)
+    {
+        struct stat libStat;
+        key.append(";");
+        key.append(it->c_str());
+        if (stat(it->c_str(), &libStat) == 0)
+        {
+            key.append(":"+to_hstring(libStat.st_size)+":"+to_hstring(libStat.st_mtime));
+        }
+    }
+    return key;
+}
+
+//! @brief Get the cache file path in a cache directory for a given key
+HString hopsan::getHmfModelCacheFilePath(const HString &rCacheDirectory, const HString &rKey)
+{
+    HString path = rCacheDirectory;
+    if (!path.empty() && (path.back() != '/') && (path.back() != '\\'))
+    {
+        path.append('/');
+    }
+    return path+toHexString(hashBytes(rKey.c_str(), rKey.size()))+".hmfc";
+}
+
+//! @brief Read a model cache file
+//! @param [in] rCacheFilePath The cache file to read
+//! @param [in] rKey The expected cache key, the file is rejected if the stored key differs
+//! @param [out] rData The recorded operations
+//! @returns True if the file exists and belongs to the given key
+bool hopsan::readHmfModelCacheFile(const HString &rCacheFilePath, const HString &rKey, std::string &rData)
+{
+    std::ifstream file(rCacheFilePath.c_str(), std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    char magic[4];
+    unsigned int formatVersion=0, keyLength=0;
+    file.read(magic, 4);
+    file.read(reinterpret_cast<char*>(&formatVersion), 4);
+    file.read(reinterpret_cast<char*>(&keyLength), 4);
+    if (!file.good() || (memcmp(magic, HMFCACHEMAGIC, 4) != 0) || (formatVersion != HMFCACHEFORMATVERSION) || (keyLength != rKey.size()))
+    {
+        return false;
+    }
+    std::string key(keyLength, '\0');
+    file.read(&key[0], keyLength);
+    if (!file.good() || (key != rKey.c_str()))
+    {
+        return false;
+    }
+
+    rData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !rData.empty();
+}
+
+//! @brief Write a model cache file
+//! @details The file is first written to a temporary file and then renamed, so that concurrent loads never see a partial file
+//! @param [in] rCacheFilePath The cache file to write
+//! @param [in] rKey The cache key
+//! @param [in] rData The recorded operations
+//! @returns True if the file was written
+bool hopsan::writeHmfModelCacheFile(const HString &rCacheFilePath, const HString &rKey, const std::string &rData)
+{
+    const HString tempFilePath = rCacheFilePath+".tmp"+to_hstring(reinterpret_cast<size_t>(&rData));
+    {
+        std::ofstream file(tempFilePath.c_str(), std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            return false;
+        }
+        const unsigned int formatVersion = HMFCACHEFORMATVERSION;
+        const unsigned int keyLength = static_cast<unsigned int>(rKey.size());
+        file.write(HMFCACHEMAGIC, 4);
+        file.write(reinterpret_cast<const char*>(&formatVersion), 4);
+        file.write(reinterpret_cast<const char*>(&keyLength), 4);
+        file.write(rKey.c_str(), keyLength);
+        file.write(rData.data(), std::streamsize(rData.size()));
+        if (!file.good())
+        {
+            file.close();
+            std::remove(tempFilePath.c_str());
+            return false;
+        }
+    }
+    // On Windows rename fails if the destination exists, remove it first
+    std::remove(rCacheFilePath.c_str());
+    if (std::rename(tempFilePath.c_str(), rCacheFilePath.c_str()) != 0)
+    {
+        std::remove(tempFilePath.c_str());
+        return false;
+    }
+    return true;
+}
+
+//! @brief Load a model by replaying the operations recorded in a model cache
+//! @param [in] rData The recorded operations
+//! @param [in] pHopsanEssentials The HopsanEssentials object used to create components
+//! @param [out] rStartTime A reference to the starttime variable
+//! @param [out] rStopTime A reference to the stoptime variable
+//! @returns A pointer to the root system of the loaded model, or 0 if the cache data is corrupt
+ComponentSystem* hopsan::loadHopsanModelCache(const std::string &rData, HopsanEssentials* pHopsanEssentials, double &rStartTime, double &rStopTime)
+{
+    CacheReader reader(rData);
+    if (reader.readOp() != RootSystemOp)
+    {
+        return 0;
+    }
+    rStartTime = reader.readDouble();
+    rStopTime = reader.readDouble();
+
+    ComponentSystem *pRootSystem = pHopsanEssentials->createComponentSystem();
+    std::vector<ComponentSystem*> systemStack;
+    systemStack.push_back(pRootSystem);
+    Component *pComponent = 0;
+
+    while (!reader.atEnd() && !systemStack.empty())
+    {
+        ComponentSystem *pSystem = systemStack.back();
+        const int op = reader.readOp();
+        switch (op)
+        {
+        case SubsystemBeginOp:
+        {
+            const HString typeName = reader.readString();
+            ComponentSystem *pSubsystem = 0;
+            if (typeName == HOPSAN_BUILTIN_TYPENAME_CONDITIONALSUBSYSTEM)
+            {
+                pSubsystem = pHopsanEssentials->createConditionalComponentSystem();
+            }
+            else if (typeName == HOPSAN_BUILTIN_TYPENAME_SUBSYSTEM)
+            {
+                pSubsystem = pHopsanEssentials->createComponentSystem();
+            }
+            if (pSubsystem)
+            {
+                pSystem->addComponent(pSubsystem);
+                systemStack.push_back(pSubsystem);
+            }
+            else
+            {
+                systemStack.clear();
+            }
+            break;
+        }
+        case SubsystemEndOp:
+            systemStack.pop_back();
+            pComponent = 0;
+            break;
+        case SystemSettingsOp:
+        {
+            const HString name = reader.readString();
+            const bool disabled = (reader.readInt() != 0);
+            const double timestep = reader.readDouble();
+            const bool inheritTimestep = (reader.readInt() != 0);
+            const double logStartTime = reader.readDouble();
+            const long int numLogSamples = reader.readInt();
+            pSystem->setName(name);
+            pSystem->setDisabled(disabled);
+            pSystem->setDesiredTimestep(timestep);
+            pSystem->setInheritTimestep(inheritTimestep);
+            pSystem->setLogStartTime(logStartTime);
+            pSystem->setNumLogSamples(size_t(numLogSamples));
+            break;
+        }
+        case SystemParameterOp:
+        {
+            const HString name = reader.readString();
+            const HString value = reader.readString();
+            const HString type = reader.readString();
+            const HString description = reader.readString();
+            const HString quantityOrUnit = reader.readString();
+            if (reader.isOK() && !pSystem->setOrAddSystemParameter(name, value, type, description, quantityOrUnit, true))
+            {
+                pSystem->addErrorMessage("Failed to load parameter: "+name+"="+value);
+            }
+            break;
+        }
+        case PrependSelfToSystemParametersOp:
+            autoPrependSelfToParameterExpressions(pSystem);
+            break;
+        case NumHopScriptOp:
+            pSystem->setNumHopScript(reader.readString());
+            break;
+        case PrependSelfToNumHopScriptOp:
+            autoPrependSelfToEmbeddedInitScript(pSystem);
+            break;
+        case ComponentOp:
+        {
+            const HString typeName = reader.readString();
+            const HString subTypeName = reader.readString();
+            const HString name = reader.readString();
+            const bool disabled = (reader.readInt() != 0);
+            pComponent = reader.isOK() ? pHopsanEssentials->createComponent(typeName) : 0;
+            if (pComponent)
+            {
+                pComponent->setName(name);
+                pComponent->setSubTypeName(subTypeName);
+                pComponent->setDisabled(disabled);
+                pSystem->addComponent(pComponent);
+            }
+            else
+            {
+                // The recording only contains components that could be created, treat this as a corrupt cache
+                systemStack.clear();
+            }
+            break;
+        }
+        case ComponentParameterOp:
+        {
+            const HString name = reader.readString();
+            const HString value = reader.readString();
+            if (pComponent && reader.isOK() && !pComponent->setParameterValue(name, value, true))
+            {
+                pComponent->addWarningMessage("Failed to set parameter: "+name+"="+value);
+            }
+            break;
+        }
+        case PrependSelfToComponentParametersOp:
+            if (pComponent)
+            {
+                autoPrependSelfToParameterExpressions(pComponent);
+            }
+            break;
+        case PortQuantityOp:
+        {
+            const HString portName = reader.readString();
+            const HString quantity = reader.readString();
+            Port *pPort = pComponent ? pComponent->getPort(portName) : 0;
+            if (pPort)
+            {
+                pPort->setSignalNodeQuantityOrUnit(quantity);
+            }
+            break;
+        }
+        case SystemPortOp:
+            pSystem->addSystemPort(reader.readString());
+            break;
+        case ConnectionOp:
+        {
+            const HString startComponent = reader.readString();
+            const HString startPort = reader.readString();
+            const HString endComponent = reader.readString();
+            const HString endPort = reader.readString();
+            if (reader.isOK())
+            {
+                pSystem->connect(startComponent, startPort, endComponent, endPort);
+            }
+            break;
+        }
+        case VariableAliasOp:
+        {
+            const HString alias = reader.readString();
+            const HString component = reader.readString();
+            const HString port = reader.readString();
+            const HString variable = reader.readString();
+            if (reader.isOK())
+            {
+                pSystem->getAliasHandler().setVariableAlias(alias, component, port, variable);
+            }
+            break;
+        }
+        default:
+            systemStack.clear();
+        }
+    }
+
+    // The recording must end with only the root system remaining
+    if (!reader.isOK() || (systemStack.size() != 1))
+    {
+        pHopsanEssentials->getCoreMessageHandler()->addDebugMessage("The model cache data is corrupt, ignoring it");
+        pHopsanEssentials->removeComponent(pRootSystem);
+        return 0;
+    }
+    return pRootSystem;
+}
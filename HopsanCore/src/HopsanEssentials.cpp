@@ -331,9 +331,10 @@ HopsanCoreMessageHandler *HopsanEssentials::getCoreMessageHandler()
 //! @param [out] rStartTime A reference to the starttime variable
 //! @param [out] rStopTime A reference to the stoptime variable
 //! @returns A pointer to the root system of the loaded model
+//! @note If a model cache directory is set, the resolved model is loaded from, or stored in, the binary model cache
 ComponentSystem* HopsanEssentials::loadHMFModelFile(const char *filePath, double &rStartTime, double &rStopTime)
 {
-    return loadHopsanModelFile(filePath, this, rStartTime, rStopTime);
+    return loadHopsanModelFile(filePath, this, rStartTime, rStopTime, mModelCacheDirectory);
 }
 
 ComponentSystem* HopsanEssentials::loadHMFModel(const std::vector<unsigned char> xmlVector)
@@ -351,6 +352,21 @@ ComponentSystem* HopsanEssentials::loadHMFModel(const char *xmlString, double &r
     return loadHopsanModel(xmlString, this, rStartTime, rStopTime);
 }
 
+//! @brief Set the directory used for the binary model cache
+//! @details Models loaded with loadHMFModelFile() are cached in this directory, keyed by the model file contents, the core
+//! version and the loaded component libraries. Loading from the cache skips xml parsing and old version fix-ups.
+//! @param [in] dirPath The cache directory (must exist), an empty string disables the cache (default)
+void HopsanEssentials::setModelCacheDirectory(const char *dirPath)
+{
+    mModelCacheDirectory = dirPath;
+}
+
+//! @brief Returns the directory used for the binary model cache, empty if the cache is disabled
+const char *HopsanEssentials::getModelCacheDirectory() const
+{
+    return mModelCacheDirectory.c_str();
+}
+
 SimulationHandler *HopsanEssentials::getSimulationHandler()
 {
     return &mSimulationHandler;
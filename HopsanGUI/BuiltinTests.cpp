@@ -1,6 +1,7 @@
 #include "BuiltinTests.h"
 
 #include "HcomTest.hpp"
+#include "CacheBenchmark.hpp"
 
 #include "global.h"
 #include "ModelHandler.h"
@@ -10,5 +11,8 @@ int runBuiltInTests() {
 
     HComTest hcomtest{};
     int rc = QTest::qExec(&hcomtest);
+
+    CacheBenchmark cachebenchmark{};
+    rc += QTest::qExec(&cachebenchmark);
     return rc;
 }
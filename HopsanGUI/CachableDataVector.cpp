@@ -34,6 +34,109 @@
 #include "CachableDataVector.h"
 
 #include <QDebug>
+#include <QPair>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+enum CompressedBlockFormatT {RawBlock=0, DeltaBlock=1};
+
+//! @brief Encodes a block of values for the compressed cache
+//! @details Each value is predicted by linear extrapolation of the bit patterns of the two previous values. The difference to the actual bit
+//! pattern is zigzag encoded and stored with as few bytes as needed, the number of bytes is stored in a four bit header per value. Smooth data
+//! gives small differences and constant data none at all. If this would not save any space the values are stored as they are.
+void encodeBlock(const double *pValues, const int numValues, QByteArray &rEncoded)
+{
+    const int numRawBytes = 1+int(sizeof(double))*numValues;
+    const int numHeaderBytes = (numValues+1)/2;
+    rEncoded.resize(numRawBytes+numHeaderBytes);
+    uchar *pOut = reinterpret_cast<uchar*>(rEncoded.data());
+    uchar *pHeaders = pOut+1;
+    uchar *pBytes = pHeaders+numHeaderBytes;
+    memset(pHeaders, 0, numHeaderBytes);
+
+    quint64 prev1=0, prev2=0;
+    for (int i=0; i<numValues; ++i)
+    {
+        quint64 bits;
+        memcpy(&bits, pValues+i, sizeof(double));
+        const quint64 delta = bits-(2*prev1-prev2);
+        quint64 zigzag = (delta << 1) ^ (quint64(0)-(delta >> 63));
+        int n=0;
+        for (; zigzag != 0; zigzag >>= 8, ++n)
+        {
+            *pBytes++ = uchar(zigzag);
+        }
+        pHeaders[i/2] |= uchar(n << 4*(i%2));
+        prev2 = prev1;
+        prev1 = bits;
+    }
+
+    const int numBytes = int(pBytes-pOut);
+    if (numBytes < numRawBytes)
+    {
+        pOut[0] = DeltaBlock;
+        rEncoded.resize(numBytes);
+    }
+    else
+    {
+        pOut[0] = RawBlock;
+        memcpy(pOut+1, pValues, sizeof(double)*numValues);
+        rEncoded.resize(numRawBytes);
+    }
+}
+
+//! @brief Decodes a block encoded by encodeBlock()
+//! @returns False if the encoded data does not match the expected number of values
+bool decodeBlock(const uchar *pEncoded, const int numBytes, const int numValues, double *pValues)
+{
+    if (numBytes < 1)
+    {
+        return false;
+    }
+    if (pEncoded[0] == RawBlock)
+    {
+        if (numBytes != 1+int(sizeof(double))*numValues)
+        {
+            return false;
+        }
+        memcpy(pValues, pEncoded+1, sizeof(double)*numValues);
+        return true;
+    }
+
+    const uchar *pHeaders = pEncoded+1;
+    const uchar *pBytes = pHeaders+(numValues+1)/2;
+    const uchar *pEnd = pEncoded+numBytes;
+    if ((pEncoded[0] != DeltaBlock) || (pBytes > pEnd))
+    {
+        return false;
+    }
+
+    quint64 prev1=0, prev2=0;
+    for (int i=0; i<numValues; ++i)
+    {
+        const int n = (pHeaders[i/2] >> 4*(i%2)) & 0x0f;
+        if ((n > 8) || (pBytes+n > pEnd))
+        {
+            return false;
+        }
+        quint64 zigzag=0;
+        for (int b=0; b<n; ++b)
+        {
+            zigzag |= quint64(pBytes[b]) << 8*b;
+        }
+        pBytes += n;
+        const quint64 bits = (2*prev1-prev2) + ((zigzag >> 1) ^ (quint64(0)-(zigzag & 1)));
+        memcpy(pValues+i, &bits, sizeof(double));
+        prev2 = prev1;
+        prev1 = bits;
+    }
+    return (pBytes == pEnd);
+}
+
+}
 
 MultiDataVectorCache::MultiDataVectorCache(const QString fileName)
 {
@@ -42,6 +145,14 @@ MultiDataVectorCache::MultiDataVectorCache(const QString fileName)
     mIsMultiReading = false;
     mNumSubscribers = 0;
     mCacheFile.setFileName(fileName);
+    mUseMemoryMapping = true;
+    mMappedFile.setFileName(fileName);
+    mpMappedData = 0;
+    mMappedSize = 0;
+    mNumReadOnlyViews = 0;
+    mUseCompression = false;
+    mUncompressedBytes = 0;
+    mDecodedBlockIndex = -1;
 }
 
 MultiDataVectorCache::~MultiDataVectorCache()
@@ -73,6 +184,76 @@ bool MultiDataVectorCache::copyDataTo(const quint64 startByte, const quint64 nBy
     return readToMem(startByte, nBytes, &rData);
 }
 
+//! @brief Reads the values at specified indices (sorted ascending) of a vector in the cache
+//! @details Runs of consecutive indices are read in one go, and the file is only opened once
+bool MultiDataVectorCache::copyDataAt(const quint64 startByte, const QVector<int> &rIndices, QVector<double> &rData)
+{
+    bool success = true;
+    rData.resize(rIndices.size());
+    if (mUseCompression)
+    {
+        // Each block is only decoded once since the indices are sorted
+        const bool wasMultiReading = mIsMultiReading;
+        mIsMultiReading = true;
+        for (int i=0; success && i<rIndices.size(); ++i)
+        {
+            const quint64 value = startByte/sizeof(double)+quint64(rIndices[i]);
+            const int block = int(value/CompressionBlockSize);
+            const double *pBlock = decodedBlock(block);
+            success = pBlock && (value % CompressionBlockSize < mCompressedBlocks[block].numValues);
+            if (success)
+            {
+                rData[i] = pBlock[value % CompressionBlockSize];
+            }
+        }
+        mIsMultiReading = wasMultiReading;
+        smartCloseFile();
+        return success;
+    }
+
+    if (!rIndices.isEmpty())
+    {
+        const quint64 nBytes = quint64(rIndices.last()+1)*sizeof(double);
+        if (const uchar *pMapped = mappedRange(startByte, nBytes))
+        {
+            const double *pMappedData = reinterpret_cast<const double*>(pMapped);
+            for (int i=0; i<rIndices.size(); ++i)
+            {
+                rData[i] = pMappedData[rIndices[i]];
+            }
+            return true;
+        }
+    }
+
+    if (smartOpenFile(QIODevice::ReadOnly))
+    {
+        int i=0;
+        while (success && i<rIndices.size())
+        {
+            int runEnd = i+1;
+            while ((runEnd < rIndices.size()) && (rIndices[runEnd] == rIndices[runEnd-1]+1))
+            {
+                ++runEnd;
+            }
+            const qint64 nBytes = (runEnd-i)*sizeof(double);
+            success = mCacheFile.seek(startByte+quint64(rIndices[i])*sizeof(double)) &&
+                      (mCacheFile.read((char*)(rData.data()+i), nBytes) == nBytes);
+            i = runEnd;
+        }
+    }
+    else
+    {
+        success = false;
+    }
+
+    if (!success)
+    {
+        mError = mCacheFile.errorString();
+    }
+    smartCloseFile();
+    return success;
+}
+
 bool MultiDataVectorCache::replaceData(const quint64 startByte, const QVector<double> &rNewData, quint64 &rNumBytes)
 {
     //! @todo prevent destroying data if new data have new longer length
@@ -82,6 +263,38 @@ bool MultiDataVectorCache::replaceData(const quint64 startByte, const QVector<do
 
 bool MultiDataVectorCache::writeInCache(const quint64 startByte, const QVector<double> &rDataVector, quint64 &rBytesWriten)
 {
+    const quint64 nBytes = sizeof(double)*rDataVector.size();
+    if (mUseCompression)
+    {
+        rBytesWriten = 0;
+        if (writeCompressed(startByte, rDataVector.constData(), nBytes))
+        {
+            rBytesWriten = nBytes;
+            return true;
+        }
+        return false;
+    }
+
+    if (uchar *pMapped = mappedRange(startByte, nBytes))
+    {
+        // Write page by page and only touch pages whose contents actually change, that way unchanged pages are not
+        // dirtied and will not be written back to disk (returning a checked out vector that was only read is cheap)
+        const uchar *pSrc = reinterpret_cast<const uchar*>(rDataVector.constData());
+        quint64 b=0;
+        while (b < nBytes)
+        {
+            const quint64 pageEnd = ((startByte+b)/PageSize+1)*PageSize;
+            const size_t n = qMin(pageEnd-startByte, nBytes)-b;
+            if (memcmp(pMapped+b, pSrc+b, n) != 0)
+            {
+                memcpy(pMapped+b, pSrc+b, n);
+            }
+            b += n;
+        }
+        rBytesWriten = nBytes;
+        return true;
+    }
+
     bool success = false;
     if (smartOpenFile(QIODevice::ReadWrite))
     {
@@ -113,6 +326,11 @@ bool MultiDataVectorCache::appendToCache(const QVector<double> &rDataVector, qui
         return false;
     }
 
+    if (mUseCompression)
+    {
+        return appendCompressed(rDataVector, rStartByte, rNumBytes);
+    }
+
     bool success = false;
     if (smartOpenFile(QIODevice::WriteOnly | QIODevice::Append))
     {
@@ -136,6 +354,19 @@ bool MultiDataVectorCache::appendToCache(const QVector<double> &rDataVector, qui
 
 bool MultiDataVectorCache::readToMem(const quint64 startByte, const quint64 nBytes, QVector<double> *pDataVector)
 {
+    if (mUseCompression)
+    {
+        pDataVector->resize(nBytes/sizeof(double));
+        return readCompressed(startByte, nBytes, pDataVector->data());
+    }
+
+    if (const uchar *pMapped = mappedRange(startByte, nBytes))
+    {
+        pDataVector->resize(nBytes/sizeof(double));
+        memcpy(pDataVector->data(), pMapped, nBytes);
+        return true;
+    }
+
     bool success = false;
     if (smartOpenFile(QIODevice::ReadOnly))
     {
@@ -158,6 +389,268 @@ bool MultiDataVectorCache::readToMem(const quint64 startByte, const quint64 nByt
     return success;
 }
 
+//! @brief Appends a vector to the compressed cache file, the vector starts at a new block
+bool MultiDataVectorCache::appendCompressed(const QVector<double> &rDataVector, quint64 &rStartByte, quint64 &rNumBytes)
+{
+    // Encode all blocks first, so that the vector is written in one go
+    QByteArray encoded, encodedBlock;
+    encoded.reserve(rDataVector.size()*int(sizeof(double))/2);
+    QVector<CompressedBlock> newBlocks;
+    for (int i=0; i<rDataVector.size(); i+=CompressionBlockSize)
+    {
+        CompressedBlock block;
+        block.numValues = quint32(qMin(int(CompressionBlockSize), rDataVector.size()-i));
+        encodeBlock(rDataVector.constData()+i, int(block.numValues), encodedBlock);
+        block.fileOffset = quint64(encoded.size());
+        block.numBytes = quint32(encodedBlock.size());
+        block.capacity = block.numBytes;
+        encoded.append(encodedBlock);
+        newBlocks.append(block);
+    }
+
+    bool success = false;
+    if (smartOpenFile(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        // In case someone has moved the pointer by reading, lets us seek to 'end of file' instead
+        mCacheFile.seek( mCacheFile.size() );
+        const quint64 fileOffset = mCacheFile.pos();
+        if (mCacheFile.write(encoded) == encoded.size())
+        {
+            rStartByte = quint64(mCompressedBlocks.size())*CompressionBlockSize*sizeof(double);
+            rNumBytes = sizeof(double)*rDataVector.size();
+            for (CompressedBlock &rBlock : newBlocks)
+            {
+                rBlock.fileOffset += fileOffset;
+                mCompressedBlocks.append(rBlock);
+            }
+            mUncompressedBytes += rNumBytes;
+            success = true;
+        }
+    }
+
+    if (!success)
+    {
+        mError = mCacheFile.errorString();
+    }
+    smartCloseFile();
+    return success;
+}
+
+//! @brief Reads a range of values from the compressed cache file, only the blocks covering the range are decoded
+bool MultiDataVectorCache::readCompressed(const quint64 startByte, const quint64 nBytes, double *pData)
+{
+    // Keep the file open while reading the blocks
+    const bool wasMultiReading = mIsMultiReading;
+    mIsMultiReading = true;
+
+    bool success = true;
+    const quint64 firstValue = startByte/sizeof(double);
+    const quint64 numValues = nBytes/sizeof(double);
+    quint64 i=0;
+    while (success && (i < numValues))
+    {
+        const int block = int((firstValue+i)/CompressionBlockSize);
+        const quint32 offset = quint32((firstValue+i)%CompressionBlockSize);
+        if ((block >= mCompressedBlocks.size()) || (offset >= mCompressedBlocks[block].numValues))
+        {
+            mError = "Trying to read outside of the cached data";
+            success = false;
+            break;
+        }
+
+        const quint32 blockSize = mCompressedBlocks[block].numValues;
+        const quint64 count = qMin(quint64(blockSize-offset), numValues-i);
+        // Entire blocks are decoded directly into the destination
+        if ((offset == 0) && (count == blockSize) && (block != mDecodedBlockIndex))
+        {
+            const uchar *pEncoded = compressedBlockData(block);
+            success = pEncoded && decodeBlock(pEncoded, int(mCompressedBlocks[block].numBytes), int(blockSize), pData+i);
+            if (pEncoded && !success)
+            {
+                mError = "Corrupt compressed data block";
+            }
+        }
+        else
+        {
+            const double *pBlock = decodedBlock(block);
+            success = (pBlock != 0);
+            if (success)
+            {
+                memcpy(pData+i, pBlock+offset, count*sizeof(double));
+            }
+        }
+        i += count;
+    }
+
+    mIsMultiReading = wasMultiReading;
+    smartCloseFile();
+    return success;
+}
+
+//! @brief Replaces a range of values in the compressed cache file, blocks that are only partially replaced are decoded and merged first
+bool MultiDataVectorCache::writeCompressed(const quint64 startByte, const double *pData, const quint64 nBytes)
+{
+    // Encode all affected blocks before writing anything
+    QList< QPair<int, QByteArray> > encodedBlocks;
+    QVector<double> merged;
+    bool success = true;
+    const quint64 firstValue = startByte/sizeof(double);
+    const quint64 numValues = nBytes/sizeof(double);
+    quint64 i=0;
+    while (success && (i < numValues))
+    {
+        const int block = int((firstValue+i)/CompressionBlockSize);
+        const quint32 offset = quint32((firstValue+i)%CompressionBlockSize);
+        if ((block >= mCompressedBlocks.size()) || (offset >= mCompressedBlocks[block].numValues))
+        {
+            mError = "Trying to write outside of the cached data";
+            success = false;
+            break;
+        }
+
+        const quint32 blockSize = mCompressedBlocks[block].numValues;
+        const quint64 count = qMin(quint64(blockSize-offset), numValues-i);
+        QByteArray encoded;
+        if ((offset == 0) && (count == blockSize))
+        {
+            encodeBlock(pData+i, int(blockSize), encoded);
+        }
+        else
+        {
+            const double *pBlock = decodedBlock(block);
+            success = (pBlock != 0);
+            if (success)
+            {
+                merged.resize(int(blockSize));
+                memcpy(merged.data(), pBlock, blockSize*sizeof(double));
+                memcpy(merged.data()+offset, pData+i, count*sizeof(double));
+                encodeBlock(merged.constData(), int(blockSize), encoded);
+            }
+        }
+        encodedBlocks.append(qMakePair(block, encoded));
+        i += count;
+    }
+
+    if (success)
+    {
+        // Keep the file open while writing the blocks
+        const bool wasMultiReadWriting = mIsMultiReadWriting;
+        mIsMultiReadWriting = true;
+        for (int b=0; success && b<encodedBlocks.size(); ++b)
+        {
+            success = storeCompressedBlock(encodedBlocks[b].first, encodedBlocks[b].second);
+        }
+        mIsMultiReadWriting = wasMultiReadWriting;
+    }
+    smartCloseFile();
+    return success;
+}
+
+//! @brief Returns the encoded bytes of a block, directly from the memory mapping if possible
+//! @returns Pointer to the encoded block, valid until the next cache operation, or 0 on failure
+const uchar *MultiDataVectorCache::compressedBlockData(const int block)
+{
+    const CompressedBlock &rBlock = mCompressedBlocks[block];
+    if (const uchar *pMapped = mappedRange(rBlock.fileOffset, rBlock.numBytes))
+    {
+        return pMapped;
+    }
+
+    bool success = false;
+    if (smartOpenFile(QIODevice::ReadOnly))
+    {
+        if (mCacheFile.seek(rBlock.fileOffset))
+        {
+            mCompressedReadBuffer.resize(int(rBlock.numBytes));
+            success = (mCacheFile.read(mCompressedReadBuffer.data(), rBlock.numBytes) == qint64(rBlock.numBytes));
+        }
+    }
+
+    if (!success)
+    {
+        mError = mCacheFile.errorString();
+    }
+    smartCloseFile();
+    return success ? reinterpret_cast<const uchar*>(mCompressedReadBuffer.constData()) : 0;
+}
+
+//! @brief Returns the decoded values of a block, the most recently decoded block is remembered so that repeated access to it (peek) is cheap
+//! @returns Pointer to the values, valid until another block is decoded, or 0 on failure
+const double *MultiDataVectorCache::decodedBlock(const int block)
+{
+    if (block == mDecodedBlockIndex)
+    {
+        return mDecodedBlock.constData();
+    }
+    if ((block < 0) || (block >= mCompressedBlocks.size()))
+    {
+        mError = "Trying to read outside of the cached data";
+        return 0;
+    }
+
+    mDecodedBlockIndex = -1;
+    const uchar *pEncoded = compressedBlockData(block);
+    if (pEncoded == 0)
+    {
+        return 0;
+    }
+    mDecodedBlock.resize(int(mCompressedBlocks[block].numValues));
+    if (!decodeBlock(pEncoded, int(mCompressedBlocks[block].numBytes), mDecodedBlock.size(), mDecodedBlock.data()))
+    {
+        mError = "Corrupt compressed data block";
+        return 0;
+    }
+    mDecodedBlockIndex = block;
+    return mDecodedBlock.constData();
+}
+
+//! @brief Writes an encoded block, in place if it fits where the block was stored before, else at the end of the file
+//! @details Blocks moved to the end of the file leave their old bytes as junk, pruning the generation cache removes it
+bool MultiDataVectorCache::storeCompressedBlock(const int block, const QByteArray &rEncoded)
+{
+    CompressedBlock &rBlock = mCompressedBlocks[block];
+    const quint32 numBytes = quint32(rEncoded.size());
+    if (block == mDecodedBlockIndex)
+    {
+        mDecodedBlockIndex = -1;
+    }
+
+    if (numBytes <= rBlock.capacity)
+    {
+        if (uchar *pMapped = mappedRange(rBlock.fileOffset, numBytes))
+        {
+            memcpy(pMapped, rEncoded.constData(), numBytes);
+            rBlock.numBytes = numBytes;
+            return true;
+        }
+    }
+
+    bool success = false;
+    if (smartOpenFile(QIODevice::ReadWrite))
+    {
+        // A file opened for appending can only be written at its end
+        const bool inPlace = (numBytes <= rBlock.capacity) && !(mCacheFile.openMode() & QIODevice::Append);
+        const quint64 fileOffset = inPlace ? rBlock.fileOffset : quint64(mCacheFile.size());
+        if (mCacheFile.seek(fileOffset) && (mCacheFile.write(rEncoded) == rEncoded.size()))
+        {
+            rBlock.fileOffset = fileOffset;
+            rBlock.numBytes = numBytes;
+            if (!inPlace)
+            {
+                rBlock.capacity = numBytes;
+            }
+            success = true;
+        }
+    }
+
+    if (!success)
+    {
+        mError = mCacheFile.errorString();
+    }
+    smartCloseFile();
+    return success;
+}
+
 bool MultiDataVectorCache::smartOpenFile(QIODevice::OpenMode flags)
 {
     if (mCacheFile.isOpen())
@@ -182,13 +675,112 @@ void MultiDataVectorCache::smartCloseFile()
 
 void MultiDataVectorCache::removeCacheFile()
 {
+    unmapFile();
     bool rc = mCacheFile.remove();
     qDebug() << "Removing file: " << mCacheFile.fileName() << " : " << rc;
 }
 
 
+//! @brief Returns a pointer to a range of the memory mapped cache file, (re)mapping the file if needed
+//! @returns Pointer to startByte in the mapping, or 0 if memory mapping is disabled or the range could not be mapped
+uchar *MultiDataVectorCache::mappedRange(const quint64 startByte, const quint64 nBytes)
+{
+    if (!mUseMemoryMapping || (nBytes == 0))
+    {
+        return 0;
+    }
+    if ((mpMappedData == 0) || (startByte+nBytes > mMappedSize))
+    {
+        if (!mapFile(startByte+nBytes))
+        {
+            return 0;
+        }
+    }
+    return mpMappedData+startByte;
+}
+
+//! @brief Maps the entire cache file into memory, the previous mapping is released (or retired if read-only views remain)
+//! @param[in] requiredBytes The minimum file size needed, nothing is mapped if the file is shorter
+bool MultiDataVectorCache::mapFile(const quint64 requiredBytes)
+{
+    // Appended data may still be buffered in the (multi-append) file handle
+    if (mCacheFile.isOpen())
+    {
+        mCacheFile.flush();
+    }
+
+    if (!mMappedFile.isOpen())
+    {
+        if (!mMappedFile.exists() || !mMappedFile.open(QIODevice::ReadWrite))
+        {
+            return false;
+        }
+    }
+
+    const qint64 fileSize = mMappedFile.size();
+    if ((fileSize <= 0) || (quint64(fileSize) < requiredBytes))
+    {
+        return false;
+    }
+
+    uchar *pNewMapping = mMappedFile.map(0, fileSize);
+    if (pNewMapping == 0)
+    {
+        qWarning() << "MultiDataVectorCache: Could not memory map cache file, falling back to file access: " << mMappedFile.errorString();
+        unmapFile();
+        mUseMemoryMapping = false;
+        return false;
+    }
+
+    if (mpMappedData)
+    {
+        if (mNumReadOnlyViews > 0)
+        {
+            mRetiredMappings.append(mpMappedData);
+        }
+        else
+        {
+            mMappedFile.unmap(mpMappedData);
+        }
+    }
+    mpMappedData = pNewMapping;
+    mMappedSize = quint64(fileSize);
+    return true;
+}
+
+void MultiDataVectorCache::unmapFile()
+{
+    if (mNumReadOnlyViews > 0)
+    {
+        qWarning() << "-- MultiDataVectorCache::unmapFile: Unmapping with" << mNumReadOnlyViews << "read-only views remaining. This should not happen!";
+    }
+    foreach(uchar *pMapping, mRetiredMappings)
+    {
+        mMappedFile.unmap(pMapping);
+    }
+    mRetiredMappings.clear();
+    if (mpMappedData)
+    {
+        mMappedFile.unmap(mpMappedData);
+    }
+    mpMappedData = 0;
+    mMappedSize = 0;
+    mMappedFile.close();
+}
+
 bool MultiDataVectorCache::peek(const quint64 byte, double &rVal)
 {
+    if (mUseCompression)
+    {
+        return readCompressed(byte, sizeof(double), &rVal);
+    }
+
+    if (const uchar *pMapped = mappedRange(byte, sizeof(double)))
+    {
+        memcpy(&rVal, pMapped, sizeof(double));
+        return true;
+    }
+
     bool success=false;
     if (smartOpenFile(QIODevice::ReadOnly))
     {
@@ -211,6 +803,18 @@ bool MultiDataVectorCache::peek(const quint64 byte, double &rVal)
 
 bool MultiDataVectorCache::poke(const quint64 byte, const double val)
 {
+    if (mUseCompression)
+    {
+        return writeCompressed(byte, &val, sizeof(double));
+    }
+
+    // Only the page containing the value is modified
+    if (uchar *pMapped = mappedRange(byte, sizeof(double)))
+    {
+        memcpy(pMapped, &val, sizeof(double));
+        return true;
+    }
+
     bool success=false;
     if (smartOpenFile(QIODevice::ReadWrite))
     {
@@ -271,6 +875,91 @@ bool MultiDataVectorCache::returnVector(QVector<double> *&rpData)
     return rc;
 }
 
+//! @brief Gives read-only access to data in the cache, without copying it if the cache file is memory mapped
+//! @details If the file can not be mapped, or if it is compressed, a temporary copy of the data is made instead. Each view must be ended by calling endReadOnlyView()
+//! @returns Pointer to the data or 0 on failure
+const double *MultiDataVectorCache::beginReadOnlyView(const quint64 startByte, const quint64 nBytes)
+{
+    if (const uchar *pMapped = mUseCompression ? 0 : mappedRange(startByte, nBytes))
+    {
+        ++mNumReadOnlyViews;
+        return reinterpret_cast<const double*>(pMapped);
+    }
+
+    QVector<double> *pCopy = new QVector<double>();
+    if ((nBytes > 0) && readToMem(startByte, nBytes, pCopy))
+    {
+        mReadOnlyCopies.insert(pCopy->constData(), pCopy);
+        return pCopy->constData();
+    }
+    delete pCopy;
+    return 0;
+}
+
+void MultiDataVectorCache::endReadOnlyView(const double *pData)
+{
+    if (pData == 0)
+    {
+        return;
+    }
+
+    QVector<double> *pCopy = mReadOnlyCopies.take(pData);
+    if (pCopy)
+    {
+        delete pCopy;
+    }
+    else if (mNumReadOnlyViews > 0)
+    {
+        --mNumReadOnlyViews;
+        // Mappings replaced while views were open can be released once the last view has ended
+        if (mNumReadOnlyViews == 0)
+        {
+            foreach(uchar *pMapping, mRetiredMappings)
+            {
+                mMappedFile.unmap(pMapping);
+            }
+            mRetiredMappings.clear();
+        }
+    }
+}
+
+//! @brief Enable or disable memory mapped access to the cache file, if disabled all access goes through regular file I/O
+void MultiDataVectorCache::setUseMemoryMapping(const bool use)
+{
+    mUseMemoryMapping = use;
+    if (!use)
+    {
+        unmapFile();
+    }
+}
+
+bool MultiDataVectorCache::isUsingMemoryMapping() const
+{
+    return mUseMemoryMapping;
+}
+
+//! @brief Enable or disable compression of the cache file, this can only be changed before any data has been added
+//! @returns True if the setting was changed (or already had the desired value), else false
+bool MultiDataVectorCache::setUseCompression(const bool use)
+{
+    if (use == mUseCompression)
+    {
+        return true;
+    }
+    if (!mCompressedBlocks.isEmpty() || (getCacheSize() > 0))
+    {
+        mError = "Compression can not be changed after data has been added to the cache";
+        return false;
+    }
+    mUseCompression = use;
+    return true;
+}
+
+bool MultiDataVectorCache::isUsingCompression() const
+{
+    return mUseCompression;
+}
+
 bool MultiDataVectorCache::hasError() const
 {
     return !mError.isEmpty();
@@ -299,6 +988,17 @@ qint64 MultiDataVectorCache::getCacheSize() const
     return mCacheFile.size();
 }
 
+//! @brief Returns the number of bytes the data in the cache would need without compression
+//! @note Without compression this is the cache size
+qint64 MultiDataVectorCache::getUncompressedSize() const
+{
+    if (mUseCompression)
+    {
+        return qint64(mUncompressedBytes);
+    }
+    return getCacheSize();
+}
+
 void MultiDataVectorCache::incrementSubscribers()
 {
     ++mNumSubscribers;
@@ -330,6 +1030,8 @@ CachableDataVector::CachableDataVector(const QVector<double> &rDataVector, Share
 {
     mCacheStartByte = 0;
     mCacheNumBytes = 0;
+    mRevision = 0;
+    mPyramidRevision = 0;
     // This bool is needed so that we can handled non-cached but empty data.
     // We can not rely on checking size of mDataVector (may be empty but non-cached) or the mCacheNumBytes (will still have a value after moving from cache to memory temporarily)
     mIsCached = false;
@@ -491,8 +1193,31 @@ bool CachableDataVector::copyDataTo(QVector<double> &rData)
     return true;
 }
 
+//! @brief Copies the values at specified indices, the indices must be sorted ascending and be in range
+bool CachableDataVector::copyDataAt(const QVector<int> &rIndices, QVector<double> &rData)
+{
+    if (isCached())
+    {
+        if (!mpMultiCache->copyDataAt(mCacheStartByte, rIndices, rData))
+        {
+            mError = mpMultiCache->getError();
+            return false;
+        }
+    }
+    else
+    {
+        rData.resize(rIndices.size());
+        for (int i=0; i<rIndices.size(); ++i)
+        {
+            rData[i] = mDataVector[rIndices[i]];
+        }
+    }
+    return true;
+}
+
 bool CachableDataVector::replaceData(const QVector<double> &rNewData)
 {
+    ++mRevision;
     if (isCached())
     {
         // If same length, then replace actual data
@@ -538,6 +1263,7 @@ bool CachableDataVector::peek(const int idx, double &rVal)
 
 bool CachableDataVector::poke(const int idx, const double val)
 {
+    ++mRevision;
     if (isCached())
     {
         if (!mpMultiCache->poke(mCacheStartByte+idx*sizeof(double),val))
@@ -578,6 +1304,8 @@ QVector<double> *CachableDataVector::beginFullVectorOperation()
 
 bool CachableDataVector::endFullVectorOperation(QVector<double> *&rpData)
 {
+    // The data may have been modified through the checked out pointer
+    ++mRevision;
     bool rc = true;
     if(isCached())
     {
@@ -591,6 +1319,54 @@ bool CachableDataVector::endFullVectorOperation(QVector<double> *&rpData)
     return rc;
 }
 
+//! @brief Gives read-only access to the data without checking it out, use this for operations that do not modify the data
+//! @details Every call must be matched by endReadOnlyOperation(). The data must not be modified while the view is open.
+//! @returns Pointer to size() values, or 0 if the data is cached but empty or could not be accessed
+const double *CachableDataVector::beginReadOnlyOperation()
+{
+    if (isCached())
+    {
+        if (mCacheNumBytes == 0)
+        {
+            return 0;
+        }
+        const double *pData = mpMultiCache->beginReadOnlyView(mCacheStartByte, mCacheNumBytes);
+        if (pData == 0)
+        {
+            mError = mpMultiCache->getError();
+        }
+        return pData;
+    }
+    return mDataVector.constData();
+}
+
+void CachableDataVector::endReadOnlyOperation(const double *&rpData)
+{
+    // Read-only operations do not change the data, so the revision is not bumped here
+    if (isCached())
+    {
+        mpMultiCache->endReadOnlyView(rpData);
+    }
+    rpData = 0;
+}
+
+//! @brief Returns the min/max pyramid of the data, it is (re)built on first use after the data has changed
+SharedMinMaxPyramidT CachableDataVector::getMinMaxPyramid()
+{
+    if (mpMinMaxPyramid.isNull() || (mPyramidRevision != mRevision))
+    {
+        const double *pData = beginReadOnlyOperation();
+        if ((pData == 0) && !isEmpty())
+        {
+            return SharedMinMaxPyramidT();
+        }
+        mpMinMaxPyramid = SharedMinMaxPyramidT(new MinMaxPyramid(pData, size()));
+        endReadOnlyOperation(pData);
+        mPyramidRevision = mRevision;
+    }
+    return mpMinMaxPyramid;
+}
+
 bool CachableDataVector::hasError() const
 {
     return !mError.isEmpty();
@@ -671,3 +1447,142 @@ bool CachableDataVector::copyToMem()
     mError = "No cached data available";
     return false;
 }
+
+
+MinMaxPyramid::MinMaxPyramid(const double *pData, const int size)
+{
+    mDataSize = size;
+
+    // Build the finest level directly from the data, NaN values are skipped unless a bucket only contains NaN
+    QVector<Bucket> level((mDataSize+BaseBucketSize-1)/BaseBucketSize);
+    for (int b=0; b<level.size(); ++b)
+    {
+        const int begin = b*BaseBucketSize;
+        const int end = qMin(begin+int(BaseBucketSize), mDataSize);
+        Bucket &rBucket = level[b];
+        rBucket.min = rBucket.max = pData[begin];
+        rBucket.minIdx = rBucket.maxIdx = begin;
+        for (int i=begin+1; i<end; ++i)
+        {
+            const double value = pData[i];
+            if (value < rBucket.min || std::isnan(rBucket.min))
+            {
+                rBucket.min = value;
+                rBucket.minIdx = i;
+            }
+            if (value > rBucket.max || std::isnan(rBucket.max))
+            {
+                rBucket.max = value;
+                rBucket.maxIdx = i;
+            }
+        }
+    }
+    mLevels.append(level);
+
+    // Merge pairs of buckets until only one bucket remains
+    while (mLevels.last().size() > 1)
+    {
+        const QVector<Bucket> &rFiner = mLevels.last();
+        QVector<Bucket> coarser((rFiner.size()+1)/2);
+        for (int b=0; b<coarser.size(); ++b)
+        {
+            Bucket bucket = rFiner[2*b];
+            if (2*b+1 < rFiner.size())
+            {
+                const Bucket &rOther = rFiner[2*b+1];
+                if (rOther.min < bucket.min || std::isnan(bucket.min))
+                {
+                    bucket.min = rOther.min;
+                    bucket.minIdx = rOther.minIdx;
+                }
+                if (rOther.max > bucket.max || std::isnan(bucket.max))
+                {
+                    bucket.max = rOther.max;
+                    bucket.maxIdx = rOther.maxIdx;
+                }
+            }
+            coarser[b] = bucket;
+        }
+        mLevels.append(coarser);
+    }
+}
+
+int MinMaxPyramid::getDataSize() const
+{
+    return mDataSize;
+}
+
+//! @brief Returns the smallest and largest value of the whole data vector
+//! @returns False if the data is empty
+bool MinMaxPyramid::getMinMax(double &rMin, double &rMax) const
+{
+    if (mLevels.isEmpty() || mLevels.last().isEmpty())
+    {
+        return false;
+    }
+    rMin = mLevels.last().first().min;
+    rMax = mLevels.last().first().max;
+    return true;
+}
+
+//! @brief Decimates a range of the data to at most about 2*maxNumBuckets indices, keeping the min and max of each bucket
+//! @details If the range is short enough all indices are returned. The first and last index of the range are always included.
+//! The last bucket may extend beyond the range, so the last returned indices can be larger than lastIdx.
+//! @param[in] firstIdx First index in the range
+//! @param[in] lastIdx Last index in the range
+//! @param[in] maxNumBuckets Maximum number of buckets to split the range into, typically the width in pixels
+//! @param[out] rIndices Sorted unique indices of the points to keep
+void MinMaxPyramid::decimate(const int firstIdx, const int lastIdx, const int maxNumBuckets, QVector<int> &rIndices) const
+{
+    rIndices.clear();
+    const int first = qMax(firstIdx, 0);
+    const int last = qMin(lastIdx, mDataSize-1);
+    if (last < first)
+    {
+        return;
+    }
+
+    const int numSamples = last-first+1;
+    const int desiredBucketSize = numSamples/qMax(maxNumBuckets, 1);
+    if (desiredBucketSize < BaseBucketSize)
+    {
+        rIndices.reserve(numSamples);
+        for (int i=first; i<=last; ++i)
+        {
+            rIndices.append(i);
+        }
+        return;
+    }
+
+    // Use the coarsest level that still has at least maxNumBuckets buckets within the range
+    int level = 0;
+    int bucketSize = BaseBucketSize;
+    while ((level+1 < mLevels.size()) && (2*bucketSize <= desiredBucketSize))
+    {
+        ++level;
+        bucketSize *= 2;
+    }
+
+    const QVector<Bucket> &rBuckets = mLevels[level];
+    const int lastBucket = qMin(last/bucketSize, rBuckets.size()-1);
+    rIndices.reserve(2*(lastBucket-first/bucketSize+1)+2);
+    rIndices.append(first);
+    for (int b=first/bucketSize; b<=lastBucket; ++b)
+    {
+        const Bucket &rBucket = rBuckets[b];
+        const int lowIdx = qMin(rBucket.minIdx, rBucket.maxIdx);
+        const int highIdx = qMax(rBucket.minIdx, rBucket.maxIdx);
+        if (lowIdx > rIndices.last())
+        {
+            rIndices.append(lowIdx);
+        }
+        if (highIdx > rIndices.last())
+        {
+            rIndices.append(highIdx);
+        }
+    }
+    if (last > rIndices.last())
+    {
+        rIndices.append(last);
+    }
+}
@@ -39,13 +39,20 @@
 #include <QFileInfo>
 #include <QSharedPointer>
 #include <QVector>
+#include <QByteArray>
 #include <QMap>
+#include <QList>
 #include <QTextStream>
 
 //! @todo this could be a template
+//! @details The cache file can optionally be compressed. Vectors are then stored in blocks of CompressionBlockSize values, each block
+//! encoded separately with a block index, so that parts of a vector can be read and written without decoding all of it. Start bytes
+//! and byte counts still refer to the uncompressed data, as if it was stored block aligned.
 class MultiDataVectorCache
 {
 public:
+    enum {PageSize=4096, CompressionBlockSize=1024};
+
     MultiDataVectorCache(const QString fileName);
     ~MultiDataVectorCache();
     bool addVector(const QVector<double> &rDataVector, quint64 &rStartByte, quint64 &rNumBytes);
@@ -53,18 +60,27 @@ public:
     void endMultiAppend();
 
     bool copyDataTo(const quint64 startByte, const quint64 nBytes, QVector<double> &rData);
+    bool copyDataAt(const quint64 startByte, const QVector<int> &rIndices, QVector<double> &rData);
     bool replaceData(const quint64 startByte, const QVector<double> &rNewData, quint64 &rNumBytes);
     bool peek(const quint64 byte, double &rVal);
     bool poke(const quint64 byte, const double val);
 
     bool checkoutVector(const quint64 startByte, const quint64 nBytes, QVector<double> *&rpData);
     bool returnVector(QVector<double> *&rpData);
+    const double *beginReadOnlyView(const quint64 startByte, const quint64 nBytes);
+    void endReadOnlyView(const double *pData);
+
+    void setUseMemoryMapping(const bool use);
+    bool isUsingMemoryMapping() const;
+    bool setUseCompression(const bool use);
+    bool isUsingCompression() const;
 
     bool hasError() const;
     QString getError() const;
     QString getAndClearError();
     QFileInfo getCacheFileInfo() const;
     qint64 getCacheSize() const;
+    qint64 getUncompressedSize() const;
 
     void incrementSubscribers();
     void decrementSubscribers();
@@ -84,17 +100,82 @@ protected:
     bool smartOpenFile(QIODevice::OpenMode flags);
     void smartCloseFile();
     void removeCacheFile();
+    uchar *mappedRange(const quint64 startByte, const quint64 nBytes);
+    bool mapFile(const quint64 requiredBytes);
+    void unmapFile();
+
+    //! @brief Location in the cache file of one compressed block
+    struct CompressedBlock
+    {
+        quint64 fileOffset;
+        quint32 numBytes;
+        quint32 capacity;
+        quint32 numValues;
+    };
+
+    bool appendCompressed(const QVector<double> &rDataVector, quint64 &rStartByte, quint64 &rNumBytes);
+    bool readCompressed(const quint64 startByte, const quint64 nBytes, double *pData);
+    bool writeCompressed(const quint64 startByte, const double *pData, const quint64 nBytes);
+    const uchar *compressedBlockData(const int block);
+    const double *decodedBlock(const int block);
+    bool storeCompressedBlock(const int block, const QByteArray &rEncoded);
 
     QMap<QVector<double> *, CheckoutInfo> mCheckoutMap;
+    QMap<const double *, QVector<double> *> mReadOnlyCopies;
     qint64 mNumSubscribers;
     QFile mCacheFile;
     QString mError;
     bool mIsMultiAppending;
     bool mIsMultiReadWriting;
     bool mIsMultiReading;
+
+    // The cache file is also mapped into memory (when possible), the mapping covers the entire file and is replaced
+    // when data is appended beyond its end. Replaced mappings are kept until all read-only views into them have ended.
+    bool mUseMemoryMapping;
+    QFile mMappedFile;
+    uchar *mpMappedData;
+    quint64 mMappedSize;
+    QList<uchar *> mRetiredMappings;
+    int mNumReadOnlyViews;
+
+    bool mUseCompression;
+    QVector<CompressedBlock> mCompressedBlocks;
+    quint64 mUncompressedBytes;
+    QByteArray mCompressedReadBuffer;
+    QVector<double> mDecodedBlock;
+    int mDecodedBlockIndex;
 };
 typedef QSharedPointer<MultiDataVectorCache> SharedMultiDataVectorCacheT;
 
+//! @brief Multi-resolution min/max summary of a data vector, used to decimate long vectors before plotting
+//! @details Level k consists of buckets of BaseBucketSize*2^k samples, each bucket remembers the index of its smallest
+//! and largest value. Building the pyramid requires one pass over the data, decimating a range is proportional to the
+//! number of requested buckets.
+class MinMaxPyramid
+{
+public:
+    enum {BaseBucketSize=64};
+
+    MinMaxPyramid(const double *pData, const int size);
+
+    int getDataSize() const;
+    bool getMinMax(double &rMin, double &rMax) const;
+    void decimate(const int firstIdx, const int lastIdx, const int maxNumBuckets, QVector<int> &rIndices) const;
+
+private:
+    struct Bucket
+    {
+        double min;
+        double max;
+        int minIdx;
+        int maxIdx;
+    };
+
+    QVector< QVector<Bucket> > mLevels;
+    int mDataSize;
+};
+typedef QSharedPointer<const MinMaxPyramid> SharedMinMaxPyramidT;
+
 class CachableDataVector
 {
 public:
@@ -111,12 +192,17 @@ public:
 
     bool streamDataTo(QTextStream &rTextStream, const QString separator);
     bool copyDataTo(QVector<double> &rData);
+    bool copyDataAt(const QVector<int> &rIndices, QVector<double> &rData);
     bool replaceData(const QVector<double> &rNewData);
     bool peek(const int idx, double &rVal);
     bool poke(const int idx, const double val);
 
     QVector<double> *beginFullVectorOperation();
     bool endFullVectorOperation(QVector<double> *&rpData);
+    const double *beginReadOnlyOperation();
+    void endReadOnlyOperation(const double *&rpData);
+
+    SharedMinMaxPyramidT getMinMaxPyramid();
 
     bool hasError() const;
     QString getError() const;
@@ -132,6 +218,9 @@ private:
     quint64 mCacheStartByte;
     quint64 mCacheNumBytes;
     bool mIsCached;
+    quint64 mRevision;
+    quint64 mPyramidRevision;
+    SharedMinMaxPyramidT mpMinMaxPyramid;
 };
 
 #endif // CACHABLEDATAVECTOR_H
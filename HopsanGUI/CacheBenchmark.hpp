@@ -0,0 +1,298 @@
+#include "CachableDataVector.h"
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+
+//! @brief Measures the throughput of the log data disk cache, with and without memory mapping or compression of the cache file
+//! @details The access patterns mimic data collection after a simulation (many appended vectors), plotting (full and
+//! decimated reads) and scripting (random peek and poke, read-only full vector operations).
+class CacheBenchmark: public QObject
+{
+    Q_OBJECT
+private:
+    enum {NumVectors=64, NumSamples=100000};
+
+    QTemporaryDir mTempDir;
+    SharedMultiDataVectorCacheT mpCache;
+    QVector<quint64> mStartBytes;
+
+    void createCache(const bool useMemoryMapping, const bool useCompression=false)
+    {
+        mpCache = SharedMultiDataVectorCacheT(new MultiDataVectorCache(mTempDir.path()+"/benchmark.cache"));
+        mpCache->incrementSubscribers();
+        mpCache->setUseMemoryMapping(useMemoryMapping);
+        QVERIFY(mpCache->setUseCompression(useCompression));
+    }
+
+    static double expectedValue(const int vector, const int sample)
+    {
+        return vector*1e6+sample;
+    }
+
+    //! @brief Appends all vectors to the cache, while also peeking in earlier vectors as the log data handler may do
+    void collect()
+    {
+        QVector<double> data(NumSamples);
+        mpCache->beginMultiAppend();
+        for (int v=0; v<NumVectors; ++v)
+        {
+            for (int i=0; i<NumSamples; ++i)
+            {
+                data[i] = expectedValue(v, i);
+            }
+            quint64 startByte, numBytes;
+            QVERIFY(mpCache->addVector(data, startByte, numBytes));
+            mStartBytes.append(startByte);
+
+            double value;
+            QVERIFY(mpCache->peek(mStartBytes.first()+sizeof(double)*(v % NumSamples), value));
+            QCOMPARE(value, expectedValue(0, v % NumSamples));
+        }
+        mpCache->endMultiAppend();
+    }
+
+    static void reportThroughput(const double numBytes, const qint64 nanoseconds)
+    {
+        QTest::setBenchmarkResult(numBytes/(qMax(nanoseconds, qint64(1))*1e-9), QTest::BytesPerSecond);
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(mTempDir.isValid());
+    }
+
+    void cleanup()
+    {
+        if (mpCache)
+        {
+            mpCache->decrementSubscribers();
+            mpCache.clear();
+        }
+        mStartBytes.clear();
+    }
+
+    void benchmarkCollect()
+    {
+        QFETCH(bool, useMemoryMapping);
+        QFETCH(bool, useCompression);
+        createCache(useMemoryMapping, useCompression);
+
+        QElapsedTimer timer;
+        timer.start();
+        collect();
+        reportThroughput(double(NumVectors)*NumSamples*sizeof(double), timer.nsecsElapsed());
+
+        QVector<double> data;
+        QVERIFY(mpCache->copyDataTo(mStartBytes.last(), NumSamples*sizeof(double), data));
+        QCOMPARE(data.last(), expectedValue(NumVectors-1, NumSamples-1));
+    }
+
+    void benchmarkCollect_data()
+    {
+        QTest::addColumn<bool>("useMemoryMapping");
+        QTest::addColumn<bool>("useCompression");
+        QTest::newRow("mmap") << true << false;
+        QTest::newRow("file") << false << false;
+        QTest::newRow("compressed") << false << true;
+    }
+
+    void benchmarkPlot()
+    {
+        QFETCH(bool, useMemoryMapping);
+        QFETCH(bool, useCompression);
+        QFETCH(int, stride);
+        createCache(useMemoryMapping, useCompression);
+        collect();
+
+        // Every stride:th sample is read, which is what plotting a decimated curve does
+        QVector<int> indices;
+        for (int i=0; i<NumSamples; i+=stride)
+        {
+            indices.append(i);
+        }
+
+        QVector<double> data;
+        QElapsedTimer timer;
+        timer.start();
+        for (int v=0; v<NumVectors; ++v)
+        {
+            if (stride == 1)
+            {
+                QVERIFY(mpCache->copyDataTo(mStartBytes[v], NumSamples*sizeof(double), data));
+            }
+            else
+            {
+                QVERIFY(mpCache->copyDataAt(mStartBytes[v], indices, data));
+            }
+        }
+        reportThroughput(double(NumVectors)*indices.size()*sizeof(double), timer.nsecsElapsed());
+
+        QCOMPARE(data.size(), indices.size());
+        QCOMPARE(data.last(), expectedValue(NumVectors-1, indices.last()));
+    }
+
+    void benchmarkPlot_data()
+    {
+        QTest::addColumn<bool>("useMemoryMapping");
+        QTest::addColumn<bool>("useCompression");
+        QTest::addColumn<int>("stride");
+        QTest::newRow("mmap full") << true << false << 1;
+        QTest::newRow("file full") << false << false << 1;
+        QTest::newRow("compressed full") << false << true << 1;
+        QTest::newRow("mmap decimated") << true << false << 100;
+        QTest::newRow("file decimated") << false << false << 100;
+        QTest::newRow("compressed decimated") << false << true << 100;
+    }
+
+    void benchmarkPeek()
+    {
+        QFETCH(bool, useMemoryMapping);
+        QFETCH(bool, useCompression);
+        createCache(useMemoryMapping, useCompression);
+        collect();
+
+        // Random access with a fixed seed so that both rows read the same values
+        qsrand(42);
+        QVector<int> vectors, samples;
+        for (int i=0; i<10000; ++i)
+        {
+            vectors.append(qrand() % NumVectors);
+            samples.append(qrand() % NumSamples);
+        }
+
+        double value=0;
+        QBENCHMARK
+        {
+            for (int i=0; i<vectors.size(); ++i)
+            {
+                mpCache->peek(mStartBytes[vectors[i]]+sizeof(double)*samples[i], value);
+            }
+        }
+        QCOMPARE(value, expectedValue(vectors.last(), samples.last()));
+    }
+
+    void benchmarkPeek_data()
+    {
+        QTest::addColumn<bool>("useMemoryMapping");
+        QTest::addColumn<bool>("useCompression");
+        QTest::newRow("mmap") << true << false;
+        QTest::newRow("file") << false << false;
+        QTest::newRow("compressed") << false << true;
+    }
+
+    void benchmarkPoke()
+    {
+        QFETCH(bool, useMemoryMapping);
+        createCache(useMemoryMapping);
+        collect();
+
+        QBENCHMARK
+        {
+            for (int i=0; i<10000; ++i)
+            {
+                mpCache->poke(mStartBytes[i % NumVectors]+sizeof(double)*((i*7919) % NumSamples), -1.0*i);
+            }
+        }
+        double value;
+        QVERIFY(mpCache->peek(mStartBytes[9999 % NumVectors]+sizeof(double)*((9999*7919) % NumSamples), value));
+        QCOMPARE(value, -9999.0);
+    }
+
+    void benchmarkPoke_data()
+    {
+        QTest::addColumn<bool>("useMemoryMapping");
+        QTest::newRow("mmap") << true;
+        QTest::newRow("file") << false;
+    }
+
+    //! @brief Compares read-only views with checking out (and returning) the vector, for an operation that only reads the data
+    void benchmarkReadOnlyOperation()
+    {
+        QFETCH(bool, useMemoryMapping);
+        QFETCH(bool, useReadOnlyView);
+        createCache(useMemoryMapping);
+        collect();
+
+        double sum=0;
+        QElapsedTimer timer;
+        timer.start();
+        for (int v=0; v<NumVectors; ++v)
+        {
+            const quint64 numBytes = NumSamples*sizeof(double);
+            if (useReadOnlyView)
+            {
+                const double *pData = mpCache->beginReadOnlyView(mStartBytes[v], numBytes);
+                QVERIFY(pData);
+                for (int i=0; i<NumSamples; ++i)
+                {
+                    sum += pData[i];
+                }
+                mpCache->endReadOnlyView(pData);
+            }
+            else
+            {
+                QVector<double> *pData=0;
+                QVERIFY(mpCache->checkoutVector(mStartBytes[v], numBytes, pData));
+                for (int i=0; i<NumSamples; ++i)
+                {
+                    sum += (*pData)[i];
+                }
+                QVERIFY(mpCache->returnVector(pData));
+            }
+        }
+        reportThroughput(double(NumVectors)*NumSamples*sizeof(double), timer.nsecsElapsed());
+
+        double expectedSum=0;
+        for (int v=0; v<NumVectors; ++v)
+        {
+            for (int i=0; i<NumSamples; ++i)
+            {
+                expectedSum += expectedValue(v, i);
+            }
+        }
+        QCOMPARE(sum, expectedSum);
+    }
+
+    void benchmarkReadOnlyOperation_data()
+    {
+        QTest::addColumn<bool>("useMemoryMapping");
+        QTest::addColumn<bool>("useReadOnlyView");
+        QTest::newRow("mmap view") << true << true;
+        QTest::newRow("mmap checkout") << true << false;
+        QTest::newRow("file view") << false << true;
+        QTest::newRow("file checkout") << false << false;
+    }
+
+    //! @brief Checks that smooth simulation-like data compresses well and is restored exactly, also after a poke
+    void compressionRatio()
+    {
+        createCache(false, true);
+
+        // A damped oscillation, similar to a step response logged from a simulation
+        QVector<double> data(NumSamples);
+        for (int i=0; i<NumSamples; ++i)
+        {
+            const double t = i*1e-4;
+            data[i] = 1.0-qExp(-t)*qCos(10.0*t);
+        }
+
+        quint64 startByte, numBytes;
+        QVERIFY(mpCache->addVector(data, startByte, numBytes));
+        QCOMPARE(mpCache->getUncompressedSize(), qint64(NumSamples*sizeof(double)));
+        const double ratio = double(mpCache->getUncompressedSize())/mpCache->getCacheSize();
+        QVERIFY2(ratio > 1.5, qPrintable(QString("Compression ratio %1").arg(ratio)));
+
+        data[NumSamples/2] = 0.5;
+        QVERIFY(mpCache->poke(startByte+sizeof(double)*(NumSamples/2), 0.5));
+
+        QVector<double> restored;
+        QVERIFY(mpCache->copyDataTo(startByte, numBytes, restored));
+        QCOMPARE(restored.size(), data.size());
+        for (int i=0; i<NumSamples; ++i)
+        {
+            QCOMPARE(restored[i], data[i]);
+        }
+    }
+};
@@ -1329,6 +1329,8 @@ void Configuration::registerSettings()
     mBoolSettings.insert(CFG_PLOTGFXKEEPASPECT, true);
     mBoolSettings.insert(CFG_AUTOLIMITGENERATIONS, false);
     mBoolSettings.insert(CFG_CACHELOGDATA, true);
+    mBoolSettings.insert(CFG_COLLECTPLOTTEDLOGDATAFIRST, true);
+    mBoolSettings.insert(CFG_COMPRESSLOGDATA, false);
     mBoolSettings.insert(CFG_SHOWHIDDENNODEDATAVARIABLES, false);
     mBoolSettings.insert(CFG_AUTOBACKUP, true);
     mBoolSettings.insert(CFG_GROUPMESSAGESBYTAG, true);
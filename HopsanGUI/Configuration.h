@@ -58,6 +58,8 @@
 #define CFG_GROUPMESSAGESBYTAG "groupmessagesbytag"
 #define CFG_GENERATIONLIMIT "generationlimit"
 #define CFG_CACHELOGDATA "cachelogdata"
+#define CFG_COLLECTPLOTTEDLOGDATAFIRST "collectplottedlogdatafirst"
+#define CFG_COMPRESSLOGDATA "compresslogdata"
 #define CFG_AUTOBACKUP "autobackup"
 #define CFG_AUTOLIMITGENERATIONS "autolimitgenerations"
 #define CFG_SETPWDTOMWD "setpwdtomwd"
@@ -927,6 +927,36 @@ void CoreSystemAccess::getPlotData(const QString compname, const QString portnam
     }
 }
 
+//! @brief Gives access to the log data of a port without copying it
+//! @details The log data is stored as one row per log sample with one column per node data variable (in node data id order).
+//! The pointers remain valid until the next simulation or until the port is removed.
+//! @param[in] compname The name of the component
+//! @param[in] portname The name of the port
+//! @param[out] rpData Pointer to the log data rows
+//! @param[out] rpTimeVector Pointer to the log time vector used by the port
+//! @param[out] rNumSamples The number of rows that have actually been logged
+//! @returns True if the port exists and has log storage, else false
+bool CoreSystemAccess::getPortLogData(const QString compname, const QString portname, const std::vector< std::vector<double> > *&rpData, std::vector<double> *&rpTimeVector, size_t &rNumSamples)
+{
+    hopsan::Port* pPort = this->getCorePortPtr(compname, portname);
+    if (pPort && pPort->getLogDataVectorPtr() && pPort->getLogTimeVectorPtr())
+    {
+        rpData = pPort->getLogDataVectorPtr();
+        rpTimeVector = pPort->getLogTimeVectorPtr();
+        // Same as in getPlotData, only rows that have actually been written are included
+        if (pPort->getNodePtr())
+        {
+            rNumSamples = qMin(pPort->getNodePtr()->getOwnerSystem()->getNumActuallyLoggedSamples(), rpData->size());
+        }
+        else
+        {
+            rNumSamples = qMin(rpData->size(), rpTimeVector->size());
+        }
+        return true;
+    }
+    return false;
+}
+
 std::vector<double> *CoreSystemAccess::getLogTimeData() const
 {
     return mpCoreComponentSystem->getLogTimeVector();
@@ -379,6 +379,8 @@ OptionsDialog::OptionsDialog(QWidget *parent)
 
     mpAutoLimitGenerationsCheckBox = new QCheckBox("Autoremove last generation when limit is reached");
     mpCacheLogDataCeckBox = new QCheckBox("Cache log data on hard drive");
+    mpCollectPlottedFirstCheckBox = new QCheckBox("Collect plotted variables first, collect the rest in the background");
+    mpCompressLogDataCheckBox = new QCheckBox("Compress cached log data (new generations)");
     mpShowHiddenNodeDataVarCheckBox = new QCheckBox("Show (and collect) hidden node data variables");
     mpPlotWindowsOnTop = new QCheckBox("Show plot windows on top of main window");
 
@@ -413,6 +415,10 @@ OptionsDialog::OptionsDialog(QWidget *parent)
     QGridLayout *pPlottingLayout = new QGridLayout(mpPlottingWidget);
     pPlottingLayout->addWidget(mpCacheLogDataCeckBox,             r, 0, 1, 4);
     ++r;
+    pPlottingLayout->addWidget(mpCompressLogDataCheckBox,         r, 0, 1, 4);
+    ++r;
+    pPlottingLayout->addWidget(mpCollectPlottedFirstCheckBox,     r, 0, 1, 4);
+    ++r;
     pPlottingLayout->addWidget(pCustomTempPathLabel,              r, 0, 1, 4);
     ++r;
     pPlottingLayout->addWidget(mpCustomTempPathLineEdit,          r, 0, 1, 2);
@@ -629,6 +635,8 @@ void OptionsDialog::setValues()
     gpConfig->setIntegerSetting(CFG_GENERATIONLIMIT, mpGenerationLimitSpinBox->value());
     gpConfig->setIntegerSetting(CFG_PLOEXPORTVERSION, mpDefaultPloExportVersion->value());
     gpConfig->setBoolSetting(CFG_CACHELOGDATA, mpCacheLogDataCeckBox->isChecked());
+    gpConfig->setBoolSetting(CFG_COLLECTPLOTTEDLOGDATAFIRST, mpCollectPlottedFirstCheckBox->isChecked());
+    gpConfig->setBoolSetting(CFG_COMPRESSLOGDATA, mpCompressLogDataCheckBox->isChecked());
     gpConfig->setStringSetting(CFG_CUSTOMTEMPPATH, mpCustomTempPathLineEdit->text());
     for(int i=0; i<gpModelHandler->count(); ++i)       //Loop through all containers and reduce their plot data
     {
@@ -739,6 +747,8 @@ void OptionsDialog::show()
     mpShowHiddenNodeDataVarCheckBox->setChecked(gpConfig->getBoolSetting(CFG_SHOWHIDDENNODEDATAVARIABLES));
     mpPlotWindowsOnTop->setChecked(gpConfig->getBoolSetting(CFG_PLOTWINDOWSONTOP));
     mpCacheLogDataCeckBox->setChecked(gpConfig->getBoolSetting(CFG_CACHELOGDATA));
+    mpCollectPlottedFirstCheckBox->setChecked(gpConfig->getBoolSetting(CFG_COLLECTPLOTTEDLOGDATAFIRST));
+    mpCompressLogDataCheckBox->setChecked(gpConfig->getBoolSetting(CFG_COMPRESSLOGDATA));
     mpCustomTempPathLineEdit->setText(gpConfig->getStringSetting(CFG_CUSTOMTEMPPATH));
 
     mpRemoteHopsanAddress->setText(gpConfig->getStringSetting(CFG_REMOTEHOPSANADDRESS));
@@ -111,6 +111,8 @@ private:
     QSpinBox *mpGenerationLimitSpinBox;
     QCheckBox *mpAutoLimitGenerationsCheckBox;
     QCheckBox *mpCacheLogDataCeckBox;
+    QCheckBox *mpCollectPlottedFirstCheckBox;
+    QCheckBox *mpCompressLogDataCheckBox;
     QCheckBox *mpShowHiddenNodeDataVarCheckBox;
     QCheckBox *mpPlotWindowsOnTop;
     QSpinBox *mpDefaultPloExportVersion;
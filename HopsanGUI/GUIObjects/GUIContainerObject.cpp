@@ -44,6 +44,7 @@
 #include <QHeaderView>
 #include <QDialogButtonBox>
 #include <QRadioButton>
+#include <QElapsedTimer>
 #include <cassert>
 
 //Hopsan includes
@@ -4349,7 +4350,7 @@ QDomElement SystemObject::saveGuiDataToDomElement(QDomElement &rDomElement)
     //Save undo stack if setting is activated
     if(mSaveUndoStack)
     {
-        guiStuff.appendChild(mpUndoStack->toXml());
+        mpUndoStack->saveToDomElement(guiStuff);
     }
 
     return guiStuff;
@@ -4598,7 +4599,7 @@ void SystemObject::loadFromDomElement(QDomElement domElement)
         if(!guiStuff.firstChildElement(HMF_UNDO).isNull())
         {
             QDomElement undoElement = guiStuff.firstChildElement(HMF_UNDO);
-            mpUndoStack->fromXml(undoElement);
+            mpUndoStack->loadFromDomElement(undoElement);
             dontClearUndo = true;
             mSaveUndoStack = true;      //Set save undo stack setting to true if loading a hmf file with undo stack saved
         }
@@ -4635,14 +4636,26 @@ void SystemObject::loadFromDomElement(QDomElement domElement)
         // Update system wide model properties
         updateHmfSystemProperties(domElement, hmfFormatVersion, coreHmfVersion);
 
+        // Time each load phase, the times are reported for the top level system (where they include all subsystems)
+        QElapsedTimer phaseTimer;
+        phaseTimer.start();
+        QStringList phaseTimes;
+        auto endLoadPhase = [&phaseTimer, &phaseTimes](const QString &rPhase, const int numObjects) {
+            phaseTimes.append(QString("%1 %2 ms (%3)").arg(rPhase).arg(phaseTimer.restart()).arg(numObjects));
+        };
+
         //1. Load global parameters
+        int numLoaded=0;
         QDomElement xmlParameters = domElement.firstChildElement(HMF_PARAMETERS);
         QDomElement xmlSubObject = xmlParameters.firstChildElement(HMF_PARAMETERTAG);
         while (!xmlSubObject.isNull())
         {
             loadSystemParameter(xmlSubObject, true, hmfFormatVersion, this);
             xmlSubObject = xmlSubObject.nextSiblingElement(HMF_PARAMETERTAG);
+            ++numLoaded;
         }
+        endLoadPhase("parameters", numLoaded);
+        numLoaded=0;
 
         //2. Load all sub-components
         QList<ModelObject*> volunectorObjectPtrs;
@@ -4685,7 +4698,10 @@ void SystemObject::loadFromDomElement(QDomElement domElement)
             }
 
             xmlSubObject = xmlSubObject.nextSiblingElement(HMF_COMPONENTTAG);
+            ++numLoaded;
         }
+        endLoadPhase("components", numLoaded);
+        numLoaded=0;
 
         //3. Load all text box widgets
         xmlSubObject = xmlSubObjects.firstChildElement(HMF_TEXTBOXWIDGETTAG);
@@ -4701,7 +4717,10 @@ void SystemObject::loadFromDomElement(QDomElement domElement)
         {
             loadModelObject(xmlSubObject, this, NoUndo);
             xmlSubObject = xmlSubObject.nextSiblingElement(HMF_SYSTEMTAG);
+            ++numLoaded;
         }
+        endLoadPhase("subsystems", numLoaded);
+        numLoaded=0;
 
         //6. Load all system ports
         xmlSubObject = xmlSubObjects.firstChildElement(HMF_SYSTEMPORTTAG);
@@ -4722,7 +4741,10 @@ void SystemObject::loadFromDomElement(QDomElement domElement)
 //                failedConnections.append(xmlSubObject);
             }
             xmlSubObject = xmlSubObject.nextSiblingElement(HMF_CONNECTORTAG);
+            ++numLoaded;
         }
+        endLoadPhase("connectors", numLoaded);
+        numLoaded=0;
 //        //If some connectors failed to load, it could mean that they were loaded in wrong order.
 //        //Try again until they work, or abort if number of attempts are greater than maximum possible for success.
 //        int stop=failedConnections.size()*(failedConnections.size()+1)/2;
@@ -4843,6 +4865,12 @@ void SystemObject::loadFromDomElement(QDomElement domElement)
 
         emit systemParametersChanged(); // Make sure we refresh the syspar widget
         emit checkMessages();
+
+        if (this->mpParentSystemObject == nullptr)
+        {
+            phaseTimes.append(QString("finalization %1 ms").arg(phaseTimer.elapsed()));
+            gpMessageHandler->addDebugMessage(QString("Load phases for %1: %2").arg(getName()).arg(phaseTimes.join(", ")));
+        }
     }
     else
     {
@@ -374,7 +374,8 @@ void ModelObject::setIcon(GraphicsTypeEnumT gfxType)
             disconnect(this->getParentSystemObject()->mpModelWidget->getGraphicsView(), SIGNAL(zoomChange(double)), this, SLOT(setIconZoom(double)));
         }
 
-        mpIcon = new QGraphicsSvgItem(iconPath, this);
+        mpIcon = new QGraphicsSvgItem(this);
+        mpIcon->setSharedRenderer(getSharedSvgRenderer(iconPath));
         mpIcon->setFlags(QGraphicsItem::ItemStacksBehindParent);
         mpIcon->setScale(iconScale);
 
@@ -474,7 +474,8 @@ void Port::refreshPortMainGraphics()
         }
 
         prepareGeometryChange();
-        mpMainIcon = new QGraphicsSvgItem(mpPortAppearance->mMainIconPath, this);
+        mpMainIcon = new QGraphicsSvgItem(this);
+        mpMainIcon->setSharedRenderer(getSharedSvgRenderer(mpPortAppearance->mMainIconPath));
         resize(mpMainIcon->boundingRect().width(), mpMainIcon->boundingRect().height());
         //qDebug() << "_______diff: " << -mpMainIcon->boundingRect().center();
         setTransform(QTransform::fromTranslate(-mpMainIcon->boundingRect().center().x(), -mpMainIcon->boundingRect().center().y()), true);
@@ -505,7 +506,8 @@ void Port::refreshPortOverlayGraphics()
         else
         {
             //! @todo check if file exist
-            mpCQSIconOverlay = new QGraphicsSvgItem(mpPortAppearance->mCQSOverlayPath, this);
+            mpCQSIconOverlay = new QGraphicsSvgItem(this);
+            mpCQSIconOverlay->setSharedRenderer(getSharedSvgRenderer(mpPortAppearance->mCQSOverlayPath));
             mpCQSIconOverlay->setZValue(CQSOverlayZValue);
             mpCQSIconOverlay->setFlag(QGraphicsItem::ItemIgnoresTransformations, true);
         }
@@ -526,7 +528,8 @@ void Port::refreshPortOverlayGraphics()
         else
         {
             //! @todo check if file exist
-            mpMultiPortIconOverlay = new QGraphicsSvgItem(mpPortAppearance->mMultiPortOverlayPath, this);
+            mpMultiPortIconOverlay = new QGraphicsSvgItem(this);
+            mpMultiPortIconOverlay->setSharedRenderer(getSharedSvgRenderer(mpPortAppearance->mMultiPortOverlayPath));
             mpMultiPortIconOverlay->setFlag(QGraphicsItem::ItemIgnoresTransformations, true);
             mpMultiPortIconOverlay->setZValue(MultiportOverlayZValue);
         }
@@ -34,6 +34,7 @@
 #include <QDesktopServices>
 #include <QApplication>
 #include <QPair>
+#include <QVarLengthArray>
 
 //HopsanGUI includes
 #include "common.h"
@@ -62,6 +63,7 @@
 #include "Widgets/ModelWidget.h"
 #include "SymHop.h"
 #include "CoreUtilities/SimulationHandler.h"
+#include "ComponentUtilities/SignalStatistics.h"
 #include "LogDataGeneration.h"
 #ifndef _WIN32
 #include <unistd.h>
@@ -172,28 +174,11 @@ int getNumberOfCommandArguments(const QString &rArgs)
     return splitCommandArguments(rArgs).size();
 }
 
-//! @brief Extract everything between the first ( and last )
-QStringList extractFunctionCallExpressionArguments(const QString& functionCallExpression)
+//! @brief Tells if a command may add or remove parameters, log variables or models, compiled scripts must then resolve names again
+bool mayChangeNameResolution(const QString &rCommand)
 {
-    QStringList args;
-    int s = functionCallExpression.indexOf('(');
-    if (s>=0)
-    {
-        int e = functionCallExpression.lastIndexOf(')');
-        if (e>=0)
-        {
-            QString argString = functionCallExpression.mid(s+1, e-s-1);
-            splitRespectingQuotationsAndParanthesis(argString, ',', args);
-        }
-    }
-
-    // Remove unnecessary leading and trailing spaces for each arg
-    for(int i=0; i<args.size(); ++i)
-    {
-        args[i] = args[i].trimmed();
-    }
-
-    return args;
+    static const QStringList readOnlyCommands = QStringList() << "call" << "print" << "echo" << "disp" << "help" << "info" << "sleep" << "peek" << "pwd" << "ls";
+    return !readOnlyCommands.contains(rCommand);
 }
 
 //! @brief Get value of flag:value argument, from a previously split argument string
@@ -349,6 +334,7 @@ HcomHandler::HcomHandler(TerminalConsole *pConsole) : QObject(pConsole)
     mAnsType = Undefined;
     mAborted = false;
     mRetvalType = Scalar;
+    mNameResolutionRevision = 0;
 
     mpConsole = pConsole;
 
@@ -367,7 +353,8 @@ HcomHandler::HcomHandler(TerminalConsole *pConsole) : QObject(pConsole)
     registerInternalFunction("esd", "Generates energy spectral density from vector","Usage: esd(vector, [timevector], [windowing]([rectangular]/flattop/hann), [mintime], [maxtime])\n");
     registerInternalFunction("psd", "Generates power spectral density from vector","Usage: psd(vector, [timevector], [windowing]([rectangular]/flattop/hann), [mintime], [maxtime])\n");
     registerInternalFunction("rmsd", "Generates root mean square spectral density from vector","Usage: rmsd(vector, [timevector], [windowing]([rectangular]/flattop/hann), [mintime], [maxtime])\n");
-    registerInternalFunction("rms", "Computes the root mean square of given vector","Usage: rms(vector)");
+    registerInternalFunction("rms", "Computes the root mean square of given vector","Usage: rms(vector)\nUsage: rms(vector, mintime, maxtime)");
+    registerInternalFunction("integral", "Computes the integral of given vector with respect to time (trapezoidal rule)","Usage: integral(vector)\nUsage: integral(vector, mintime, maxtime)");
     registerInternalFunction("gt", "Index-wise greater than check between vectors and/or scalars (equivalent to \">\" operator)","Usage: gt(varName, threshold)\nUsage: gt(var1, var2)");
     registerInternalFunction("lt", "Index-wise less than check between vectors and/or scalars  (equivalent to \"<\" operator)","Usage: lt(varName, threshold)\nUsage: lt(var1,var2)");
     registerInternalFunction("eq", "Index-wise fuzzy equal check between vectors and/or scalars  (equivalent to \"==\" operator)","Usage: eq(varName, threshold, eps)\nUsage: eq(var1, var2, eps)");
@@ -405,7 +392,7 @@ HcomHandler::HcomHandler(TerminalConsole *pConsole) : QObject(pConsole)
     registerInternalFunction("ssi", "Identifies steady-state for specified variable", "Usage: ssi(vector, method, arguments)\n       Method 0 (rectangular window):\n         ssi(vector, 0, tolerance, windowlength)\n       Method 1 (ratio of differently estimated variances):\n         ssi(vector, 1, tolerance, windowlength, noiseamplitude\n       Method 2 (ratio of differently estimated variances using weighted moving average):\n         ssi(vector, 2, tolerance, lambda1, lambda2, lambda3, noiseamplitude)");
 
     //Setup local function pointers (used to evaluate expressions in SymHop)
-    registerFunctionoid("aver", new HcomFunctionoidAver(this), "Calculate average value of vector", "Usage: aver(vector)");
+    registerFunctionoid("aver", new HcomFunctionoidAver(this), "Calculate average value of vector", "Usage: aver(vector)\nUsage: aver(vector, mintime, maxtime)");
     registerFunctionoid("min", new HcomFunctionoidMin(this), "Calculate minimum value of vector", "Usage: min(vector)");
     registerFunctionoid("max", new HcomFunctionoidMax(this), "Calculate maximum value of vector","Usage:max(vector)");
     registerFunctionoid("imin", new HcomFunctionoidIMin(this), "Calculate index of minimum value of vector","Usage: imin(vector)");
@@ -441,6 +428,7 @@ HcomHandler::~HcomHandler()
 void HcomHandler::setModelPtr(ModelWidget *pModel)
 {
     mpModel = pModel;
+    ++mNameResolutionRevision;
 
     updatePwd();
 }
@@ -1407,6 +1395,12 @@ void HcomHandler::executeCommand(QString cmd)
     cmd = cmd.section("#",0,0);
     if(cmd.isEmpty()) return;
 
+    //Variables from the last simulation may still be collected in the background
+    if(mpModel)
+    {
+        mpModel->getLogDataHandler()->finishCollectingLogData();
+    }
+
     //Allow several commands on one line, separated by semicolon
     if(cmd.contains(";"))
     {
@@ -1454,6 +1448,10 @@ void HcomHandler::executeCommand(QString cmd)
     {
         //TicToc timer;
         mCmdList[idx].runCommand(subCmd, this);
+        if(mayChangeNameResolution(majorCmd))
+        {
+            ++mNameResolutionRevision;
+        }
         //timer.toc("runCommand "+QString("(%1)  %2").arg(majorCmd).arg(subCmd));
     }
 }
@@ -6632,29 +6630,10 @@ void HcomHandler::evaluateExpression(QString expr, VariableType desiredType)
         mAnsVector = pVar->toFrequencySpectrum(pTimeVar, type, windowingFunction, minTime, maxTime);
         return;
     }
-    else if(isHcomFunctionCall("rms", expr))
+    else if(isHcomFunctionCall("rms", expr) || isHcomFunctionCall("integral", expr))
     {
-        QStringList splitArgs = extractFunctionCallExpressionArguments(expr);
-        if(splitArgs.size() != 1) {
-            HCOMERR("Wrong number of arguments provided for rms function.\n"+mLocalFunctionDescriptions.find("rms").value().second);
-            mAnsType = Undefined;
-            return;
-        }
-        mAnsType = Scalar;
-        const QString varName = splitArgs[0].trimmed();
-        evaluateExpression(varName, DataVector);
-        SharedVectorVariableT pVar = mAnsVector;
-        if (mAnsType == DataVector) {
-            mAnsType = Scalar;
-            mAnsScalar = pVar->rmsOfData();
-            return;
-        }
-        else
-        {
-            HCOMERR(QString("Variable: %1 was not found!").arg(varName));
-            mAnsType = Undefined;
-            return;
-        }
+        executeStatisticsBuiltInFunction(expr);
+        return;
     }
     //else if(desiredType != Scalar && (expr.startsWith("greaterThan(") || expr.startsWith("gt(")) && expr.endsWith(")"))
     else if(desiredType != Scalar && (isHcomFunctionCall("greaterThan", expr) || isHcomFunctionCall("gt", expr)) )
@@ -7473,6 +7452,12 @@ void HcomHandler::evaluateExpression(QString expr, VariableType desiredType)
         return;
     }
 
+    //Arithmetic with data vectors, evaluated in one pass without temporary variables for intermediate results
+    if(desiredType != Scalar && pLogDataHandler && evaluateFusedVectorExpression(symHopExpr, expr, desiredType))
+    {
+        return;
+    }
+
     //Multiplication between data vector and scalar
     //timer.tic();
     //! @todo this code does pointer lookup, then does it again, and then get names to use string versions of logdatahandler functions, it could lookup once and then use the pointer versions instead
@@ -7709,6 +7694,154 @@ void HcomHandler::evaluateExpression(QString expr, VariableType desiredType)
     return;
 }
 
+//! @brief Collects the operands in an arithmetic expression that must be evaluated by HCOM
+//! @details Numbers and functions known by SymHop are part of the arithmetic, everything else (variables, HCOM functions) is an operand
+static void collectFusedOperands(const SymHop::Expression &rExpr, QList<SymHop::Expression> &rOperands)
+{
+    static const QStringList symHopFunctions = SymHop::getSupportedFunctionsList();
+    if(rExpr.isAdd())
+    {
+        for(const SymHop::Expression &term : rExpr.getTerms())
+        {
+            collectFusedOperands(term, rOperands);
+        }
+    }
+    else if(rExpr.isMultiplyOrDivide())
+    {
+        for(const SymHop::Expression &factor : rExpr.getFactors())
+        {
+            collectFusedOperands(factor, rOperands);
+        }
+        for(const SymHop::Expression &divisor : rExpr.getDivisors())
+        {
+            collectFusedOperands(divisor, rOperands);
+        }
+    }
+    else if(rExpr.isPower())
+    {
+        collectFusedOperands(*rExpr.getBase(), rOperands);
+        collectFusedOperands(*rExpr.getPower(), rOperands);
+    }
+    else if(rExpr.isFunction() && symHopFunctions.contains(rExpr.getFunctionName()))
+    {
+        for(const SymHop::Expression &argument : rExpr.getArguments())
+        {
+            collectFusedOperands(argument, rOperands);
+        }
+    }
+    else if(!rExpr.isNumericalSymbol() && !rOperands.contains(rExpr))
+    {
+        rOperands.append(rExpr);
+    }
+}
+
+//! @brief Evaluates an arithmetic expression with data vector operands in one fused pass over the data
+//! @details Each operand is evaluated once, then the expression is compiled and evaluated element-wise (in chunks and
+//! possibly multithreaded), so only the final result variable is created. Nothing is evaluated unless some operand is,
+//! or may evaluate to, a data vector. Scalar operands are bound to the compiled expression by value. If the evaluated
+//! operands all turned out to be scalars, the scalar result is computed from them, so they are not evaluated again.
+//! @param[in] rExpr The expression to evaluate
+//! @param[in] rName The name of the resulting variable
+//! @param[in] desiredType The desired result type, a scalar result is only given if this is Undefined
+//! @returns True if the result was stored in mAnsVector (or mAnsScalar), false if the expression must be evaluated one operation at a time
+bool HcomHandler::evaluateFusedVectorExpression(const SymHop::Expression &rExpr, const QString &rName, const VariableType desiredType)
+{
+    if(!mpModel || !mpModel->getViewContainerObject())
+    {
+        return false;
+    }
+    LogDataHandler2 *pLogDataHandler = mpModel->getViewContainerObject()->getLogDataHandler().data();
+
+    QList<SymHop::Expression> operands;
+    collectFusedOperands(rExpr, operands);
+    if(operands.contains(rExpr))
+    {
+        // Nothing to fuse, the expression is a single operand
+        return false;
+    }
+
+    // Look up local variables and data variables first, other operands must be evaluated
+    QStringList vectorNames;
+    QVector<SharedVectorVariableT> vectors;
+    QMap<QString, double> scalars;
+    QList<SymHop::Expression> unevaluatedOperands;
+    bool mayHaveVectors = false;
+    for(const SymHop::Expression &operand : operands)
+    {
+        const QString name = operand.toString();
+        LocalVarsMapT::iterator it = mLocalVars.find(name);
+        if(it != mLocalVars.end())
+        {
+            scalars.insert(name, it.value());
+            continue;
+        }
+
+        SharedVectorVariableT pVector = getLogVariable(name);
+        if(pVector)
+        {
+            vectorNames.append(name);
+            vectors.append(pVector);
+        }
+        else
+        {
+            // Only function calls can evaluate to data vectors, plain names are parameters
+            mayHaveVectors = mayHaveVectors || operand.isFunction();
+            unevaluatedOperands.append(operand);
+        }
+    }
+    if(vectors.isEmpty() && !mayHaveVectors)
+    {
+        return false;
+    }
+
+    for(const SymHop::Expression &operand : unevaluatedOperands)
+    {
+        const QString name = operand.toString();
+        evaluateExpression(name);
+        if(mAnsType == DataVector)
+        {
+            vectorNames.append(name);
+            vectors.append(mAnsVector);
+        }
+        else if(mAnsType == Scalar)
+        {
+            scalars.insert(name, mAnsScalar);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    SymHop::EvaluationTape tape;
+    if(!tape.compile(rExpr, vectorNames, scalars))
+    {
+        return false;
+    }
+
+    if(vectors.isEmpty())
+    {
+        // Only scalar operands, same as evaluating the expression with the operand values
+        if(desiredType != Undefined)
+        {
+            return false;
+        }
+        mAnsType = Scalar;
+        mAnsScalar = tape.evaluate(nullptr);
+        return true;
+    }
+
+    const int numThreads = getConfigPtr()->getBoolSetting(CFG_MULTICORE) ? getConfigPtr()->getIntegerSetting(CFG_NUMBEROFTHREADS) : 1;
+    SharedVectorVariableT pResult = pLogDataHandler->evaluateVariableExpression(tape, vectors, rName, numThreads);
+    if(!pResult)
+    {
+        return false;
+    }
+    mAnsType = DataVector;
+    mAnsVector = pResult;
+    return true;
+}
+
 //! @brief Evaluate an expressions when the expected result is a scalar, the expression may in turn contain expressions
 double HcomHandler::evaluateScalarExpression(QString expr, bool &rIsOK)
 {
@@ -7782,107 +7915,115 @@ bool HcomHandler::containsOutsideParentheses(QString str, QString c)
 }
 
 
+//! @brief Runs script lines
+//! @details The lines are compiled the first time they are run, loops and functions are then executed from the compiled script
+//! @param[in,out] lines The script lines, they are trimmed
+//! @param[out] pAbort Set to true if the script was aborted
+//! @returns A goto label if the script jumps to a label, "%%%%%EOF" if it was stopped, otherwise empty
 QString HcomHandler::runScriptCommands(QStringList &lines, bool *pAbort)
 {
     mAborted = false; //Reset if pushed when script didn't run
 
-    for(int l=0; l<lines.size(); ++l)
+    // Remove indentation and trailing spaces, callers look for goto labels in the trimmed lines
+    for(QString &rLine : lines)
+    {
+        rLine = rLine.trimmed();
+    }
+
+    return runCompiledScript(*getCompiledScript(lines), pAbort);
+}
+
+
+//! @brief Returns the compiled version of script lines, they are only compiled the first time
+SharedHcomScriptBlockT HcomHandler::getCompiledScript(const QStringList &rLines)
+{
+    const QString key = rLines.join("\n");
+    SharedHcomScriptBlockT pScript = mCompiledScripts.value(key);
+    if(!pScript)
+    {
+        // Foreach bodies are compiled once per variable, so do not let the cache grow forever
+        if(mCompiledScripts.size() >= 256)
+        {
+            mCompiledScripts.clear();
+        }
+
+        QStringList commandNames;
+        for(const HcomCommand &rCommand : mCmdList)
+        {
+            commandNames.append(rCommand.cmd);
+        }
+        pScript = compileHcomScript(rLines, commandNames);
+        mCompiledScripts.insert(key, pScript);
+    }
+    return pScript;
+}
+
+
+//! @brief Executes a compiled script
+//! @param[in] rScript The compiled script
+//! @param[out] pAbort Set to true if the script was aborted
+//! @returns A goto label if the script jumps to a label, "%%%%%EOF" if it was stopped, otherwise empty
+QString HcomHandler::runCompiledScript(const HcomScriptBlock &rScript, bool *pAbort)
+{
+    for(const HcomScriptNode &rNode : rScript)
     {
         qApp->processEvents();
         if(mAborted)
         {
             HCOMPRINT("Script aborted.");
-            //mAborted = false;
             *pAbort=true;
             return "";
         }
 
-        // Remove indentation and trailing spaces
-        lines[l] = lines[l].trimmed();
-
-        // Check how each line starts call appropriate commands
-        if(lines[l].isEmpty() || lines[l].startsWith("#") || lines[l].startsWith("&"))
-        {
-            // Ignore blank lines comments and labels
-            continue;
-        }
-        else if(lines[l].startsWith("stop"))
+        switch(rNode.mType)
         {
+        case HcomScriptNode::StopNode:
             return "%%%%%EOF";
-        }
-        else if(lines[l].startsWith("define "))
+        case HcomScriptNode::GotoNode:
+            return rNode.mText;
+        case HcomScriptNode::ErrorNode:
+            HCOMERR(rNode.mText);
+            return QString();
+        case HcomScriptNode::DefineNode:
+            mFunctions.insert(rNode.mText, rNode.mLines);
+            HCOMPRINT("Defined function: "+rNode.mText);
+            break;
+        case HcomScriptNode::WhileNode:
         {
-            QString funcName = lines[l].section(" ",1).trimmed();
-            QStringList funcCommands;
-            while(!lines[l].trimmed().startsWith("enddefine"))
+            const HcomScriptExpression &rCondition = rNode.mConditions.first();
+            while(true)
             {
-                ++l;
-                if(l>=lines.size())
+                double value;
+                if(!evaluateCompiledExpression(rCondition, value))
                 {
-                    HCOMERR("Missing  enddefine  to end function definition.");
-                    return QString();
+                    // Evaluate condition using SymHop, with local variables and parameters
+                    QMap<QString, double> localVars = mLocalVars;
+                    QStringList localPars;
+                    getParameters("*", localPars);
+                    for(int p=0; p<localPars.size(); ++p)
+                    {
+                        localVars.insert(localPars[p],getParameterValue(localPars[p]).toDouble());
+                    }
+                    bool ok = true;
+                    value = rCondition.mExpression.evaluate(localVars, &mLocalFunctionoidPtrs, &ok);
+                    if(!ok)
+                    {
+                        break;
+                    }
                 }
-                funcCommands << lines[l];
-            }
-            funcCommands.removeLast();
-            mFunctions.insert(funcName, funcCommands);
-            HCOMPRINT("Defined function: "+funcName);
-        }
-        else if(lines[l].startsWith("goto"))
-        {
-            QString argument = lines[l].section(" ",1);
-            return argument;
-        }
-        else if(lines[l].startsWith("while"))        //Handle while loops
-        {
-            QStringList args = extractFunctionCallExpressionArguments(lines[l]);
-            if (args.size() != 1)
-            {
-                HCOMERR("While requires one condition expression");
-                return "";
-            }
-            QString condition = args.front();
-            QStringList loop;
-            int nLoops=1;
-            while(nLoops > 0)
-            {
-                ++l;
-                if(l>=lines.size())
+                if(value <= 0)
                 {
-                    HCOMERR("Missing  repeat  to end while loop.");
-                    return QString();
+                    break;
                 }
-                lines[l] = lines[l].trimmed();
-
-                if(lines[l].startsWith("while")) { ++nLoops; }
-                if(lines[l].startsWith("repeat")) { --nLoops; }
 
-                loop.append(lines[l]);
-            }
-            loop.removeLast();
-
-            // Evaluate condition using SymHop
-            SymHop::Expression symHopExpr = SymHop::Expression(condition);
-            QMap<QString, double> localVars = mLocalVars;
-            QStringList localPars;
-            getParameters("*", localPars);
-            for(int p=0; p<localPars.size(); ++p)
-            {
-                localVars.insert(localPars[p],getParameterValue(localPars[p]).toDouble());
-            }
-
-            bool ok = true;
-            while(symHopExpr.evaluate(localVars, &mLocalFunctionoidPtrs, &ok) > 0 && ok)
-            {
                 qApp->processEvents();
                 if(mAborted)
                 {
                     HCOMPRINT("Script aborted.");
-                    //mAborted = false;
                     *pAbort=true;
                     return "";
                 }
-                QString gotoLabel = runScriptCommands(loop, pAbort);
+                QString gotoLabel = runCompiledScript(*rNode.mBlocks.first(), pAbort);
                 if(*pAbort)
                 {
                     return "";
@@ -7891,139 +8032,47 @@ QString HcomHandler::runScriptCommands(QStringList &lines, bool *pAbort)
                 {
                     return gotoLabel;
                 }
-
-                // Update local variables for SymHop in case they have changed
-                localVars = mLocalVars;
-                QStringList localPars;
-                getParameters("*", localPars);
-                for(int p=0; p<localPars.size(); ++p)
-                {
-                    localVars.insert(localPars[p],getParameterValue(localPars[p]).toDouble());
-                }
             }
+            break;
         }
-        else if(lines[l].startsWith("if"))        //Handle if statements
+        case HcomScriptNode::IfNode:
         {
-            QStringList args = extractFunctionCallExpressionArguments(lines[l]);
-            if (args.size() != 1)
-            {
-                HCOMERR("If requires one condition expression");
-                return "";
-            }
-            QList<QString> conditions;
-            conditions.append(args.front());
-            QList<QStringList> ifCodes;
-            ifCodes.append(QStringList());
-            QStringList elseCode;
-            bool inElse=false;
-            int depth=1;
-            while(true)
+            // The last block is the else block (it may be empty)
+            int block = rNode.mConditions.size();
+            for(int i=0; i<rNode.mConditions.size(); ++i)
             {
-                ++l;
-                if(l>=lines.size())
+                double value;
+                if(!evaluateCompiledExpression(rNode.mConditions[i], value))
                 {
-                    HCOMERR("Missing  endif  in if-statement.");
-                    return QString();
-                }
-                lines[l] = lines[l].trimmed();
-                if(lines[l].startsWith("if")) {
-                    ++depth;
-                }
-                else if(lines[l] == "endif")
-                {
-                    if(depth > 1) {
-                        --depth;
-                    }
-                    else {
-                        break;
-                    }
-                }
-                else if(lines[l].startsWith("elseif") && depth == 1) {
-                    QStringList args = extractFunctionCallExpressionArguments(lines[l]);
-                    if (args.size() != 1)
+                    evaluateExpression(rNode.mConditions[i].mText, Scalar);
+                    if(mAnsType != Scalar)
                     {
-                        HCOMERR("If requires one condition expression");
-                        return "";
+                        HCOMERR("Evaluation of if-statement argument failed.");
+                        return QString();
                     }
-                    conditions.append(args.front());
-                    ifCodes.append(QStringList());
-                    continue;
-                }
-                else if(lines[l] == "else" && depth == 1)
-                {
-                    inElse=true;
-                    continue;
-                }
-                if(!inElse)
-                {
-                    ifCodes.last().append(lines[l]);
-                }
-                else
-                {
-                    elseCode.append(lines[l]);
+                    value = mAnsScalar;
                 }
-            }
-
-            bool oneConditionWasTrue = false;
-            for(int i=0; i<conditions.size(); ++i) {
-                evaluateExpression(conditions[i], Scalar);
-                if(mAnsType != Scalar)
+                if(value > 0)
                 {
-                    HCOMERR("Evaluation of if-statement argument failed.");
-                    return QString();
-                }
-                if(mAnsScalar > 0)
-                {
-                    oneConditionWasTrue = true;
-                    QString gotoLabel = runScriptCommands(ifCodes[i], pAbort);
-                    if(*pAbort)
-                    {
-                        return "";
-                    }
-                    if(!gotoLabel.isEmpty())
-                    {
-                        return gotoLabel;
-                    }
+                    block = i;
                     break;
                 }
             }
-            if(!oneConditionWasTrue)
+            QString gotoLabel = runCompiledScript(*rNode.mBlocks[block], pAbort);
+            if(*pAbort)
             {
-                if(!elseCode.isEmpty()) {
-                    QString gotoLabel = runScriptCommands(elseCode, pAbort);
-                    if(*pAbort)
-                    {
-                        return QString();
-                    }
-                    if(!gotoLabel.isEmpty())
-                    {
-                        return gotoLabel;
-                    }
-                }
-                else {
-                    continue;
-                }
+                return "";
             }
+            if(!gotoLabel.isEmpty())
+            {
+                return gotoLabel;
+            }
+            break;
         }
-        else if(lines[l].startsWith("foreach"))        //Handle foreach loops
+        case HcomScriptNode::ForeachNode:
         {
-            QString var = lines[l].section(" ",1,1);
-            QString filter = lines[l].section(" ",2,2);
             QStringList vars;
-            getMatchingLogVariableNames(filter, vars);
-            QStringList loop;
-            while(!lines[l].trimmed().startsWith("endforeach"))
-            {
-                ++l;
-                if(l>=lines.size())
-                {
-                    HCOMERR("Missing  endforeach  in foreach-statement.");
-                    return QString();
-                }
-                loop.append(lines[l]);
-            }
-            loop.removeLast();
-
+            getMatchingLogVariableNames(rNode.mFilter, vars);
             for(int v=0; v<vars.size(); ++v)
             {
                 //Append quotations around spaces
@@ -8043,13 +8092,13 @@ QString HcomHandler::runScriptCommands(QStringList &lines, bool *pAbort)
 
                 //Execute command
                 QStringList tempCmds;
-                for(int l=0; l<loop.size(); ++l)
+                for(int l=0; l<rNode.mLines.size(); ++l)
                 {
-                    QString tempCmd = loop[l];
-                    tempCmd.replace("$"+var, vars[v]);
+                    QString tempCmd = rNode.mLines[l];
+                    tempCmd.replace("$"+rNode.mText, vars[v]);
                     tempCmds.append(tempCmd);
                 }
-                QString gotoLabel = runScriptCommands(tempCmds, pAbort);
+                QString gotoLabel = runCompiledScript(*getCompiledScript(tempCmds), pAbort);
                 if(*pAbort)
                 {
                     return "";
@@ -8059,16 +8108,120 @@ QString HcomHandler::runScriptCommands(QStringList &lines, bool *pAbort)
                     return gotoLabel;
                 }
             }
+            break;
         }
-        else
-        {
-            this->executeCommand(lines[l]);
+        case HcomScriptNode::CommandNode:
+            for(const HcomScriptCommand &rCommand : rNode.mCommands)
+            {
+                executeScriptCommand(rCommand);
+            }
+            break;
         }
     }
     return QString();
 }
 
 
+//! @brief Executes a command in a compiled script, the equivalent of executeCommand()
+void HcomHandler::executeScriptCommand(const HcomScriptCommand &rCommand)
+{
+    if(rCommand.mCommandIndex >= 0)
+    {
+        HcomCommand &rHcomCommand = mCmdList[rCommand.mCommandIndex];
+        rHcomCommand.runCommand(rCommand.mSubCommand, this);
+        if(mayChangeNameResolution(rHcomCommand.cmd))
+        {
+            ++mNameResolutionRevision;
+        }
+    }
+    else if(!rCommand.mIsLocalAssignment || !executeCompiledLocalAssignment(rCommand))
+    {
+        if(!evaluateArithmeticExpression(rCommand.mCommand))
+        {
+            HCOMERR("Unknown command or failed to evaluate: " + rCommand.mCommand);
+        }
+        // Assignments of data vectors may create new log variables
+        if(mAnsType != Scalar)
+        {
+            ++mNameResolutionRevision;
+        }
+    }
+}
+
+
+//! @brief Assigns a local scalar variable from a compiled expression
+//! @returns True if successful, false if the assignment must be evaluated the ordinary way (by evaluateArithmeticExpression())
+bool HcomHandler::executeCompiledLocalAssignment(const HcomScriptCommand &rCommand)
+{
+    if(rCommand.mResolvedRevision != mNameResolutionRevision)
+    {
+        // Assigning a name that is also a parameter changes the parameter, and log variables can not be assigned a scalar
+        QStringList pars;
+        getParameters(rCommand.mAssignedName, pars);
+        rCommand.mAssignsLocalVariable = pars.isEmpty() && !getLogVariable(rCommand.mAssignedName);
+        rCommand.mResolvedRevision = mNameResolutionRevision;
+    }
+
+    double value;
+    if(!rCommand.mAssignsLocalVariable || !evaluateCompiledExpression(rCommand.mValue, value))
+    {
+        return false;
+    }
+    mAnsType = Scalar;
+    mAnsScalar = value;
+    mLocalVars.insert(rCommand.mAssignedName, value);
+    HCOMPRINT("Assigning scalar "+rCommand.mAssignedName+" with "+QString::number(value));
+    return true;
+}
+
+
+//! @brief Evaluates a compiled expression directly from the values of local variables
+//! @param[in] rExpression The compiled expression
+//! @param[out] rValue The value of the expression
+//! @returns True if successful, false if the expression must be evaluated the ordinary way (it uses parameters, log data or HCOM functions)
+bool HcomHandler::evaluateCompiledExpression(const HcomScriptExpression &rExpression, double &rValue)
+{
+    if(!rExpression.isCompiled())
+    {
+        return false;
+    }
+
+    if(rExpression.mResolvedRevision != mNameResolutionRevision)
+    {
+        // Parameters take precedence over local variables with the same name
+        rExpression.mVariablesAreLocal = true;
+        for(const QString &rName : rExpression.mVariableNames)
+        {
+            QStringList pars;
+            getParameters(rName, pars);
+            if(!pars.isEmpty())
+            {
+                rExpression.mVariablesAreLocal = false;
+                break;
+            }
+        }
+        rExpression.mResolvedRevision = mNameResolutionRevision;
+    }
+    if(!rExpression.mVariablesAreLocal)
+    {
+        return false;
+    }
+
+    QVarLengthArray<double, 16> values(rExpression.mVariableNames.size());
+    for(int v=0; v<rExpression.mVariableNames.size(); ++v)
+    {
+        LocalVarsMapT::const_iterator it = mLocalVars.constFind(rExpression.mVariableNames[v]);
+        if(it == mLocalVars.constEnd())
+        {
+            return false;
+        }
+        values[v] = it.value();
+    }
+    rValue = rExpression.mTape.evaluate(values.constData());
+    return true;
+}
+
+
 //! @brief Help function that returns a list of components depending on input (with support for asterisks)
 //! @param[in] rStr Component name to look for
 //! @param[out] rComponents Reference to list of found components
@@ -9362,6 +9515,61 @@ void HcomHandler::executeSsiBuiltInFunction(QString functionCall)
 
 
 
+//! @brief Execute the "rms" and "integral" built in functions, optionally over a time range
+//! @param functionCall The function call expression
+void HcomHandler::executeStatisticsBuiltInFunction(QString functionCall)
+{
+    const QString funcName = functionCall.left(functionCall.indexOf("(")).trimmed();
+    QStringList args = extractFunctionCallExpressionArguments(functionCall);
+    if(args.size() != 1 && args.size() != 3) {
+        HCOMERR(QString("Wrong number of arguments provided for %1 function.\n").arg(funcName)+mLocalFunctionDescriptions.find(funcName).value().second);
+        mAnsType = Undefined;
+        return;
+    }
+
+    const QString varName = args[0].trimmed();
+    evaluateExpression(varName, DataVector);
+    if(mAnsType != DataVector) {
+        HCOMERR(QString("Variable: %1 was not found!").arg(varName));
+        mAnsType = Undefined;
+        return;
+    }
+    SharedVectorVariableT pVar = mAnsVector;
+
+    double minTime=-std::numeric_limits<double>::max();
+    double maxTime=std::numeric_limits<double>::max();
+    if(args.size() == 3) {
+        bool ok;
+        minTime = getNumber(args[1], &ok);
+        if(!ok) {
+            HCOMERR("Unknown minimum time limit: "+args[1]);
+            mAnsType = Undefined;
+            return;
+        }
+        maxTime = getNumber(args[2], &ok);
+        if(!ok) {
+            HCOMERR("Unknown maximum time limit: "+args[2]);
+            mAnsType = Undefined;
+            return;
+        }
+    }
+
+    hopsan::SignalStatistics statistics;
+    mAnsType = Scalar;
+    if(!pVar->statisticsOfData(minTime, maxTime, statistics)) {
+        // An empty vector has always given zero, but an empty time range is most likely a mistake
+        if(args.size() == 3) {
+            HCOMERR(QString("No samples of %1 in the time range").arg(varName));
+            mAnsType = Undefined;
+        }
+        mAnsScalar = 0;
+        return;
+    }
+    mAnsScalar = (funcName == "integral") ? statistics.integral : statistics.rms;
+}
+
+
+
 //! @brief Returns data pointers for the variable with given full short name format (may include generation)
 //! @param fullShortName Full concatenated name of the variable, (short name format expected)
 //! @returns Pointers to the data variable and container
@@ -9587,6 +9795,37 @@ void HcomHandler::registerFunctionoid(const QString &funcName, SymHopFunctionoid
 //! @brief Function operator for the "aver" functionoid
 double HcomFunctionoidAver::operator()(QString &str, bool &ok)
 {
+    QStringList splitStr;
+    splitRespectingQuotationsAndParanthesis(str, ',', splitStr);
+    if(splitStr.size() == 3)
+    {
+        // Average over a time range
+        SharedVectorVariableT pData = mpHandler->getLogVariable(splitStr[0]);
+        if(!pData)
+        {
+            mpHandler->evaluateExpression(splitStr[0], HcomHandler::DataVector);
+            if(mpHandler->mAnsType == HcomHandler::DataVector)
+            {
+                pData = mpHandler->mAnsVector;
+            }
+        }
+
+        QMap<QString, double> localVars = mpHandler->getLocalVariables();
+        QMap<QString, SymHopFunctionoid*> localFuncs = mpHandler->getLocalFunctionoidPointers();
+        bool minOk, maxOk;
+        const double minTime = SymHop::Expression(splitStr[1]).evaluate(localVars, &localFuncs, &minOk);
+        const double maxTime = SymHop::Expression(splitStr[2]).evaluate(localVars, &localFuncs, &maxOk);
+        hopsan::SignalStatistics statistics;
+        if(pData && minOk && maxOk && pData->statisticsOfData(minTime, maxTime, statistics))
+        {
+            ok=true;
+            return statistics.mean;
+        }
+        mpHandler->mpConsole->printErrorMessage(QString("Failed to compute average of %1").arg(str), "", false);
+        ok=false;
+        return 0;
+    }
+
     SharedVectorVariableT pData = mpHandler->getLogVariable(str);
     if(!pData)
     {
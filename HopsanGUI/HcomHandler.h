@@ -35,8 +35,11 @@
 #ifndef HCOMHANDLER_H
 #define HCOMHANDLER_H
 
+#include <QHash>
+
 #include "LogVariable.h"
 #include "SymHop.h"
+#include "HcomScript.h"
 #include "PlotCurveStyle.h"
 
 class SystemObject;
@@ -253,12 +256,19 @@ private:
     QString getParameterValue(QString parameterName) const;
 
     bool evaluateArithmeticExpression(QString cmd);
+    SharedHcomScriptBlockT getCompiledScript(const QStringList &rLines);
+    QString runCompiledScript(const HcomScriptBlock &rScript, bool *pAbort);
+    void executeScriptCommand(const HcomScriptCommand &rCommand);
+    bool executeCompiledLocalAssignment(const HcomScriptCommand &rCommand);
+    bool evaluateCompiledExpression(const HcomScriptExpression &rExpression, double &rValue);
+    bool evaluateFusedVectorExpression(const SymHop::Expression &rExpr, const QString &rName, const VariableType desiredType);
 
     void executeGtBuiltInFunction(QString functionCall);
     void executeLtBuiltInFunction(QString functionCall);
     void executeEqBuiltInFunction(QString functionCall);
     void executeCutBuiltInFunction(QString functionCall);
     void executeSsiBuiltInFunction(QString functionCall);
+    void executeStatisticsBuiltInFunction(QString functionCall);
 
     QString getDirectory(const QString &cmd) const;
     double getNumber(const QString &rStr, bool *pOk);
@@ -297,6 +307,10 @@ private:
     // Functions
     QMap<QString, QStringList> mFunctions;
 
+    // Compiled scripts and function bodies, and a revision that changes when commands may have changed what names refer to
+    QHash<QString, SharedHcomScriptBlockT> mCompiledScripts;
+    int mNameResolutionRevision;
+
     //Private get functions
 
     void updatePwd();
@@ -0,0 +1,372 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The full license is available in the file GPLv3.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   HcomScript.cpp
+//!
+//! @brief Contains the compiled (parsed once) representation of HCOM scripts
+//!
+//$Id$
+
+#include "HcomScript.h"
+#include "Utilities/GUIUtilities.h"
+
+namespace {
+
+//! @brief Checks if a name can only refer to a local (scalar) variable, names with dots refer to model parameters or log data
+bool isPlainVariableName(const QString &rName)
+{
+    if(rName.isEmpty() || !rName[0].isLetter())
+    {
+        return false;
+    }
+    for(const QChar c : rName)
+    {
+        if(!(c.isLetterOrNumber() || c == '_'))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//! @brief Returns the number of lines in a while loop body, the block ends with repeat
+//! @returns The number of lines, or -1 if repeat is missing
+int findWhileLoopEnd(const QStringList &rLines, const int start)
+{
+    int nLoops=1;
+    for(int l=start+1; l<rLines.size(); ++l)
+    {
+        const QString line = rLines[l].trimmed();
+        if(line.startsWith("while")) { ++nLoops; }
+        if(line.startsWith("repeat")) { --nLoops; }
+        if(nLoops == 0)
+        {
+            return l;
+        }
+    }
+    return -1;
+}
+
+}
+
+
+//! @brief Extract everything between the first ( and last )
+QStringList extractFunctionCallExpressionArguments(const QString& functionCallExpression)
+{
+    QStringList args;
+    int s = functionCallExpression.indexOf('(');
+    if (s>=0)
+    {
+        int e = functionCallExpression.lastIndexOf(')');
+        if (e>=0)
+        {
+            QString argString = functionCallExpression.mid(s+1, e-s-1);
+            splitRespectingQuotationsAndParanthesis(argString, ',', args);
+        }
+    }
+
+    // Remove unnecessary leading and trailing spaces for each arg
+    for(int i=0; i<args.size(); ++i)
+    {
+        args[i] = args[i].trimmed();
+    }
+
+    return args;
+}
+
+
+HcomScriptExpression::HcomScriptExpression()
+    : mResolvedRevision(-1), mVariablesAreLocal(false)
+{
+}
+
+//! @brief Parses an expression and compiles it to an evaluation tape if possible
+void HcomScriptExpression::compile(const QString &rText)
+{
+    bool ok;
+    const SymHop::Expression expression = SymHop::Expression(rText, &ok, SymHop::Expression::NoSimplifications);
+    if(ok)
+    {
+        compile(expression);
+    }
+    else
+    {
+        mExpression = expression;
+        mVariableNames.clear();
+        mTape = SymHop::EvaluationTape();
+    }
+    mText = rText;
+}
+
+//! @brief Compiles an already parsed expression to an evaluation tape if possible
+void HcomScriptExpression::compile(const SymHop::Expression &rExpression)
+{
+    mExpression = rExpression;
+    mText = rExpression.toString();
+    mVariableNames.clear();
+    for(const SymHop::Expression &variable : rExpression.getVariables())
+    {
+        const QString name = variable.toString();
+        if(!mVariableNames.contains(name))
+        {
+            mVariableNames.append(name);
+        }
+    }
+    // Variables with dots are model parameters or log data, they are always looked up the ordinary way
+    for(const QString &name : mVariableNames)
+    {
+        if(!isPlainVariableName(name))
+        {
+            return;
+        }
+    }
+    mTape.compile(rExpression, mVariableNames);
+    mResolvedRevision = -1;
+}
+
+//! @brief Tells if the expression can be evaluated from its compiled tape
+bool HcomScriptExpression::isCompiled() const
+{
+    return mTape.isCompiled();
+}
+
+
+HcomScriptCommand::HcomScriptCommand()
+    : mCommandIndex(-1), mIsLocalAssignment(false), mResolvedRevision(-1), mAssignsLocalVariable(false)
+{
+}
+
+//! @brief Splits a command into command name and arguments, and parses scalar assignments to local variables
+//! @param[in] rCommand The command, without comments
+//! @param[in] rCommandNames The names of the registered commands, in the order they are registered in the handler
+void HcomScriptCommand::compile(const QString &rCommand, const QStringList &rCommandNames)
+{
+    mCommand = rCommand.simplified();
+    const QString majorCommand = mCommand.section(" ", 0, 0);
+    mSubCommand = (majorCommand.size() == mCommand.size()) ? QString() : mCommand.mid(majorCommand.size()+1);
+    mCommandIndex = rCommandNames.indexOf(majorCommand);
+
+    mIsLocalAssignment = false;
+    if(mCommandIndex < 0 && !mCommand.endsWith("*") && mCommand.contains("="))
+    {
+        SymHop::Expression expr = SymHop::Expression(mCommand, 0, SymHop::Expression::NoSimplifications);
+        if(expr.isAssignment())
+        {
+            const QString left = expr.getLeft()->toString();
+            if(isPlainVariableName(left))
+            {
+                mValue.compile(*expr.getRight());
+                mIsLocalAssignment = mValue.isCompiled();
+                mAssignedName = left;
+            }
+        }
+    }
+    mResolvedRevision = -1;
+}
+
+
+HcomScriptNode::HcomScriptNode(NodeTypeT type, const QString &rText)
+    : mType(type), mText(rText)
+{
+}
+
+
+//! @brief Compiles HCOM script lines into statements, control flow blocks are compiled recursively
+//! @details Syntax errors are compiled to error statements, so that they are reported when (and if) execution reaches them
+//! @param[in] rLines The script lines
+//! @param[in] rCommandNames The names of the registered commands, in the order they are registered in the handler
+//! @returns The compiled script
+SharedHcomScriptBlockT compileHcomScript(const QStringList &rLines, const QStringList &rCommandNames)
+{
+    QSharedPointer<HcomScriptBlock> pBlock(new HcomScriptBlock());
+    for(int l=0; l<rLines.size(); ++l)
+    {
+        const QString line = rLines[l].trimmed();
+
+        if(line.isEmpty() || line.startsWith("#") || line.startsWith("&"))
+        {
+            // Ignore blank lines comments and labels
+            continue;
+        }
+        else if(line.startsWith("stop"))
+        {
+            pBlock->append(HcomScriptNode(HcomScriptNode::StopNode));
+        }
+        else if(line.startsWith("define "))
+        {
+            HcomScriptNode node(HcomScriptNode::DefineNode, line.section(" ",1).trimmed());
+            while(!rLines[l].trimmed().startsWith("enddefine"))
+            {
+                ++l;
+                if(l>=rLines.size())
+                {
+                    pBlock->append(HcomScriptNode(HcomScriptNode::ErrorNode, "Missing  enddefine  to end function definition."));
+                    return pBlock;
+                }
+                node.mLines << rLines[l];
+            }
+            node.mLines.removeLast();
+            pBlock->append(node);
+        }
+        else if(line.startsWith("goto"))
+        {
+            pBlock->append(HcomScriptNode(HcomScriptNode::GotoNode, line.section(" ",1)));
+        }
+        else if(line.startsWith("while"))
+        {
+            const QStringList args = extractFunctionCallExpressionArguments(line);
+            if(args.size() != 1)
+            {
+                pBlock->append(HcomScriptNode(HcomScriptNode::ErrorNode, "While requires one condition expression"));
+                return pBlock;
+            }
+            const int end = findWhileLoopEnd(rLines, l);
+            if(end < 0)
+            {
+                pBlock->append(HcomScriptNode(HcomScriptNode::ErrorNode, "Missing  repeat  to end while loop."));
+                return pBlock;
+            }
+
+            HcomScriptNode node(HcomScriptNode::WhileNode);
+            node.mConditions.append(HcomScriptExpression());
+            node.mConditions.last().compile(args.front());
+            node.mBlocks.append(compileHcomScript(rLines.mid(l+1, end-l-1), rCommandNames));
+            pBlock->append(node);
+            l = end;
+        }
+        else if(line.startsWith("if"))
+        {
+            QStringList args = extractFunctionCallExpressionArguments(line);
+            if(args.size() != 1)
+            {
+                pBlock->append(HcomScriptNode(HcomScriptNode::ErrorNode, "If requires one condition expression"));
+                return pBlock;
+            }
+            QStringList conditions(args.front());
+            QList<QStringList> codes;
+            codes.append(QStringList());
+            QStringList elseCode;
+            bool inElse=false;
+            int depth=1;
+            while(true)
+            {
+                ++l;
+                if(l>=rLines.size())
+                {
+                    pBlock->append(HcomScriptNode(HcomScriptNode::ErrorNode, "Missing  endif  in if-statement."));
+                    return pBlock;
+                }
+                const QString ifLine = rLines[l].trimmed();
+                if(ifLine.startsWith("if"))
+                {
+                    ++depth;
+                }
+                else if(ifLine == "endif")
+                {
+                    if(depth > 1)
+                    {
+                        --depth;
+                    }
+                    else
+                    {
+                        break;
+                    }
+                }
+                else if(ifLine.startsWith("elseif") && depth == 1)
+                {
+                    args = extractFunctionCallExpressionArguments(ifLine);
+                    if(args.size() != 1)
+                    {
+                        pBlock->append(HcomScriptNode(HcomScriptNode::ErrorNode, "If requires one condition expression"));
+                        return pBlock;
+                    }
+                    conditions.append(args.front());
+                    codes.append(QStringList());
+                    continue;
+                }
+                else if(ifLine == "else" && depth == 1)
+                {
+                    inElse=true;
+                    continue;
+                }
+                if(!inElse)
+                {
+                    codes.last().append(ifLine);
+                }
+                else
+                {
+                    elseCode.append(ifLine);
+                }
+            }
+
+            HcomScriptNode node(HcomScriptNode::IfNode);
+            for(int i=0; i<conditions.size(); ++i)
+            {
+                node.mConditions.append(HcomScriptExpression());
+                node.mConditions.last().compile(conditions[i]);
+                node.mBlocks.append(compileHcomScript(codes[i], rCommandNames));
+            }
+            node.mBlocks.append(compileHcomScript(elseCode, rCommandNames));
+            pBlock->append(node);
+        }
+        else if(line.startsWith("foreach"))
+        {
+            HcomScriptNode node(HcomScriptNode::ForeachNode, line.section(" ",1,1));
+            node.mFilter = line.section(" ",2,2);
+            while(!rLines[l].trimmed().startsWith("endforeach"))
+            {
+                ++l;
+                if(l>=rLines.size())
+                {
+                    pBlock->append(HcomScriptNode(HcomScriptNode::ErrorNode, "Missing  endforeach  in foreach-statement."));
+                    return pBlock;
+                }
+                node.mLines.append(rLines[l]);
+            }
+            node.mLines.removeLast();
+            pBlock->append(node);
+        }
+        else
+        {
+            // Ignore everything after first comment symbol, allow several commands on one line separated by semicolon
+            const QString commands = line.section("#",0,0);
+            if(commands.isEmpty())
+            {
+                continue;
+            }
+            HcomScriptNode node(HcomScriptNode::CommandNode, line);
+            for(const QString &command : commands.split(";"))
+            {
+                if(!command.isEmpty())
+                {
+                    node.mCommands.append(HcomScriptCommand());
+                    node.mCommands.last().compile(command, rCommandNames);
+                }
+            }
+            pBlock->append(node);
+        }
+    }
+    return pBlock;
+}
@@ -0,0 +1,109 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The full license is available in the file GPLv3.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   HcomScript.h
+//!
+//! @brief Contains the compiled (parsed once) representation of HCOM scripts
+//!
+//$Id$
+
+#ifndef HCOMSCRIPT_H
+#define HCOMSCRIPT_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QSharedPointer>
+
+#include "SymHop.h"
+
+class HcomScriptNode;
+typedef QVector<HcomScriptNode> HcomScriptBlock;
+typedef QSharedPointer<const HcomScriptBlock> SharedHcomScriptBlockT;
+
+//! @brief An expression in a compiled HCOM script
+//! @details The expression is parsed once. If it only uses built-in functions it is also compiled to an evaluation tape
+//! that can be evaluated directly from the values of its variables, without any string handling.
+class HcomScriptExpression
+{
+public:
+    HcomScriptExpression();
+    void compile(const QString &rText);
+    void compile(const SymHop::Expression &rExpression);
+    bool isCompiled() const;
+
+    QString mText;
+    SymHop::Expression mExpression;
+    QStringList mVariableNames;
+    SymHop::EvaluationTape mTape;
+
+    // Name resolution, valid as long as the handler resolution revision is unchanged
+    mutable int mResolvedRevision;
+    mutable bool mVariablesAreLocal;
+};
+
+//! @brief A single command in a compiled HCOM script
+//! @details Comments are removed and the registered command is looked up when compiling.
+//! Scalar assignments to local variables keep their parsed right hand side expression.
+class HcomScriptCommand
+{
+public:
+    HcomScriptCommand();
+    void compile(const QString &rCommand, const QStringList &rCommandNames);
+
+    QString mCommand;
+    QString mSubCommand;
+    int mCommandIndex;
+
+    bool mIsLocalAssignment;
+    QString mAssignedName;
+    HcomScriptExpression mValue;
+
+    // Name resolution, valid as long as the handler resolution revision is unchanged
+    mutable int mResolvedRevision;
+    mutable bool mAssignsLocalVariable;
+};
+
+//! @brief A statement (line or control flow block) in a compiled HCOM script
+class HcomScriptNode
+{
+public:
+    enum NodeTypeT {CommandNode, DefineNode, GotoNode, StopNode, WhileNode, IfNode, ForeachNode, ErrorNode};
+
+    HcomScriptNode(NodeTypeT type=CommandNode, const QString &rText=QString());
+
+    NodeTypeT mType;
+    QString mText;                              //!< Function name, goto label, foreach variable or error message
+    QString mFilter;                            //!< Foreach variable filter
+    QStringList mLines;                         //!< Function body or foreach body (which is text substituted for each variable)
+    QVector<HcomScriptCommand> mCommands;       //!< The (semicolon separated) commands on a command line
+    QVector<HcomScriptExpression> mConditions;  //!< While condition, or if and elseif conditions
+    QVector<SharedHcomScriptBlockT> mBlocks;    //!< While body, or if and elseif bodies followed by the else body
+};
+
+QStringList extractFunctionCallExpressionArguments(const QString& functionCallExpression);
+SharedHcomScriptBlockT compileHcomScript(const QStringList &rLines, const QStringList &rCommandNames);
+
+#endif // HCOMSCRIPT_H
@@ -174,5 +174,88 @@ private slots:
         QCOMPARE(mpHcom->mAnsScalar, 44.0);
     }
 
+    void testControlFlowCompiled() {
+        // Nested loops and functions run from the compiled script, syspar is a parameter and is looked up each time
+        QString script = R"(
+                define twice
+                  w = w*2
+                enddefine
+                total = 0
+                i = 0
+                while (i < 10)
+                  j = 0
+                  while (j < i)
+                    total = total + syspar; j = j + 1
+                  repeat
+                  i = i + 1
+                repeat
+                w = 3
+                call twice
+                call twice
+                )";
+        bool abort=false;
+        QStringList lines = script.split("\n");
+        mpHcom->runScriptCommands(lines, &abort);
+        mpHcom->executeCommand("total");
+        QCOMPARE(mpHcom->mAnsType, HcomHandler::Scalar);
+        QCOMPARE(mpHcom->mAnsScalar, 45*42.0);
+        mpHcom->executeCommand("w");
+        QCOMPARE(mpHcom->mAnsType, HcomHandler::Scalar);
+        QCOMPARE(mpHcom->mAnsScalar, 12.0);
+
+        // A parameter added after the script was compiled takes precedence over the local variable with the same name
+        lines = QStringList() << "z = q*2";
+        mpHcom->executeCommand("q = 1");
+        mpHcom->runScriptCommands(lines, &abort);
+        mpHcom->executeCommand("z");
+        QCOMPARE(mpHcom->mAnsScalar, 2.0);
+        mpHcom->executeCommand("adpa q 10");
+        mpHcom->runScriptCommands(lines, &abort);
+        mpHcom->executeCommand("z");
+        QCOMPARE(mpHcom->mAnsScalar, 20.0);
+    }
+
+    void testVectorMath() {
+        QFETCH(QString, expression);
+        QFETCH(double, expectedValue);
 
+        // Both step outputs are constant 43 during the simulation
+        mpHcom->executeCommand("scale = 2");
+        mpHcom->evaluateExpression(expression);
+        QCOMPARE(mpHcom->mAnsType, HcomHandler::DataVector);
+        QCOMPARE(mpHcom->mAnsVector->getDataSize(), mpHcom->getLogVariable("step.out.y")->getDataSize());
+        QCOMPARE(mpHcom->mAnsVector->minOfData(), expectedValue);
+        QCOMPARE(mpHcom->mAnsVector->maxOfData(), expectedValue);
+    }
+
+    void testVectorMath_data() {
+        QTest::addColumn<QString>("expression");
+        QTest::addColumn<double>("expectedValue");
+        QTest::newRow("fused") << "step.out.y*step2.out.y+step.out.y/step2.out.y-scale" << 43.0*43.0+1.0-2.0;
+        QTest::newRow("scalar first") << "scale/step.out.y" << 2.0/43.0;
+        QTest::newRow("power") << "step.out.y^2-step2.out.y" << 43.0*43.0-43.0;
+        QTest::newRow("function") << "sqrt(step.out.y*step2.out.y)+1" << 44.0;
+        QTest::newRow("absolute") << "2*abs(step.out.y)" << 86.0;
+        QTest::newRow("hcom function") << "step.out.y-aver(step2.out.y)" << 0.0;
+    }
+
+    void testStatistics() {
+        QFETCH(QString, expression);
+        QFETCH(double, expectedValue);
+
+        // The step output is constant 43 during the simulation (0 to 10 s)
+        mpHcom->evaluateExpression(expression);
+        QCOMPARE(mpHcom->mAnsType, HcomHandler::Scalar);
+        QCOMPARE(mpHcom->mAnsScalar, expectedValue);
+    }
+
+    void testStatistics_data() {
+        QTest::addColumn<QString>("expression");
+        QTest::addColumn<double>("expectedValue");
+        QTest::newRow("rms") << "rms(step.out.y)" << 43.0;
+        QTest::newRow("rms range") << "rms(step.out.y, 2, 3)" << 43.0;
+        QTest::newRow("integral") << "integral(step.out.y)" << 430.0;
+        QTest::newRow("aver range") << "aver(step.out.y, 1, 2)*2" << 86.0;
+        QTest::newRow("steady state") << "aver(ssi(step.out.y, 0, 0.1, 1), 5, 10)" << 1.0;
+    }
 };
@@ -242,6 +242,7 @@ SOURCES += main.cpp \
     Dialogs/ComponentPropertiesDialog3.cpp \
     Widgets/DebuggerWidget.cpp \
     HcomHandler.cpp \
+    HcomScript.cpp \
     Widgets/HVCWidget.cpp \
     ModelHandler.cpp \
     Widgets/ModelWidget.cpp \
@@ -329,6 +330,7 @@ HEADERS += MainWindow.h \
     Dialogs/ComponentPropertiesDialog3.h \
     Widgets/DebuggerWidget.h \
     HcomHandler.h \
+    HcomScript.h \
     Widgets/HVCWidget.h \
     ModelHandler.h \
     Widgets/ModelWidget.h \
@@ -359,7 +361,8 @@ HEADERS += MainWindow.h \
     GeneratorUtils.h \
     Dialogs/OptimizationScriptWizard.h \
     Widgets/TextEditorWidget.h \
-    HcomTest.hpp
+    HcomTest.hpp \
+    CacheBenchmark.hpp
 
 OTHER_FILES += \
     ../hopsan-default-configuration.xml
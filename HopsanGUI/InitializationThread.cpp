@@ -32,6 +32,9 @@
 //$Id$
 
 #include <QDebug>
+#include <QFile>
+#include <QEventLoop>
+#include <QElapsedTimer>
 
 #include "InitializationThread.h"
 #include "Widgets/ModelWidget.h"
@@ -110,3 +113,95 @@ void MultipleInitializationThread::run()
 
     //exec(); //Is used if one want to run an event loop in this thread.
 }
+
+
+
+//! @class ModelFileParserThread
+//! @brief Reads and parses a model file into a DOM document in a separate thread
+//!
+//! Parsing a large model file takes a noticeable time, running it in a separate thread keeps the window responsive. The DOM
+//! document must only be used from the calling thread after the parser thread has finished.
+//!
+
+
+//! Constructor.
+//! @param rFilePath is the path to the model file to parse
+//! @param rRootTagName is the expected root tag of the document
+ModelFileParserThread::ModelFileParserThread(const QString &rFilePath, const QString &rRootTagName)
+{
+    mFilePath = rFilePath;
+    mRootTagName = rRootTagName;
+    mParseSuccessful = false;
+    mElapsedMs = 0;
+}
+
+//! @brief Check if parsing was successful
+bool ModelFileParserThread::wasParseSuccessful() const
+{
+    return mParseSuccessful;
+}
+
+//! @brief Returns a description of why the file could not be parsed
+QString ModelFileParserThread::getErrorMessage() const
+{
+    return mErrorMessage;
+}
+
+QDomDocument ModelFileParserThread::getDomDocument() const
+{
+    return mDomDocument;
+}
+
+QDomElement ModelFileParserThread::getRootElement() const
+{
+    return mDomDocument.documentElement();
+}
+
+//! @brief Returns the time it took to read and parse the file
+qint64 ModelFileParserThread::getElapsedMs() const
+{
+    return mElapsedMs;
+}
+
+//! @brief Starts the thread and processes events (except user input) until it has finished
+//! @returns true if the file was parsed and had the expected root tag
+bool ModelFileParserThread::parseAndWait()
+{
+    QEventLoop loop;
+    connect(this, SIGNAL(finished()), &loop, SLOT(quit()));
+    start();
+    // If the thread finishes before the loop is started, the (queued) quit is handled as soon as the loop runs
+    loop.exec(QEventLoop::ExcludeUserInputEvents);
+    wait();
+    return mParseSuccessful;
+}
+
+
+//! Implements the task for the thread.
+void ModelFileParserThread::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile file(mFilePath);
+    QString errorStr;
+    int errorLine, errorColumn;
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        mErrorMessage = QString("%1: Could not open file").arg(mFilePath);
+    }
+    else if (!mDomDocument.setContent(file.readAll(), false, &errorStr, &errorLine, &errorColumn))
+    {
+        mErrorMessage = QString(mFilePath + ": Parse error at line %1, column %2:\n%3").arg(errorLine).arg(errorColumn).arg(errorStr);
+    }
+    else if (mDomDocument.documentElement().tagName() != mRootTagName)
+    {
+        mErrorMessage = QString("The file has the wrong Root Tag Name: ") + mDomDocument.documentElement().tagName() + "!=" + mRootTagName;
+    }
+    else
+    {
+        mParseSuccessful = true;
+    }
+
+    mElapsedMs = timer.elapsed();
+}
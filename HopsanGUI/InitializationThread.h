@@ -37,6 +37,8 @@
 
 #include <QThread>
 #include <QVector>
+#include <QString>
+#include <QDomDocument>
 
 class ModelWidget;
 class CoreSystemAccess;
@@ -79,4 +81,29 @@ private:
     QVector<CoreSystemAccess *> mvGUIRootSystemPtrs;
 };
 
+
+class ModelFileParserThread : public QThread
+{
+public:
+    ModelFileParserThread(const QString &rFilePath, const QString &rRootTagName);
+    bool wasParseSuccessful() const;
+    QString getErrorMessage() const;
+    QDomDocument getDomDocument() const;
+    QDomElement getRootElement() const;
+    qint64 getElapsedMs() const;
+
+    bool parseAndWait();
+
+protected:
+    void run();
+
+private:
+    QString mFilePath;
+    QString mRootTagName;
+    QDomDocument mDomDocument;
+    QString mErrorMessage;
+    bool mParseSuccessful;
+    qint64 mElapsedMs;
+};
+
 #endif // INITIALIZATIONTHREAD_H
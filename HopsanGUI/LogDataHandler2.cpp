@@ -36,6 +36,7 @@
 #include <QProgressDialog>
 #include <QDialogButtonBox>
 #include <QPushButton>
+#include <QTimer>
 
 #include "LogDataHandler2.h"
 #include "LogDataGeneration.h"
@@ -59,6 +60,10 @@
 #include "ComponentUtilities/CSVParser.h"
 #include "HopsanTypes.h"
 #include "ComponentSystem.h"
+#include "SymHop.h"
+
+#include <atomic>
+#include <thread>
 
 #ifdef USEHDF5
 #include "hopsanhdf5exporter.h"
@@ -1085,6 +1090,13 @@ bool LogDataHandler2::isEmpty()
 
 void LogDataHandler2::clear()
 {
+    // Variables that have not yet been collected are not needed any more
+    if (isCollectingLogData())
+    {
+        mPendingLogDataJobs.clear();
+        mpParentModel->lockModelEditingLimited(false);
+    }
+
     // Clear all data generations
     for (auto git = mGenerationMap.begin(); git!=mGenerationMap.end(); ++git)
     {
@@ -1113,8 +1125,15 @@ void LogDataHandler2::clear()
 
 
 //! @brief Collects plot data from last simulation
-void LogDataHandler2::collectLogDataFromModel(bool overWriteLastGeneration)
+//! @param[in] overWriteLastGeneration Replace the data in the current generation instead of creating a new generation
+//! @param[in] collectPlottedFirst Only collect the variables that are currently plotted right away, the remaining variables are collected in the background
+//! @details The log data is copied from the core by worker threads, one port at the time, and each variable is then written to the generation cache in one go.
+//! While variables are collected in the background model editing is limited, since the data is read directly from the core log storage.
+void LogDataHandler2::collectLogDataFromModel(bool overWriteLastGeneration, bool collectPlottedFirst)
 {
+    // Variables remaining from the previous simulation should already have been collected before this simulation started
+    finishCollectingLogData();
+
     if (!(mpParentModel && mpParentModel->getTopLevelSystemContainer()))
     {
         return;
@@ -1146,12 +1165,59 @@ void LogDataHandler2::collectLogDataFromModel(bool overWriteLastGeneration)
 
     TicToc tictoc(TicToc::TextOutput::DebugMessage);
     auto sizeBefore = pGMC->getCacheSize();
+    auto uncompressedSizeBefore = pGMC->getUncompressedSize();
     QMap<std::vector<double>*, SharedVectorVariableT> generationTimeVectors;
-    bool foundData = collectLogDataFromSystem(pTopLevelSystem, QStringList(), generationTimeVectors);
+    QVector<PortLogDataJob> jobs;
+    bool foundData = collectLogDataFromSystem(pTopLevelSystem, QStringList(), generationTimeVectors, jobs);
+
+    // Move the variables that are not plotted to the background jobs
+    QVector<PortLogDataJob> backgroundJobs;
+    if (collectPlottedFirst && !mPlottedVariables.isEmpty())
+    {
+        for (PortLogDataJob &rJob : jobs)
+        {
+            PortLogDataJob backgroundJob = rJob;
+            backgroundJob.mDataIds.clear();
+            backgroundJob.mVariableDescriptions.clear();
+            int numPlotted=0;
+            for (int i=0; i<rJob.mDataIds.size(); ++i)
+            {
+                if (mPlottedVariables.contains(rJob.mVariableDescriptions[i]->getFullName()))
+                {
+                    rJob.mDataIds[numPlotted] = rJob.mDataIds[i];
+                    rJob.mVariableDescriptions[numPlotted] = rJob.mVariableDescriptions[i];
+                    ++numPlotted;
+                }
+                else
+                {
+                    backgroundJob.mDataIds.append(rJob.mDataIds[i]);
+                    backgroundJob.mVariableDescriptions.append(rJob.mVariableDescriptions[i]);
+                }
+            }
+            rJob.mDataIds.resize(numPlotted);
+            rJob.mVariableDescriptions.resize(numPlotted);
+            if (!backgroundJob.mDataIds.isEmpty())
+            {
+                backgroundJobs.append(backgroundJob);
+            }
+        }
+    }
+
+    while (!jobs.isEmpty())
+    {
+        collectLogDataColumns(jobs, mCurrentGenerationNumber);
+    }
+
     auto sizeAfter = pGMC->getCacheSize();
     const double cachedSize_mb = (sizeAfter-sizeBefore)*1.0e-6;
     const double collect_ms = tictoc.toc("Collecting all log data");
     gpMessageHandler->addDebugMessage(QString("Wrote to disk: %1 MB data at %2 MB/s").arg(cachedSize_mb).arg( cachedSize_mb*1.0e3/collect_ms));
+    if (pGMC->isUsingCompression() && (sizeAfter > sizeBefore))
+    {
+        const double uncompressedSize_mb = (pGMC->getUncompressedSize()-uncompressedSizeBefore)*1.0e-6;
+        gpMessageHandler->addInfoMessage(QString("Compressed %1 MB log data at %2 MB/s, compression ratio %3").arg(uncompressedSize_mb)
+                                         .arg(uncompressedSize_mb*1.0e3/collect_ms).arg(uncompressedSize_mb/cachedSize_mb));
+    }
 
     this->blockSignals(false);
 
@@ -1168,6 +1234,15 @@ void LogDataHandler2::collectLogDataFromModel(bool overWriteLastGeneration)
     // If we found data then emit signals
     if (foundData)
     {
+        // Let the event loop collect the remaining variables
+        if (!backgroundJobs.isEmpty())
+        {
+            mPendingLogDataJobs = backgroundJobs;
+            mPendingLogDataGeneration = mCurrentGenerationNumber;
+            mpParentModel->lockModelEditingLimited(true);
+            QTimer::singleShot(0, this, SLOT(collectPendingLogData()));
+        }
+
         emit dataAdded();
         emit dataAddedFromModel(true);
     }
@@ -1179,13 +1254,65 @@ void LogDataHandler2::collectLogDataFromModel(bool overWriteLastGeneration)
     }
 }
 
-bool LogDataHandler2::collectLogDataFromSystem(SystemObject *pCurrentSystem, const QStringList &rSystemHieararchy, QMap<std::vector<double>*, SharedVectorVariableT> &rGenTimeVectors)
+//! @brief Collects all variables that are still waiting to be collected in the background
+void LogDataHandler2::finishCollectingLogData()
+{
+    while (isCollectingLogData())
+    {
+        collectPendingLogData();
+    }
+}
+
+//! @brief Tells whether or not there are variables from the last simulation that have not yet been collected
+bool LogDataHandler2::isCollectingLogData() const
+{
+    return !mPendingLogDataJobs.isEmpty();
+}
+
+//! @brief Collects the next batch of variables that are waiting to be collected in the background
+void LogDataHandler2::collectPendingLogData()
+{
+    // This may already have been done by finishCollectingLogData()
+    if (mPendingLogDataJobs.isEmpty())
+    {
+        return;
+    }
+
+    auto pGMC = this->getGenerationMultiCache(mPendingLogDataGeneration);
+    pGMC->beginMultiAppend();
+    this->blockSignals(true);
+    collectLogDataColumns(mPendingLogDataJobs, mPendingLogDataGeneration);
+    this->blockSignals(false);
+    pGMC->endMultiAppend();
+
+    if (mPendingLogDataJobs.isEmpty())
+    {
+        mpParentModel->lockModelEditingLimited(false);
+    }
+    else
+    {
+        QTimer::singleShot(0, this, SLOT(collectPendingLogData()));
+    }
+
+    emit dataAdded();
+}
+
+//! @brief Finds the variables that have log data in a system and its subsystems
+//! @details The system time vectors are inserted directly, the variables are only described in the returned port jobs
+//! @param[in] pCurrentSystem The system to search
+//! @param[in] rSystemHieararchy The names of the parent systems and of the system itself
+//! @param[in,out] rGenTimeVectors The time vectors that have been inserted in this generation, by core time vector
+//! @param[out] rJobs The ports with variables to collect are appended here
+//! @returns True if any variable with log data was found
+bool LogDataHandler2::collectLogDataFromSystem(SystemObject *pCurrentSystem, const QStringList &rSystemHieararchy, QMap<std::vector<double>*, SharedVectorVariableT> &rGenTimeVectors,
+                                               QVector<PortLogDataJob> &rJobs)
 {
     SharedSystemHierarchyT sharedSystemHierarchy(new QStringList(rSystemHieararchy));
     bool foundData=false, foundDataInSubsys=false;
+    CoreSystemAccess *pCoreSystemAccess = pCurrentSystem->getCoreSystemAccessPtr();
 
     // Store the systems own time vector
-    auto pCoreSysTimeVector = pCurrentSystem->getCoreSystemAccessPtr()->getLogTimeData();
+    auto pCoreSysTimeVector = pCoreSystemAccess->getLogTimeData();
     if (pCoreSysTimeVector && !pCoreSysTimeVector->empty())
     {
         // Check so that we have not already stored this time vector in this generation
@@ -1193,7 +1320,7 @@ bool LogDataHandler2::collectLogDataFromSystem(SystemObject *pCurrentSystem, con
         {
             //! @todo here we need to copy (convert) from std vector to qvector, don know if that slows down (probably not much)
             auto time_vec = QVector<double>::fromStdVector(*pCoreSysTimeVector);
-            time_vec.resize(pCurrentSystem->getCoreSystemAccessPtr()->getCoreSystemPtr()->getNumActuallyLoggedSamples());
+            time_vec.resize(pCoreSystemAccess->getCoreSystemPtr()->getNumActuallyLoggedSamples());
             auto pSysTimeVector = insertTimeVectorVariable(time_vec, sharedSystemHierarchy);
             rGenTimeVectors.insert(pCoreSysTimeVector, pSysTimeVector);
         }
@@ -1213,64 +1340,61 @@ bool LogDataHandler2::collectLogDataFromSystem(SystemObject *pCurrentSystem, con
         for(auto &pPort : ports)
         {
             QVector<CoreVariableData> varDescs;
-            pCurrentSystem->getCoreSystemAccessPtr()->getVariableDescriptions(pModelObject->getName(),
-                                                                              pPort->getName(),
-                                                                              varDescs);
+            pCoreSystemAccess->getVariableDescriptions(pModelObject->getName(), pPort->getName(), varDescs);
+
+            // Prevent adding data if time or data vector was empty
+            PortLogDataJob job;
+            std::vector<double> *pCoreVarTimeVector=nullptr;
+            if (varDescs.isEmpty() ||
+                !pCoreSystemAccess->getPortLogData(pModelObject->getName(), pPort->getName(), job.mpCoreData, pCoreVarTimeVector, job.mNumSamples) ||
+                pCoreVarTimeVector->empty() || (job.mNumSamples == 0))
+            {
+                continue;
+            }
 
-            // Iterate variables
-            for(auto &varDesc : varDescs)
+            // Iterate variables, the description index is the node data id
+            for(int i=0; i<varDescs.size(); ++i)
             {
+                const CoreVariableData &varDesc = varDescs[i];
                 // Skip hidden variables
                 if ( gpConfig->getBoolSetting(CFG_SHOWHIDDENNODEDATAVARIABLES) || (varDesc.mNodeDataVariableType != "Hidden") )
                 {
-                    // Fetch variable data
-                    QVector<double> dataVec;
-                    std::vector<double> *pCoreVarTimeVector=0;
-                    pCurrentSystem->getCoreSystemAccessPtr()->getPlotData(pModelObject->getName(),
-                                                                          pPort->getName(),
-                                                                          varDesc.mName,
-                                                                          pCoreVarTimeVector,
-                                                                          dataVec);
-
-                    // Prevent adding data if time or data vector was empty
-                    if (!pCoreVarTimeVector->empty() && !dataVec.isEmpty())
-                    {
-                        foundData=true;
-                        SharedVariableDescriptionT pVarDesc = SharedVariableDescriptionT(new VariableDescription);
-                        pVarDesc->mModelPath = pModelObject->getParentSystemObject()->getModelFilePath();
-                        pVarDesc->mpSystemHierarchy = sharedSystemHierarchy;
-                        pVarDesc->mComponentName = pModelObject->getName();
-                        pVarDesc->mPortName = pPort->getName();
-                        pVarDesc->mDataName = varDesc.mName;
-                        pVarDesc->mDataUnit = varDesc.mUnit;
-                        pVarDesc->mDataQuantity = varDesc.mQuantity;
-                        pVarDesc->mDataDescription = varDesc.mDescription;
-                        pVarDesc->mAliasName  = varDesc.mAlias;
-                        pVarDesc->mVariableSourceType = ModelVariableType;
-                        pVarDesc->mModelInvertPlot = pModelObject->getInvertPlotVariable(pPort->getName()+"#"+varDesc.mName);
-                        pVarDesc->mLocalInvertInvertPlot = false;
-                        pVarDesc->mCustomLabel = pModelObject->getVariablePlotLabel(pPort->getName()+"#"+varDesc.mName);
-
-                        SharedVectorVariableT pNewData;
-
-                        // Lookup which time vector from system parent or system grand parent to use
-                        auto pSysTimeVector = rGenTimeVectors.value(pCoreVarTimeVector);
-
-                        // Insert variable with parent system time vector if  that is what it is using
-                        if (pSysTimeVector)
-                        {
-                            pNewData = insertTimeDomainVariable(pSysTimeVector, dataVec, pVarDesc);
-                        }
-                        // Else create a unique variable time vector for this component
-                        else
-                        {
-                            auto time_vec = QVector<double>::fromStdVector(*pCoreVarTimeVector);
-                            time_vec.resize(pCurrentSystem->getCoreSystemAccessPtr()->getCoreSystemPtr()->getNumActuallyLoggedSamples());
-                            auto pVarTimeVec = insertTimeVectorVariable(time_vec, SharedSystemHierarchyT());
-                            pNewData = insertTimeDomainVariable(pVarTimeVec, dataVec, pVarDesc);
-                        }
-                    }
+                    SharedVariableDescriptionT pVarDesc = SharedVariableDescriptionT(new VariableDescription);
+                    pVarDesc->mModelPath = pModelObject->getParentSystemObject()->getModelFilePath();
+                    pVarDesc->mpSystemHierarchy = sharedSystemHierarchy;
+                    pVarDesc->mComponentName = pModelObject->getName();
+                    pVarDesc->mPortName = pPort->getName();
+                    pVarDesc->mDataName = varDesc.mName;
+                    pVarDesc->mDataUnit = varDesc.mUnit;
+                    pVarDesc->mDataQuantity = varDesc.mQuantity;
+                    pVarDesc->mDataDescription = varDesc.mDescription;
+                    pVarDesc->mAliasName  = varDesc.mAlias;
+                    pVarDesc->mVariableSourceType = ModelVariableType;
+                    pVarDesc->mModelInvertPlot = pModelObject->getInvertPlotVariable(pPort->getName()+"#"+varDesc.mName);
+                    pVarDesc->mLocalInvertInvertPlot = false;
+                    pVarDesc->mCustomLabel = pModelObject->getVariablePlotLabel(pPort->getName()+"#"+varDesc.mName);
+
+                    job.mDataIds.append(i);
+                    job.mVariableDescriptions.append(pVarDesc);
+                }
+            }
+
+            if (!job.mDataIds.isEmpty())
+            {
+                foundData=true;
+
+                // Lookup which time vector from system parent or system grand parent to use
+                job.mpTimeVariable = rGenTimeVectors.value(pCoreVarTimeVector);
+
+                // Else create a unique variable time vector for this component
+                if (!job.mpTimeVariable)
+                {
+                    auto time_vec = QVector<double>::fromStdVector(*pCoreVarTimeVector);
+                    time_vec.resize(pCoreSystemAccess->getCoreSystemPtr()->getNumActuallyLoggedSamples());
+                    job.mpTimeVariable = insertTimeVectorVariable(time_vec, SharedSystemHierarchyT());
                 }
+
+                rJobs.append(job);
             }
         }
 
@@ -1279,15 +1403,103 @@ bool LogDataHandler2::collectLogDataFromSystem(SystemObject *pCurrentSystem, con
         {
             QStringList subsysHierarchy = rSystemHieararchy;
             subsysHierarchy << pModelObject->getName();
-            bool foundDataInThisSubsys = collectLogDataFromSystem(qobject_cast<SystemObject*>(pModelObject), subsysHierarchy, rGenTimeVectors);
+            bool foundDataInThisSubsys = collectLogDataFromSystem(qobject_cast<SystemObject*>(pModelObject), subsysHierarchy, rGenTimeVectors, rJobs);
             foundDataInSubsys = foundDataInSubsys || foundDataInThisSubsys;
         }
     }
     return (foundData || foundDataInSubsys);
 }
 
+//! @brief Copies the log data of the first ports in a job list from the core and inserts the variables, the handled jobs are removed from the list
+//! @details The ports are handled by worker threads. The core stores one row per log sample, so all variables of a port are copied in
+//! one pass over its rows. Each variable is then added to the generation cache with one sequential write.
+//! @param[in,out] rJobs The ports to collect, ports are taken from the front until the batch size limit is reached (but at least one port is taken)
+//! @param[in] generation The generation to insert the variables in
+void LogDataHandler2::collectLogDataColumns(QVector<PortLogDataJob> &rJobs, const int generation)
+{
+    // Limit the number of bytes copied in one batch, this limits the memory use and keeps background collection responsive
+    const qint64 maxBatchBytes = 32*1024*1024;
+
+    int numJobs=0, numColumns=0;
+    qint64 numBytes=0;
+    while (numJobs < rJobs.size() && (numJobs == 0 || numBytes < maxBatchBytes))
+    {
+        numBytes += qint64(rJobs[numJobs].mNumSamples)*rJobs[numJobs].mDataIds.size()*qint64(sizeof(double));
+        numColumns += rJobs[numJobs].mDataIds.size();
+        ++numJobs;
+    }
+
+    // Allocate all columns here, the worker threads only write into their memory
+    QVector< QVector<double> > columns(numColumns);
+    QVector<double*> columnPointers(numColumns);
+    QVector<int> firstColumns(numJobs);
+    for (int j=0, c=0; j<numJobs; ++j)
+    {
+        firstColumns[j] = c;
+        for (int k=0; k<rJobs[j].mDataIds.size(); ++k, ++c)
+        {
+            columns[c].resize(int(rJobs[j].mNumSamples));
+            columnPointers[c] = columns[c].data();
+        }
+    }
+
+    std::atomic<int> nextJob(0);
+    const PortLogDataJob *pJobs = rJobs.constData();
+    double * const *ppColumns = columnPointers.constData();
+    const int *pFirstColumns = firstColumns.constData();
+    auto copyColumns = [&nextJob, numJobs, pJobs, ppColumns, pFirstColumns]()
+    {
+        for (int j=nextJob++; j<numJobs; j=nextJob++)
+        {
+            const PortLogDataJob &rJob = pJobs[j];
+            const int numVariables = rJob.mDataIds.size();
+            const int *pDataIds = rJob.mDataIds.constData();
+            double * const *ppPortColumns = ppColumns+pFirstColumns[j];
+            for (size_t r=0; r<rJob.mNumSamples; ++r)
+            {
+                const double *pRow = (*rJob.mpCoreData)[r].data();
+                for (int k=0; k<numVariables; ++k)
+                {
+                    ppPortColumns[k][r] = pRow[pDataIds[k]];
+                }
+            }
+        }
+    };
+
+    const int numThreads = qMin(numJobs, qMax(1, int(std::thread::hardware_concurrency())));
+    std::vector<std::thread> threads;
+    for (int t=1; t<numThreads; ++t)
+    {
+        threads.push_back(std::thread(copyColumns));
+    }
+    copyColumns();
+    for (std::thread &rThread : threads)
+    {
+        rThread.join();
+    }
+
+    // Insert the variables, this writes each of them to the cache
+    auto pGMC = getGenerationMultiCache(generation);
+    for (int j=0; j<numJobs; ++j)
+    {
+        const PortLogDataJob &rJob = rJobs[j];
+        for (int k=0; k<rJob.mDataIds.size(); ++k)
+        {
+            QVector<double> &rColumn = columns[firstColumns[j]+k];
+            SharedVectorVariableT pNewData = SharedVectorVariableT(new TimeDomainVariable(rJob.mpTimeVariable, rColumn, generation,
+                                                                                          rJob.mVariableDescriptions[k], pGMC));
+            insertVariable(pNewData, QString(), generation);
+            // Release the memory as soon as possible
+            rColumn = QVector<double>();
+        }
+    }
+
+    rJobs.remove(0, numJobs);
+}
+
 void LogDataHandler2::collectLogDataFromRemoteModel(QVector<RemoteResultVariable> &rResultVariables, bool overWriteLastGeneration)
 {
+    finishCollectingLogData();
     TicToc tictoc;
     if(!overWriteLastGeneration)
     {
@@ -1642,6 +1854,7 @@ void LogDataHandler2::limitPlotGenerations()
 //! @brief Removes a generation
 bool LogDataHandler2::removeGeneration(const int gen, const bool force)
 {
+    finishCollectingLogData();
     auto git = mGenerationMap.find(gen);
     if (git != mGenerationMap.end())
     {
@@ -1702,6 +1915,7 @@ SharedMultiDataVectorCacheT LogDataHandler2::getGenerationMultiCache(const int g
     if (!pCache)
     {
         pCache = SharedMultiDataVectorCacheT(new MultiDataVectorCache(getNewCacheName()));
+        pCache->setUseCompression(gpConfig->getBoolSetting(CFG_COMPRESSLOGDATA));
         mGenerationCacheMap.insert(gen, pCache);
     }
     return pCache;
@@ -1724,6 +1938,7 @@ void LogDataHandler2::pruneGenerationCache(const int generation, LogDataGenerati
         }
 
         SharedMultiDataVectorCacheT pCache = SharedMultiDataVectorCacheT(new MultiDataVectorCache(getNewCacheName(prevName)));
+        pCache->setUseCompression(gpConfig->getBoolSetting(CFG_COMPRESSLOGDATA));
         pGeneration->switchGenerationDataCache(pCache);
 
         // Replace old generation
@@ -1733,22 +1948,30 @@ void LogDataHandler2::pruneGenerationCache(const int generation, LogDataGenerati
 
 
 //! @brief Increments counter for number of open plot curves (in plot windows)
-//! @note Used to decide if warning message shall be shown when closing model
+//! @note Used to decide if warning message shall be shown when closing model, and which variables to collect first after a simulation
+//! @param[in] rFullName The full name of the plotted variable
 //! @see PlotData::decrementOpenPlotCurves()
 //! @see PlotData::hasOpenPlotCurves()
-void LogDataHandler2::incrementOpenPlotCurves()
+void LogDataHandler2::incrementOpenPlotCurves(const QString &rFullName)
 {
     ++mNumPlotCurves;
+    ++mPlottedVariables[rFullName];
 }
 
 
 //! @brief Decrements counter for number of open plot curves (in plot windows)
 //! @note Used to decide if warning message shall be shown when closing model
+//! @param[in] rFullName The full name of the plotted variable
 //! @see PlotData::incrementOpenPlotCurves()
 //! @see PlotData::hasOpenPlotCurves()
-void LogDataHandler2::decrementOpenPlotCurves()
+void LogDataHandler2::decrementOpenPlotCurves(const QString &rFullName)
 {
     --mNumPlotCurves;
+    auto it = mPlottedVariables.find(rFullName);
+    if (it != mPlottedVariables.end() && --it.value() <= 0)
+    {
+        mPlottedVariables.erase(it);
+    }
 }
 
 
@@ -1858,6 +2081,96 @@ SharedVectorVariableT LogDataHandler2::elementWisePower(SharedVectorVariableT a,
     return pTempVar;
 }
 
+//! @brief Evaluates a compiled expression element-wise over data variables in one fused pass
+//! @details The operands are read through read-only views of the (cached) data and only the result is written, so no
+//! temporary variables are created for intermediate results. Long vectors are split in chunks that are evaluated in parallel.
+//! @param[in] rTape The compiled expression, variable slot i refers to rOperands[i]
+//! @param[in] rOperands The operand variables, they must all have the same size
+//! @param[in] rName The name of the resulting variable
+//! @param[in] numThreads The number of threads to use, 0 = one per processor core
+//! @returns The resulting variable, or a null pointer if the operands do not have the same size or could not be read
+SharedVectorVariableT LogDataHandler2::evaluateVariableExpression(const SymHop::EvaluationTape &rTape, const QVector<SharedVectorVariableT> &rOperands,
+                                                                  const QString &rName, int numThreads)
+{
+    if (rOperands.isEmpty() || !rTape.isCompiled() || (rTape.getVariableNames().size() != rOperands.size()))
+    {
+        return SharedVectorVariableT();
+    }
+
+    const int n = rOperands.first()->getDataSize();
+    for (const SharedVectorVariableT &pOperand : rOperands)
+    {
+        if (!pOperand || (pOperand->getDataSize() != n) || (n == 0))
+        {
+            return SharedVectorVariableT();
+        }
+    }
+
+    QVector<const double*> columns;
+    columns.reserve(rOperands.size());
+    for (const SharedVectorVariableT &pOperand : rOperands)
+    {
+        columns.append(pOperand->beginReadOnlyOperation());
+    }
+
+    QVector<double> result;
+    if (!columns.contains(nullptr))
+    {
+        result.resize(n);
+
+        // Do not spawn threads for short vectors, the fused pass is memory bound anyway
+        const int minSamplesPerThread = 65536;
+        if (numThreads <= 0)
+        {
+            numThreads = int(std::thread::hardware_concurrency());
+        }
+        numThreads = qBound(1, numThreads, qMax(n/minSamplesPerThread, 1));
+
+        if (numThreads == 1)
+        {
+            rTape.evaluate(columns.constData(), result.data(), size_t(n));
+        }
+        else
+        {
+            std::vector<std::thread> threads;
+            QVector< QVector<const double*> > chunkColumns(numThreads, columns);
+            for (int t=0; t<numThreads; ++t)
+            {
+                const int begin = int(qint64(n)*t/numThreads);
+                const int end = int(qint64(n)*(t+1)/numThreads);
+                for (const double *&rpColumn : chunkColumns[t])
+                {
+                    rpColumn += begin;
+                }
+                const double * const *pChunkColumns = chunkColumns[t].constData();
+                double *pChunkResult = result.data()+begin;
+                threads.emplace_back([&rTape, pChunkColumns, pChunkResult, begin, end]()
+                {
+                    rTape.evaluate(pChunkColumns, pChunkResult, size_t(end-begin));
+                });
+            }
+            for (std::thread &rThread : threads)
+            {
+                rThread.join();
+            }
+        }
+    }
+
+    for (int i=0; i<rOperands.size(); ++i)
+    {
+        rOperands[i]->endReadOnlyOperation(columns[i]);
+    }
+
+    if (result.isEmpty())
+    {
+        return SharedVectorVariableT();
+    }
+
+    SharedVectorVariableT pTempVar = createOrphanVariable(rName, rOperands.first()->getVariableType());
+    pTempVar->assignFrom(rOperands.first()->getSharedTimeOrFrequencyVector(), result);
+    return pTempVar;
+}
+
 void LogDataHandler2::setGenerationTimePlotOffset(int generation, double offset)
 {
     // Should we take current
@@ -2290,6 +2603,8 @@ void LogDataHandler2::removeGenerationCacheIfEmpty(const int gen)
 
 void LogDataHandler2::takeOwnershipOfData(LogDataHandler2 *pOtherHandler, const int otherGeneration)
 {
+    pOtherHandler->finishCollectingLogData();
+
     // If otherGeneration < -1 then take everything
     if (otherGeneration < -1)
     {
@@ -30,6 +30,7 @@
 
 #include <QVector>
 #include <QMap>
+#include <QHash>
 #include <QString>
 #include <QColor>
 #include <QObject>
@@ -43,6 +44,9 @@
 class PlotWindow;
 class ModelWidget;
 class LogDataGeneration;
+namespace SymHop {
+class EvaluationTape;
+}
 
 
 class LogDataHandler2 : public QObject
@@ -58,7 +62,9 @@ public:
     void setParentModel(ModelWidget *pParentModel);
     ModelWidget *getParentModel();
 
-    void collectLogDataFromModel(bool overWriteLastGeneration=false);
+    void collectLogDataFromModel(bool overWriteLastGeneration=false, bool collectPlottedFirst=false);
+    void finishCollectingLogData();
+    bool isCollectingLogData() const;
     void collectLogDataFromRemoteModel(QVector<RemoteResultVariable> &rResultVariables, bool overWriteLastGeneration=false);
     void importFromPlo(QString importFilePath=QString());
     void importFromCSV_AutoFormat(QString importFilePath=QString());
@@ -126,8 +132,8 @@ public:
     SharedMultiDataVectorCacheT getGenerationMultiCache(const int gen);
     void pruneGenerationCache(const int generation);
 
-    void incrementOpenPlotCurves();
-    void decrementOpenPlotCurves();
+    void incrementOpenPlotCurves(const QString &rFullName);
+    void decrementOpenPlotCurves(const QString &rFullName);
     bool hasOpenPlotCurves();
     void closePlotsWithCurvesBasedOnOwnedData();
 
@@ -154,6 +160,9 @@ public:
 
     SharedVectorVariableT elementWisePower(SharedVectorVariableT a, const double x);
 
+    SharedVectorVariableT evaluateVariableExpression(const SymHop::EvaluationTape &rTape, const QVector<SharedVectorVariableT> &rOperands,
+                                                     const QString &rName, int numThreads=1);
+
     void setGenerationTimePlotOffset(int generation, double offset);
 
     void takeOwnershipOfData(LogDataHandler2 *pOtherHandler, const int otherGeneration=-2);
@@ -165,6 +174,9 @@ public slots:
     bool registerQuantity(const QString &rFullName, const QString &rQuantity);
 
 
+private slots:
+    void collectPendingLogData();
+
 signals:
     void dataAdded();
     void dataAddedFromModel(bool);
@@ -177,6 +189,16 @@ private:
     typedef QMap< int, LogDataGeneration* > GenerationMapT;
     typedef QMap<int, SharedMultiDataVectorCacheT> GenerationCacheMapT;
 
+    //! @brief Variables of one port whose log data remains to be copied from the core into the generation cache
+    struct PortLogDataJob
+    {
+        const std::vector< std::vector<double> > *mpCoreData;
+        size_t mNumSamples;
+        SharedVectorVariableT mpTimeVariable;
+        QVector<int> mDataIds;
+        QVector<SharedVariableDescriptionT> mVariableDescriptions;
+    };
+
     SharedVectorVariableT insertCustomVectorVariable(const QVector<double> &rVector, SharedVariableDescriptionT pVarDesc);
     SharedVectorVariableT insertCustomVectorVariable(const QVector<double> &rVector, SharedVariableDescriptionT pVarDesc, const QString &rImportFileName);
     SharedVectorVariableT insertTimeVectorVariable(const QVector<double> &rTimeVector, SharedSystemHierarchyT pSysHierarchy);
@@ -189,7 +211,9 @@ private:
     SharedVectorVariableT insertFrequencyDomainVariable(SharedVectorVariableT pFrequencyVector, const QVector<double> &rDataVector, SharedVariableDescriptionT pVarDesc, const QString &rImportFileName);
     SharedVectorVariableT insertVariable(SharedVectorVariableT pVariable, QString keyName=QString(), int gen=-1);
 
-    bool collectLogDataFromSystem(SystemObject *pCurrentSystem, const QStringList &rSystemHieararchy, QMap<std::vector<double> *, SharedVectorVariableT> &rGenTimeVectors);
+    bool collectLogDataFromSystem(SystemObject *pCurrentSystem, const QStringList &rSystemHieararchy, QMap<std::vector<double> *, SharedVectorVariableT> &rGenTimeVectors,
+                                  QVector<PortLogDataJob> &rJobs);
+    void collectLogDataColumns(QVector<PortLogDataJob> &rJobs, const int generation);
 
     QString getNewCacheName(const QString &rDesiredName=QString());
     void removeGenerationCacheIfEmpty(const int gen);
@@ -197,6 +221,7 @@ private:
 
     ModelWidget *mpParentModel = nullptr;
     int mNumPlotCurves = 0;
+    QHash<QString, int> mPlottedVariables;
     int mCurrentGenerationNumber = -1;
 
     ImportedGenerationsMapT mImportedGenerationsMap;
@@ -205,6 +230,9 @@ private:
 
     QList<QDir> mCacheDirs;
     quint64 mCacheSubDirCtr = 0;
+
+    QVector<PortLogDataJob> mPendingLogDataJobs;
+    int mPendingLogDataGeneration = -1;
 };
 
 
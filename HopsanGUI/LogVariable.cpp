@@ -38,6 +38,8 @@
 #include "Utilities/GUIUtilities.h"
 #include "LogDataGeneration.h"
 #include "MessageHandler.h"
+#include "ComponentUtilities/SpectralAnalysis.h"
+#include "ComponentUtilities/SignalStatistics.h"
 
 #include <limits>
 #include <algorithm>
@@ -570,14 +572,14 @@ void VectorVariable::diffBy(SharedVectorVariableT pOther)
     {
         // Get data vectors
         DataVectorT* pThisData = mpCachedDataVector->beginFullVectorOperation();
-        DataVectorT* pOtherData = pOther->beginFullVectorOperation(); //!< @todo it would be nice to be able to check out read only
+        const double *pOtherData = pOther->beginReadOnlyOperation();
 
         // Check so that vectors have same size
-        if (pThisData->size() != pOtherData->size())
+        if (!pOtherData || (pThisData->size() != pOther->getDataSize()))
         {
             // Abort
             // Return data vectors
-            pOther->endFullVectorOperation(pOtherData);
+            pOther->endReadOnlyOperation(pOtherData);
             mpCachedDataVector->endFullVectorOperation(pThisData);
             //! @todo error message
             return;
@@ -586,7 +588,7 @@ void VectorVariable::diffBy(SharedVectorVariableT pOther)
         // Perform diff operation
         for(int i=0; i<pThisData->size()-1; ++i)
         {
-            (*pThisData)[i] = ((*pThisData)[i+1]-(*pThisData)[i])/((*pOtherData)[i+1]-(*pOtherData)[i]);
+            (*pThisData)[i] = ((*pThisData)[i+1]-(*pThisData)[i])/(pOtherData[i+1]-pOtherData[i]);
         }
         if (pThisData->size() > 1)
         {
@@ -595,7 +597,7 @@ void VectorVariable::diffBy(SharedVectorVariableT pOther)
 
 
         // Return data vectors
-        pOther->endFullVectorOperation(pOtherData);
+        pOther->endReadOnlyOperation(pOtherData);
         mpCachedDataVector->endFullVectorOperation(pThisData);
 
         emit dataChanged();
@@ -728,18 +730,11 @@ SharedVectorVariableT VectorVariable::toFrequencySpectrum(const SharedVectorVari
             }
         }
 
-        // Vector size has to be an even potential of 2.
-        // Calculate largest potential that is smaller than or equal to the vector size.
-#ifndef Q_OS_OSX
-        const int n = pow(2, int(log2(data.size()))); // This is odd.... /magse
-#else
-        const int n = (int)round(ldexp(2.0, int(log2(data.size()))));
-#endif
-        if(n != data.size())     // Vector is not an exact potential, so reduce it
+        // Any length can be transformed, but lengths with only the prime factors 2, 3 and 5 are much faster
+        // Resample to the largest such length, it is at most a few percent shorter than the data
+        const int n = int(hopsan::largestEfficientFFTSize(size_t(data.size())));
+        if(n != data.size())
         {
-            QString oldString, newString;
-            oldString.setNum(data.size());
-            newString.setNum(n);
             resampleVector(data, n);
             resampleVector(time, n);
         }
@@ -748,11 +743,9 @@ SharedVectorVariableT VectorVariable::toFrequencySpectrum(const SharedVectorVari
         double Ca, Cb;
         windowFunction(data, windowingFunction, Ca, Cb);
 
-        // Create a complex vector
-        QVector< std::complex<double> > vComplex = realToComplex(data);
-
-        // Apply the fourier transform
-        FFT(vComplex);
+        // Apply the fourier transform, only the non-redundant half (up to and including nyquist) is computed
+        QVector< std::complex<double> > vComplex(n/2+1);
+        hopsan::RealFFTPlan::get(size_t(n))->forward(data.constData(), vComplex.data());
 
         // Scalar multiply complex vector with its conjugate, and divide it with its size
         // Also build frequency vector
@@ -816,126 +809,48 @@ SharedVectorVariableT VectorVariable::toFrequencySpectrum(const SharedVectorVari
 //! @param[in] l3 Filter coefficient (used by MovingAverageVarianceRatioTest method)
 SharedVectorVariableT VectorVariable::identifySteadyState(const SteadyStateIdentificationMethodEnumT method, double tol, double win, double stdev, double l1, double l2, double l3)
 {
-    SharedVectorVariableT pRetVar = mpParentLogDataHandler->createOrphanVariable(this->getFullVariableName()+"_ss", TimeDomainType);
-
-    SharedVectorVariableT pTime = this->getSharedTimeOrFrequencyVector();
-    QVector<double> time = pTime->getDataVectorCopy();
-    QVector<double> data = this->getDataVectorCopy();
-
-    if(method == RectangularWindowTest) {
-        int nw = 0;
-        for(int i=0; i<time.size(); ++i) {
-            if(time[i] < win) {
-                pRetVar->append(time[i], 0);
-                nw = i+1;  //Update number of samples for window
-                continue;
-            }
-
-            //Compute first variance
-            double xmax = data[i-nw];
-            double xmin = data[i-nw];
-            for(int j=i-nw+1; j<i; ++j) {
-                if(data[j] > xmax) {
-                    xmax = data[j];
-                }
-                else if(data[j] < xmin) {
-                    xmin = data[j];
-                }
-            }
-
-            if(xmax-xmin < tol) {
-                pRetVar->append(time[i], 1);
-            }
-            else {
-                pRetVar->append(time[i], 0);
-            }
-        }
+    hopsan::SteadyStateMethodT coreMethod;
+    switch (method)
+    {
+    case RectangularWindowTest:
+        coreMethod = hopsan::RectangularWindowSteadyState;
+        break;
+    case VarianceRatioTest:
+        coreMethod = hopsan::VarianceRatioSteadyState;
+        break;
+    case MovingAverageVarianceRatioTest:
+        coreMethod = hopsan::MovingAverageVarianceRatioSteadyState;
+        break;
+    default:
+        return nullptr;
     }
-    else if(method == VarianceRatioTest) {
-
-        //Create randomized data vector
-        QVector<double> x;
-        x.resize(data.size());
-        for(int i=0; i<data.size(); ++i) {
-            x[i] = normalDistribution(data[i], stdev);
-        }
-
-        int nw = 0;
-        for(int i=0; i<time.size(); ++i) {
-            if(time[i] < win) {
-                pRetVar->append(time[i], 0);
-                nw = i+1;  //Update number of samples for window
-                continue;
-            }
-
-
-            //Compute average of window
-            double mean = 0;
-            for(int j=i-nw; j<i; ++j) {
-                mean += x[j];
-            }
-            mean /= nw;
-
-            //Compute first variance
-            double s1 = 0;
-            for(int j=i-nw; j<i; ++j) {
-                s1 += (x[j]-mean)*(x[j]-mean);
-            }
-            s1 /= (nw-1.0);
-
-            //Compute second variance
-            double s2 = 0;
-            for(int j=i-nw; j<i-1; ++j) {
-                s2 += (x[j+1]-x[j])*(x[j+1]-x[j]);
-            }
-            s2 /= (nw-1.0);
-
-            //Avoid division by zero
-            s1 = fmax(std::numeric_limits<double>::min(), fabs(s1));
-            s2 = fmax(std::numeric_limits<double>::min(), fabs(s2));
 
-            if(s1/s2 < tol) {
-                pRetVar->append(time[i], 1);
-            }
-            else {
-                pRetVar->append(time[i], 0);
-            }
-        }
+    SharedVectorVariableT pTime = this->getSharedTimeOrFrequencyVector();
+    if (!pTime || (pTime->getDataSize() != this->getDataSize()))
+    {
+        return nullptr;
     }
-    else if(method == MovingAverageVarianceRatioTest) {
-        double xf = 0;
-        double df = 0;
-        double xold = data[0];
-        pRetVar->append(time[0], 0);
-        for(int i=1; i<time.size(); ++i) {
-            double x = normalDistribution(data[i], stdev);
-
-            double vf = l2*(x-xf)*(x-xf);
-
-            xf = l1*x+(1.0-l1)*xf;
-
-            double s1 = (2.0-l1)/2.0*vf;
-
-            df = l3*(x-xold)*(x-xold) + (1-l3)*df;
-            double s2 = df/2.0;
-
-            //Avoid division by zero
-            s1 = fmax(std::numeric_limits<double>::min(), fabs(s1));
-            s2 = fmax(std::numeric_limits<double>::min(), fabs(s2));
 
-            if(s1/s2 < tol) {
-                pRetVar->append(time[i], 1);
-            }
-            else {
-                pRetVar->append(time[i], 0);
-            }
-            xold = x;
-        }
+    // Read directly from the cache, the result shares the time vector with this variable
+    std::vector<double> steadyState;
+    const double *pTimeData = pTime->beginReadOnlyOperation();
+    const double *pData = this->beginReadOnlyOperation();
+    bool isOK = false;
+    if (pTimeData && pData)
+    {
+        isOK = hopsan::identifySteadyState(coreMethod, pTimeData, pData, size_t(this->getDataSize()), tol, win, stdev, l1, l2, l3, steadyState);
     }
-    else {
+    this->endReadOnlyOperation(pData);
+    pTime->endReadOnlyOperation(pTimeData);
+    if (!isOK)
+    {
         return nullptr;
     }
-    return pRetVar;
+
+    SharedVariableDescriptionT pDesc = SharedVariableDescriptionT(new VariableDescription());
+    pDesc->mDataName = this->getFullVariableName()+"_ss";
+    pDesc->mVariableSourceType = ScriptVariableType;
+    return SharedVectorVariableT(new TimeDomainVariable(pTime, QVector<double>::fromStdVector(steadyState), this->getGeneration(), pDesc, SharedMultiDataVectorCacheT()));
 }
 
 
@@ -1007,13 +922,17 @@ double VectorVariable::averageOfData() const
 {
     double ret = 0;
     int i=0;
-    QVector<double> *pVector = mpCachedDataVector->beginFullVectorOperation();
-    for(; i<pVector->size(); ++i)
+    const double *pData = mpCachedDataVector->beginReadOnlyOperation();
+    if (pData)
     {
-        ret += pVector->at(i);
+        const int size = mpCachedDataVector->size();
+        for(; i<size; ++i)
+        {
+            ret += pData[i];
+        }
+        mpCachedDataVector->endReadOnlyOperation(pData);
     }
     ret /= i;
-    mpCachedDataVector->endFullVectorOperation(pVector);
     return ret;
 }
 
@@ -1021,19 +940,20 @@ double VectorVariable::minOfData(int &rIdx) const
 {
     rIdx = -1;
     double ret = std::numeric_limits<double>::max();
-    QVector<double> *pVector = mpCachedDataVector->beginFullVectorOperation();
-    if (pVector)
+    const double *pData = mpCachedDataVector->beginReadOnlyOperation();
+    if (pData)
     {
-        for(int i=0; i<pVector->size(); ++i)
+        const int size = mpCachedDataVector->size();
+        for(int i=0; i<size; ++i)
         {
-            const double &v = (*pVector)[i];
+            const double v = pData[i];
             if(v < ret)
             {
                 ret = v;
                 rIdx=i;
             }
         }
-        mpCachedDataVector->endFullVectorOperation(pVector);
+        mpCachedDataVector->endReadOnlyOperation(pData);
     }
     return ret;
 }
@@ -1047,11 +967,12 @@ double VectorVariable::minOfData() const
 
 void VectorVariable::elementWiseGt(QVector<double> &rResult, const double threshold) const
 {
-    QVector<double> *pVector = mpCachedDataVector->beginFullVectorOperation();
-    rResult.resize(pVector->size());
-    for(int i=0; i<pVector->size(); ++i)
+    const double *pData = mpCachedDataVector->beginReadOnlyOperation();
+    const int size = pData ? mpCachedDataVector->size() : 0;
+    rResult.resize(size);
+    for(int i=0; i<size; ++i)
     {
-        if ((*pVector)[i] > threshold)
+        if (pData[i] > threshold)
         {
             rResult[i] = 1;
         }
@@ -1060,18 +981,18 @@ void VectorVariable::elementWiseGt(QVector<double> &rResult, const double thresh
             rResult[i] = 0;
         }
     }
-    mpCachedDataVector->endFullVectorOperation(pVector);
+    mpCachedDataVector->endReadOnlyOperation(pData);
 }
 
 void VectorVariable::elementWiseGt(QVector<double> &rResult, const SharedVectorVariableT pOther) const
 {
-    QVector<double> *pThisData = mpCachedDataVector->beginFullVectorOperation();
-    QVector<double> *pOtherData = pOther->beginFullVectorOperation();
-    const int size = qMin(pThisData->size(), pOtherData->size());
+    const double *pThisData = mpCachedDataVector->beginReadOnlyOperation();
+    const double *pOtherData = pOther->beginReadOnlyOperation();
+    const int size = (pThisData && pOtherData) ? qMin(mpCachedDataVector->size(), pOther->getDataSize()) : 0;
     rResult.resize(size);
     for(int i=0; i<size; ++i)
     {
-        if ((*pThisData)[i] > (*pOtherData)[i])
+        if (pThisData[i] > pOtherData[i])
         {
             rResult[i] = 1;
         }
@@ -1080,17 +1001,18 @@ void VectorVariable::elementWiseGt(QVector<double> &rResult, const SharedVectorV
             rResult[i] = 0;
         }
     }
-    pOther->endFullVectorOperation(pOtherData);
-    mpCachedDataVector->endFullVectorOperation(pThisData);
+    pOther->endReadOnlyOperation(pOtherData);
+    mpCachedDataVector->endReadOnlyOperation(pThisData);
 }
 
 void VectorVariable::elementWiseLt(QVector<double> &rResult, const double threshold) const
 {
-    QVector<double> *pVector = mpCachedDataVector->beginFullVectorOperation();
-    rResult.resize(pVector->size());
-    for(int i=0; i<pVector->size(); ++i)
+    const double *pData = mpCachedDataVector->beginReadOnlyOperation();
+    const int size = pData ? mpCachedDataVector->size() : 0;
+    rResult.resize(size);
+    for(int i=0; i<size; ++i)
     {
-        if ((*pVector)[i] < threshold)
+        if (pData[i] < threshold)
         {
             rResult[i] = 1;
         }
@@ -1099,18 +1021,18 @@ void VectorVariable::elementWiseLt(QVector<double> &rResult, const double thresh
             rResult[i] = 0;
         }
     }
-    mpCachedDataVector->endFullVectorOperation(pVector);
+    mpCachedDataVector->endReadOnlyOperation(pData);
 }
 
 void VectorVariable::elementWiseLt(QVector<double> &rResult, const SharedVectorVariableT pOther) const
 {
-    QVector<double> *pThisData = mpCachedDataVector->beginFullVectorOperation();
-    QVector<double> *pOtherData = pOther->beginFullVectorOperation();
-    const int size = qMin(pThisData->size(), pOtherData->size());
+    const double *pThisData = mpCachedDataVector->beginReadOnlyOperation();
+    const double *pOtherData = pOther->beginReadOnlyOperation();
+    const int size = (pThisData && pOtherData) ? qMin(mpCachedDataVector->size(), pOther->getDataSize()) : 0;
     rResult.resize(size);
     for(int i=0; i<size; ++i)
     {
-        if ((*pThisData)[i] < (*pOtherData)[i])
+        if (pThisData[i] < pOtherData[i])
         {
             rResult[i] = 1;
         }
@@ -1119,17 +1041,18 @@ void VectorVariable::elementWiseLt(QVector<double> &rResult, const SharedVectorV
             rResult[i] = 0;
         }
     }
-    pOther->endFullVectorOperation(pOtherData);
-    mpCachedDataVector->endFullVectorOperation(pThisData);
+    pOther->endReadOnlyOperation(pOtherData);
+    mpCachedDataVector->endReadOnlyOperation(pThisData);
 }
 
 void VectorVariable::elementWiseEq(QVector<double> &rResult, const double value, const double eps) const
 {
-    QVector<double> *pVector = mpCachedDataVector->beginFullVectorOperation();
-    rResult.resize(pVector->size());
-    for(int i=0; i<pVector->size(); ++i)
+    const double *pData = mpCachedDataVector->beginReadOnlyOperation();
+    const int size = pData ? mpCachedDataVector->size() : 0;
+    rResult.resize(size);
+    for(int i=0; i<size; ++i)
     {
-        if (fuzzyEqual((*pVector)[i], value, eps))
+        if (fuzzyEqual(pData[i], value, eps))
         {
             rResult[i] = 1;
         }
@@ -1138,18 +1061,18 @@ void VectorVariable::elementWiseEq(QVector<double> &rResult, const double value,
             rResult[i] = 0;
         }
     }
-    mpCachedDataVector->endFullVectorOperation(pVector);
+    mpCachedDataVector->endReadOnlyOperation(pData);
 }
 
 void VectorVariable::elementWiseEq(QVector<double> &rResult, const SharedVectorVariableT pOther, const double eps) const
 {
-    QVector<double> *pThisData = mpCachedDataVector->beginFullVectorOperation();
-    QVector<double> *pOtherData = pOther->beginFullVectorOperation();
-    const int size = qMin(pThisData->size(), pOtherData->size());
+    const double *pThisData = mpCachedDataVector->beginReadOnlyOperation();
+    const double *pOtherData = pOther->beginReadOnlyOperation();
+    const int size = (pThisData && pOtherData) ? qMin(mpCachedDataVector->size(), pOther->getDataSize()) : 0;
     rResult.resize(size);
     for(int i=0; i<size; ++i)
     {
-        if (fuzzyEqual((*pThisData)[i], (*pOtherData)[i], eps))
+        if (fuzzyEqual(pThisData[i], pOtherData[i], eps))
         {
             rResult[i] = 1;
         }
@@ -1158,8 +1081,8 @@ void VectorVariable::elementWiseEq(QVector<double> &rResult, const SharedVectorV
             rResult[i] = 0;
         }
     }
-    pOther->endFullVectorOperation(pOtherData);
-    mpCachedDataVector->endFullVectorOperation(pThisData);
+    pOther->endReadOnlyOperation(pOtherData);
+    mpCachedDataVector->endReadOnlyOperation(pThisData);
 }
 
 bool VectorVariable::compare(SharedVectorVariableT pOther, const double eps) const
@@ -1168,22 +1091,23 @@ bool VectorVariable::compare(SharedVectorVariableT pOther, const double eps) con
     bool isOK=false;
     if (this->getDataSize() == pOther->getDataSize())
     {
-        QVector<double> *pThisData = mpCachedDataVector->beginFullVectorOperation();
-        QVector<double> *pOtherData = pOther->beginFullVectorOperation();
+        const double *pThisData = mpCachedDataVector->beginReadOnlyOperation();
+        const double *pOtherData = pOther->beginReadOnlyOperation();
         if (pThisData && pOtherData)
         {
             isOK=true;
-            for (int i=0; i<pThisData->size(); ++i)
+            const int size = mpCachedDataVector->size();
+            for (int i=0; i<size; ++i)
             {
-                if (!fuzzyEqual((*pThisData)[i], (*pOtherData)[i], eps))
+                if (!fuzzyEqual(pThisData[i], pOtherData[i], eps))
                 {
                     isOK = false;
                     break;
                 }
             }
         }
-        pOther->endFullVectorOperation(pOtherData);
-        mpCachedDataVector->endFullVectorOperation(pThisData);
+        pOther->endReadOnlyOperation(pOtherData);
+        mpCachedDataVector->endReadOnlyOperation(pThisData);
     }
     return isOK;
 }
@@ -1195,30 +1119,44 @@ bool VectorVariable::compare(SharedVectorVariableT pOther, const double eps) con
 int VectorVariable::lower_bound(const double value, const bool assumeSorted) const
 {
     int result = -1;
-    QVector<double> *pThisData = mpCachedDataVector->beginFullVectorOperation();
-    if (pThisData == nullptr) {
-        return result;
-    }
-
-    const QVector<double> &data = *pThisData;
 
+    // Binary search by peeking, this avoids reading all data from the disk cache (and checking out the data vector)
     if (assumeSorted) {
-        auto lower = std::lower_bound(std::begin(data), std::end(data), value);
-        if (lower != std::end(data)) {
-            result = static_cast<int>(std::distance(std::begin(data), lower));
+        int low = 0, high = mpCachedDataVector->size();
+        while (low < high) {
+            const int mid = low + (high-low)/2;
+            double midValue;
+            if (!mpCachedDataVector->peek(mid, midValue)) {
+                return result;
+            }
+            if (midValue < value) {
+                low = mid+1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        if (low < mpCachedDataVector->size()) {
+            result = low;
         }
+        return result;
     }
-    else {
-        // Search from start to end until first match
-        for (int i=0; i<data.size(); ++i) {
-            if (data[i] >= value) {
-                result = i;
-                break;
-            }
+
+    const double *pThisData = mpCachedDataVector->beginReadOnlyOperation();
+    if (pThisData == nullptr) {
+        return result;
+    }
+
+    // Search from start to end until first match
+    const int size = mpCachedDataVector->size();
+    for (int i=0; i<size; ++i) {
+        if (pThisData[i] >= value) {
+            result = i;
+            break;
         }
     }
 
-    mpCachedDataVector->endFullVectorOperation(pThisData);
+    mpCachedDataVector->endReadOnlyOperation(pThisData);
     return result;
 }
 
@@ -1232,6 +1170,18 @@ bool VectorVariable::endFullVectorOperation(QVector<double> *&rpData)
     return mpCachedDataVector->endFullVectorOperation(rpData);
 }
 
+//! @brief Gives read-only access to the data without checking it out, the pointer is valid for getDataSize() values
+//! @note Must be matched by a call to endReadOnlyOperation(), and the data must not be modified in between
+const double *VectorVariable::beginReadOnlyOperation() const
+{
+    return mpCachedDataVector->beginReadOnlyOperation();
+}
+
+void VectorVariable::endReadOnlyOperation(const double *&rpData) const
+{
+    mpCachedDataVector->endReadOnlyOperation(rpData);
+}
+
 
 //! @brief Appends one point to a curve, NEVER USE THIS UNLESS A CUSTOM (PRIVATE) X (TIME) VECTOR IS USED!
 void VectorVariable::append(const double t, const double y)
@@ -1269,19 +1219,20 @@ double VectorVariable::maxOfData(int &rIdx) const
 {
     rIdx = -1;
     double ret = -std::numeric_limits<double>::max();
-    QVector<double> *pVector = mpCachedDataVector->beginFullVectorOperation();
-    if (pVector)
+    const double *pData = mpCachedDataVector->beginReadOnlyOperation();
+    if (pData)
     {
-        for(int i=0; i<pVector->size(); ++i)
+        const int size = mpCachedDataVector->size();
+        for(int i=0; i<size; ++i)
         {
-            const double &v = (*pVector)[i];
+            const double v = pData[i];
             if(v > ret)
             {
                 ret = v;
                 rIdx = i;
             }
         }
-        mpCachedDataVector->endFullVectorOperation(pVector);
+        mpCachedDataVector->endReadOnlyOperation(pData);
     }
     return ret;
 }
@@ -1299,12 +1250,13 @@ void VectorVariable::minMaxOfData(double &rMin, double &rMax, int &rMinIdx, int
     rMin = std::numeric_limits<double>::max();
     rMax = -rMin;
 
-    QVector<double> *pVector = mpCachedDataVector->beginFullVectorOperation();
-    if (pVector)
+    const double *pData = mpCachedDataVector->beginReadOnlyOperation();
+    if (pData)
     {
-        for(int i=0; i<pVector->size(); ++i)
+        const int size = mpCachedDataVector->size();
+        for(int i=0; i<size; ++i)
         {
-            const double &v = (*pVector)[i];
+            const double v = pData[i];
             if(v < rMin)
             {
                 rMin = v;
@@ -1316,7 +1268,7 @@ void VectorVariable::minMaxOfData(double &rMin, double &rMax, int &rMinIdx, int
                 rMaxIdx = i;
             }
         }
-        mpCachedDataVector->endFullVectorOperation(pVector);
+        mpCachedDataVector->endReadOnlyOperation(pData);
     }
 }
 
@@ -1327,12 +1279,13 @@ bool VectorVariable::positiveNonZeroMinMaxOfData(double &rMin, double &rMax, int
     rMin = std::numeric_limits<double>::max();
     rMax = std::numeric_limits<double>::epsilon();
 
-    QVector<double> *pVector = mpCachedDataVector->beginFullVectorOperation();
-    if (pVector)
+    const double *pData = mpCachedDataVector->beginReadOnlyOperation();
+    if (pData)
     {
-        for(int i=0; i<pVector->size(); ++i)
+        const int size = mpCachedDataVector->size();
+        for(int i=0; i<size; ++i)
         {
-            const double &v = (*pVector)[i];
+            const double v = pData[i];
             if( (v < rMin) && (v > std::numeric_limits<double>::epsilon()) )
             {
                 rMin = v;
@@ -1344,28 +1297,67 @@ bool VectorVariable::positiveNonZeroMinMaxOfData(double &rMin, double &rMax, int
                 rMaxIdx = i;
             }
         }
-        mpCachedDataVector->endFullVectorOperation(pVector);
+        mpCachedDataVector->endReadOnlyOperation(pData);
     }
     return ((rMinIdx > -1) && (rMaxIdx>-1));
 }
 
 double VectorVariable::rmsOfData() const
 {
-    QVector<double> *pData = mpCachedDataVector->beginFullVectorOperation();
-    if(pData->isEmpty()) {
+    const int size = mpCachedDataVector->size();
+    const double *pData = mpCachedDataVector->beginReadOnlyOperation();
+    if((pData == 0) || (size == 0)) {
+        mpCachedDataVector->endReadOnlyOperation(pData);
         return 0;
     }
     double rms = 0;
-    for (int i=0; i<pData->size(); ++i)
+    for (int i=0; i<size; ++i)
     {
-        rms += (*pData)[i]*(*pData)[i];
+        rms += pData[i]*pData[i];
     }
-    rms /= pData->size();
+    rms /= size;
     rms = sqrt(rms);
-    mpCachedDataVector->endFullVectorOperation(pData);
+    mpCachedDataVector->endReadOnlyOperation(pData);
     return rms;
 }
 
+//! @brief Computes mean, RMS, min, max and integral of the data in one pass
+//! @details Variables without a time (or frequency) vector use all samples and unit sample spacing for the integral
+//! @param[in] minTime The start of the range
+//! @param[in] maxTime The end of the range
+//! @param[out] rStatistics The result
+//! @returns false if no samples are in the range
+bool VectorVariable::statisticsOfData(const double minTime, const double maxTime, hopsan::SignalStatistics &rStatistics) const
+{
+    const size_t size = size_t(getDataSize());
+    SharedVectorVariableT pTime = getSharedTimeOrFrequencyVector();
+    if (pTime && (size_t(pTime->getDataSize()) != size))
+    {
+        return false;
+    }
+
+    bool isOK = false;
+    const double *pTimeData = pTime ? pTime->beginReadOnlyOperation() : 0;
+    const double *pData = mpCachedDataVector->beginReadOnlyOperation();
+    if (pData && (pTimeData || !pTime))
+    {
+        if (pTimeData)
+        {
+            isOK = hopsan::computeSignalStatistics(pTimeData, pData, size, minTime, maxTime, rStatistics);
+        }
+        else
+        {
+            isOK = hopsan::computeSignalStatistics(0, pData, 0, size, rStatistics);
+        }
+    }
+    mpCachedDataVector->endReadOnlyOperation(pData);
+    if (pTime)
+    {
+        pTime->endReadOnlyOperation(pTimeData);
+    }
+    return isOK;
+}
+
 void VectorVariable::preventAutoRemoval()
 {
     mAllowAutoRemove = false;
@@ -1465,6 +1457,20 @@ QVector<double> VectorVariable::getDataVectorCopy() const
     return vec;
 }
 
+//! @brief Returns the values at specified indices, the indices must be sorted ascending and be in range
+QVector<double> VectorVariable::getDataAt(const QVector<int> &rIndices) const
+{
+    QVector<double> vec;
+    mpCachedDataVector->copyDataAt(rIndices, vec);
+    return vec;
+}
+
+//! @brief Returns the min/max pyramid used to decimate the data for plotting, it is built on first use
+SharedMinMaxPyramidT VectorVariable::getMinMaxPyramid() const
+{
+    return mpCachedDataVector->getMinMaxPyramid();
+}
+
 void VectorVariable::sendDataToStream(QTextStream &rStream, QString separator)
 {
     mpCachedDataVector->streamDataTo(rStream, separator);
@@ -1762,18 +1768,10 @@ void createBodeVariables(const SharedVectorVariableT pInput, const SharedVectorV
         return;
     }
 
-    // Reduce vector size if they are not equal to an even potential of 2, and inform user
-#ifndef Q_OS_OSX
-        int n = pow(2, int(log2(vRealOut.size()))); // Odd.... /magse
-#else
-        int n = (int)round(ldexp(2.0, int(log2(vRealOut.size()))));
-#endif
-    if(n != vRealOut.size())     //Vector is not an exact potential, so reduce it
+    // Reduce vector size to the largest length with only the prime factors 2, 3 and 5 (efficient FFT lengths)
+    const int n = int(hopsan::largestEfficientFFTSize(size_t(vRealOut.size())));
+    if(n != vRealOut.size())
     {
-        QString oldString, newString;
-        oldString.setNum(vRealOut.size());
-        newString.setNum(n);
-        //QMessageBox::information(gpMainWindowWidget, QWidget::tr("Wrong Vector Size"), "Size of data vector must be an even power of 2. Number of log samples was reduced from " + oldString + " to " + newString + ".");
         resampleVector(vRealOut, n);
         resampleVector(vRealIn, n);
     }
@@ -1783,29 +1781,28 @@ void createBodeVariables(const SharedVectorVariableT pInput, const SharedVectorV
     windowFunction(vRealIn, windowType, Ca, Cb);
     windowFunction(vRealOut, windowType, Ca, Cb);
 
-    //Create complex vectors
-    QVector< std::complex<double> > vCompIn = realToComplex(vRealIn);
-    QVector< std::complex<double> > vCompOut = realToComplex(vRealOut);
-
-    //Apply the fourier transforms
-    FFT(vCompOut);
-    FFT(vCompIn);
+    //Apply the fourier transforms (both in parallel), only the non-redundant half is computed
+    std::shared_ptr<const hopsan::RealFFTPlan> pPlan = hopsan::RealFFTPlan::get(size_t(n));
+    QVector< std::complex<double> > vCompIn(n/2+1), vCompOut(n/2+1);
+    std::vector<const double*> fftInputs = {vRealIn.constData(), vRealOut.constData()};
+    std::vector< std::complex<double>* > fftOutputs = {vCompIn.data(), vCompOut.data()};
+    hopsan::forwardRealFFTBatch(*pPlan, fftInputs, fftOutputs, 2);
 
     // Calculate the transfer function G and then the bode vectors
     QVector< std::complex<double> > G;
     QVector<double> vRe, vIm, vImNeg, vBodeGain, vBodePhase, vBodePhaseUncorrected, freq;
     // Reserve memory
-    G.reserve(vCompIn.size()/2);
-    vRe.reserve(vCompIn.size()/2);
-    vIm.reserve(vCompIn.size()/2);
-    vImNeg.reserve(vCompIn.size()/2);
-    vBodeGain.reserve(vCompIn.size()/2);
-    vBodePhase.reserve(vCompIn.size()/2);
-    vBodePhaseUncorrected.reserve(vCompIn.size()/2);
-    freq.reserve(vCompIn.size()/2);
+    G.reserve(n/2);
+    vRe.reserve(n/2);
+    vIm.reserve(n/2);
+    vImNeg.reserve(n/2);
+    vBodeGain.reserve(n/2);
+    vBodePhase.reserve(n/2);
+    vBodePhaseUncorrected.reserve(n/2);
+    freq.reserve(n/2);
 
     double phaseCorrection=0;
-    for(int i=0; i<vCompIn.size()/2; ++i)
+    for(int i=0; i<n/2; ++i)
     {
         if(vCompIn[i] == std::complex<double>(0,0))        //Check for division by zero
         {
@@ -46,6 +46,10 @@
 #include "common.h"
 #include "UnitScale.h"
 
+namespace hopsan {
+struct SignalStatistics;
+}
+
 #define TIMEVARIABLENAME "Time"
 #define FREQUENCYVARIABLENAME "Frequency"
 
@@ -163,6 +167,8 @@ public:
     // Functions that only read data
     int getDataSize() const;
     QVector<double> getDataVectorCopy() const;
+    QVector<double> getDataAt(const QVector<int> &rIndices) const;
+    SharedMinMaxPyramidT getMinMaxPyramid() const;
     double first() const;
     double last() const;
     bool indexInRange(const int idx) const;
@@ -176,6 +182,7 @@ public:
     void minMaxOfData(double &rMin, double &rMax, int &rMinIdx, int &rMaxIdx) const;
     bool positiveNonZeroMinMaxOfData(double &rMin, double &rMax, int &rMinIdx, int &rMaxIdx) const;
     double rmsOfData() const;
+    bool statisticsOfData(const double minTime, const double maxTime, hopsan::SignalStatistics &rStatistics) const;
     void elementWiseGt(QVector<double> &rResult, const double threshold) const;
     void elementWiseGt(QVector<double> &rResult, const SharedVectorVariableT pOther) const;
     void elementWiseLt(QVector<double> &rResult, const double threshold) const;
@@ -188,6 +195,8 @@ public:
     // Check out and return pointers to data (move to ram if necessary)
     QVector<double> *beginFullVectorOperation();
     bool endFullVectorOperation(QVector<double> *&rpData);
+    const double *beginReadOnlyOperation() const;
+    void endReadOnlyOperation(const double *&rpData) const;
 
     // Functions that only read data but that require reimplementation in derived classes
     virtual const SharedVectorVariableT getSharedTimeOrFrequencyVector() const;
@@ -43,6 +43,7 @@
 #include "GraphicsView.h"
 #include "GraphicsViewPort.h"
 #include "GUIObjects/GUIContainerObject.h"
+#include "InitializationThread.h"
 #include "MessageHandler.h"
 #include "MainWindow.h"
 #include "ModelHandler.h"
@@ -325,18 +326,29 @@ ModelWidget *ModelHandler::loadModel(QString modelFileName, LoadOptions options)
     }
     QFileInfo modelFileInfo(modelFile);
 
-    // Make sure file not already open
+    // Make sure file not already open, or being opened
     if(!options.testFlag(IgnoreAlreadyOpen)) {
+        bool isAlreadyOpen = mParsingModelFiles.contains(modelFileInfo.absoluteFilePath());
         for(int t=0; t!=mModelPtrs.size(); ++t)
         {
             if(this->getTopLevelSystem(t)->getModelFileInfo().filePath() == modelFileInfo.filePath() && gpCentralTabWidget->indexOf(mModelPtrs[t]) > -1)
             {
-                QMessageBox::information(gpMainWindowWidget, tr("Error"), tr("Unable to load model. File is already open."));
-                return nullptr;
+                isAlreadyOpen = true;
             }
         }
+        if(isAlreadyOpen)
+        {
+            QMessageBox::information(gpMainWindowWidget, tr("Error"), tr("Unable to load model. File is already open."));
+            return nullptr;
+        }
     }
 
+    // Parse the file before the model widget is created, events are processed while the parser runs
+    ModelFileParserThread parserThread(modelFileInfo.absoluteFilePath(), HMF_ROOTTAG);
+    mParsingModelFiles.append(modelFileInfo.absoluteFilePath());
+    parserThread.parseAndWait();
+    mParsingModelFiles.removeOne(modelFileInfo.absoluteFilePath());
+
     ModelWidget *pNewModel = new ModelWidget(this, gpCentralTabWidget);
     connect(pNewModel->getSimulationThreadHandler(), SIGNAL(startSimulation()), gpMainWindow, SLOT(hideSimulateButton()));
     connect(pNewModel->getSimulationThreadHandler(), SIGNAL(done(bool)), gpMainWindow, SLOT(showSimulateButton()));
@@ -346,7 +358,7 @@ ModelWidget *ModelHandler::loadModel(QString modelFileName, LoadOptions options)
     }
 
    addModelWidget(pNewModel, modelFileInfo.baseName(), options);
-   bool loadOK = pNewModel->loadModel(modelFile);
+   bool loadOK = pNewModel->loadModel(modelFile, parserThread);
    if (loadOK) {
        emit newModelWidgetAdded();
        if(!options.testFlag(Detatched)) {
@@ -151,6 +151,7 @@ private:
 
     QList<ModelWidget*> mModelPtrs;
     QList<TextEditorWidget*> mTextEditors;
+    QStringList mParsingModelFiles;
     int mCurrentIdx;
     int mNumberOfUntitledModels;
     int mNumberOfUntitledScripts;
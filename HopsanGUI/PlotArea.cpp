@@ -397,6 +397,8 @@ void PlotArea::addCurve(PlotCurve *pCurve, PlotCurveStyle style)
 
     // Connect some signals from the curve
     connect(pCurve, SIGNAL(curveDataUpdated()), this, SLOT(rescaleAxesToCurves()));
+    // Decimated curves need to fetch new samples when zooming or panning (queued, since this is emitted during replot)
+    connect(mpQwtPlot->axisWidget(QwtPlot::xBottom), SIGNAL(scaleDivChanged()), pCurve, SLOT(updateVisibleSamples()), Qt::QueuedConnection);
     connect(pCurve, SIGNAL(customXDataChanged(PlotCurve*)), this, SLOT(determineCurveXDataUnitScale(PlotCurve*)));
     connect(pCurve, SIGNAL(customXDataChanged(PlotCurve*)), this, SLOT(refreshPlotAreaCustomXData()));
     connect(pCurve, SIGNAL(curveInfoUpdated()), this, SLOT(updateAxisLabels()));
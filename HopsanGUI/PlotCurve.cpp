@@ -46,7 +46,9 @@
 
 //Other includes
 #include <limits>
+#include <cmath>
 #include <qwt_plot_zoomer.h>
+#include <qwt_scale_div.h>
 #include <QColorDialog>
 #include <QDialog>
 #include <QPushButton>
@@ -57,6 +59,9 @@
 
 namespace {
 const double DoubleMax = std::numeric_limits<double>::max();
+// Curves with fewer samples are always fetched and drawn in full
+const int MinNumSamplesToDecimate = 100000;
+const int MinNumDecimationBuckets = 512;
 
 
 class AlignmentSelectionStruct
@@ -132,6 +137,19 @@ public:
         }
     }
 
+    //! @brief Converts a value in plot units back to data units (the inverse of convertVector)
+    double convertToData(const double plotValue) const {
+        double direction = mInvert ? -1.0 : 1.0;
+        if (mUc.isExpression()) {
+            return mUc.convertToBase((plotValue - mLocalOffset)*direction) - mDataPlotOffsett;
+        }
+        else {
+            const double scaleFromBaseToDesiredUnit = mLocalScale*direction/mUc.scaleToDouble(1.0);
+            const double offsetInBaseUnit = mDataPlotOffsett - mUc.offsetToDouble();
+            return (plotValue - mLocalOffset)/scaleFromBaseToDesiredUnit - offsetInBaseUnit;
+        }
+    }
+
     UnitConverter mUc;
     double mDataPlotOffsett;
     bool mInvert;
@@ -151,6 +169,8 @@ PlotCurve::PlotCurve(SharedVectorVariableT data, const QwtPlot::Axis axisY, cons
     mpParentPlotArea = nullptr;
     mHaveCustomData = false;
     mShowVsSamples = false;
+    mIsDecimated = false;
+    mDecimatedFirstIdx = mDecimatedLastIdx = mDecimatedNumBuckets = -1;
     mData = data;
     mSetGeneration = mData->getGeneration();
     mSetGenerationIsValid = true;
@@ -189,7 +209,7 @@ PlotCurve::PlotCurve(SharedVectorVariableT data, const QwtPlot::Axis axisY, cons
 
     if (mData->getLogDataHandler())
     {
-        mData->getLogDataHandler()->incrementOpenPlotCurves();
+        mData->getLogDataHandler()->incrementOpenPlotCurves(mData->getFullVariableName());
     }
 }
 
@@ -205,7 +225,7 @@ PlotCurve::~PlotCurve()
     LogDataHandler2* pDataHandler = mData->getLogDataHandler();
     if (pDataHandler)
     {
-        pDataHandler->decrementOpenPlotCurves();
+        pDataHandler->decrementOpenPlotCurves(mData->getFullVariableName());
     }
 
     // Delete custom data if any
@@ -1181,13 +1201,15 @@ void PlotCurve::updateCurve()
     // Handle complex variables in a special way
     if (mData->getVariableType() == ComplexType)
     {
+        mIsDecimated = false;
         ComplexVectorVariable *pComplexVar = qobject_cast<ComplexVectorVariable*>(mData.data());
         if (pComplexVar)
         {
             setSamples(pComplexVar->getRealDataCopy(), pComplexVar->getImagDataCopy());
         }
     }
-    else
+    // Very long curves only fetch the decimated visible range
+    else if (!updateDecimatedSamples(true))
     {
         QVector<double> tempX, tempY;
         // We copy here, it should be faster then peek (at least when data is cached on disc)
@@ -1234,6 +1256,132 @@ void PlotCurve::updateCurve()
     emit curveDataUpdated();
 }
 
+//! @brief Refetches decimated samples when the visible x-range has changed
+void PlotCurve::updateVisibleSamples()
+{
+    if (mIsDecimated && updateDecimatedSamples(false) && plot())
+    {
+        plot()->replot();
+    }
+}
+
+//! @brief Fetches min/max decimated samples for the visible x-range, for curves with very many samples
+//! @details The data is decimated using its min/max pyramid so that at most a few points per pixel are fetched, and unit
+//! conversion is only applied to the fetched points. Curves with custom x-data are never decimated, since decimation
+//! assumes that x increases with the sample index.
+//! @param[in] force Fetch samples even if the visible range has not changed since the last call
+//! @returns True if the curve is decimated and new samples were set
+bool PlotCurve::updateDecimatedSamples(const bool force)
+{
+    const int numSamples = mData->getDataSize();
+    SharedVectorVariableT pTimeOrFrequency;
+    if (!mShowVsSamples)
+    {
+        pTimeOrFrequency = mData->getSharedTimeOrFrequencyVector();
+    }
+    if ((numSamples < MinNumSamplesToDecimate) || (mCustomXdata && !mShowVsSamples) ||
+        (pTimeOrFrequency && (pTimeOrFrequency->getDataSize() != numSamples)))
+    {
+        mIsDecimated = false;
+        return false;
+    }
+    SharedMinMaxPyramidT pPyramid = mData->getMinMaxPyramid();
+    if (pPyramid.isNull())
+    {
+        mIsDecimated = false;
+        return false;
+    }
+
+    const bool invertYData = mData->isPlotInverted();
+    DataUnitConverter yConverter(mCurveDataUnitScale, mData->getGenerationPlotOffsetIfTime(), invertYData, mCurveExtraDataScale, mCurveExtraDataOffset);
+    constexpr bool notInverted = false;
+    constexpr double localCurveTFScale = 1.0;
+    constexpr double localCurveTFOffset = 0.0;
+    const double timeDataOffset = pTimeOrFrequency ? pTimeOrFrequency->getGenerationPlotOffsetIfTime() : 0.0;
+    DataUnitConverter xConverter(mCurveTFUnitScale, timeDataOffset, notInverted, localCurveTFScale, localCurveTFOffset);
+
+    // Find the index range of the visible x-range (plus one sample on each side so that lines reach the plot edges)
+    int firstIdx = 0;
+    int lastIdx = numSamples-1;
+    int numBuckets = MinNumDecimationBuckets;
+    if (plot())
+    {
+        const QwtScaleDiv &rScaleDiv = plot()->axisScaleDiv(xAxis());
+        double xMin = rScaleDiv.lowerBound();
+        double xMax = rScaleDiv.upperBound();
+        if (pTimeOrFrequency)
+        {
+            xMin = xConverter.convertToData(xMin);
+            xMax = xConverter.convertToData(xMax);
+            if (xMin > xMax)
+            {
+                qSwap(xMin, xMax);
+            }
+            const int minIdx = pTimeOrFrequency->lower_bound(xMin, true);
+            const int maxIdx = pTimeOrFrequency->lower_bound(xMax, true);
+            firstIdx = (minIdx < 0) ? numSamples-1 : qMax(minIdx-1, 0);
+            lastIdx = (maxIdx < 0) ? numSamples-1 : maxIdx;
+        }
+        else
+        {
+            firstIdx = qBound(0, int(std::floor(qMin(xMin, xMax))), numSamples-1);
+            lastIdx = qBound(0, int(std::ceil(qMax(xMin, xMax))), numSamples-1);
+        }
+        numBuckets = qMax(plot()->canvas()->width(), MinNumDecimationBuckets);
+    }
+
+    if (!force && mIsDecimated && (firstIdx == mDecimatedFirstIdx) && (lastIdx == mDecimatedLastIdx) && (numBuckets == mDecimatedNumBuckets))
+    {
+        return false;
+    }
+    mDecimatedFirstIdx = firstIdx;
+    mDecimatedLastIdx = lastIdx;
+    mDecimatedNumBuckets = numBuckets;
+
+    QVector<int> indices;
+    pPyramid->decimate(firstIdx, lastIdx, numBuckets, indices);
+
+    QVector<double> tempX, tempY;
+    tempY = mData->getDataAt(indices);
+    yConverter.convertVector(tempY);
+    if (pTimeOrFrequency)
+    {
+        tempX = pTimeOrFrequency->getDataAt(indices);
+        xConverter.convertVector(tempX);
+    }
+    else
+    {
+        tempX.resize(indices.size());
+        for (int i=0; i<tempX.size(); ++i)
+        {
+            tempX[i] = indices[i];
+        }
+    }
+    setSamples(tempX, tempY);
+
+    // Remember the bounding rect of all data, so that axis auto scaling is not limited to the visible range
+    QVector<double> yLimits(2), xLimits(2);
+    pPyramid->getMinMax(yLimits[0], yLimits[1]);
+    yConverter.convertVector(yLimits);
+    if (pTimeOrFrequency)
+    {
+        xLimits[0] = pTimeOrFrequency->first();
+        xLimits[1] = pTimeOrFrequency->last();
+        xConverter.convertVector(xLimits);
+    }
+    else
+    {
+        xLimits[0] = 0;
+        xLimits[1] = numSamples-1;
+    }
+    const double xLow = qMin(xLimits[0], xLimits[1]);
+    const double yLow = qMin(yLimits[0], yLimits[1]);
+    mDecimatedBoundingRect = QRectF(xLow, yLow, qMax(xLimits[0], xLimits[1])-xLow, qMax(yLimits[0], yLimits[1])-yLow);
+
+    mIsDecimated = true;
+    return true;
+}
+
 void PlotCurve::updateCurveName()
 {
     refreshCurveTitle();
@@ -1615,7 +1763,7 @@ QList<QwtLegendData> PlotCurve::legendData() const
 //! @note This is related to issue #1151
 QRectF PlotCurve::boundingRect() const
 {
-    QRectF rect = QwtPlotCurve::boundingRect();
+    QRectF rect = mIsDecimated ? mDecimatedBoundingRect : QwtPlotCurve::boundingRect();
     if (std::isinf(rect.width()) || std::isinf(rect.height()))
     {
         qDebug() << "---------------- Bounding rect        : " << rect;
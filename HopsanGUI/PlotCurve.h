@@ -186,6 +186,7 @@ public slots:
 
 private slots:
     void updateCurve();
+    void updateVisibleSamples();
     void updateCurveName();
     void dataIsBeingRemoved();
     void customXDataIsBeingRemoved();
@@ -193,6 +194,7 @@ private slots:
 private:
     // Private member functions
     void deleteCustomData();
+    bool updateDecimatedSamples(const bool force);
     void connectDataSignals();
     void connectCustomXDataSignals();
     void disconnectDataSignals();
@@ -205,6 +207,11 @@ private:
     bool mHaveCustomData;
     bool mShowVsSamples;
 
+    // Decimated curve data (only the visible range is fetched for very long curves)
+    bool mIsDecimated;
+    int mDecimatedFirstIdx, mDecimatedLastIdx, mDecimatedNumBuckets;
+    QRectF mDecimatedBoundingRect;
+
     // Curve scale
     UnitConverter mCurveCustomXDataUnitScale;
     UnitConverter mCurveDataUnitScale;
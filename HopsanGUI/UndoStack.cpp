@@ -40,12 +40,373 @@
 #include "MessageHandler.h"
 #include "Widgets/UndoWidget.h"
 
+#include <QTextStream>
+
+//! @brief Serialized XML in undo actions larger than this (in bytes) is compressed
+static const int compressUndoXmlThreshold = 1024;
+//! @brief The oldest undo posts are discarded when the undo stack uses more memory than this (in bytes)
+static const qint64 maxUndoMemoryUsage = 64*1024*1024;
+
+
+//! @brief Saves an object (model object, connector or widget) to XML and stores it in an undo action
+template<typename T>
+static void saveXmlToAction(T *pItem, UndoAction &rAction)
+{
+    QDomDocument domDocument;
+    QDomElement stuffElement = domDocument.createElement("stuff");
+    domDocument.appendChild(stuffElement);
+    pItem->saveToDomElement(stuffElement);
+    rAction.setXml(stuffElement);
+}
+
+static void setConnectorEnds(UndoAction &rAction, Connector *pConnector)
+{
+    rAction.mStartComponent = pConnector->getStartComponentName();
+    rAction.mStartPort = pConnector->getStartPortName();
+    rAction.mEndComponent = pConnector->getEndComponentName();
+    rAction.mEndPort = pConnector->getEndPortName();
+}
+
+static void setConnectorEnds(UndoAction &rAction, const QDomElement &rConnectorElement)
+{
+    rAction.mStartComponent = rConnectorElement.attribute(HMF_CONNECTORSTARTCOMPONENTTAG);
+    rAction.mStartPort = rConnectorElement.attribute(HMF_CONNECTORSTARTPORTTAG);
+    rAction.mEndComponent = rConnectorElement.attribute(HMF_CONNECTORENDCOMPONENTTAG);
+    rAction.mEndPort = rConnectorElement.attribute(HMF_CONNECTORENDPORTTAG);
+}
+
+static void appendConnectorEnds(QDomElement &rStuffElement, const UndoAction &rAction)
+{
+    QDomElement connectorElement = appendDomElement(rStuffElement, HMF_CONNECTORTAG);
+    connectorElement.setAttribute(HMF_CONNECTORSTARTCOMPONENTTAG, rAction.mStartComponent);
+    connectorElement.setAttribute(HMF_CONNECTORSTARTPORTTAG, rAction.mStartPort);
+    connectorElement.setAttribute(HMF_CONNECTORENDCOMPONENTTAG, rAction.mEndComponent);
+    connectorElement.setAttribute(HMF_CONNECTORENDPORTTAG, rAction.mEndPort);
+}
+
+//! @brief Returns the XML tag used for the model object in an added or deleted object action
+static QString modelObjectTag(const QString &rWhat)
+{
+    if (rWhat == UNDO_ADDEDSYSTEMPORT || rWhat == UNDO_DELETEDSYSTEMPORT)
+    {
+        return HMF_SYSTEMPORTTAG;
+    }
+    else if (rWhat == UNDO_ADDEDSUBSYSTEM || rWhat == UNDO_DELETEDSUBSYSTEM)
+    {
+        return HMF_SYSTEMTAG;
+    }
+    return HMF_COMPONENTTAG;
+}
+
+
+//! @class UndoAction
+//! @brief The UndoAction class stores one typed change (delta) in the undo stack
+//!
+//! Which members are used depends on the action type (mWhat). Added objects and connectors only remember their names, their XML is saved
+//! when the addition is undone (so that it can be redone) and released again when it is redone. Deleted objects, connectors and widgets keep
+//! their XML, serialized to a compact string that is compressed if large. This is much smaller than keeping the DOM nodes.
+//!
+
+UndoAction::UndoAction(const QString &rWhat)
+{
+    mWhat = rWhat;
+    mAngle = 0;
+    mIndex = 0;
+    mIsVisible = false;
+    mXmlIsCompressed = false;
+}
+
+
+//! @brief Saves the action to a "stuff" element in the (hmf) undo XML format
+//! @param[in] rPostElement The undo post element to append the action to
+void UndoAction::saveToDomElement(QDomElement &rPostElement) const
+{
+    QDomElement stuffElement;
+    if (hasXml())
+    {
+        QDomDocument xmlDocument;
+        stuffElement = rPostElement.ownerDocument().importNode(getXml(xmlDocument), true).toElement();
+        rPostElement.appendChild(stuffElement);
+    }
+    else
+    {
+        stuffElement = appendDomElement(rPostElement, "stuff");
+    }
+    stuffElement.setAttribute("what", mWhat);
+
+    if (mWhat == UNDO_ADDEDOBJECT || mWhat == UNDO_ADDEDSYSTEMPORT || mWhat == UNDO_ADDEDSUBSYSTEM)
+    {
+        if (!hasXml())
+        {
+            appendDomElement(stuffElement, modelObjectTag(mWhat)).setAttribute(HMF_NAMETAG, mObjectName);
+        }
+    }
+    else if (mWhat == UNDO_ADDEDCONNECTOR)
+    {
+        if (!hasXml())
+        {
+            appendConnectorEnds(stuffElement, *this);
+        }
+    }
+    else if (mWhat == UNDO_RENAME)
+    {
+        stuffElement.setAttribute("oldname", mObjectName);
+        stuffElement.setAttribute("newname", mNewObjectName);
+    }
+    else if (mWhat == UNDO_MODIFIEDCONNECTOR)
+    {
+        stuffElement.setAttribute("linenumber", mIndex);
+        appendDomValueNode2(stuffElement, "oldpos", mOldPos.x(), mOldPos.y());
+        appendDomValueNode2(stuffElement, "newpos", mNewPos.x(), mNewPos.y());
+        appendConnectorEnds(stuffElement, *this);
+    }
+    else if (mWhat == UNDO_MOVEDOBJECT)
+    {
+        stuffElement.setAttribute(HMF_NAMETAG, mObjectName);
+        appendDomValueNode2(stuffElement, "oldpos", mOldPos.x(), mOldPos.y());
+        appendDomValueNode2(stuffElement, "newpos", mNewPos.x(), mNewPos.y());
+    }
+    else if (mWhat == UNDO_MOVEDCONNECTOR)
+    {
+        setQrealAttribute(stuffElement, "dx", mNewPos.x()-mOldPos.x());
+        setQrealAttribute(stuffElement, "dy", mNewPos.y()-mOldPos.y());
+        appendConnectorEnds(stuffElement, *this);
+    }
+    else if (mWhat == UNDO_ROTATE)
+    {
+        stuffElement.setAttribute("objectname", mObjectName);
+        setQrealAttribute(stuffElement, "angle", mAngle);
+    }
+    else if (mWhat == UNDO_VERTICALFLIP || mWhat == UNDO_HORIZONTALFLIP)
+    {
+        stuffElement.setAttribute("objectname", mObjectName);
+    }
+    else if (mWhat == UNDO_CHANGEDPARAMETER)
+    {
+        stuffElement.setAttribute("parametername", mParameterName);
+        stuffElement.setAttribute("oldvalue", mOldValue);
+        stuffElement.setAttribute("newvalue", mNewValue);
+        stuffElement.setAttribute("objectname", mObjectName);
+    }
+    else if (mWhat == UNDO_NAMEVISIBILITYCHANGE || mWhat == UNDO_ALWAYSVISIBLECHANGE)
+    {
+        stuffElement.setAttribute("objectname", mObjectName);
+        stuffElement.setAttribute("isvisible", mIsVisible);
+    }
+    else if (mWhat == UNDO_ADDEDTEXTBOXWIDGET || mWhat == UNDO_DELETEDTEXTBOXWIDGET || mWhat == UNDO_MODIFIEDTEXTBOXWIDGET)
+    {
+        stuffElement.setAttribute("index", mIndex);
+    }
+    else if (mWhat == UNDO_RESIZEDTEXTBOXWIDGET)
+    {
+        stuffElement.setAttribute("index", mIndex);
+        setQrealAttribute(stuffElement, "w_old", mOldSize.width());
+        setQrealAttribute(stuffElement, "h_old", mOldSize.height());
+        setQrealAttribute(stuffElement, "w_new", mNewSize.width());
+        setQrealAttribute(stuffElement, "h_new", mNewSize.height());
+        appendDomValueNode2(stuffElement, "oldpos", mOldPos.x(), mOldPos.y());
+        appendDomValueNode2(stuffElement, "newpos", mNewPos.x(), mNewPos.y());
+    }
+    else if (mWhat == UNDO_MOVEDWIDGET)
+    {
+        stuffElement.setAttribute("index", mIndex);
+        appendDomValueNode2(stuffElement, "oldpos", mOldPos.x(), mOldPos.y());
+        appendDomValueNode2(stuffElement, "newpos", mNewPos.x(), mNewPos.y());
+    }
+}
+
+
+//! @brief Loads the action from a "stuff" element in the (hmf) undo XML format
+//! @param[in] rStuffElement The element to load from
+void UndoAction::loadFromDomElement(const QDomElement &rStuffElement)
+{
+    double x, y;
+    mWhat = rStuffElement.attribute("what");
+    clearXml();
+
+    if (mWhat == UNDO_DELETEDOBJECT || mWhat == UNDO_DELETEDSYSTEMPORT || mWhat == UNDO_DELETEDSUBSYSTEM)
+    {
+        mObjectName = rStuffElement.firstChildElement(modelObjectTag(mWhat)).attribute(HMF_NAMETAG);
+        setXml(rStuffElement);
+    }
+    else if (mWhat == UNDO_ADDEDOBJECT || mWhat == UNDO_ADDEDSYSTEMPORT || mWhat == UNDO_ADDEDSUBSYSTEM)
+    {
+        // The object exists, its XML is saved again if the addition is undone
+        mObjectName = rStuffElement.firstChildElement(modelObjectTag(mWhat)).attribute(HMF_NAMETAG);
+    }
+    else if (mWhat == UNDO_DELETEDCONNECTOR)
+    {
+        setConnectorEnds(*this, rStuffElement.firstChildElement(HMF_CONNECTORTAG));
+        setXml(rStuffElement);
+    }
+    else if (mWhat == UNDO_ADDEDCONNECTOR)
+    {
+        setConnectorEnds(*this, rStuffElement.firstChildElement(HMF_CONNECTORTAG));
+    }
+    else if (mWhat == UNDO_RENAME)
+    {
+        mObjectName = rStuffElement.attribute("oldname");
+        mNewObjectName = rStuffElement.attribute("newname");
+    }
+    else if (mWhat == UNDO_MODIFIEDCONNECTOR)
+    {
+        mIndex = rStuffElement.attribute("linenumber").toInt();
+        parseDomValueNode2(rStuffElement.firstChildElement("oldpos"), x, y);
+        mOldPos = QPointF(x, y);
+        parseDomValueNode2(rStuffElement.firstChildElement("newpos"), x, y);
+        mNewPos = QPointF(x, y);
+        setConnectorEnds(*this, rStuffElement.firstChildElement(HMF_CONNECTORTAG));
+    }
+    else if (mWhat == UNDO_MOVEDOBJECT)
+    {
+        mObjectName = rStuffElement.attribute(HMF_NAMETAG);
+        parseDomValueNode2(rStuffElement.firstChildElement("oldpos"), x, y);
+        mOldPos = QPointF(x, y);
+        parseDomValueNode2(rStuffElement.firstChildElement("newpos"), x, y);
+        mNewPos = QPointF(x, y);
+    }
+    else if (mWhat == UNDO_MOVEDCONNECTOR)
+    {
+        mOldPos = QPointF(0, 0);
+        mNewPos = QPointF(rStuffElement.attribute("dx").toDouble(), rStuffElement.attribute("dy").toDouble());
+        setConnectorEnds(*this, rStuffElement.firstChildElement(HMF_CONNECTORTAG));
+    }
+    else if (mWhat == UNDO_ROTATE)
+    {
+        mObjectName = rStuffElement.attribute("objectname");
+        mAngle = rStuffElement.attribute("angle").toDouble();
+    }
+    else if (mWhat == UNDO_VERTICALFLIP || mWhat == UNDO_HORIZONTALFLIP)
+    {
+        mObjectName = rStuffElement.attribute("objectname");
+    }
+    else if (mWhat == UNDO_CHANGEDPARAMETER)
+    {
+        mObjectName = rStuffElement.attribute("objectname");
+        mParameterName = rStuffElement.attribute("parametername");
+        mOldValue = rStuffElement.attribute("oldvalue");
+        mNewValue = rStuffElement.attribute("newvalue");
+    }
+    else if (mWhat == UNDO_NAMEVISIBILITYCHANGE || mWhat == UNDO_ALWAYSVISIBLECHANGE)
+    {
+        mObjectName = rStuffElement.attribute("objectname");
+        mIsVisible = (rStuffElement.attribute("isvisible").toInt() == 1);
+    }
+    else if (mWhat == UNDO_ADDEDTEXTBOXWIDGET || mWhat == UNDO_DELETEDTEXTBOXWIDGET || mWhat == UNDO_MODIFIEDTEXTBOXWIDGET)
+    {
+        mIndex = rStuffElement.attribute("index").toInt();
+        setXml(rStuffElement);
+    }
+    else if (mWhat == UNDO_RESIZEDTEXTBOXWIDGET)
+    {
+        mIndex = rStuffElement.attribute("index").toInt();
+        mOldSize = QSizeF(rStuffElement.attribute("w_old").toDouble(), rStuffElement.attribute("h_old").toDouble());
+        mNewSize = QSizeF(rStuffElement.attribute("w_new").toDouble(), rStuffElement.attribute("h_new").toDouble());
+        parseDomValueNode2(rStuffElement.firstChildElement("oldpos"), x, y);
+        mOldPos = QPointF(x, y);
+        parseDomValueNode2(rStuffElement.firstChildElement("newpos"), x, y);
+        mNewPos = QPointF(x, y);
+    }
+    else if (mWhat == UNDO_MOVEDWIDGET)
+    {
+        mIndex = rStuffElement.attribute("index").toInt();
+        parseDomValueNode2(rStuffElement.firstChildElement("oldpos"), x, y);
+        mOldPos = QPointF(x, y);
+        parseDomValueNode2(rStuffElement.firstChildElement("newpos"), x, y);
+        mNewPos = QPointF(x, y);
+    }
+    else if (mWhat == UNDO_REMOVEDALIASES)
+    {
+        setXml(rStuffElement);
+    }
+}
+
+
+//! @brief Stores the XML of an element, and its children, in the action
+//! @param[in] rStuffElement The element to store, objects that were saved to it are restored from its children
+void UndoAction::setXml(const QDomElement &rStuffElement)
+{
+    QByteArray xml;
+    QTextStream stream(&xml);
+    stream.setCodec("UTF-8");
+    rStuffElement.save(stream, -1);
+    stream.flush();
+
+    mXmlIsCompressed = (xml.size() > compressUndoXmlThreshold);
+    mXml = mXmlIsCompressed ? qCompress(xml) : xml;
+}
+
+
+//! @brief Restores the XML stored in the action
+//! @param[in,out] rDomDocument The document to parse the XML into, it must outlive the returned element
+//! @returns The stored element, or a null element if no XML is stored
+QDomElement UndoAction::getXml(QDomDocument &rDomDocument) const
+{
+    rDomDocument.setContent(mXmlIsCompressed ? qUncompress(mXml) : mXml);
+    return rDomDocument.documentElement();
+}
+
+
+bool UndoAction::hasXml() const
+{
+    return !mXml.isEmpty();
+}
+
+
+void UndoAction::clearXml()
+{
+    mXml.clear();
+    mXmlIsCompressed = false;
+}
+
+
+//! @brief Returns the approximate number of bytes used by the action
+qint64 UndoAction::getMemoryUsage() const
+{
+    const int numChars = mWhat.size() + mObjectName.size() + mNewObjectName.size() + mParameterName.size() + mOldValue.size() +
+                         mNewValue.size() + mStartComponent.size() + mStartPort.size() + mEndComponent.size() + mEndPort.size();
+    return qint64(sizeof(UndoAction)) + numChars*qint64(sizeof(QChar)) + mXml.size();
+}
+
+
+
+//! @class UndoPost
+//! @brief The UndoPost class holds the actions that are undone or redone by pressing ctrl-z or ctrl-y once
+//!
+
+UndoPost::UndoPost(const int number, const QString &rType)
+{
+    mNumber = number;
+    mType = rType;
+    mMemoryUsage = 0;
+}
+
+
+void UndoPost::appendAction(const UndoAction &rAction)
+{
+    mActions.append(rAction);
+    mMemoryUsage += rAction.getMemoryUsage();
+}
+
+
+//! @brief Recalculates the memory usage, must be called when the XML stored in an action has changed
+void UndoPost::updateMemoryUsage()
+{
+    mMemoryUsage = 0;
+    for (const UndoAction &rAction : mActions)
+    {
+        mMemoryUsage += rAction.getMemoryUsage();
+    }
+}
+
+
 
 //! @class UndoStack
-//! @brief The UndoStack class is used as an XML-based storage for undo and redo operations.
+//! @brief The UndoStack class is used as storage for undo and redo operations.
 //!
 //! The stack consists of "undo posts", where each post can contain several actions. One undo post equal pressing ctrl-z once. To add a new post, use newPost().
 //! New actions are registered to the stack with their respective register functions. To undo or redo, use the undoOneStep() and redoOneStep() functions.
+//! Each action only stores what changed (see UndoAction), and the oldest posts are discarded if the stack grows too large.
 //! In order to maximize performance, it is important not to send more data than necessary to the register functions.
 //!
 
@@ -61,18 +422,53 @@ UndoStack::UndoStack(SystemObject *parentSystem)
 }
 
 
-QDomElement UndoStack::toXml()
+//! @brief Saves the undo stack to XML, so that it can be saved with the model
+//! @param[in] rDomElement The element to append the undo element to
+void UndoStack::saveToDomElement(QDomElement &rDomElement) const
 {
-    return mUndoRoot;
+    QDomElement undoRoot = appendDomElement(rDomElement, HMF_UNDO);
+    for (const UndoPost &rPost : mPosts)
+    {
+        QDomElement postElement = appendDomElement(undoRoot, "post");
+        postElement.setAttribute("number", rPost.mNumber);
+        if(!rPost.mType.isEmpty())
+        {
+            postElement.setAttribute("type", rPost.mType);
+        }
+        for (const UndoAction &rAction : rPost.mActions)
+        {
+            rAction.saveToDomElement(postElement);
+        }
+    }
 }
 
 
-void UndoStack::fromXml(QDomElement &undoElement)
+//! @brief Loads the undo stack from XML saved with the model
+//! @param[in] rUndoElement The undo element
+void UndoStack::loadFromDomElement(const QDomElement &rUndoElement)
 {
-    mUndoRoot.clear();
-    mDomDocument.replaceChild(undoElement.cloneNode(), mDomDocument.firstChild());
-    mUndoRoot = undoElement;
-    mCurrentStackPosition = mUndoRoot.lastChildElement().attribute("number").toInt();
+    mPosts.clear();
+    QDomElement postElement = rUndoElement.firstChildElement("post");
+    while(!postElement.isNull())
+    {
+        UndoPost post(postElement.attribute("number").toInt(), postElement.attribute("type"));
+        QDomElement stuffElement = postElement.firstChildElement("stuff");
+        while(!stuffElement.isNull())
+        {
+            UndoAction action;
+            action.loadFromDomElement(stuffElement);
+            post.appendAction(action);
+            stuffElement = stuffElement.nextSiblingElement("stuff");
+        }
+        mPosts.append(post);
+        postElement = postElement.nextSiblingElement("post");
+    }
+    if (mPosts.isEmpty())
+    {
+        mPosts.append(UndoPost(-1));
+    }
+    mCurrentStackPosition = mPosts.last().mNumber;
+    limitMemoryUsage();
     gpUndoWidget->refreshList();
 }
 
@@ -82,11 +478,8 @@ void UndoStack::fromXml(QDomElement &undoElement)
 void UndoStack::clear(QString errorMsg)
 {
     mCurrentStackPosition = -1;
-    mUndoRoot.clear();
-    mUndoRoot = mDomDocument.createElement(HMF_UNDO);
-    mDomDocument.appendChild(mUndoRoot);
-    QDomElement firstPost = appendDomElement(mUndoRoot, "post");
-    firstPost.setAttribute("number", mCurrentStackPosition);
+    mPosts.clear();
+    mPosts.append(UndoPost(mCurrentStackPosition));
 
     gpUndoWidget->refreshList();
 
@@ -103,46 +496,69 @@ void UndoStack::newPost(QString type)
 {
     if (mEnabled) {
         ++mCurrentStackPosition;
-        QDomElement maybeDeletePost = mUndoRoot.firstChildElement("post");
-        while(!maybeDeletePost.isNull())
+        // Posts after the current position can no longer be redone
+        while(!mPosts.isEmpty() && mPosts.last().mNumber > mCurrentStackPosition-1)
         {
-            QDomElement tempPost = maybeDeletePost;
-            maybeDeletePost = maybeDeletePost.nextSiblingElement("post");
-            if(tempPost.attribute("number").toInt() > mCurrentStackPosition-1)
-            {
-                mUndoRoot.removeChild(tempPost);
-            }
-        }
-        QDomElement newPost = appendDomElement(mUndoRoot, "post");
-        newPost.setAttribute("number", mCurrentStackPosition);
-        if(!type.isEmpty())
-        {
-            newPost.setAttribute("type", type);
+            mPosts.removeLast();
         }
+        mPosts.append(UndoPost(mCurrentStackPosition, type));
+        limitMemoryUsage();
         gpUndoWidget->refreshList();
     }
 }
 
 
+//! @brief Returns the approximate number of bytes used by the undo stack
+qint64 UndoStack::getMemoryUsage() const
+{
+    qint64 memoryUsage = 0;
+    for (const UndoPost &rPost : mPosts)
+    {
+        memoryUsage += rPost.mMemoryUsage;
+    }
+    return memoryUsage;
+}
+
+
+//! @brief Discards the oldest posts until the memory usage is below the limit, the current post is always kept
+void UndoStack::limitMemoryUsage()
+{
+    qint64 memoryUsage = getMemoryUsage();
+    int numDiscarded = 0;
+    while(memoryUsage > maxUndoMemoryUsage && mPosts.size() > 1 && mPosts.first().mNumber < mCurrentStackPosition)
+    {
+        memoryUsage -= mPosts.first().mMemoryUsage;
+        mPosts.removeFirst();
+        ++numDiscarded;
+    }
+    if (numDiscarded > 0)
+    {
+        gpMessageHandler->addDebugMessage(QString("Discarded the %1 oldest undo steps, the undo stack was too large").arg(numDiscarded));
+    }
+}
+
+
 //! @brief Will undo the changes registered in the current stack position and decrease stack position one step
 //! @see redoOneStep()
 void UndoStack::undoOneStep()
 {
     bool didSomething = false;
-    QList<QDomElement> deletedConnectorList;
-    QList<QDomElement> addedConnectorList;
-    QList<QDomElement> addedObjectList;
-    QList<QDomElement> addedsystemportsList;
-    QList<QDomElement> addedsubsystemsList;
+    QList<UndoAction*> deletedConnectorList;
+    QList<UndoAction*> addedConnectorList;
+    QList<UndoAction*> addedObjectList;
+    QList<UndoAction*> addedsystemportsList;
+    QList<UndoAction*> addedsubsystemsList;
     QStringList movedObjects;
     int dx=0, dy=0;
-    QDomElement stuffElement = getCurrentPost().lastChildElement("stuff");
-    while(!stuffElement.isNull())
+    UndoPost *pPost = getCurrentPost();
+    for(int i=(pPost ? pPost->mActions.size()-1 : -1); i>=0; --i)
     {
+        UndoAction &rAction = pPost->mActions[i];
         didSomething = true;
-        if(stuffElement.attribute("what") == UNDO_DELETEDOBJECT)
+        if(rAction.mWhat == UNDO_DELETEDOBJECT)
         {
-            QDomElement componentElement = stuffElement.firstChildElement(HMF_COMPONENTTAG);
+            QDomDocument xmlDocument;
+            QDomElement componentElement = rAction.getXml(xmlDocument).firstChildElement(HMF_COMPONENTTAG);
             ModelObject* pObj = loadModelObject(componentElement, mpParentSystemObject, NoUndo);
 
             //Load parameter values
@@ -154,261 +570,201 @@ void UndoStack::undoOneStep()
                 xmlParameter = xmlParameter.nextSiblingElement(HMF_PARAMETERTAG);
             }
         }
-        else if(stuffElement.attribute("what") == UNDO_DELETEDSYSTEMPORT)
+        else if(rAction.mWhat == UNDO_DELETEDSYSTEMPORT)
         {
-            QDomElement systemPortElement = stuffElement.firstChildElement(HMF_SYSTEMPORTTAG);
+            QDomDocument xmlDocument;
+            QDomElement systemPortElement = rAction.getXml(xmlDocument).firstChildElement(HMF_SYSTEMPORTTAG);
             loadSystemPortObject(systemPortElement, mpParentSystemObject, NoUndo);
         }
-        else if(stuffElement.attribute("what") == UNDO_DELETEDSUBSYSTEM)
+        else if(rAction.mWhat == UNDO_DELETEDSUBSYSTEM)
         {
-            QDomElement systemElement = stuffElement.firstChildElement(HMF_SYSTEMTAG);
+            QDomDocument xmlDocument;
+            QDomElement systemElement = rAction.getXml(xmlDocument).firstChildElement(HMF_SYSTEMTAG);
             loadModelObject(systemElement, mpParentSystemObject, NoUndo);
         }
-        else if(stuffElement.attribute("what") == UNDO_ADDEDOBJECT)
+        else if(rAction.mWhat == UNDO_ADDEDOBJECT)
         {
-            QDomElement componentElement = stuffElement.firstChildElement(HMF_COMPONENTTAG);
-            addedObjectList.append(componentElement);
+            addedObjectList.append(&rAction);
         }
-        else if(stuffElement.attribute("what") == UNDO_ADDEDSYSTEMPORT)
+        else if(rAction.mWhat == UNDO_ADDEDSYSTEMPORT)
         {
-            QDomElement systemPortElement = stuffElement.firstChildElement(HMF_SYSTEMPORTTAG);
-            addedsystemportsList.append(systemPortElement);
+            addedsystemportsList.append(&rAction);
         }
-        else if(stuffElement.attribute("what") == UNDO_ADDEDSUBSYSTEM)
+        else if(rAction.mWhat == UNDO_ADDEDSUBSYSTEM)
         {
-            QDomElement systemElement = stuffElement.firstChildElement(HMF_SYSTEMTAG);
-            addedsubsystemsList.append(systemElement);
+            addedsubsystemsList.append(&rAction);
         }
-        else if(stuffElement.attribute("what") == UNDO_DELETEDCONNECTOR)
+        else if(rAction.mWhat == UNDO_DELETEDCONNECTOR)
         {
-            QDomElement connectorElement = stuffElement.firstChildElement(HMF_CONNECTORTAG);
-            deletedConnectorList.append(connectorElement);
+            deletedConnectorList.append(&rAction);
         }
-        else if(stuffElement.attribute("what") == UNDO_ADDEDCONNECTOR)
+        else if(rAction.mWhat == UNDO_ADDEDCONNECTOR)
         {
-            QDomElement connectorElement = stuffElement.firstChildElement(HMF_CONNECTORTAG);
-            addedConnectorList.append(connectorElement);
+            addedConnectorList.append(&rAction);
         }
-        else if(stuffElement.attribute("what") == UNDO_RENAME)
+        else if(rAction.mWhat == UNDO_RENAME)
         {
-            QString newName = stuffElement.attribute("newname");
-            QString oldName = stuffElement.attribute("oldname");
-            if(!mpParentSystemObject->hasModelObject(newName))
+            if(!mpParentSystemObject->hasModelObject(rAction.mNewObjectName))
             {
                 this->clear("Undo stack attempted to access non-existing conmponent. Stack was cleared to ensure stability.");
                 return;
             }
-            mpParentSystemObject->renameModelObject(newName, oldName, NoUndo);
+            mpParentSystemObject->renameModelObject(rAction.mNewObjectName, rAction.mObjectName, NoUndo);
         }
-        else if(stuffElement.attribute("what") == UNDO_MODIFIEDCONNECTOR)
+        else if(rAction.mWhat == UNDO_MODIFIEDCONNECTOR)
         {
-            double tempX, tempY;
-            QDomElement oldPosElement = stuffElement.firstChildElement("oldpos");
-            parseDomValueNode2(oldPosElement, tempX, tempY);
-            QPointF oldPos = QPointF(tempX, tempY);
-            QDomElement newPosElement = stuffElement.firstChildElement("newpos");
-            parseDomValueNode2(newPosElement, tempX, tempY);
-            QPointF newPos = QPointF(tempX, tempY);
-            int lineNumber = stuffElement.attribute("linenumber").toDouble();
-            QDomElement connectorElement = stuffElement.firstChildElement(HMF_CONNECTORTAG);
-            QString startComponent = connectorElement.attribute("startcomponent");
-            QString startPort = connectorElement.attribute("startport");
-            QString endComponent = connectorElement.attribute("endcomponent");
-            QString endPort = connectorElement.attribute("endport");
-            if(!mpParentSystemObject->hasConnector(startComponent, startPort, endComponent, endPort))
+            if(!hasConnector(rAction))
             {
                 this->clear("Undo stack attempted to access non-existing connector. Stack was cleared to ensure stability.");
                 return;
             }
-            Connector *item = mpParentSystemObject->findConnector(startComponent, startPort, endComponent, endPort);
-            QPointF dXY = newPos - oldPos;
-            item->getLine(lineNumber)->setPos(item->getLine(lineNumber)->pos()-dXY);
-            item->updateLine(lineNumber);
+            Connector *item = findConnector(rAction);
+            QPointF dXY = rAction.mNewPos - rAction.mOldPos;
+            item->getLine(rAction.mIndex)->setPos(item->getLine(rAction.mIndex)->pos()-dXY);
+            item->updateLine(rAction.mIndex);
         }
-        else if(stuffElement.attribute("what") == UNDO_MOVEDOBJECT)
+        else if(rAction.mWhat == UNDO_MOVEDOBJECT)
         {
-            double x, y, x_new, y_new;
-            QDomElement newPosElement = stuffElement.firstChildElement("newpos");
-            QDomElement oldPosElement = stuffElement.firstChildElement("oldpos");
-            parseDomValueNode2(newPosElement, x_new, y_new);
-            parseDomValueNode2(oldPosElement, x, y);
-            QString name = stuffElement.attribute(HMF_NAMETAG);
+            const QString &name = rAction.mObjectName;
             if(!mpParentSystemObject->hasModelObject(name))
             {
                 this->clear("Undo stack attempted to access non-existing component. Stack was cleared to ensure stability.");
                 return;
             }
-            mpParentSystemObject->getModelObject(name)->setPos(x, y);
+            mpParentSystemObject->getModelObject(name)->setPos(rAction.mOldPos);
             mpParentSystemObject->getModelObject(name)->rememberPos();
             movedObjects.append(name);
-            dx = x_new - x;
-            dy = y_new - y;
+            dx = rAction.mNewPos.x() - rAction.mOldPos.x();
+            dy = rAction.mNewPos.y() - rAction.mOldPos.y();
         }
-        else if(stuffElement.attribute("what") == UNDO_MOVEDCONNECTOR)
+        else if(rAction.mWhat == UNDO_MOVEDCONNECTOR)
         {
-            double dx = stuffElement.attribute("dx").toDouble();
-            double dy = stuffElement.attribute("dy").toDouble();
-
-            QDomElement connectorElement = stuffElement.firstChildElement(HMF_CONNECTORTAG);
-            QString startComponent = connectorElement.attribute("startcomponent");
-            QString startPort = connectorElement.attribute("startport");
-            QString endComponent = connectorElement.attribute("endcomponent");
-            QString endPort = connectorElement.attribute("endport");
-
-            if(!mpParentSystemObject->hasConnector(startComponent, startPort, endComponent, endPort))
+            if(!hasConnector(rAction))
             {
                 this->clear("Undo stack attempted to access non-existing connector. Stack was cleared to ensure stability.");
                 return;
             }
-            mpParentSystemObject->findConnector(startComponent, startPort, endComponent, endPort)->moveAllPoints(-dx, -dy);
+            QPointF dXY = rAction.mNewPos - rAction.mOldPos;
+            findConnector(rAction)->moveAllPoints(-dXY.x(), -dXY.y());
         }
-        else if(stuffElement.attribute("what") == UNDO_ROTATE)
+        else if(rAction.mWhat == UNDO_ROTATE)
         {
-            QString name = stuffElement.attribute("objectname");
-            double angle = stuffElement.attribute("angle").toDouble();
-            if(!mpParentSystemObject->hasModelObject(name))
+            if(!mpParentSystemObject->hasModelObject(rAction.mObjectName))
             {
                 this->clear("Undo stack attempted to access non-existing component. Stack was cleared to ensure stability.");
                 return;
             }
-            //double targetAngle = mpParentSystemObject->getGUIModelObject(name)->rotation()-angle;
-            //if(targetAngle >= 360) { targetAngle = 0; }
-            //if(targetAngle < 0) { targetAngle = 270; }
-            mpParentSystemObject->getModelObject(name)->rotate(-angle, NoUndo);
-
+            mpParentSystemObject->getModelObject(rAction.mObjectName)->rotate(-rAction.mAngle, NoUndo);
         }
-        else if(stuffElement.attribute("what") == UNDO_VERTICALFLIP)
+        else if(rAction.mWhat == UNDO_VERTICALFLIP)
         {
-            QString name = stuffElement.attribute("objectname");
-            if(!mpParentSystemObject->hasModelObject(name))
+            if(!mpParentSystemObject->hasModelObject(rAction.mObjectName))
             {
                 this->clear("Undo stack attempted to access non-existing component. Stack was cleared to ensure stability.");
                 return;
             }
-            mpParentSystemObject->getModelObject(name)->flipVertical(NoUndo);
+            mpParentSystemObject->getModelObject(rAction.mObjectName)->flipVertical(NoUndo);
         }
-        else if(stuffElement.attribute("what") == UNDO_HORIZONTALFLIP)
+        else if(rAction.mWhat == UNDO_HORIZONTALFLIP)
         {
-            QString name = stuffElement.attribute("objectname");
-            if(!mpParentSystemObject->hasModelObject(name))
+            if(!mpParentSystemObject->hasModelObject(rAction.mObjectName))
             {
                 this->clear("Undo stack attempted to access non-existing component. Stack was cleared to ensure stability.");
                 return;
             }
-            mpParentSystemObject->getModelObject(name)->flipHorizontal(NoUndo);
+            mpParentSystemObject->getModelObject(rAction.mObjectName)->flipHorizontal(NoUndo);
         }
-        else if(stuffElement.attribute("what") == UNDO_CHANGEDPARAMETER)
+        else if(rAction.mWhat == UNDO_CHANGEDPARAMETER)
         {
-            QString objectName = stuffElement.attribute("objectname");
-            QString parameterName = stuffElement.attribute("parametername");
-            QString oldValue = stuffElement.attribute("oldvalue");
-            if(!mpParentSystemObject->hasModelObject(objectName))
+            if(!mpParentSystemObject->hasModelObject(rAction.mObjectName))
             {
                 this->clear("Undo stack attempted to access non-existing component. Stack was cleared to ensure stability.");
                 return;
             }
-            mpParentSystemObject->getModelObject(objectName)->setParameterValue(parameterName, oldValue);
+            mpParentSystemObject->getModelObject(rAction.mObjectName)->setParameterValue(rAction.mParameterName, rAction.mOldValue);
         }
-        else if(stuffElement.attribute("what") == UNDO_NAMEVISIBILITYCHANGE)
+        else if(rAction.mWhat == UNDO_NAMEVISIBILITYCHANGE)
         {
-            QString objectName = stuffElement.attribute("objectname");
-            bool isVisible = (stuffElement.attribute("isvisible").toInt() == 1);
-            if(isVisible)
+            if(rAction.mIsVisible)
             {
-                mpParentSystemObject->getModelObject(objectName)->hideName(NoUndo);
+                mpParentSystemObject->getModelObject(rAction.mObjectName)->hideName(NoUndo);
             }
             else
             {
-                mpParentSystemObject->getModelObject(objectName)->showName(NoUndo);
+                mpParentSystemObject->getModelObject(rAction.mObjectName)->showName(NoUndo);
             }
         }
-        else if(stuffElement.attribute("what") == UNDO_ALWAYSVISIBLECHANGE)
+        else if(rAction.mWhat == UNDO_ALWAYSVISIBLECHANGE)
         {
-            QString objectName = stuffElement.attribute("objectname");
-            bool isVisible = (stuffElement.attribute("isvisible").toInt() == 1);
-            mpParentSystemObject->getModelObject(objectName)->setAlwaysVisible(!isVisible, NoUndo);
+            mpParentSystemObject->getModelObject(rAction.mObjectName)->setAlwaysVisible(!rAction.mIsVisible, NoUndo);
         }
-        else if(stuffElement.attribute("what") == UNDO_ADDEDTEXTBOXWIDGET)
+        else if(rAction.mWhat == UNDO_ADDEDTEXTBOXWIDGET)
         {
-            removeTextboxWidget(stuffElement);
+            removeTextboxWidget(rAction);
         }
-        else if(stuffElement.attribute("what") == UNDO_DELETEDTEXTBOXWIDGET)
+        else if(rAction.mWhat == UNDO_DELETEDTEXTBOXWIDGET)
         {
-            addTextboxwidget(stuffElement);
+            addTextboxwidget(rAction);
         }
-        else if(stuffElement.attribute("what") == UNDO_RESIZEDTEXTBOXWIDGET)
+        else if(rAction.mWhat == UNDO_RESIZEDTEXTBOXWIDGET)
         {
-            size_t index = stuffElement.attribute("index").toInt();
-            double w_old = stuffElement.attribute("w_old").toDouble();
-            double h_old = stuffElement.attribute("h_old").toDouble();
-            double x_old, y_old;
-            QDomElement oldPosElement = stuffElement.firstChildElement("oldpos");
-            parseDomValueNode2(oldPosElement, x_old, y_old);
-            TextBoxWidget *pTempWidget = qobject_cast<TextBoxWidget *>(mpParentSystemObject->getWidget(index));
+            TextBoxWidget *pTempWidget = qobject_cast<TextBoxWidget *>(mpParentSystemObject->getWidget(rAction.mIndex));
             if (pTempWidget)
             {
-                pTempWidget->setSize(w_old, h_old);
-                pTempWidget->setPos(x_old, y_old);
+                pTempWidget->setSize(rAction.mOldSize.width(), rAction.mOldSize.height());
+                pTempWidget->setPos(rAction.mOldPos);
             }
         }
-        else if(stuffElement.attribute("what") == UNDO_MODIFIEDTEXTBOXWIDGET)
+        else if(rAction.mWhat == UNDO_MODIFIEDTEXTBOXWIDGET)
         {
-            modifyTextboxWidget(stuffElement);
-
+            modifyTextboxWidget(rAction);
         }
-        else if(stuffElement.attribute("what") == UNDO_MOVEDWIDGET)
+        else if(rAction.mWhat == UNDO_MOVEDWIDGET)
         {
-            double x_old, y_old;
-            QDomElement oldPosElement = stuffElement.firstChildElement("oldpos");
-            parseDomValueNode2(oldPosElement, x_old, y_old);
-            int id = stuffElement.attribute("index").toInt();
-            Widget *pWidget = mpParentSystemObject->getWidget(id);
+            Widget *pWidget = mpParentSystemObject->getWidget(rAction.mIndex);
             if(pWidget)
             {
-                pWidget->setPos(x_old, y_old);
+                pWidget->setPos(rAction.mOldPos);
             }
             else
             {
-                qDebug() << "Failed to find index in map: " << id;
+                qDebug() << "Failed to find index in map: " << rAction.mIndex;
                 this->clear("Undo stack attempted to access non-existing widget. Stack was cleared to ensure stability.");
                 return;
             }
         }
-        else if(stuffElement.attribute("what") == UNDO_REMOVEDALIASES)
+        else if(rAction.mWhat == UNDO_REMOVEDALIASES)
         {
-            QDomElement xmlAlias = stuffElement.firstChildElement(HMF_ALIAS);
+            QDomDocument xmlDocument;
+            QDomElement xmlAlias = rAction.getXml(xmlDocument).firstChildElement(HMF_ALIAS);
             while (!xmlAlias.isNull())
             {
                 loadPlotAlias(xmlAlias, mpParentSystemObject);
                 xmlAlias = xmlAlias.nextSiblingElement(HMF_ALIAS);
             }
         }
-        stuffElement = stuffElement.previousSiblingElement("stuff");
     }
 
     // Re-add connectors after components, to make sure start and end component exist
-    QList<QDomElement>::iterator it;
+    QList<UndoAction*>::iterator it;
     for(it=deletedConnectorList.begin(); it!=deletedConnectorList.end(); ++it)
     {
-        QString startComponent = (*it).attribute("startcomponent");
-        QString endComponent = (*it).attribute("endcomponent");
-        if(!mpParentSystemObject->hasModelObject(startComponent) || !mpParentSystemObject->hasModelObject(endComponent))
+        if(!mpParentSystemObject->hasModelObject((*it)->mStartComponent) || !mpParentSystemObject->hasModelObject((*it)->mEndComponent))
         {
             this->clear("Undo stack attempted to access non-existing component. Stack was cleared to ensure stability.");
             return;
         }
-        loadConnector(*it, mpParentSystemObject, NoUndo);
+        QDomDocument xmlDocument;
+        QDomElement connectorElement = (*it)->getXml(xmlDocument).firstChildElement(HMF_CONNECTORTAG);
+        loadConnector(connectorElement, mpParentSystemObject, NoUndo);
     }
 
-    // Remove connectors after modified connector action
+    // Remove connectors after modified connector action, remember them so that the addition can be redone
     for(it=addedConnectorList.begin(); it!=addedConnectorList.end(); ++it)
     {
-        QString startComponent = (*it).attribute("startcomponent");
-        QString startPort = (*it).attribute("startport");
-        QString endComponent = (*it).attribute("endcomponent");
-        QString endPort = (*it).attribute("endport");
-        auto pConnectorToRemove = mpParentSystemObject->findConnector(startComponent, startPort, endComponent, endPort);
+        auto pConnectorToRemove = findConnector(**it);
         if(pConnectorToRemove) {
+            saveXmlToAction(pConnectorToRemove, **it);
             mpParentSystemObject->removeSubConnector(pConnectorToRemove, NoUndo);
         }
         else {
@@ -417,50 +773,23 @@ void UndoStack::undoOneStep()
     }
 
     // Remove objects after removing connectors, to make sure connectors don't lose their start and end components
-    for(it = addedObjectList.begin(); it!=addedObjectList.end(); ++it)
-    {
-        QString name = (*it).attribute(HMF_NAMETAG);
-        if(!mpParentSystemObject->hasModelObject(name))
-        {
-            this->clear("Undo stack attempted to access non-existing component. Stack was cleared to ensure stability.");
-            return;
-        }
-        this->mpParentSystemObject->deleteModelObject(name, NoUndo);
-    }
-
-    // Remove system ports
-    for(it = addedsystemportsList.begin(); it!=addedsystemportsList.end(); ++it)
+    // System ports and subsystems are removed after components. The objects are saved first, in case they have changed since
+    // they were added, so that the addition can be redone.
+    QList<UndoAction*> objectsToRemove = addedObjectList + addedsystemportsList + addedsubsystemsList;
+    for(it = objectsToRemove.begin(); it!=objectsToRemove.end(); ++it)
     {
-        QString name = (*it).attribute(HMF_NAMETAG);
+        const QString name = (*it)->mObjectName;
         if(!mpParentSystemObject->hasModelObject(name))
         {
             this->clear("Undo stack attempted to access non-existing component. Stack was cleared to ensure stability.");
             return;
         }
+        saveXmlToAction(mpParentSystemObject->getModelObject(name), **it);
         this->mpParentSystemObject->deleteModelObject(name, NoUndo);
     }
-
-    // Remove subsystems
-    for(it = addedsubsystemsList.begin(); it!=addedsubsystemsList.end(); ++it)
+    if (pPost)
     {
-        QString name = (*it).attribute(HMF_NAMETAG);
-        SystemObject *pSystemToRemove = qobject_cast<SystemObject *>(mpParentSystemObject->getModelObject(name));
-
-        // Update information about Subsystem in DOM tree, in case it has changed inside since registered in the undo stack
-        QDomElement oldElement = (*it).parentNode().toElement();
-        QDomElement parentElement = (*it).parentNode().parentNode().toElement();
-        QDomElement newStuffElement = oldElement.ownerDocument().createElement("stuff");
-        parentElement.insertAfter(newStuffElement, oldElement); //Note! cant use append, because then order will be changed and redo will fail some operations
-        newStuffElement.setAttribute("what", UNDO_ADDEDSUBSYSTEM);
-        pSystemToRemove->saveToDomElement(newStuffElement);
-        parentElement.removeChild(oldElement);
-
-        if(!mpParentSystemObject->hasModelObject(name))
-        {
-            this->clear("Undo stack attempted to access non-existing component. Stack was cleared to ensure stability.");
-            return;
-        }
-        this->mpParentSystemObject->deleteModelObject(name, NoUndo);
+        pPost->updateMemoryUsage();
     }
 
     // Move all connectors that are connected between two components that has moved (must be done after components have been moved)
@@ -491,255 +820,198 @@ void UndoStack::redoOneStep()
 {
     bool didSomething = false;
     ++mCurrentStackPosition;
-    QList<QDomElement> addedConnectorList;
-    QList<QDomElement> modifiedConnectorList;
+    QList<UndoAction*> addedConnectorList;
+    QList<UndoAction*> modifiedConnectorList;
     QStringList movedObjects;
     int dx=0, dy=0;
-    QDomElement stuffElement = getCurrentPost().firstChildElement("stuff");
-    while(!stuffElement.isNull())
+    UndoPost *pPost = getCurrentPost();
+    for(int i=0; pPost && i<pPost->mActions.size(); ++i)
     {
+        UndoAction &rAction = pPost->mActions[i];
         didSomething = true;
-        if(stuffElement.attribute("what") == UNDO_DELETEDOBJECT)
+        if(rAction.mWhat == UNDO_DELETEDOBJECT || rAction.mWhat == UNDO_DELETEDSYSTEMPORT || rAction.mWhat == UNDO_DELETEDSUBSYSTEM)
         {
-            QDomElement componentElement = stuffElement.firstChildElement(HMF_COMPONENTTAG);
-            QString name = componentElement.attribute(HMF_NAMETAG);
-            if(mpParentSystemObject->hasModelObject(name)) {
-                mpParentSystemObject->deleteModelObject(name, NoUndo);
+            if(mpParentSystemObject->hasModelObject(rAction.mObjectName)) {
+                mpParentSystemObject->deleteModelObject(rAction.mObjectName, NoUndo);
             }
             else{
-                gpMessageHandler->addErrorMessage("Undo stack (redo) attempted to access non-existing component: "+name);
+                gpMessageHandler->addErrorMessage("Undo stack (redo) attempted to access non-existing component: "+rAction.mObjectName);
             }
         }
-        else if(stuffElement.attribute("what") == UNDO_DELETEDSYSTEMPORT)
+        else if(rAction.mWhat == UNDO_ADDEDOBJECT || rAction.mWhat == UNDO_ADDEDSYSTEMPORT || rAction.mWhat == UNDO_ADDEDSUBSYSTEM)
         {
-            QDomElement systemPortElement = stuffElement.firstChildElement(HMF_SYSTEMPORTTAG);
-            QString name = systemPortElement.attribute(HMF_NAMETAG);
-            if(mpParentSystemObject->hasModelObject(name)) {
-                mpParentSystemObject->deleteModelObject(name, NoUndo);
-            }
-            else{
-                gpMessageHandler->addErrorMessage("Undo stack (redo) attempted to access non-existing component: "+name);
+            QDomDocument xmlDocument;
+            QDomElement objectElement = rAction.getXml(xmlDocument).firstChildElement(modelObjectTag(rAction.mWhat));
+            if(objectElement.isNull()) {
+                gpMessageHandler->addErrorMessage("Undo stack (redo) has no data for component: "+rAction.mObjectName);
             }
-
-        }
-        else if(stuffElement.attribute("what") == UNDO_DELETEDSUBSYSTEM)
-        {
-            QDomElement systemElement = stuffElement.firstChildElement(HMF_SYSTEMTAG);
-            QString name = systemElement.attribute(HMF_NAMETAG);
-            if(mpParentSystemObject->hasModelObject(name)) {
-                mpParentSystemObject->deleteModelObject(name, NoUndo);
+            else if(rAction.mWhat == UNDO_ADDEDSYSTEMPORT) {
+                loadSystemPortObject(objectElement, mpParentSystemObject, NoUndo);
             }
-            else{
-                gpMessageHandler->addErrorMessage("Undo stack (redo) attempted to access non-existing component: "+name);
+            else {
+                loadModelObject(objectElement, mpParentSystemObject, NoUndo);
             }
+            // The object exists again, it is saved again if the addition is undone
+            rAction.clearXml();
         }
-        else if(stuffElement.attribute("what") == UNDO_ADDEDOBJECT)
-        {
-            QDomElement componentElement = stuffElement.firstChildElement(HMF_COMPONENTTAG);
-            loadModelObject(componentElement, mpParentSystemObject, NoUndo);
-        }
-        else if(stuffElement.attribute("what") == UNDO_ADDEDSYSTEMPORT)
+        else if(rAction.mWhat == UNDO_DELETEDCONNECTOR)
         {
-            QDomElement systemPortElement = stuffElement.firstChildElement(HMF_SYSTEMPORTTAG);
-            loadSystemPortObject(systemPortElement, mpParentSystemObject, NoUndo);
-        }
-        else if(stuffElement.attribute("what") == UNDO_ADDEDSUBSYSTEM)
-        {
-            QDomElement systemElement = stuffElement.firstChildElement(HMF_SYSTEMTAG);
-            loadModelObject(systemElement, mpParentSystemObject, NoUndo);
-        }
-        else if(stuffElement.attribute("what") == UNDO_DELETEDCONNECTOR)
-        {
-            QDomElement connectorElement = stuffElement.firstChildElement(HMF_CONNECTORTAG);
-            QString startComponent = connectorElement.attribute("startcomponent");
-            QString startPort = connectorElement.attribute("startport");
-            QString endComponent = connectorElement.attribute("endcomponent");
-            QString endPort = connectorElement.attribute("endport");
-            if(!mpParentSystemObject->hasConnector(startComponent, startPort, endComponent, endPort))
+            if(!hasConnector(rAction))
             {
                 this->clear("Undo stack attempted to access non-existing connector. Stack was cleared to ensure stability.");
                 return;
             }
-            mpParentSystemObject->removeSubConnector(mpParentSystemObject->findConnector(startComponent, startPort, endComponent, endPort), NoUndo);
+            mpParentSystemObject->removeSubConnector(findConnector(rAction), NoUndo);
         }
-        else if(stuffElement.attribute("what") == UNDO_ADDEDCONNECTOR)
+        else if(rAction.mWhat == UNDO_ADDEDCONNECTOR)
         {
-            QDomElement connectorElement = stuffElement.firstChildElement(HMF_CONNECTORTAG);
-            addedConnectorList.append(connectorElement);
+            addedConnectorList.append(&rAction);
         }
-        else if(stuffElement.attribute("what") == UNDO_RENAME)
+        else if(rAction.mWhat == UNDO_RENAME)
         {
-            QString newName = stuffElement.attribute("newname");
-            QString oldName = stuffElement.attribute("oldname");
-            if(mpParentSystemObject->hasModelObject(oldName)) {
-                mpParentSystemObject->renameModelObject(oldName, newName, NoUndo);
+            if(mpParentSystemObject->hasModelObject(rAction.mObjectName)) {
+                mpParentSystemObject->renameModelObject(rAction.mObjectName, rAction.mNewObjectName, NoUndo);
             }
             else{
-                gpMessageHandler->addErrorMessage("Undo stack (redo) attempted to access non-existing component: "+oldName);
+                gpMessageHandler->addErrorMessage("Undo stack (redo) attempted to access non-existing component: "+rAction.mObjectName);
             }
 
         }
-        else if(stuffElement.attribute("what") == UNDO_MODIFIEDCONNECTOR)
+        else if(rAction.mWhat == UNDO_MODIFIEDCONNECTOR)
         {
-            QDomElement tempElement = stuffElement;
-            modifiedConnectorList.append(tempElement);
+            modifiedConnectorList.append(&rAction);
         }
-        else if(stuffElement.attribute("what") == UNDO_MOVEDOBJECT)
+        else if(rAction.mWhat == UNDO_MOVEDOBJECT)
         {
-            double x, y, x_old, y_old;
-            QDomElement newPosElement = stuffElement.firstChildElement("newpos");
-            QDomElement oldPosElement = stuffElement.firstChildElement("oldpos");
-            parseDomValueNode2(newPosElement, x, y);
-            parseDomValueNode2(oldPosElement, x_old, y_old);
-            QString name = stuffElement.attribute(HMF_NAMETAG);
+            const QString &name = rAction.mObjectName;
             if(mpParentSystemObject->hasModelObject(name)) {
-                mpParentSystemObject->getModelObject(name)->setPos(x, y);
+                mpParentSystemObject->getModelObject(name)->setPos(rAction.mNewPos);
                 mpParentSystemObject->getModelObject(name)->rememberPos();
                 movedObjects.append(name);
-                dx = x - x_old;
-                dy = y - y_old;
+                dx = rAction.mNewPos.x() - rAction.mOldPos.x();
+                dy = rAction.mNewPos.y() - rAction.mOldPos.y();
             }
             else{
                 gpMessageHandler->addErrorMessage("Undo stack (redo) attempted to access non-existing component: "+name);
             }
         }
-        else if(stuffElement.attribute("what") == UNDO_ROTATE)
+        else if(rAction.mWhat == UNDO_ROTATE)
         {
-            QString name = stuffElement.attribute("objectname");
-            double angle = stuffElement.attribute("angle").toDouble();
-            if(mpParentSystemObject->hasModelObject(name)) {
-                mpParentSystemObject->getModelObject(name)->rotate(angle, NoUndo);
+            if(mpParentSystemObject->hasModelObject(rAction.mObjectName)) {
+                mpParentSystemObject->getModelObject(rAction.mObjectName)->rotate(rAction.mAngle, NoUndo);
             }
             else{
-                gpMessageHandler->addErrorMessage("Undo stack (redo) attempted to access non-existing component: "+name);
+                gpMessageHandler->addErrorMessage("Undo stack (redo) attempted to access non-existing component: "+rAction.mObjectName);
             }
 
         }
-        else if(stuffElement.attribute("what") == UNDO_VERTICALFLIP)
+        else if(rAction.mWhat == UNDO_VERTICALFLIP)
         {
-            QString name = stuffElement.attribute("objectname");
-            if(mpParentSystemObject->hasModelObject(name)) {
-                mpParentSystemObject->getModelObject(name)->flipVertical(NoUndo);
+            if(mpParentSystemObject->hasModelObject(rAction.mObjectName)) {
+                mpParentSystemObject->getModelObject(rAction.mObjectName)->flipVertical(NoUndo);
             }
             else{
-                gpMessageHandler->addErrorMessage("Undo stack (redo) attempted to access non-existing component: "+name);
+                gpMessageHandler->addErrorMessage("Undo stack (redo) attempted to access non-existing component: "+rAction.mObjectName);
             }
 
         }
-        else if(stuffElement.attribute("what") == UNDO_HORIZONTALFLIP)
+        else if(rAction.mWhat == UNDO_HORIZONTALFLIP)
         {
-            QString name = stuffElement.attribute("objectname");
-            if(mpParentSystemObject->hasModelObject(name)) {
-                mpParentSystemObject->getModelObject(name)->flipHorizontal(NoUndo);
+            if(mpParentSystemObject->hasModelObject(rAction.mObjectName)) {
+                mpParentSystemObject->getModelObject(rAction.mObjectName)->flipHorizontal(NoUndo);
             }
             else{
-                gpMessageHandler->addErrorMessage("Undo stack (redo) attempted to access non-existing component: "+name);
+                gpMessageHandler->addErrorMessage("Undo stack (redo) attempted to access non-existing component: "+rAction.mObjectName);
             }
 
         }
-        else if(stuffElement.attribute("what") == UNDO_CHANGEDPARAMETER)
+        else if(rAction.mWhat == UNDO_CHANGEDPARAMETER)
         {
-            QString objectName = stuffElement.attribute("objectname");
-            QString parameterName = stuffElement.attribute("parametername");
-            QString newValue = stuffElement.attribute("newvalue");
-            if(mpParentSystemObject->hasModelObject(objectName)) {
-                mpParentSystemObject->getModelObject(objectName)->setParameterValue(parameterName, newValue);
+            if(mpParentSystemObject->hasModelObject(rAction.mObjectName)) {
+                mpParentSystemObject->getModelObject(rAction.mObjectName)->setParameterValue(rAction.mParameterName, rAction.mNewValue);
             }
             else{
-                gpMessageHandler->addErrorMessage("Undo stack (redo) attempted to access non-existing component: "+objectName);
+                gpMessageHandler->addErrorMessage("Undo stack (redo) attempted to access non-existing component: "+rAction.mObjectName);
             }
 
         }
-        else if(stuffElement.attribute("what") == UNDO_NAMEVISIBILITYCHANGE)
+        else if(rAction.mWhat == UNDO_NAMEVISIBILITYCHANGE)
         {
-            QString objectName = stuffElement.attribute("objectname");
-            bool isVisible = (stuffElement.attribute("isvisible").toInt() == 1);
-            if(isVisible)
+            if(rAction.mIsVisible)
             {
-                mpParentSystemObject->getModelObject(objectName)->showName(NoUndo);
+                mpParentSystemObject->getModelObject(rAction.mObjectName)->showName(NoUndo);
             }
             else
             {
-                mpParentSystemObject->getModelObject(objectName)->hideName(NoUndo);
+                mpParentSystemObject->getModelObject(rAction.mObjectName)->hideName(NoUndo);
             }
         }
-        else if(stuffElement.attribute("what") == UNDO_ALWAYSVISIBLECHANGE)
+        else if(rAction.mWhat == UNDO_ALWAYSVISIBLECHANGE)
         {
-            QString objectName = stuffElement.attribute("objectname");
-            bool isVisible = (stuffElement.attribute("isvisible").toInt() == 1);
-            mpParentSystemObject->getModelObject(objectName)->setAlwaysVisible(isVisible, NoUndo);
+            mpParentSystemObject->getModelObject(rAction.mObjectName)->setAlwaysVisible(rAction.mIsVisible, NoUndo);
         }
-        else if(stuffElement.attribute("what") == UNDO_ADDEDTEXTBOXWIDGET)
+        else if(rAction.mWhat == UNDO_ADDEDTEXTBOXWIDGET)
         {
-            addTextboxwidget(stuffElement);
+            addTextboxwidget(rAction);
         }
-        else if(stuffElement.attribute("what") == UNDO_DELETEDTEXTBOXWIDGET)
+        else if(rAction.mWhat == UNDO_DELETEDTEXTBOXWIDGET)
         {
-            removeTextboxWidget(stuffElement);
+            removeTextboxWidget(rAction);
         }
-        else if(stuffElement.attribute("what") == UNDO_RESIZEDTEXTBOXWIDGET)
+        else if(rAction.mWhat == UNDO_RESIZEDTEXTBOXWIDGET)
         {
-            size_t index = stuffElement.attribute("index").toInt();
-            double w_new = stuffElement.attribute("w_new").toDouble();
-            double h_new = stuffElement.attribute("h_new").toDouble();
-            double x_new, y_new;
-            QDomElement newPosElement = stuffElement.firstChildElement("newpos");
-            parseDomValueNode2(newPosElement, x_new, y_new);
-            TextBoxWidget *tempWidget = qobject_cast<TextBoxWidget *>(mpParentSystemObject->mWidgetMap.find(index).value());
-            tempWidget->setSize(w_new, h_new);
-            tempWidget->setPos(x_new, y_new);
-        }
-        else if(stuffElement.attribute("what") == UNDO_MODIFIEDTEXTBOXWIDGET)
+            TextBoxWidget *pTempWidget = qobject_cast<TextBoxWidget *>(mpParentSystemObject->getWidget(rAction.mIndex));
+            if (pTempWidget)
+            {
+                pTempWidget->setSize(rAction.mNewSize.width(), rAction.mNewSize.height());
+                pTempWidget->setPos(rAction.mNewPos);
+            }
+        }
+        else if(rAction.mWhat == UNDO_MODIFIEDTEXTBOXWIDGET)
         {
-            modifyTextboxWidget(stuffElement);
+            modifyTextboxWidget(rAction);
         }
-        else if(stuffElement.attribute("what") == UNDO_MOVEDWIDGET)
+        else if(rAction.mWhat == UNDO_MOVEDWIDGET)
         {
-            double x_new, y_new;
-            QDomElement newPosElement = stuffElement.firstChildElement("newpos");
-            parseDomValueNode2(newPosElement, x_new, y_new);
-            size_t index = stuffElement.attribute("index").toInt();
-            if(!mpParentSystemObject->mWidgetMap.contains(index))
+            Widget *pWidget = mpParentSystemObject->getWidget(rAction.mIndex);
+            if(!pWidget)
             {
                 this->clear("Undo stack attempted to access non-existing widget. Stack was cleared to ensure stability.");
                 return;
             }
-            mpParentSystemObject->mWidgetMap.find(index).value()->setPos(x_new, y_new);
+            pWidget->setPos(rAction.mNewPos);
         }
-        stuffElement = stuffElement.nextSiblingElement("stuff");
     }
 
         //Create connectors after everything else, to make sure components are created before connectors
-    QList<QDomElement>::iterator it;
+    QList<UndoAction*>::iterator it;
     for(it=addedConnectorList.begin(); it!=addedConnectorList.end(); ++it)
     {
-        loadConnector(*it, mpParentSystemObject, NoUndo);
+        QDomDocument xmlDocument;
+        QDomElement connectorElement = (*it)->getXml(xmlDocument).firstChildElement(HMF_CONNECTORTAG);
+        if(connectorElement.isNull())
+        {
+            gpMessageHandler->addErrorMessage("Undo stack (redo) has no data for connector from: "+(*it)->mStartComponent);
+            continue;
+        }
+        loadConnector(connectorElement, mpParentSystemObject, NoUndo);
+        (*it)->clearXml();
+    }
+    if (pPost)
+    {
+        pPost->updateMemoryUsage();
     }
 
     for(it=modifiedConnectorList.begin(); it!=modifiedConnectorList.end(); ++it)
     {
-        double tempX, tempY;
-        QDomElement oldPosElement = (*it).firstChildElement("oldpos");
-        parseDomValueNode2(oldPosElement, tempX, tempY);
-        QPointF oldPos = QPointF(tempX, tempY);
-        QDomElement newPosElement = (*it).firstChildElement("newpos");
-        parseDomValueNode2(newPosElement, tempX, tempY);
-        QPointF newPos = QPointF(tempX, tempY);
-
-        int lineNumber = (*it).attribute("linenumber").toDouble();
-
-        QDomElement connectorElement = (*it).firstChildElement(HMF_CONNECTORTAG);
-        QString startComponent = connectorElement.attribute("startcomponent");
-        QString startPort = connectorElement.attribute("startport");
-        QString endComponent = connectorElement.attribute("endcomponent");
-        QString endPort = connectorElement.attribute("endport");
-        QPointF dXY = oldPos-newPos;
-        if(!mpParentSystemObject->hasConnector(startComponent, startPort, endComponent, endPort))
+        QPointF dXY = (*it)->mOldPos - (*it)->mNewPos;
+        if(!hasConnector(**it))
         {
             this->clear("Undo stack attempted to access non-existing connector. Stack was cleared to ensure stability.");
             return;
         }
-        Connector *item = mpParentSystemObject->findConnector(startComponent, startPort, endComponent, endPort);
+        Connector *item = findConnector(**it);
+        const int lineNumber = (*it)->mIndex;
 
         item->getLine(lineNumber)->setPos(item->getLine(lineNumber)->pos()-dXY);
         item->updateLine(lineNumber);
@@ -773,24 +1045,22 @@ void UndoStack::redoOneStep()
 void UndoStack::registerDeletedObject(ModelObject *item)
 {
     if(mEnabled) {
-        QDomElement currentPostElement = getCurrentPost();
-        if (currentPostElement.isNull())
-            return;
-        QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
+        UndoAction action;
         if(item->getTypeName() == HOPSANGUISYSTEMPORTTYPENAME)
         {
-            stuffElement.setAttribute("what", UNDO_DELETEDSYSTEMPORT);
+            action.mWhat = UNDO_DELETEDSYSTEMPORT;
         }
         else if(item->getTypeName() == HOPSANGUISYSTEMTYPENAME || item->getTypeName() == HOPSANGUICONDITIONALSYSTEMTYPENAME)
         {
-            stuffElement.setAttribute("what", UNDO_DELETEDSUBSYSTEM);
+            action.mWhat = UNDO_DELETEDSUBSYSTEM;
         }
         else
         {
-            stuffElement.setAttribute("what", UNDO_DELETEDOBJECT);
+            action.mWhat = UNDO_DELETEDOBJECT;
         }
-        item->saveToDomElement(stuffElement);
-        gpUndoWidget->refreshList();
+        action.mObjectName = item->getName();
+        saveXmlToAction(item, action);
+        addAction(action);
     }
 }
 
@@ -800,40 +1070,35 @@ void UndoStack::registerDeletedObject(ModelObject *item)
 void UndoStack::registerDeletedConnector(Connector *item)
 {
     if(mEnabled) {
-        QDomElement currentPostElement = getCurrentPost();
-        //! @todo this check below is needed elsewhere also, to prevent crash under rare circumstances
-        if (currentPostElement.isNull())
-            return;
-        QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
-        stuffElement.setAttribute("what", UNDO_DELETEDCONNECTOR);
-        item->saveToDomElement(stuffElement);
-        gpUndoWidget->refreshList();
+        UndoAction action(UNDO_DELETEDCONNECTOR);
+        setConnectorEnds(action, item);
+        saveXmlToAction(item, action);
+        addAction(action);
     }
 }
 
 
 //! @brief Register function for added objects
-//! @param itemName Name of the added object
+//! @param item Pointer to the added object
 void UndoStack::registerAddedObject(ModelObject *item)
 {
     if(mEnabled) {
-        QDomElement currentPostElement = getCurrentPost();
-        QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
+        UndoAction action;
         if(item->getTypeName() == HOPSANGUISYSTEMPORTTYPENAME)
         {
-            stuffElement.setAttribute("what", UNDO_ADDEDSYSTEMPORT);
+            action.mWhat = UNDO_ADDEDSYSTEMPORT;
         }
         else if(item->getTypeName() == HOPSANGUISYSTEMTYPENAME || item->getTypeName() == HOPSANGUICONDITIONALSYSTEMTYPENAME)
         {
-            stuffElement.setAttribute("what", UNDO_ADDEDSUBSYSTEM);
+            action.mWhat = UNDO_ADDEDSUBSYSTEM;
         }
         else
         {
-            stuffElement.setAttribute("what", UNDO_ADDEDOBJECT);
+            action.mWhat = UNDO_ADDEDOBJECT;
         }
-        item->saveToDomElement(stuffElement);
-
-        gpUndoWidget->refreshList();
+        // Only the name is needed until the addition is undone
+        action.mObjectName = item->getName();
+        addAction(action);
     }
 }
 
@@ -843,11 +1108,9 @@ void UndoStack::registerAddedObject(ModelObject *item)
 void UndoStack::registerAddedConnector(Connector *pConnector)
 {
     if(mEnabled) {
-        QDomElement currentPostElement = getCurrentPost();
-        QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
-        stuffElement.setAttribute("what", UNDO_ADDEDCONNECTOR);
-        pConnector->saveToDomElement(stuffElement);
-        gpUndoWidget->refreshList();
+        UndoAction action(UNDO_ADDEDCONNECTOR);
+        setConnectorEnds(action, pConnector);
+        addAction(action);
     }
 }
 
@@ -858,12 +1121,10 @@ void UndoStack::registerAddedConnector(Connector *pConnector)
 void UndoStack::registerRenameObject(QString oldName, QString newName)
 {
     if(mEnabled) {
-        QDomElement currentPostElement = getCurrentPost();
-        QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
-        stuffElement.setAttribute("what", UNDO_RENAME);
-        stuffElement.setAttribute("oldname", oldName);
-        stuffElement.setAttribute("newname", newName);
-        gpUndoWidget->refreshList();
+        UndoAction action(UNDO_RENAME);
+        action.mObjectName = oldName;
+        action.mNewObjectName = newName;
+        addAction(action);
     }
 }
 
@@ -876,16 +1137,15 @@ void UndoStack::registerModifiedConnector(QPointF oldPos, QPointF newPos, Connec
 {
     if(mEnabled) {
         //! @todo This if statement is a very very very ugly hack...
-        if(!(getCurrentPost().attribute("type") == UNDO_PASTE))    //Connectors are modified when undoing paste operations, but this will modify them twice, so don't register it
+        UndoPost *pPost = getCurrentPost();
+        if(!(pPost && pPost->mType == UNDO_PASTE))    //Connectors are modified when undoing paste operations, but this will modify them twice, so don't register it
         {
-            QDomElement currentPostElement = getCurrentPost();
-            QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
-            stuffElement.setAttribute("what", UNDO_MODIFIEDCONNECTOR);
-            stuffElement.setAttribute("linenumber", lineNumber);
-            appendDomValueNode2(stuffElement, "oldpos", oldPos.x(), oldPos.y());
-            appendDomValueNode2(stuffElement, "newpos", newPos.x(), newPos.y());
-            item->saveToDomElement(stuffElement);
-            gpUndoWidget->refreshList();
+            UndoAction action(UNDO_MODIFIEDCONNECTOR);
+            action.mIndex = lineNumber;
+            action.mOldPos = oldPos;
+            action.mNewPos = newPos;
+            setConnectorEnds(action, item);
+            addAction(action);
         }
     }
 }
@@ -897,13 +1157,11 @@ void UndoStack::registerModifiedConnector(QPointF oldPos, QPointF newPos, Connec
 void UndoStack::registerMovedObject(QPointF oldPos, QPointF newPos, QString objectName)
 {
     if(mEnabled) {
-        QDomElement currentPostElement = getCurrentPost();
-        QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
-        stuffElement.setAttribute("what", UNDO_MOVEDOBJECT);
-        stuffElement.setAttribute(HMF_NAMETAG, objectName);
-        appendDomValueNode2(stuffElement, "oldpos", oldPos.x(), oldPos.y());
-        appendDomValueNode2(stuffElement, "newpos", newPos.x(), newPos.y());
-        gpUndoWidget->refreshList();
+        UndoAction action(UNDO_MOVEDOBJECT);
+        action.mObjectName = objectName;
+        action.mOldPos = oldPos;
+        action.mNewPos = newPos;
+        addAction(action);
     }
 }
 
@@ -913,12 +1171,10 @@ void UndoStack::registerMovedObject(QPointF oldPos, QPointF newPos, QString obje
 void UndoStack::registerRotatedObject(const QString objectName, const double angle)
 {
     if(mEnabled) {
-        QDomElement currentPostElement = getCurrentPost();
-        QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
-        stuffElement.setAttribute("what", UNDO_ROTATE);
-        stuffElement.setAttribute("objectname", objectName);
-        setQrealAttribute(stuffElement, "angle", angle);
-        gpUndoWidget->refreshList();
+        UndoAction action(UNDO_ROTATE);
+        action.mObjectName = objectName;
+        action.mAngle = angle;
+        addAction(action);
     }
 }
 
@@ -928,11 +1184,9 @@ void UndoStack::registerRotatedObject(const QString objectName, const double ang
 void UndoStack::registerVerticalFlip(QString objectName)
 {
     if(mEnabled) {
-        QDomElement currentPostElement = getCurrentPost();
-        QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
-        stuffElement.setAttribute("what", UNDO_VERTICALFLIP);
-        stuffElement.setAttribute("objectname", objectName);
-        gpUndoWidget->refreshList();
+        UndoAction action(UNDO_VERTICALFLIP);
+        action.mObjectName = objectName;
+        addAction(action);
     }
 }
 
@@ -942,11 +1196,9 @@ void UndoStack::registerVerticalFlip(QString objectName)
 void UndoStack::registerHorizontalFlip(QString objectName)
 {
     if(mEnabled) {
-        QDomElement currentPostElement = getCurrentPost();
-        QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
-        stuffElement.setAttribute("what", UNDO_HORIZONTALFLIP);
-        stuffElement.setAttribute("objectname", objectName);
-        gpUndoWidget->refreshList();
+        UndoAction action(UNDO_HORIZONTALFLIP);
+        action.mObjectName = objectName;
+        addAction(action);
     }
 }
 
@@ -959,14 +1211,12 @@ void UndoStack::registerHorizontalFlip(QString objectName)
 void UndoStack::registerChangedParameter(QString objectName, QString parameterName, QString oldValueTxt, QString newValueTxt)
 {
     if(mEnabled) {
-        QDomElement currentPostElement = getCurrentPost();
-        QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
-        stuffElement.setAttribute("what", UNDO_CHANGEDPARAMETER);
-        stuffElement.setAttribute("parametername", parameterName);
-        stuffElement.setAttribute("oldvalue", oldValueTxt);
-        stuffElement.setAttribute("newvalue", newValueTxt);
-        stuffElement.setAttribute("objectname", objectName);
-        gpUndoWidget->refreshList();
+        UndoAction action(UNDO_CHANGEDPARAMETER);
+        action.mObjectName = objectName;
+        action.mParameterName = parameterName;
+        action.mOldValue = oldValueTxt;
+        action.mNewValue = newValueTxt;
+        addAction(action);
     }
 }
 
@@ -977,21 +1227,19 @@ void UndoStack::registerChangedParameter(QString objectName, QString parameterNa
 void UndoStack::registerNameVisibilityChange(QString objectName, bool isVisible)
 {
     if(mEnabled) {
-        QDomElement currentPostElement = getCurrentPost();
-        QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
-        stuffElement.setAttribute("what", UNDO_NAMEVISIBILITYCHANGE);
-        stuffElement.setAttribute("objectname", objectName);
-        stuffElement.setAttribute("isvisible", isVisible);
-        gpUndoWidget->refreshList();
+        UndoAction action(UNDO_NAMEVISIBILITYCHANGE);
+        action.mObjectName = objectName;
+        action.mIsVisible = isVisible;
+        addAction(action);
     }
 }
 
 void UndoStack::registerRemovedAliases(QStringList &aliases)
 {
     if(mEnabled) {
-        QDomElement currentPostElement = getCurrentPost();
-        QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
-        stuffElement.setAttribute("what", UNDO_REMOVEDALIASES);
+        QDomDocument domDocument;
+        QDomElement stuffElement = domDocument.createElement("stuff");
+        domDocument.appendChild(stuffElement);
 
         //! @todo need one function that gets both alias and full maybe
         for (int i=0; i<aliases.size(); ++i)
@@ -1002,18 +1250,20 @@ void UndoStack::registerRemovedAliases(QStringList &aliases)
             QString fullName = mpParentSystemObject->getFullNameFromAlias(aliases[i]);
             appendDomTextNode(alias, "fullname",fullName );
         }
+
+        UndoAction action(UNDO_REMOVEDALIASES);
+        action.setXml(stuffElement);
+        addAction(action);
     }
 }
 
 void UndoStack::registerAlwaysVisibleChange(QString objectName, bool isVisible)
 {
     if(mEnabled) {
-        QDomElement currentPostElement = getCurrentPost();
-        QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
-        stuffElement.setAttribute("what", UNDO_ALWAYSVISIBLECHANGE);
-        stuffElement.setAttribute("objectname", objectName);
-        stuffElement.setAttribute("isvisible", isVisible);
-        gpUndoWidget->refreshList();
+        UndoAction action(UNDO_ALWAYSVISIBLECHANGE);
+        action.mObjectName = objectName;
+        action.mIsVisible = isVisible;
+        addAction(action);
     }
 }
 
@@ -1021,13 +1271,12 @@ void UndoStack::registerAlwaysVisibleChange(QString objectName, bool isVisible)
 void UndoStack::registerAddedWidget(Widget *item)
 {
     if(mEnabled) {
-        QDomElement currentPostElement = getCurrentPost();
-        QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
+        UndoAction action;
         if(item->getWidgetType() == TextBoxWidgetType)
-            stuffElement.setAttribute("what", UNDO_ADDEDTEXTBOXWIDGET);
-        stuffElement.setAttribute("index", item->getWidgetIndex());
-        item->saveToDomElement(stuffElement);
-        gpUndoWidget->refreshList();
+            action.mWhat = UNDO_ADDEDTEXTBOXWIDGET;
+        action.mIndex = item->getWidgetIndex();
+        saveXmlToAction(item, action);
+        addAction(action);
     }
 }
 
@@ -1035,13 +1284,12 @@ void UndoStack::registerAddedWidget(Widget *item)
 void UndoStack::registerDeletedWidget(Widget *item)
 {
     if(mEnabled) {
-        QDomElement currentPostElement = getCurrentPost();
-        QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
+        UndoAction action;
         if(item->getWidgetType() == TextBoxWidgetType)
-            stuffElement.setAttribute("what", UNDO_DELETEDTEXTBOXWIDGET);
-        stuffElement.setAttribute("index", item->getWidgetIndex());
-        item->saveToDomElement(stuffElement);
-        gpUndoWidget->refreshList();
+            action.mWhat = UNDO_DELETEDTEXTBOXWIDGET;
+        action.mIndex = item->getWidgetIndex();
+        saveXmlToAction(item, action);
+        addAction(action);
     }
 }
 
@@ -1055,13 +1303,11 @@ void UndoStack::registerMovedWidget(Widget *item, QPointF oldPos, QPointF newPos
     qDebug() << "registerMovedWidget(), index = " << item->getWidgetIndex();
 
     if(mEnabled) {
-        QDomElement currentPostElement = getCurrentPost();
-        QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
-        stuffElement.setAttribute("what", UNDO_MOVEDWIDGET);
-        stuffElement.setAttribute("index", item->getWidgetIndex());
-        appendDomValueNode2(stuffElement, "oldpos", oldPos.x(), oldPos.y());
-        appendDomValueNode2(stuffElement, "newpos", newPos.x(), newPos.y());
-        gpUndoWidget->refreshList();
+        UndoAction action(UNDO_MOVEDWIDGET);
+        action.mIndex = item->getWidgetIndex();
+        action.mOldPos = oldPos;
+        action.mNewPos = newPos;
+        addAction(action);
     }
 }
 
@@ -1078,32 +1324,26 @@ void UndoStack::registerMovedWidget(Widget *item, QPointF oldPos, QPointF newPos
 void UndoStack::registerResizedTextBoxWidget(const int index, const double w_old, const double h_old, const double w_new, const double h_new, const QPointF oldPos, const QPointF newPos)
 {
     if(mEnabled) {
-        QDomElement currentPostElement = getCurrentPost();
-        QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
-        stuffElement.setAttribute("what", UNDO_RESIZEDTEXTBOXWIDGET);
-        stuffElement.setAttribute("index", index);
-        setQrealAttribute(stuffElement, "w_old", w_old);
-        setQrealAttribute(stuffElement, "h_old", h_old);
-        setQrealAttribute(stuffElement, "w_new", w_new);
-        setQrealAttribute(stuffElement, "h_new", h_new);
-        appendDomValueNode2(stuffElement, "oldpos", oldPos.x(), oldPos.y());
-        appendDomValueNode2(stuffElement, "newpos", newPos.x(), newPos.y());
-        gpUndoWidget->refreshList();
+        UndoAction action(UNDO_RESIZEDTEXTBOXWIDGET);
+        action.mIndex = index;
+        action.mOldSize = QSizeF(w_old, h_old);
+        action.mNewSize = QSizeF(w_new, h_new);
+        action.mOldPos = oldPos;
+        action.mNewPos = newPos;
+        addAction(action);
     }
 }
 
 void UndoStack::registerModifiedTextBoxWidget(Widget *pItem)
 {
     if(mEnabled) {
-        QDomElement currentPostElement = getCurrentPost();
-        QDomElement stuffElement = appendDomElement(currentPostElement, "stuff");
-        stuffElement.setAttribute("what", UNDO_MODIFIEDTEXTBOXWIDGET);
-        stuffElement.setAttribute("index", pItem->getWidgetIndex());
+        UndoAction action(UNDO_MODIFIEDTEXTBOXWIDGET);
+        action.mIndex = pItem->getWidgetIndex();
 
         // Save the old text box widget
-        pItem->saveToDomElement(stuffElement);
+        saveXmlToAction(pItem, action);
 
-        gpUndoWidget->refreshList();
+        addAction(action);
     }
 }
 
@@ -1112,48 +1352,69 @@ void UndoStack::setEnabled(bool enabled)
     mEnabled = enabled;
 }
 
-void UndoStack::addTextboxwidget(const QDomElement &rStuffElement)
+//! @brief Appends an action to the current undo post
+void UndoStack::addAction(const UndoAction &rAction)
+{
+    UndoPost *pPost = getCurrentPost();
+    //! @todo a missing post should not happen, but has been seen under rare circumstances
+    if (pPost)
+    {
+        pPost->appendAction(rAction);
+    }
+    gpUndoWidget->refreshList();
+}
+
+bool UndoStack::hasConnector(const UndoAction &rAction) const
 {
-    QDomElement textBoxElement = rStuffElement.firstChildElement(HMF_TEXTBOXWIDGETTAG);
+    return mpParentSystemObject->hasConnector(rAction.mStartComponent, rAction.mStartPort, rAction.mEndComponent, rAction.mEndPort);
+}
+
+Connector *UndoStack::findConnector(const UndoAction &rAction) const
+{
+    return mpParentSystemObject->findConnector(rAction.mStartComponent, rAction.mStartPort, rAction.mEndComponent, rAction.mEndPort);
+}
+
+void UndoStack::addTextboxwidget(const UndoAction &rAction)
+{
+    QDomDocument xmlDocument;
+    QDomElement textBoxElement = rAction.getXml(xmlDocument).firstChildElement(HMF_TEXTBOXWIDGETTAG);
     int id = parseAttributeInt(textBoxElement, "index", 0);
     TextBoxWidget *pWidget = mpParentSystemObject->addTextBoxWidget(QPointF(1,1), id, NoUndo);
     pWidget->loadFromDomElement(textBoxElement);
 }
 
-void UndoStack::removeTextboxWidget(const QDomElement &rStuffElement)
+void UndoStack::removeTextboxWidget(const UndoAction &rAction)
 {
-    size_t id = rStuffElement.attribute("index").toInt();
-    mpParentSystemObject->deleteWidget(id, NoUndo);
+    mpParentSystemObject->deleteWidget(rAction.mIndex, NoUndo);
 }
 
-void UndoStack::modifyTextboxWidget(QDomElement &rStuffElement)
+void UndoStack::modifyTextboxWidget(UndoAction &rAction)
 {
-    size_t index = rStuffElement.attribute("index").toInt();
-    TextBoxWidget *pWidget = qobject_cast<TextBoxWidget *>(mpParentSystemObject->getWidget(index));
+    TextBoxWidget *pWidget = qobject_cast<TextBoxWidget *>(mpParentSystemObject->getWidget(rAction.mIndex));
     if (pWidget)
     {
-        pWidget->saveToDomElement(rStuffElement);
-
-        QString tagname(HMF_TEXTBOXWIDGETTAG);
-        pWidget->loadFromDomElement(rStuffElement.firstChildElement(tagname));
+        QDomDocument xmlDocument;
+        QDomElement textBoxElement = rAction.getXml(xmlDocument).firstChildElement(HMF_TEXTBOXWIDGETTAG);
 
-        // Now remember the prevData in case we want to redo/undo again
-        rStuffElement.replaceChild(rStuffElement.lastChildElement(tagname), rStuffElement.firstChildElement(tagname));
+        // Remember the current data in case we want to redo/undo again
+        saveXmlToAction(pWidget, rAction);
+        pWidget->loadFromDomElement(textBoxElement);
     }
 }
 
 
-//! @brief Returns the DOM element for the current undo post
-QDomElement UndoStack::getCurrentPost()
+//! @brief Returns the current undo post, or nullptr if it has been discarded
+UndoPost *UndoStack::getCurrentPost()
 {
-    QDomElement postElement = mUndoRoot.firstChildElement("post");
-    while(!postElement.isNull())
+    if (mPosts.isEmpty())
     {
-        if(postElement.attribute("number").toInt() == mCurrentStackPosition)
-        {
-            return postElement;
-        }
-        postElement = postElement.nextSiblingElement("post");
+        return nullptr;
+    }
+    // Post numbers are consecutive
+    const int i = mCurrentStackPosition - mPosts.first().mNumber;
+    if (i >= 0 && i < mPosts.size() && mPosts[i].mNumber == mCurrentStackPosition)
+    {
+        return &mPosts[i];
     }
-    return QDomElement();
+    return nullptr;
 }
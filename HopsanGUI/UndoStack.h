@@ -42,6 +42,9 @@
 #include <QTableWidget>
 #include <QObject>
 #include <QGridLayout>
+#include <QPointF>
+#include <QSizeF>
+#include <QByteArray>
 
 #include <QDomElement>
 #include <QDomDocument>
@@ -92,6 +95,61 @@ class SystemObject;
 class Widget;
 class UndoWidget;
 
+//! @brief One recorded change in the undo stack
+//! @details Only the data needed to revert and reapply the change is stored. Removed objects, that must be recreated on undo
+//! or redo, keep their XML description in serialized (and if large, compressed) form.
+class UndoAction
+{
+public:
+    UndoAction(const QString &rWhat=QString());
+
+    void saveToDomElement(QDomElement &rPostElement) const;
+    void loadFromDomElement(const QDomElement &rStuffElement);
+
+    void setXml(const QDomElement &rStuffElement);
+    QDomElement getXml(QDomDocument &rDomDocument) const;
+    bool hasXml() const;
+    void clearXml();
+
+    qint64 getMemoryUsage() const;
+
+    QString mWhat;
+    QString mObjectName;
+    QString mNewObjectName;
+    QString mParameterName;
+    QString mOldValue;
+    QString mNewValue;
+    QString mStartComponent;
+    QString mStartPort;
+    QString mEndComponent;
+    QString mEndPort;
+    QPointF mOldPos;
+    QPointF mNewPos;
+    QSizeF mOldSize;
+    QSizeF mNewSize;
+    double mAngle;
+    int mIndex;
+    bool mIsVisible;
+
+private:
+    QByteArray mXml;
+    bool mXmlIsCompressed;
+};
+
+//! @brief One undo post, all actions in a post are undone or redone together
+class UndoPost
+{
+public:
+    UndoPost(const int number=-1, const QString &rType=QString());
+    void appendAction(const UndoAction &rAction);
+    void updateMemoryUsage();
+
+    int mNumber;
+    QString mType;
+    QList<UndoAction> mActions;
+    qint64 mMemoryUsage;
+};
+
 class UndoStack
 {
 friend class UndoWidget;
@@ -99,14 +157,15 @@ friend class UndoWidget;
 public:
     UndoStack(SystemObject *parentSystem);
 
-    QDomElement toXml();
-    void fromXml(QDomElement &undoElement);
+    void saveToDomElement(QDomElement &rDomElement) const;
+    void loadFromDomElement(const QDomElement &rUndoElement);
     void setEnabled(bool enabled);
     void clear(QString errorMsg = "");
     void newPost(QString type = "");
     void insertPost(QString str);
     void undoOneStep();
     void redoOneStep();
+    qint64 getMemoryUsage() const;
 
     void registerDeletedObject(ModelObject *item);
     void registerDeletedConnector(Connector *item);
@@ -135,13 +194,17 @@ private:
     int mCurrentStackPosition;
     bool mEnabled;
 
-    void addTextboxwidget(const QDomElement &rStuffElement);
-    void removeTextboxWidget(const QDomElement &rStuffElement);
-    void modifyTextboxWidget(QDomElement &rStuffElement);
+    void addAction(const UndoAction &rAction);
+    void limitMemoryUsage();
+    bool hasConnector(const UndoAction &rAction) const;
+    Connector *findConnector(const UndoAction &rAction) const;
+
+    void addTextboxwidget(const UndoAction &rAction);
+    void removeTextboxWidget(const UndoAction &rAction);
+    void modifyTextboxWidget(UndoAction &rAction);
 
-    QDomElement getCurrentPost();
-    QDomDocument mDomDocument;
-    QDomElement mUndoRoot;
+    UndoPost *getCurrentPost();
+    QList<UndoPost> mPosts;
 };
 
 
@@ -44,6 +44,10 @@
 #include <QDir>
 #include <QDebug>
 #include <QStringList>
+#include <QSvgRenderer>
+#include <QHash>
+#include <QDateTime>
+#include <QCoreApplication>
 #include <limits>
 #include <math.h>
 #include <complex>
@@ -359,21 +363,6 @@ QString parseVariableUnit(QString input)
 }
 
 
-//! @brief Converts a vector of real numbers to a vector of complex numbers with i=0
-//! @param realVector Vector with real numbers
-//! @returns Vector with complex numbers
-QVector< complex<double> > realToComplex(const QVector<double> &rRealVector)
-{
-    QVector< complex<double> > complexVector;
-    complexVector.reserve(rRealVector.size());
-    for(int i=0; i<rRealVector.size(); ++i)
-    {
-        complexVector.append(std::complex<double>(rRealVector[i], 0));
-    }
-    return complexVector;
-}
-
-
 //! @brief Apply windowing function
 //! Only Hann windows are supported for now
 //! @param data Vector with data to be windowed
@@ -428,86 +417,6 @@ void windowFunction(QVector<double> &data, WindowingFunctionEnumT function, doub
 }
 
 
-//! @brief Forward fast fourier transform
-//! Transforms given vector into its fourier transform.
-//! Even elements in the vector represents real numbers, and odd imaginary numbers.
-//! Original source:
-//! V. Myrnyy, A Simple and Efficient FFT Implementation in C++, Dr.Dobbs, 2007
-//! http://drdobbs.com/cpp/199500857
-//! @param data Vector with data
-void FFT(QVector< complex<double> > &data)
-{
-    unsigned long n = data.size();
-
-    qDebug() << "FFT of vector with size " << n;
-
-    unsigned long mmax, m, j, istep, i;
-    double wtemp, wr, wpr, wpi, wi, theta;
-    double tempr, tempi;
-
-    // Reverse-binary reindexing
-    j=1;
-    for (i=0; i<n; ++i)
-    {
-        if (j>i)
-        {
-#if __cplusplus >= 201103L // magse Värre än så. swap har flyttat från <algorithm> till <utility> i C++11
-            swap(data[j-1],  data[i]);
-#else
-            swap(data[j-1].real(), data[i].real());     // Even numbers
-            swap(data[j-1].imag(), data[i].imag());     // Odd numbers
-#endif
-        }
-        m = n>>1;
-        while (m>=2 && j>m)
-        {
-            j -= m;
-            m >>= 1;    //m = m/2
-        }
-        j += m;
-    };
-
-    // Here begins the Danielson-Lanczos section
-    mmax=1;
-    while (n>mmax)
-    {
-        istep = mmax<<1;
-        theta = -(M_PI/mmax);
-        wtemp = sin(0.5*theta);
-        wpr = -2.0*wtemp*wtemp;
-        wpi = sin(theta);
-        wr = 1.0;
-        wi = 0.0;
-        for (m=0; m < mmax; m++)
-        {
-            for (i=m; i < n; i += istep)
-            {
-                j=i+mmax;
-                tempr = wr*data[j].real() - wi*data[j].imag();
-                tempi = wr*data[j].imag() + wi*data[j].real();
-
-#if __cplusplus >= 201103L
-                data[j].real(data[i].real() - tempr);
-                data[j].imag(data[i].imag() - tempi);
-                data[i].real(data[i].real() + tempr);
-                data[i].imag(data[i].imag() + tempi);
-#else
-                data[j].real() = data[i].real() - tempr;
-                data[j].imag() = data[i].imag() - tempi;
-                data[i].real() += tempr;
-                data[i].imag() += tempi;
-#endif
-            }
-            wtemp=wr;
-            wr += wr*wpr - wi*wpi;
-            wi += wi*wpr + wtemp*wpi;
-        }
-        mmax=istep;
-    }
-    qDebug () << "FFT successful!";
-}
-
-
 //! @brief Resample a data vector to specified size using linear interpolation
 //! @param [in,out] vector Reference to vector that will be resampled
 //! @param newSize New size of vector
@@ -1231,3 +1140,31 @@ QStringList getAllAccessibleSystemParameterNames(SystemObject *pSystem) {
     }
     return parameterNames;
 }
+
+
+//! @brief Returns an SVG renderer for the given file, shared by all graphics items that show the same file
+//! @details Large models contain thousands of components and ports using the same few icons, parsing each icon only once
+//! considerably reduces model loading time. If the file has been modified since it was parsed a new renderer is created,
+//! items already using the old renderer keep it. Must only be called from the GUI thread.
+//! @param[in] rFilePath The path to the SVG file
+//! @returns A renderer owned by the application, never deleted by the caller
+QSvgRenderer *getSharedSvgRenderer(const QString &rFilePath)
+{
+    struct CachedSvgRenderer
+    {
+        QSvgRenderer *mpRenderer;
+        QDateTime mLastModified;
+    };
+    static QHash<QString, CachedSvgRenderer> cache;
+
+    const QDateTime lastModified = QFileInfo(rFilePath).lastModified();
+    auto it = cache.find(rFilePath);
+    if (it == cache.end() || it->mLastModified != lastModified)
+    {
+        CachedSvgRenderer cached;
+        cached.mpRenderer = new QSvgRenderer(rFilePath, QCoreApplication::instance());
+        cached.mLastModified = lastModified;
+        it = cache.insert(rFilePath, cached);
+    }
+    return it->mpRenderer;
+}
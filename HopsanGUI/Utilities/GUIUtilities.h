@@ -50,6 +50,7 @@
 
 class GUIMessageHandler;
 class SystemObject;
+class QSvgRenderer;
 
 QString readName(QTextStream &rTextStream);
 QString readName(QString namestring);
@@ -68,9 +69,7 @@ bool fuzzyLT(const double first, const double second, const double eps);
 void replaceWord(QString &string, QString before, QString after);
 QString parseVariableDescription(QString input);
 QString parseVariableUnit(QString input);
-QVector< std::complex<double> > realToComplex(const QVector<double> &rRealVector);
 void windowFunction(QVector<double> &data, WindowingFunctionEnumT function, double &Ca, double &Cb);
-void FFT(QVector< std::complex<double> > &data);
 void resampleVector(QVector<double> &vector, int newSize);
 void limitVectorToRange(QVector<double> &x, QVector<double> &y, double min, double max);
 void removeDir(QString path, qint64 age_seconds=-1);
@@ -173,4 +172,6 @@ private:
 
 bool saveXmlFile(QString xmlFilePath, GUIMessageHandler* pMessageHandler, std::function<QDomDocument()> saveFunction);
 
+QSvgRenderer *getSharedSvgRenderer(const QString &rFilePath);
+
 #endif // GUIUTILITIES_H
@@ -40,6 +40,7 @@
 #include <QHBoxLayout>
 #include <QInputDialog>
 #include <QMessageBox>
+#include <QElapsedTimer>
 
 
 //Hopsan includes
@@ -620,6 +621,9 @@ bool ModelWidget::simulate_nonblocking()
     {
         if(!mSimulateMutex.tryLock()) return false;
 
+        // The simulation will overwrite the core log data that the previous results may still be collected from
+        mpLogDataHandler->finishCollectingLogData();
+
         qDebug() << "Calling simulate_nonblocking()";
         mpSimulationThreadHandler->setSimulationTimeVariables(mStartTime.toDouble(), mStopTime.toDouble(), mpToplevelSystem->getLogStartTime(), mpToplevelSystem->getNumberOfLogSamples());
         mpSimulationThreadHandler->initSimulateFinalize(mpToplevelSystem);
@@ -670,11 +674,16 @@ bool ModelWidget::simulate_blocking()
     {
         if(!mSimulateMutex.tryLock()) return false;
 
+        mpLogDataHandler->finishCollectingLogData();
+
         mpSimulationThreadHandler->setSimulationTimeVariables(mStartTime.toDouble(), mStopTime.toDouble(), mpToplevelSystem->getLogStartTime(), mpToplevelSystem->getNumberOfLogSamples());
         mpSimulationThreadHandler->setProgressDilaogBehaviour(true, false);
         QVector<SystemObject*> vec;
         vec.push_back(mpToplevelSystem);
         mpSimulationThreadHandler->initSimulateFinalize_blocking(vec);
+
+        // Callers of the blocking simulation expect all results to be available when it returns
+        mpLogDataHandler->finishCollectingLogData();
     }
 
     return true;
@@ -688,6 +697,7 @@ bool ModelWidget::startRealtimeSimulation(const double realtimeFactor)
         gpMessageHandler->addErrorMessage("Simulation mutex is locked. Aborting.");
         return false;
     }
+    mpLogDataHandler->finishCollectingLogData();
     CoreSimulationHandler mCoreSimulationHandler;
     return mCoreSimulationHandler.startRealtimeSimulation(mpToplevelSystem->getCoreSystemAccessPtr(), realtimeFactor);
 }
@@ -1063,7 +1073,7 @@ void ModelWidget::collectPlotData(bool overWriteGeneration)
     if (mRemoteResultVariables.empty())
     {
         // Collect local data
-        mpLogDataHandler->collectLogDataFromModel(overWriteGeneration);
+        mpLogDataHandler->collectLogDataFromModel(overWriteGeneration, gpConfig->getBoolSetting(CFG_COLLECTPLOTTEDLOGDATAFIRST));
     }
     else
     {
@@ -1083,16 +1093,21 @@ void ModelWidget::revertModel()
 {
     QFileInfo modelfileinfo = mpToplevelSystem->getModelFileInfo();
 
-    // This will remove the current model and create a new empty one
-    createOrDestroyToplevelSystem(true);
-
-    // Now reload the model
     QFile modelFile(modelfileinfo.absoluteFilePath());
     if(!modelFile.exists())
     {
         gpMessageHandler->addErrorMessage("File not found: " + modelfileinfo.absoluteFilePath());
     }
-    loadModel(modelFile);
+
+    // Parse the file while the current model is still intact, events are processed while parsing
+    ModelFileParserThread parserThread(modelfileinfo.absoluteFilePath(), HMF_ROOTTAG);
+    parserThread.parseAndWait();
+
+    // This will remove the current model and create a new empty one
+    createOrDestroyToplevelSystem(true);
+
+    // Now reload the model
+    loadModel(modelFile, parserThread);
     mpGraphicsView->setContainerPtr(mpToplevelSystem);
     emit modelChanged(this);
 }
@@ -1283,6 +1298,12 @@ void ModelWidget::createOrDestroyToplevelSystem(bool recreate)
     // Destroy
     else
     {
+        // Log data must not be collected from the core after it has been deleted
+        if (mpLogDataHandler)
+        {
+            mpLogDataHandler->finishCollectingLogData();
+        }
+
         // First make sure that we go to the top level system, we don't want to be inside a subsystem while it is being deleted
         mpQuickNavigationWidget->gotoContainerAndCloseSubcontainers(0);
 
@@ -1374,16 +1395,26 @@ bool ModelWidget::loadModelRemote()
     return false;
 }
 
-bool ModelWidget::loadModel(QFile &rModelFile)
+//! @brief Builds the model from an already parsed model file
+//! @details The file must be parsed before the model is built, since the parser processes events while it runs
+//! @param[in] rModelFile The model file
+//! @param[in] rParsedModelFile The finished parser for the model file
+//! @returns True if the model was loaded
+bool ModelWidget::loadModel(QFile &rModelFile, const ModelFileParserThread &rParsedModelFile)
 {
     QFileInfo modelFileInfo(rModelFile);
 
+    // Check if this is an expected hmf xml file
+    if (!rParsedModelFile.wasParseSuccessful())
+    {
+        QMessageBox::information(0, "Hopsan GUI", rParsedModelFile.getErrorMessage());
+    }
+    QDomDocument domDocument = rParsedModelFile.getDomDocument();
+    QDomElement hmfRoot = rParsedModelFile.wasParseSuccessful() ? rParsedModelFile.getRootElement() : QDomElement();
+
     mpToplevelSystem->getCoreSystemAccessPtr()->addSearchPath(modelFileInfo.absoluteDir().absolutePath());
     mpToplevelSystem->setUndoEnabled(false, true);
 
-    // Check if this is an expected hmf xml file
-    QDomDocument domDocument;
-    QDomElement hmfRoot = loadXMLDomDocument(rModelFile, domDocument, HMF_ROOTTAG);
     if (!hmfRoot.isNull())
     {
         //! @todo check if we could load else give error message and don't attempt to load
@@ -1403,7 +1434,12 @@ bool ModelWidget::loadModel(QFile &rModelFile)
 
         mpToplevelSystem->setModelFileInfo(rModelFile); //Remember info about the file from which the data was loaded
         mpToplevelSystem->setAppearanceDataBasePath(modelFileInfo.absolutePath());
+        const qint64 parseMs = rParsedModelFile.getElapsedMs();
+        QElapsedTimer loadTimer;
+        loadTimer.start();
         mpToplevelSystem->loadFromDomElement(systemElement);
+        gpMessageHandler->addDebugMessage(QString("Loaded model %1 in %2 ms (parsing %3 ms, building %4 ms)").arg(modelFileInfo.fileName())
+                                          .arg(parseMs+loadTimer.elapsed()).arg(parseMs).arg(loadTimer.elapsed()));
 
         // Check for required libraries and show warning if they do not seem to be loaded
         QStringList loadedLibraryNames = gpLibraryHandler->getLoadedLibraryNames();
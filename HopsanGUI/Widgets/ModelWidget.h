@@ -56,6 +56,7 @@ class AnimationWidget;
 class SimulationThreadHandler;
 class GUIMessageHandler;
 class LogDataHandler2;
+class ModelFileParserThread;
 
 #include "CoreAccess.h"
 #include "RemoteCoreAccess.h"
@@ -101,7 +102,7 @@ public:
     bool isRemoteCoreConnected() const;
 
     bool loadModelRemote();
-    bool loadModel(QFile &rModelFile);
+    bool loadModel(QFile &rModelFile, const ModelFileParserThread &rParsedModelFile);
 
     SystemObject *getTopLevelSystemContainer() const;
     SystemObject *getViewContainerObject();
@@ -102,9 +102,23 @@ void UndoWidget::show()
 }
 
 
+//! @brief Refreshes the list when the widget becomes visible, since it is not refreshed while hidden
+void UndoWidget::showEvent(QShowEvent *event)
+{
+    refreshList();
+    QDialog::showEvent(event);
+}
+
+
 //! @brief Refresh function for the list. Reads from the current undo stack and displays the results in the table.
+//! The list is only refreshed when visible, rebuilding it for every registered action slows down large edits.
 void UndoWidget::refreshList()
 {
+    if(!isVisible())
+    {
+        return;
+    }
+
     if(gpModelHandler->count() == 0)
     {
         mpClearButton->setEnabled(false);
@@ -123,9 +137,6 @@ void UndoWidget::refreshList()
     mUndoTable->clear();
     mUndoTable->setRowCount(0);
 
-
-    //XML//
-
     QColor oddColor = QColor("white");
     QColor evenColor = QColor("whitesmoke");
     QColor activeColor = QColor("chartreuse");
@@ -135,82 +146,54 @@ void UndoWidget::refreshList()
         return;
     }
 
-    int pos = 0;
-    bool found = true;
-
-    //qDebug() << "refreshList for Undo in: " << gpModelHandler->getCurrentContainer();
-    //qDebug() << "refreshList for Undo in: " << gpModelHandler->getCurrentContainer()->getName();
-    QDomElement undoRoot = gpModelHandler->getCurrentViewContainerObject()->getUndoStackPtr()->mUndoRoot;
-    QDomElement postElement = undoRoot.firstChildElement("post");
-    while(found)
+    UndoStack *pUndoStack = gpModelHandler->getCurrentViewContainerObject()->getUndoStackPtr();
+    for(const UndoPost &rPost : pUndoStack->mPosts)
     {
-        found = false;
-        while(!postElement.isNull())
+        const int pos = rPost.mNumber;
+        if(pos < 0)
+        {
+            continue;
+        }
+
+        // Posts with a type are shown as one item, otherwise each action is shown
+        QStringList tags;
+        if(!rPost.mType.isEmpty())
+        {
+            tags.append(rPost.mType);
+        }
+        else
+        {
+            for(const UndoAction &rAction : rPost.mActions)
+            {
+                tags.append(rAction.mWhat);
+            }
+        }
+
+        for(const QString &rTag : tags)
         {
-            if(postElement.attribute("number").toInt() == pos)
+            item = new QTableWidgetItem();
+            item->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
+            item->setText(translateTag(rTag));
+            if(pos == pUndoStack->mCurrentStackPosition)
+            {
+                item->setBackgroundColor(activeColor);
+            }
+            else if(pos%2 == 0)
+            {
+                item->setBackgroundColor(evenColor);
+            }
+            else
+            {
+                item->setBackgroundColor(oddColor);
+            }
+            if(pos > pUndoStack->mCurrentStackPosition)
             {
-                //Found correct number, write it's contents to the list
-                found = true;
-                if(postElement.attribute("type") != QString())
-                {
-                    item = new QTableWidgetItem();
-                    item->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
-                    item->setText(translateTag(postElement.attribute("type")));
-                    if(pos == gpModelHandler->getCurrentViewContainerObject()->getUndoStackPtr()->mCurrentStackPosition)
-                    {
-                        item->setBackgroundColor(activeColor);
-                    }
-                    else if(pos%2 == 0)
-                    {
-                        item->setBackgroundColor(evenColor);
-                    }
-                    else
-                    {
-                        item->setBackgroundColor(oddColor);
-                    }
-                    if(pos > gpModelHandler->getCurrentViewContainerObject()->getUndoStackPtr()->mCurrentStackPosition)
-                    {
-                        item->setForeground(QColor("gray"));
-                    }
-                    mUndoTable->insertRow(0);
-                    mUndoTable->setItem(0,0,item);
-                }
-                else
-                {
-                    QDomElement stuffElement = postElement.firstChildElement("stuff");
-                    while(!stuffElement.isNull())
-                    {
-                        item = new QTableWidgetItem();
-                        item->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
-                        item->setText(translateTag(stuffElement.attribute("what")));
-                        if(pos == gpModelHandler->getCurrentViewContainerObject()->getUndoStackPtr()->mCurrentStackPosition)
-                        {
-                            item->setBackgroundColor(activeColor);
-                        }
-                        else if(pos%2 == 0)
-                        {
-                            item->setBackgroundColor(evenColor);
-                        }
-                        else
-                        {
-                            item->setBackgroundColor(oddColor);
-                        }
-                        if(pos > gpModelHandler->getCurrentViewContainerObject()->getUndoStackPtr()->mCurrentStackPosition)
-                        {
-                            item->setForeground(QColor("gray"));
-                        }
-                        mUndoTable->insertRow(0);
-                        mUndoTable->setItem(0,0,item);
-                        stuffElement = stuffElement.nextSiblingElement("stuff");
-                    }
-                }
-                break;
+                item->setForeground(QColor("gray"));
             }
-            postElement = postElement.nextSiblingElement("post");
+            mUndoTable->insertRow(0);
+            mUndoTable->setItem(0,0,item);
         }
-        ++pos;
     }
-    //qDebug() << gpModelHandler->getCurrentContainer()->mUndoStack->mDomDocument.toString();
 }
 
 
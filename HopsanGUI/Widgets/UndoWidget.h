@@ -54,6 +54,9 @@ public:
     QPushButton *getRedoButton();
     QPushButton *getClearButton();
 
+protected:
+    void showEvent(QShowEvent *event);
+
 private:
     QTableWidget *mUndoTable;
     QList< QList<QString> > mTempStack;
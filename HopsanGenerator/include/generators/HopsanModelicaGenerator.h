@@ -53,6 +53,7 @@ private:
     bool parseModelicaModel(QString code, QString &typeName, QString &displayName, QString &cqsType, QStringList &initAlgorithms, QStringList &algorithms, QStringList &equations, QList<PortSpecification> &portList, QList<ParameterSpecification> &parametersList, QList<VariableSpecification> &variablesList, QString &transform);
     bool generateComponentObject(ComponentSpecification &comp, QString &typeName, QString &displayName, QString &cqsType, QString &transform, QStringList &initAlgorithms, QStringList &algorithms, QStringList &plainEquations, QList<PortSpecification> &ports, QList<ParameterSpecification> &parameters, QList<VariableSpecification> &variables, QTextStream &logStream);
     bool sortEquationByVariables(QList<SymHop::Expression> &equations, QList<SymHop::Expression> &variables, QList<SymHop::Expression> &knowns);
+    QStringList generateOptimizedAssignments(const QStringList &targets, QList<SymHop::Expression> expressions, const QString &tempPrefix, const QString &description, QTextStream &logStream);
     bool verifyModelicaLine(const QString &line, int flags);
 };
 
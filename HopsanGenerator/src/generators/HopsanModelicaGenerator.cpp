@@ -988,6 +988,8 @@ bool HopsanModelicaGenerator::generateComponentObject(ComponentSpecification &co
     }
 
     //Differentiate each equation for each state variable to generate the Jacobian matrix
+    //Equations share many subexpressions, so memoize derivatives and simplifications while doing so
+    SymHop::setMemoizationEnabled(true);
     QList<QList<Expression> > jacobian;
     for(int e=0; e<systemEquations.size(); ++e)
     {
@@ -1005,6 +1007,13 @@ bool HopsanModelicaGenerator::generateComponentObject(ComponentSpecification &co
         jacobian.append(result);
     }
 
+    //Memoized derivatives are only shared within one equation system, so release them
+    int nMemoNodes;
+    qint64 nMemoHits, nMemoMisses;
+    SymHop::getMemoizationStatistics(nMemoNodes, nMemoHits, nMemoMisses);
+    logStream << "Jacobian memoization: " << nMemoNodes << " nodes, " << nMemoHits << " hits, " << nMemoMisses << " misses\n";
+    SymHop::setMemoizationEnabled(false);
+
     //Expand power functions for performance
     for(auto &equation : systemEquations) {
         equation.expandPowers();
@@ -1203,9 +1212,11 @@ bool HopsanModelicaGenerator::generateComponentObject(ComponentSpecification &co
             comp.auxiliaryFunctions << "    double "+unknowns[u].toString()+" = y["+QString::number(u)+"];";
         }
         comp.auxiliaryFunctions << "    ";
+        QStringList residualTargets;
         for(int e=0; e<systemEquations.size(); ++e) {
-            comp.auxiliaryFunctions << "    res["+QString::number(e)+"] = "+systemEquations[e].toString()+";";
+            residualTargets << "res["+QString::number(e)+"]";
         }
+        comp.auxiliaryFunctions << generateOptimizedAssignments(residualTargets, systemEquations, "cseRes", "residuals", logStream);
         comp.auxiliaryFunctions << "}";
 
         comp.auxiliaryFunctions << "";
@@ -1221,13 +1232,17 @@ bool HopsanModelicaGenerator::generateComponentObject(ComponentSpecification &co
         comp.auxiliaryFunctions << "    ";
 
         //Only compute Jacobian elements that are non-zero for best performance
+        QStringList jacobianTargets;
+        QList<Expression> jacobianElements;
         for(int i=0; i<jacobian.size(); ++i) {
             for(int j=0; j<jacobian[i].size(); ++j) {
                 if(jacobian[i][j] != Expression(0)) {
-                    comp.auxiliaryFunctions << QString("    J[%2*%3+%1] = ").arg(i).arg(j).arg(unknowns.size()) + jacobian[i][j].toString() + ";";
+                    jacobianTargets << QString("J[%2*%3+%1]").arg(i).arg(j).arg(unknowns.size());
+                    jacobianElements << jacobian[i][j];
                 }
             }
         }
+        comp.auxiliaryFunctions << generateOptimizedAssignments(jacobianTargets, jacobianElements, "cseJac", "Jacobian", logStream);
         comp.auxiliaryFunctions << "}";
     }
 
@@ -1238,6 +1253,42 @@ bool HopsanModelicaGenerator::generateComponentObject(ComponentSpecification &co
 
 
 
+//! @brief Generates assignment code lines, where sub-expressions used more than once are stored in temporary variables
+//! @details Small integer powers are written as multiplications. The number of operations before and after is reported.
+//! @param targets Left-hand side of each assignment
+//! @param expressions Right-hand side expression of each assignment
+//! @param tempPrefix Name prefix for the temporary variables
+//! @param description Description of the assignments, used in the operation count report
+//! @param logStream Stream for the generator log
+//! @returns Code lines with temporary variable declarations followed by the assignments
+QStringList HopsanModelicaGenerator::generateOptimizedAssignments(const QStringList &targets, QList<Expression> expressions, const QString &tempPrefix, const QString &description, QTextStream &logStream)
+{
+    OperationCount opsBefore, opsAfter;
+    for(const Expression &expr : expressions) {
+        opsBefore += countOperations(expr);
+    }
+
+    QList<Expression> temporaries;
+    eliminateCommonSubexpressions(expressions, temporaries, tempPrefix);
+
+    QStringList code;
+    for(const Expression &temp : temporaries) {
+        code << "    const double "+temp.getLeft()->toString()+" = "+temp.getRight()->toCodeString()+";";
+        opsAfter += countOperations(*temp.getRight(), true);
+    }
+    for(int i=0; i<expressions.size(); ++i) {
+        code << "    "+targets[i]+" = "+expressions[i].toCodeString()+";";
+        opsAfter += countOperations(expressions[i], true);
+    }
+
+    printMessage(QString("Operation count for %1: %2 before optimization").arg(description).arg(opsBefore.toString()));
+    printMessage(QString("Operation count for %1: %2 after optimization, using %3 temporary variables").arg(description).arg(opsAfter.toString()).arg(temporaries.size()));
+    logStream << "Operation count for " << description << ": " << opsBefore.total() << " before and " << opsAfter.total() << " after optimization\n";
+
+    return code;
+}
+
+
 //! @brief Sorts and equation system by its depending variables, so that it can be solved equation-by-equation
 //! @param equations List with equations to sort
 //! @param variables Empty list that will contain corresponding variables
@@ -15,6 +15,7 @@ TARGET = $${TARGET}$${DEBUG_EXT}
 
 # Allow non-strict ansi code
 QMAKE_CXXFLAGS *= -U__STRICT_ANSI__ -Wno-c++0x-compat
+unix:LIBS *= -pthread
 
 #--------------------------------------------------
 # Add the include path to our self, (Ops)
@@ -49,6 +50,11 @@ SOURCES += \
     src/OpsWorkerComplexRF.cpp \
     src/OpsWorkerNelderMead.cpp \
     src/OpsEvaluator.cpp \
+    src/OpsEvaluationCache.cpp \
+    src/OpsSurrogateModel.cpp \
+    src/OpsParallelEvaluator.cpp \
+    src/OpsExperimentDesign.cpp \
+    src/OpsSweepRunner.cpp \
     src/OpsWorkerParticleSwarm.cpp \
     src/OpsWorkerComplexRFP.cpp \
     src/OpsWorkerParamterSweep.cpp \
@@ -65,6 +71,11 @@ HEADERS += \
     include/OpsWorkerComplexRF.h \
     include/OpsWorkerNelderMead.h \
     include/OpsEvaluator.h \
+    include/OpsEvaluationCache.h \
+    include/OpsSurrogateModel.h \
+    include/OpsParallelEvaluator.h \
+    include/OpsExperimentDesign.h \
+    include/OpsSweepRunner.h \
     include/OpsWorkerParticleSwarm.h \
     include/OpsWorkerComplexRFP.h \
     include/OpsWorkerParameterSweep.h \
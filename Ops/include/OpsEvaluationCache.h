@@ -0,0 +1,83 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+//!
+//! @file   OpsEvaluationCache.h
+//!
+//! @brief Contains a cache of objective values for previously evaluated parameter sets
+//!
+//$Id$
+
+#ifndef OPSEVALUATIONCACHE_H
+#define OPSEVALUATIONCACHE_H
+
+#include <vector>
+#include <map>
+#include <string>
+
+#include "OpsWin32DLL.h"
+
+namespace Ops {
+
+//! @brief Stores objective values keyed by model hash and quantized parameter values
+//! @details Parameter values are rounded to a relative tolerance, so candidates that only differ by numerical noise
+//! share the same entry. The model hash identifies the model and objective function, so that a cache file can be shared
+//! by several models and stale entries are never used after the model has changed.
+class OPS_DLLAPI EvaluationCache
+{
+public:
+    EvaluationCache();
+
+    void setModelHash(const std::string &hash);
+    const std::string &getModelHash() const;
+    void setTolerance(double relativeTolerance);
+
+    bool lookup(const std::vector<double> &rParameters, double &rObjective) const;
+    void store(const std::vector<double> &rParameters, double objective);
+    void clear();
+    size_t size() const;
+
+    bool load(const std::string &filePath);
+    bool save(const std::string &filePath) const;
+
+    static std::string computeHash(const std::string &rData);
+
+private:
+    typedef std::vector<long long> KeyT;
+    struct Entry
+    {
+        std::vector<double> parameters;
+        double objective;
+    };
+
+    KeyT makeKey(const std::vector<double> &rParameters) const;
+
+    std::string mModelHash;
+    double mTolerance;
+    std::map<KeyT, Entry> mEntries;
+    std::vector<std::string> mOtherModelLines;
+};
+
+}
+
+#endif // OPSEVALUATIONCACHE_H
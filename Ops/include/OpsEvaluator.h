@@ -36,10 +36,10 @@
 
 #include <stdlib.h>
 #include <vector>
-#include <deque>
 
 #include "OpsWin32DLL.h"
-#include "matrix.h"
+#include "OpsEvaluationCache.h"
+#include "OpsSurrogateModel.h"
 
 namespace Ops {
 
@@ -56,31 +56,40 @@ public:
     virtual void evaluateAllPoints();               //Can be re-implemented
     virtual void evaluateCandidate(size_t idx);        //Must be re-implemented
     virtual void evaluateAllCandidates();           //Can be re-implemented
+    virtual void evaluateCandidates(const std::vector<size_t> &rIndices);   //Can be re-implemented
     void evaluateAllPointsWithSurrogateModel();
     bool evaluateAllCandidatesWithSurrogateModel();
     void evaluateCandidateWithSurrogateModel(size_t idx);
 
-protected:
-    Worker *mpWorker;
-
-private:
-    void updateSurrogateModel();
-    void storeValuesForMetaModel(size_t idx);
+    void setUseCache(bool value);
+    bool isUsingCache() const;
+    EvaluationCache &getCache();
 
-    size_t mStorageSize;
-    Vec* mpSurrogateModelCoefficients = nullptr;
-    std::deque< std::vector<double> > mStoredParameters;
+    void setSurrogateModel(SurrogateModelT type);
+    void setSurrogateModel(SurrogateModel *pModel);
+    SurrogateModel *getSurrogateModel();
+    void setScreeningFraction(double value);
+    size_t getNumberOfScreenedCandidates() const;
 
-    Vec *mpStoredObjectives = nullptr;
-    Matrix *mpMatrix = nullptr;
+protected:
+    bool lookupCachedObjective(const std::vector<double> &rParameters, double &rObjective);
+    void storeCachedObjective(const std::vector<double> &rParameters, double objective);
 
-    double mPercDiff;
-    int mCountMax;
+    Worker *mpWorker;
 
-    bool mUseMetaModel;
-    bool mSurrogateModelExist;
-    size_t mSurrogateModelEvaluations;
-    bool mSurrogateModelInitialized;
+private:
+    void evaluateCandidateCached(size_t idx);
+    bool prepareSurrogateModel();
+    double getWorstObjective() const;
+
+    SurrogateModel *mpSurrogateModel;
+    bool mSurrogateModelPrepared;
+    double mScreeningFraction;
+    size_t mNumPredictionsSinceRefresh;
+    size_t mNumScreenedCandidates;
+
+    bool mUseCache;
+    EvaluationCache mCache;
 };
 
 }
@@ -0,0 +1,85 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+//!
+//! @file   OpsExperimentDesign.h
+//!
+//! @brief Contains generators for design of experiments sampling plans
+//!
+//$Id$
+
+#ifndef OPSEXPERIMENTDESIGN_H
+#define OPSEXPERIMENTDESIGN_H
+
+#include <vector>
+#include <string>
+
+#include "OpsWin32DLL.h"
+
+namespace Ops {
+
+enum DesignT {DesignFullFactorial, DesignLatinHypercube, DesignSobol, DesignHalton, DesignRandom};
+
+//! @brief Generates the parameter values of each run in a design of experiments
+//! @details Points are computed from the run index, so getPoint() can be called concurrently and in any order once
+//! prepare() has been called. The same settings and seed always give the same points, which allows interrupted sweeps
+//! to be resumed.
+class OPS_DLLAPI ExperimentDesign
+{
+public:
+    ExperimentDesign();
+
+    void setDesign(DesignT design);
+    DesignT getDesign() const;
+    void setNumberOfParameters(size_t value);
+    size_t getNumberOfParameters() const;
+    void setParameterLimits(size_t idx, double min, double max);
+    void getParameterLimits(size_t idx, double &rMin, double &rMax) const;
+    void setNumberOfLevels(size_t idx, size_t levels);
+    size_t getNumberOfLevels(size_t idx) const;
+    void setNumberOfRuns(size_t value);
+    size_t getNumberOfRuns() const;
+    void setRandomSeed(unsigned int seed);
+    unsigned int getRandomSeed() const;
+
+    bool prepare(std::string &rErrorMessage);
+    void getPoint(size_t run, std::vector<double> &rPoint) const;
+
+    static size_t getMaxNumberOfSobolDimensions();
+
+private:
+    double getUnitCoordinate(size_t run, size_t dim) const;
+
+    DesignT mDesign;
+    size_t mNumRuns;
+    unsigned int mSeed;
+    std::vector<double> mParameterMin, mParameterMax;
+    std::vector<size_t> mNumLevels;
+    std::vector<std::vector<size_t> > mPermutations;
+    std::vector<std::vector<unsigned int> > mDirectionNumbers;
+    std::vector<unsigned int> mPrimes;
+};
+
+}
+
+#endif // OPSEXPERIMENTDESIGN_H
@@ -33,7 +33,7 @@ namespace Ops {
 class MessageHandler
 {
 public:
-    MessageHandler() { mIsAborted = false;}
+    MessageHandler() { mIsAborted = false; mNumCacheHits = 0; mNumCacheMisses = 0; }
 
     void printMessage(std::string msg)
     {
@@ -50,6 +50,10 @@ public:
     virtual void objectiveChanged(size_t) {}
     virtual void objectivesChanged() {}
     virtual void stepCompleted(size_t) {}
+    virtual void cacheLookedUp(bool hit) { if(hit) { ++mNumCacheHits; } else { ++mNumCacheMisses; } }
+
+    size_t getNumberOfCacheHits() const { return mNumCacheHits; }
+    size_t getNumberOfCacheMisses() const { return mNumCacheMisses; }
 
     bool aborted() { return mIsAborted; }
 
@@ -57,6 +61,8 @@ public:
 
 protected:
     bool mIsAborted;
+    size_t mNumCacheHits;
+    size_t mNumCacheMisses;
 };
 
 }
@@ -0,0 +1,100 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   OpsParallelEvaluator.h
+//!
+//! @brief Contains the parallel optimization evaluator base class
+//!
+//$Id$
+
+#ifndef OPSPARALLELEVALUATOR_H
+#define OPSPARALLELEVALUATOR_H
+
+#include <vector>
+#include <random>
+#include <atomic>
+#include <chrono>
+
+#include "OpsWin32DLL.h"
+#include "OpsEvaluator.h"
+
+namespace Ops {
+
+class ParallelEvaluatorPool;
+
+//! @brief Evaluator base class that evaluates populations concurrently in a pool of threads
+//! @details Each thread owns one model context (for example one copy of a simulation model), identified by an index.
+//! Sub classes only need to implement evaluateParameters(), which must be safe to call concurrently for different contexts.
+//! Populations are evaluated with the evaluateAll...() functions, asynchronous algorithms use submitEvaluation() and
+//! waitForEvaluation() instead.
+class OPS_DLLAPI ParallelEvaluator : public Evaluator
+{
+    friend class ParallelEvaluatorPool;
+public:
+    ParallelEvaluator(size_t numContexts);
+    virtual ~ParallelEvaluator();
+
+    size_t getNumberOfContexts() const;
+    void setNumberOfThreads(size_t numThreads);
+    size_t getNumberOfThreads() const;
+    void setRandomSeed(unsigned int seed);
+
+    virtual void evaluateAllPoints();
+    virtual void evaluateCandidate(size_t idx);
+    virtual void evaluateAllCandidates();
+    virtual void evaluateCandidates(const std::vector<size_t> &rIndices);
+
+    virtual double evaluateParameters(const std::vector<double> &rParameters, size_t context) = 0;    //Must be re-implemented
+
+    void submitEvaluation(size_t id, const std::vector<double> &rParameters);
+    bool waitForEvaluation(size_t &rId, double &rObjective);
+    size_t getNumberOfPendingEvaluations() const;
+
+    void resetStatistics();
+    size_t getNumberOfCompletedEvaluations() const;
+    double getElapsedTime() const;
+    double getThroughput() const;
+    double getUtilization() const;
+
+protected:
+    double contextRand(size_t context);
+
+private:
+    double evaluateTimed(const std::vector<double> &rParameters, size_t context);
+    ParallelEvaluatorPool *getPool();
+    void evaluateInParallel(const std::vector<std::vector<double> > &rPoints, std::vector<double> &rObjectives);
+
+    size_t mNumContexts;
+    size_t mNumThreads;
+    ParallelEvaluatorPool *mpPool;
+    std::vector<std::mt19937> mContextGenerators;
+    std::atomic<size_t> mNumCompletedEvaluations;
+    std::atomic<long long> mBusyNanoseconds;
+    std::chrono::steady_clock::time_point mStatisticsStartTime;
+};
+
+}
+
+#endif // OPSPARALLELEVALUATOR_H
@@ -0,0 +1,142 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+//!
+//! @file   OpsSurrogateModel.h
+//!
+//! @brief Contains surrogate models used for pre-screening candidates before they are simulated
+//!
+//$Id$
+
+#ifndef OPSSURROGATEMODEL_H
+#define OPSSURROGATEMODEL_H
+
+#include <cstddef>
+#include <vector>
+#include <deque>
+
+#include "OpsWin32DLL.h"
+
+namespace Ops {
+
+enum SurrogateModelT {SurrogateQuadratic, SurrogateRadialBasis};
+
+//! @brief Base class for surrogate models that approximate the objective function from evaluated samples
+//! @details Samples are added one at a time with addSample() and the model is refitted with update(). Only the most recent
+//! samples are kept (see setMaxNumberOfSamples()). Parameters are scaled to [-1,1] using the parameter limits, which must
+//! be set before any samples are added. Predictions are made for whole batches of points at once.
+class OPS_DLLAPI SurrogateModel
+{
+public:
+    SurrogateModel();
+    virtual ~SurrogateModel();
+
+    void setParameterLimits(const std::vector<double> &rMin, const std::vector<double> &rMax);
+    size_t getNumberOfParameters() const;
+    void setMaxNumberOfSamples(size_t value);
+    size_t getMaxNumberOfSamples() const;
+    size_t getNumberOfSamples() const;
+    virtual size_t getMinNumberOfSamples() const = 0;
+
+    void addSample(const std::vector<double> &rParameters, double objective);
+    void clear();
+    bool update();
+    bool isReady() const;
+
+    double predict(const std::vector<double> &rParameters) const;
+    void predict(const std::vector<std::vector<double> > &rPoints, std::vector<double> &rPredictions) const;
+
+protected:
+    virtual size_t getDefaultMaxNumberOfSamples() const = 0;
+    virtual void sampleAdded() = 0;
+    virtual void sampleRemoved() = 0;
+    virtual void samplesCleared() = 0;
+    virtual bool fit() = 0;
+    virtual void predictScaled(const double *pPoints, size_t numPoints, double *pPredictions) const = 0;
+
+    std::deque<std::vector<double> > mSamples;      //!< Scaled parameter values
+    std::deque<double> mSampleObjectives;
+
+private:
+    std::vector<double> mOffset, mScale;
+    size_t mMaxNumSamples;
+    bool mReady;
+};
+
+
+//! @brief Full quadratic response surface, fitted by least squares
+//! @details The normal equations are updated incrementally when samples are added or removed, so refitting only requires
+//! solving a system with one row per coefficient, regardless of the number of samples.
+class OPS_DLLAPI QuadraticSurrogateModel : public SurrogateModel
+{
+public:
+    QuadraticSurrogateModel();
+
+    size_t getMinNumberOfSamples() const;
+
+protected:
+    size_t getDefaultMaxNumberOfSamples() const;
+    void sampleAdded();
+    void sampleRemoved();
+    void samplesCleared();
+    bool fit();
+    void predictScaled(const double *pPoints, size_t numPoints, double *pPredictions) const;
+
+private:
+    size_t getNumberOfCoefficients() const;
+    void calculateFeatures(const double *pPoint, double *pFeatures) const;
+    void accumulate(const std::vector<double> &rPoint, double objective, double sign);
+    void rebuild();
+
+    std::vector<double> mNormalMatrix, mNormalVector, mCoefficients, mFeatures;
+    size_t mNumDowndates;
+};
+
+
+//! @brief Radial basis function interpolation with a cubic kernel and a linear polynomial tail
+//! @details The kernel matrix is extended incrementally when samples are added and shrunk when old samples are removed.
+class OPS_DLLAPI RadialBasisSurrogateModel : public SurrogateModel
+{
+public:
+    RadialBasisSurrogateModel();
+
+    size_t getMinNumberOfSamples() const;
+
+protected:
+    size_t getDefaultMaxNumberOfSamples() const;
+    void sampleAdded();
+    void sampleRemoved();
+    void samplesCleared();
+    bool fit();
+    void predictScaled(const double *pPoints, size_t numPoints, double *pPredictions) const;
+
+private:
+    std::deque<std::vector<double> > mKernel;
+    std::vector<double> mCenters, mWeights, mTail;
+};
+
+SurrogateModel *createSurrogateModel(SurrogateModelT type);
+
+}
+
+#endif // OPSSURROGATEMODEL_H
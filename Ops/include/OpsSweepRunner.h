@@ -0,0 +1,98 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+//!
+//! @file   OpsSweepRunner.h
+//!
+//! @brief Contains the design of experiments sweep engine
+//!
+//$Id$
+
+#ifndef OPSSWEEPRUNNER_H
+#define OPSSWEEPRUNNER_H
+
+#include <vector>
+#include <string>
+#include <set>
+
+#include "OpsWin32DLL.h"
+#include "OpsExperimentDesign.h"
+
+namespace Ops {
+
+class MessageHandler;
+
+//! @brief Evaluates one run of a sweep and returns its scalar outputs
+//! @details Sub classes must make evaluateRun() safe to call concurrently for different contexts, for example by using
+//! one model instance per context.
+class OPS_DLLAPI SweepEvaluator
+{
+public:
+    virtual ~SweepEvaluator() {}
+
+    virtual size_t getNumberOfContexts() const = 0;
+    virtual std::vector<std::string> getOutputNames() const = 0;
+    virtual bool evaluateRun(const std::vector<double> &rParameters, size_t context, std::vector<double> &rOutputs) = 0;
+};
+
+//! @brief Executes all runs of an experiment design in parallel and streams the results to a CSV file
+//! @details Each completed run is appended as one row (run index, parameter values, output values) and flushed
+//! immediately, so results are never kept in memory. If the result file already exists with the same columns, runs
+//! found in it are skipped, so an interrupted sweep continues where it stopped. Failed runs are not written and are
+//! therefore retried when the sweep is resumed.
+class OPS_DLLAPI SweepRunner
+{
+public:
+    SweepRunner(SweepEvaluator *pEvaluator, MessageHandler *pMessageHandler);
+
+    ExperimentDesign &getDesign();
+    void setParameterNames(const std::vector<std::string> &names);
+    void setNumberOfThreads(size_t numThreads);
+    size_t getNumberOfThreads() const;
+    void setResultFile(const std::string &filePath);
+    void setResume(bool value);
+
+    bool run();
+
+    size_t getNumberOfCompletedRuns() const;
+    size_t getNumberOfResumedRuns() const;
+    size_t getNumberOfFailedRuns() const;
+
+private:
+    std::string createSignature() const;
+    std::string createHeader() const;
+    bool readCompletedRuns(std::set<size_t> &rCompletedRuns);
+
+    SweepEvaluator *mpEvaluator;
+    MessageHandler *mpMessageHandler;
+    ExperimentDesign mDesign;
+    std::vector<std::string> mParameterNames;
+    size_t mNumThreads;
+    std::string mResultFile;
+    bool mResume;
+    size_t mNumCompletedRuns, mNumResumedRuns, mNumFailedRuns;
+};
+
+}
+
+#endif // OPSSWEEPRUNNER_H
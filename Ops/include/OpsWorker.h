@@ -36,6 +36,7 @@
 
 #include <vector>
 #include <string>
+#include <random>
 
 #include "OpsWin32DLL.h"
 
@@ -45,6 +46,7 @@ enum AlgorithmT {Undefined, NelderMead, ComplexRF, ComplexRFP,  ParticleSwarm, D
 enum SamplingT {SamplingRandom, SamplingLatinHypercube};
 
 class Evaluator;
+class ParallelEvaluator;
 class MessageHandler;
 
 template<typename T>
@@ -95,6 +97,7 @@ public:
     void getParameterLimits(size_t idx, double &min, double &max) const;
 
     void setCandidateObjectiveValue(size_t idx, double value);
+    double getCandidateObjectiveValue(size_t idx) const;
     double getObjectiveValue(size_t idx) const;
     std::vector<double> &getObjectiveValues();
     std::vector<std::vector<double> > &getPoints();
@@ -117,6 +120,7 @@ public:
     void setTolerance(double value);
     void setSamplingMethod(SamplingT dist);
     void setUseSurrogateModel(size_t interval);
+    void setAsynchronous(bool value);
 
     size_t getNumberOfCandidates();
     size_t getNumberOfPoints();
@@ -125,10 +129,14 @@ public:
     size_t getCurrentNumberOfIterations();
 
     double opsRand();
+    void setRandomSeed(unsigned int seed);
 
     bool aborted();
 
 protected:
+    ParallelEvaluator *getAsynchronousEvaluator();
+    void printEvaluationStatistics(const ParallelEvaluator *pEvaluator);
+
     size_t mIterationCounter;
     size_t mNumCandidates;
     size_t mNumPoints;
@@ -148,6 +156,8 @@ protected:
     std::vector<std::pair<size_t,size_t>> mIgnoredWhenSampling;
     bool mUseSurrogateModel;
     size_t mNumSurrogateModelUpdateInterval;
+    bool mAsynchronous;
+    std::mt19937 mRandomGenerator;
 };
 
 }
@@ -51,6 +51,8 @@ public:
 
 private:
     void moveParticle(int p);
+    void generateTrial(size_t p);
+    void runAsynchronous(ParallelEvaluator *pEvaluator);
 protected:
     double mCR, mF;
     void getRandomIds(size_t notId, size_t &id1, size_t &id2, size_t &id3, size_t &id4);
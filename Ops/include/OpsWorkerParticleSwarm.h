@@ -76,6 +76,8 @@ protected:
 
 private:
     void moveParticle(int p);
+    bool updateInertia();
+    void runAsynchronous(ParallelEvaluator *pEvaluator);
 protected:
     double mRandomFactor;
 
@@ -0,0 +1,231 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+//!
+//! @file   OpsEvaluationCache.cpp
+//!
+//! @brief Contains a cache of objective values for previously evaluated parameter sets
+//!
+//$Id$
+
+#include <cmath>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <limits>
+
+#include "OpsEvaluationCache.h"
+
+using namespace Ops;
+
+EvaluationCache::EvaluationCache()
+{
+    mModelHash = "0";
+    mTolerance = 1e-9;
+}
+
+
+//! @brief Sets the hash that identifies the model and objective function, entries for other hashes are never used
+//! @param [in] hash Hash string, whitespace is replaced since the hash is stored as a single word in cache files
+void EvaluationCache::setModelHash(const std::string &hash)
+{
+    mModelHash = hash.empty() ? "0" : hash;
+    for(char &c : mModelHash)
+    {
+        if(std::isspace(static_cast<unsigned char>(c)))
+        {
+            c = '_';
+        }
+    }
+}
+
+
+const std::string &EvaluationCache::getModelHash() const
+{
+    return mModelHash;
+}
+
+
+//! @brief Sets the relative tolerance used when quantizing parameter values, clears the cache since existing keys become invalid
+void EvaluationCache::setTolerance(double relativeTolerance)
+{
+    if(relativeTolerance > 0 && relativeTolerance != mTolerance)
+    {
+        mTolerance = relativeTolerance;
+        std::map<KeyT, Entry> entries;
+        entries.swap(mEntries);
+        for(const auto &rEntry : entries)
+        {
+            store(rEntry.second.parameters, rEntry.second.objective);
+        }
+    }
+}
+
+
+//! @brief Looks up the objective value of a parameter set
+//! @returns True if the parameter set (within tolerance) has been stored before
+bool EvaluationCache::lookup(const std::vector<double> &rParameters, double &rObjective) const
+{
+    std::map<KeyT, Entry>::const_iterator it = mEntries.find(makeKey(rParameters));
+    if(it == mEntries.end())
+    {
+        return false;
+    }
+    rObjective = it->second.objective;
+    return true;
+}
+
+
+//! @brief Stores the objective value of a parameter set, NaN objectives are not stored
+void EvaluationCache::store(const std::vector<double> &rParameters, double objective)
+{
+    if(std::isnan(objective))
+    {
+        return;
+    }
+    Entry &rEntry = mEntries[makeKey(rParameters)];
+    rEntry.parameters = rParameters;
+    rEntry.objective = objective;
+}
+
+
+void EvaluationCache::clear()
+{
+    mEntries.clear();
+}
+
+
+size_t EvaluationCache::size() const
+{
+    return mEntries.size();
+}
+
+
+//! @brief Loads entries from a cache file, entries for other model hashes are kept so that they are written back by save()
+//! @param [in] filePath Path to the cache file
+//! @returns False if the file could not be opened
+bool EvaluationCache::load(const std::string &filePath)
+{
+    std::ifstream file(filePath.c_str());
+    if(!file.good())
+    {
+        return false;
+    }
+
+    mOtherModelLines.clear();
+    std::string line;
+    while(std::getline(file, line))
+    {
+        if(line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream lineStream(line);
+        std::string hash;
+        double objective;
+        size_t numParameters;
+        if(!(lineStream >> hash >> objective >> numParameters))
+        {
+            continue;
+        }
+        if(hash != mModelHash)
+        {
+            mOtherModelLines.push_back(line);
+            continue;
+        }
+        std::vector<double> parameters(numParameters);
+        for(size_t i=0; i<numParameters && lineStream; ++i)
+        {
+            lineStream >> parameters[i];
+        }
+        if(lineStream)
+        {
+            store(parameters, objective);
+        }
+    }
+    return true;
+}
+
+
+//! @brief Writes all entries to a cache file, one line per entry: model hash, objective, number of parameters, parameters
+//! @param [in] filePath Path to the cache file, it is overwritten
+//! @returns False if the file could not be written
+bool EvaluationCache::save(const std::string &filePath) const
+{
+    std::ofstream file(filePath.c_str());
+    if(!file.good())
+    {
+        return false;
+    }
+
+    file.precision(std::numeric_limits<double>::max_digits10);
+    file << "# Ops evaluation cache: model hash, objective, number of parameters, parameter values\n";
+    for(const std::string &rLine : mOtherModelLines)
+    {
+        file << rLine << "\n";
+    }
+    for(const auto &rEntry : mEntries)
+    {
+        file << mModelHash << " " << rEntry.second.objective << " " << rEntry.second.parameters.size();
+        for(double value : rEntry.second.parameters)
+        {
+            file << " " << value;
+        }
+        file << "\n";
+    }
+    return file.good();
+}
+
+
+//! @brief Computes a 64-bit FNV-1a hash, use this to create model hashes that are stable between runs and platforms
+//! @param [in] rData Data identifying the model and objective function, for example the model file contents
+//! @returns The hash as a hexadecimal string
+std::string EvaluationCache::computeHash(const std::string &rData)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    for(unsigned char c : rData)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    std::ostringstream ss;
+    ss << std::hex << hash;
+    return ss.str();
+}
+
+
+//! @brief Quantizes parameter values to the relative tolerance, each value gives a binary exponent and a rounded mantissa
+EvaluationCache::KeyT EvaluationCache::makeKey(const std::vector<double> &rParameters) const
+{
+    KeyT key;
+    key.reserve(2*rParameters.size());
+    for(double value : rParameters)
+    {
+        int exponent;
+        double mantissa = std::frexp(value, &exponent);
+        long long quantized = std::llround(mantissa/mTolerance);
+        key.push_back(exponent);
+        key.push_back(quantized);
+    }
+    return key;
+}
@@ -39,29 +39,26 @@
 #include "OpsEvaluator.h"
 #include "OpsWorker.h"
 #include "OpsMessageHandler.h"
-#include "ludcmp.h"
-#include "matrix.h"
 
 #include <cmath>
+#include <limits>
+#include <numeric>
 
 using namespace Ops;
 
 Evaluator::Evaluator()
 {
-    mSurrogateModelInitialized = false;
+    mpSurrogateModel = nullptr;
+    mSurrogateModelPrepared = false;
+    mScreeningFraction = 0.5;
+    mNumPredictionsSinceRefresh = 0;
+    mNumScreenedCandidates = 0;
+    mUseCache = false;
 }
 
 Evaluator::~Evaluator()
 {
-    if(mpSurrogateModelCoefficients != nullptr) {
-        delete mpSurrogateModelCoefficients;
-    }
-    if(mpStoredObjectives != nullptr) {
-        delete mpStoredObjectives;
-    }
-    if(mpMatrix != nullptr) {
-        delete mpMatrix;
-    }
+    delete mpSurrogateModel;
 }
 
 
@@ -85,30 +82,25 @@ void Evaluator::evaluateAllPoints()
         for(size_t i=0; i<mpWorker->mNumPoints && !mpWorker->aborted(); ++i)
         {
             mpWorker->mCandidatePoints[0] = mpWorker->mPoints[i];
-            evaluateCandidate(0);
+            evaluateCandidateCached(0);
             mpWorker->mObjectives[i] = mpWorker->mCandidateObjectives[0];
         }
     }
 }
 
 
+//! @brief Evaluates all points and uses the results to train the surrogate model (if enabled)
 void Evaluator::evaluateAllPointsWithSurrogateModel()
 {
-    if(mpWorker->mNumCandidates == mpWorker->mNumPoints)
-    {
-        mpWorker->mCandidatePoints = mpWorker->mPoints;
-        evaluateAllCandidatesWithSurrogateModel();
-        mpWorker->mObjectives = mpWorker->mCandidateObjectives;
+    evaluateAllPoints();
+    if(!mpWorker->mUseSurrogateModel || !prepareSurrogateModel()) {
+        return;
     }
-    else
-    {
-        for(size_t i=0; i<mpWorker->mNumPoints && !mpWorker->aborted(); ++i)
-        {
-            mpWorker->mCandidatePoints[0] = mpWorker->mPoints[i];
-            evaluateCandidateWithSurrogateModel(0);
-            mpWorker->mObjectives[i] = mpWorker->mCandidateObjectives[0];
-        }
+    for(size_t i=0; i<mpWorker->mNumPoints; ++i) {
+        mpSurrogateModel->addSample(mpWorker->mPoints[i], mpWorker->mObjectives[i]);
     }
+    mpSurrogateModel->update();
+    mNumPredictionsSinceRefresh = 0;
 }
 
 
@@ -123,210 +115,236 @@ void Evaluator::evaluateAllCandidates()
 {
     for(size_t i=0; i<mpWorker->mNumCandidates && !mpWorker->aborted(); ++i)
     {
-        evaluateCandidate(i);
+        evaluateCandidateCached(i);
+    }
+}
+
+
+//! @brief Evaluates a subset of the candidates
+void Evaluator::evaluateCandidates(const std::vector<size_t> &rIndices)
+{
+    for(size_t i=0; i<rIndices.size() && !mpWorker->aborted(); ++i)
+    {
+        evaluateCandidateCached(rIndices[i]);
     }
 }
 
 
+//! @brief Evaluates all candidates, using the surrogate model to screen out the least promising ones (if enabled)
+//! @details The whole batch is predicted at once and only the best fraction (see setScreeningFraction()) is simulated.
+//! The remaining candidates are given their predicted objective value, but never better than the worst current point,
+//! so that algorithms will not accept a candidate that has not been simulated. Every n:th batch (the surrogate model
+//! update interval) is simulated in full, to keep the model from drifting.
+//! @returns True if any candidates were screened out
 bool Evaluator::evaluateAllCandidatesWithSurrogateModel()
 {
-    if(!mpWorker->mUseSurrogateModel) {
+    if(!mpWorker->mUseSurrogateModel || !prepareSurrogateModel()) {
         evaluateAllCandidates();
         return false;
     }
-    if(!mSurrogateModelInitialized) {
-        //Calculate how many iterations to store for meta model
-        size_t npars = mpWorker->getNumberOfParameters();
-        mStorageSize = size_t(npars*npars/2.0)+size_t(1.5*npars)+1;
-        mpSurrogateModelCoefficients = new Vec(int(mStorageSize));
-        mStorageSize = std::max(size_t(mStorageSize*1.5),mpWorker->getNumberOfCandidates());
-        mpStoredObjectives = new Vec(int(mStorageSize));
-        mStoredParameters.clear();
-        mSurrogateModelEvaluations=0;
-        mSurrogateModelInitialized = true;
-    }
 
-    if(mSurrogateModelEvaluations > mpWorker->mNumSurrogateModelUpdateInterval || mStoredParameters.size() < mStorageSize ) {
+    std::vector<std::vector<double> > &rCandidates = mpWorker->mCandidatePoints;
+    size_t numCandidates = mpWorker->mNumCandidates;
+    size_t numToSimulate = size_t(std::ceil(mScreeningFraction*double(numCandidates)));
+    numToSimulate = std::max(size_t(1), std::min(numToSimulate, numCandidates));
+
+    if(!mpSurrogateModel->isReady() || numToSimulate == numCandidates ||
+       mNumPredictionsSinceRefresh >= mpWorker->mNumSurrogateModelUpdateInterval) {
         evaluateAllCandidates();
-        for(size_t i=0; i<mpWorker->getNumberOfCandidates(); ++i) {
-            storeValuesForMetaModel(i);
-        }
-        if(mStoredParameters.size() >= mStorageSize) {
-            updateSurrogateModel();
+        for(size_t i=0; i<numCandidates; ++i) {
+            mpSurrogateModel->addSample(rCandidates[i], mpWorker->mCandidateObjectives[i]);
         }
-        mSurrogateModelEvaluations = 0;
+        mpSurrogateModel->update();
+        mNumPredictionsSinceRefresh = 0;
+        return false;
     }
-    else {
-        ++mSurrogateModelEvaluations;
-
-        for(size_t idx=0; idx<mpWorker->getNumberOfCandidates(); ++idx) {
-            double obj=1*(*mpSurrogateModelCoefficients)[0];
-
-            size_t npars = mpWorker->getNumberOfParameters();
-            for(size_t i=0; i<npars; ++i)
-            {
-                obj += (*mpSurrogateModelCoefficients)[int(i)+1]*mpWorker->getParameter(idx, i);
-            }
-
-            for(size_t i=0; i<npars; ++i)
-            {
-                for(size_t j=i; j<npars; ++j)
-                {
-                    obj += (*mpSurrogateModelCoefficients)[int(1+i*npars+j+npars)]*mpWorker->getParameter(idx, i)*mpWorker->getParameter(idx, j);
-                }
-            }
-
-            //Use regular evaluate if objective is NaN
-            if(std::isnan(obj))
-            {
-                evaluateCandidate(idx);
-                storeValuesForMetaModel(idx);
-            }
-            else
-            {
-                mpWorker->mCandidateObjectives[idx] = obj;
-            }
+    ++mNumPredictionsSinceRefresh;
+
+    //Predict the whole batch and simulate the most promising candidates (unpredictable ones are always simulated)
+    std::vector<double> predictions;
+    mpSurrogateModel->predict(rCandidates, predictions);
+    std::vector<size_t> order(numCandidates);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&predictions](size_t a, size_t b) {
+        if(std::isnan(predictions[a]) || std::isnan(predictions[b])) {
+            return std::isnan(predictions[a]) && !std::isnan(predictions[b]);
         }
-        return true;
+        return predictions[a] < predictions[b];
+    });
+    std::vector<size_t> simulated(order.begin(), order.begin()+long(numToSimulate));
+    evaluateCandidates(simulated);
+
+    for(size_t idx : simulated) {
+        mpSurrogateModel->addSample(rCandidates[idx], mpWorker->mCandidateObjectives[idx]);
     }
-    return false;
+    mpSurrogateModel->update();
+
+    double worst = getWorstObjective();
+    for(size_t i=numToSimulate; i<numCandidates; ++i) {
+        size_t idx = order[i];
+        mpWorker->mCandidateObjectives[idx] = std::isnan(worst) ? predictions[idx] : std::max(predictions[idx], worst);
+    }
+    mNumScreenedCandidates += numCandidates-numToSimulate;
+    return true;
 }
 
 
+//! @brief Evaluates a candidate, unless the surrogate model predicts that it is worse than all current points
+//! @details A screened out candidate is given its predicted objective value. Candidates are always simulated if the
+//! model is not ready, or if the surrogate model update interval number of candidates in a row have been screened out.
 void Evaluator::evaluateCandidateWithSurrogateModel(size_t idx)
 {
-    if(!mpWorker->mUseSurrogateModel) {
-        evaluateCandidate(idx);
+    if(!mpWorker->mUseSurrogateModel || !prepareSurrogateModel()) {
+        evaluateCandidateCached(idx);
         return;
     }
 
-    if(!mSurrogateModelInitialized) {
-        //Calculate how many iterations to store for meta model
-        size_t npars = mpWorker->getNumberOfParameters();
-        mStorageSize = size_t(npars*npars/2.0)+size_t(1.5*npars)+1;
-        mpSurrogateModelCoefficients = new Vec(int(mStorageSize));
-        mStorageSize = size_t(mStorageSize*2);
-        mpStoredObjectives = new Vec(int(mStorageSize));
-        mStoredParameters.clear();
-        mSurrogateModelEvaluations=0;
-        mSurrogateModelInitialized = true;
-    }
-
-    if(mSurrogateModelEvaluations > mpWorker->mNumSurrogateModelUpdateInterval || mStoredParameters.size() < mStorageSize ) {
-        evaluateCandidate(idx);
-        storeValuesForMetaModel(idx);
-        if(mStoredParameters.size() >= mStorageSize) {
-            updateSurrogateModel();
-        }
-        mSurrogateModelEvaluations = 0;
-        if(mSurrogateModelExist) {
-            evaluateAllPointsWithSurrogateModel();
+    const std::vector<double> &rCandidate = mpWorker->mCandidatePoints[idx];
+    if(mpSurrogateModel->isReady() && mNumPredictionsSinceRefresh < mpWorker->mNumSurrogateModelUpdateInterval) {
+        double prediction = mpSurrogateModel->predict(rCandidate);
+        double worst = getWorstObjective();
+        if(!std::isnan(prediction) && !std::isnan(worst) && prediction > worst) {
+            mpWorker->mCandidateObjectives[idx] = prediction;
+            ++mNumPredictionsSinceRefresh;
+            ++mNumScreenedCandidates;
+            return;
         }
     }
-    else {
-        ++mSurrogateModelEvaluations;
 
-        double obj=1*(*mpSurrogateModelCoefficients)[0];
+    evaluateCandidateCached(idx);
+    mpSurrogateModel->addSample(rCandidate, mpWorker->mCandidateObjectives[idx]);
+    mpSurrogateModel->update();
+    mNumPredictionsSinceRefresh = 0;
+}
 
-        size_t npars = mpWorker->getNumberOfParameters();
-        for(size_t i=0; i<npars; ++i)
-        {
-            obj += (*mpSurrogateModelCoefficients)[int(i)+1]*mpWorker->getCandidateParameter(idx, i);
-        }
 
-        for(size_t i=0; i<npars; ++i)
-        {
-            for(size_t j=i; j<npars; ++j)
-            {
-                obj += (*mpSurrogateModelCoefficients)[int(1+i*npars+j+npars)]*mpWorker->getCandidateParameter(idx, i)*mpWorker->getCandidateParameter(idx, j);
-            }
-        }
+//! @brief Enables the evaluation cache, so that parameter sets that have already been evaluated are not simulated again
+//! @details Configure the model hash and tolerance, and load or save cache files, through getCache()
+void Evaluator::setUseCache(bool value)
+{
+    mUseCache = value;
+}
 
-        //Use regular evaluate if objective is NaN
-        if(std::isnan(obj))
-        {
-            evaluateCandidate(idx);
-            storeValuesForMetaModel(idx);
-        }
-        else
-        {
-            mpWorker->mCandidateObjectives[idx] = obj;
-        }
-    }
+
+bool Evaluator::isUsingCache() const
+{
+    return mUseCache;
 }
 
 
-void Evaluator::storeValuesForMetaModel(size_t idx)
+EvaluationCache &Evaluator::getCache()
 {
-    mStoredParameters.push_back(std::vector<double>());
-    for(size_t p=0; p<mpWorker->getNumberOfParameters(); ++p)
-    {
-        mStoredParameters.back().push_back(mpWorker->getCandidateParameter(idx, p));
-    }
+    return mCache;
+}
 
-    //Shift vector to the left
-    for(int i=0; i<mpStoredObjectives->length()-1; ++i)
-    {
-        mpStoredObjectives[i] = mpStoredObjectives[i+1];
-    }
-    mpStoredObjectives[mpStoredObjectives->length()-1] = mpWorker->mCandidateObjectives[idx];
 
-    //Remove first element if stored vectors are too long
-    if(mStoredParameters.size() > mStorageSize)
-    {
-        mStoredParameters.pop_front();
-    }
+//! @brief Selects which type of surrogate model to use for pre-screening (quadratic by default)
+//! @details Pre-screening is enabled with Worker::setUseSurrogateModel()
+void Evaluator::setSurrogateModel(SurrogateModelT type)
+{
+    setSurrogateModel(createSurrogateModel(type));
+}
+
+
+//! @brief Sets a custom surrogate model, the evaluator takes ownership of it
+void Evaluator::setSurrogateModel(SurrogateModel *pModel)
+{
+    delete mpSurrogateModel;
+    mpSurrogateModel = pModel;
+    mSurrogateModelPrepared = false;
+    mNumPredictionsSinceRefresh = 0;
 }
 
 
+SurrogateModel *Evaluator::getSurrogateModel()
+{
+    return mpSurrogateModel;
+}
+
 
-void Evaluator::updateSurrogateModel()
+//! @brief Sets the fraction of each candidate batch that is simulated when the surrogate model is used (default 0.5)
+void Evaluator::setScreeningFraction(double value)
 {
-    mpStoredObjectives->print();
-    Vec previousSurrogateModelCoefficients = (*mpSurrogateModelCoefficients);
+    mScreeningFraction = std::max(0.0, std::min(1.0, value));
+}
+
 
-    //Create surrogate model
-    int n=mStorageSize;
-    int m=mpSurrogateModelCoefficients->length();
+//! @brief Returns the number of candidates that have been given predicted objective values instead of being simulated
+size_t Evaluator::getNumberOfScreenedCandidates() const
+{
+    return mNumScreenedCandidates;
+}
 
-    mpMatrix = new Matrix(n, m);
 
-    for(int i=0; i<n; ++i)
+//! @brief Looks up a parameter set in the evaluation cache (if enabled) and reports the hit or miss to the message handler
+//! @returns True if a cached objective value was found
+bool Evaluator::lookupCachedObjective(const std::vector<double> &rParameters, double &rObjective)
+{
+    if(!mUseCache)
     {
-        (*mpMatrix)[i][0] = 1;
+        return false;
     }
+    bool hit = mCache.lookup(rParameters, rObjective);
+    mpWorker->mpMessageHandler->cacheLookedUp(hit);
+    return hit;
+}
 
-    size_t npars = mpWorker->getNumberOfParameters();
 
-    for(size_t i=0; i<size_t(n); ++i)
+//! @brief Stores an evaluated objective value in the evaluation cache (if enabled)
+void Evaluator::storeCachedObjective(const std::vector<double> &rParameters, double objective)
+{
+    if(mUseCache)
     {
-        for(size_t j=0; j<npars; ++j)
-        {
-            (*mpMatrix)[i][j+1] = mStoredParameters[i][j];
-        }
+        mCache.store(rParameters, objective);
     }
+}
+
 
-    for(int i=0; i<n; ++i)
+//! @brief Evaluates a candidate unless its objective value is found in the evaluation cache
+void Evaluator::evaluateCandidateCached(size_t idx)
+{
+    const std::vector<double> &rParameters = mpWorker->mCandidatePoints[idx];
+    if(!lookupCachedObjective(rParameters, mpWorker->mCandidateObjectives[idx]))
     {
-        size_t col=npars+1;
-        for(size_t j=0; j<npars; ++j)
-        {
-            for(size_t k=j; k<npars; ++k)
-            {
-                (*mpMatrix)[i][col] = mStoredParameters[i][j]*mStoredParameters[i][k];
-                ++col;
-            }
-        }
+        evaluateCandidate(idx);
+        storeCachedObjective(rParameters, mpWorker->mCandidateObjectives[idx]);
     }
+}
 
-    //Solve system using L and U matrices
-    Matrix matrixT = (*mpMatrix).transpose();       //Multiply matrix and vector with transpose of matrix, because we need a square matrix
-    Matrix tempMatrix = matrixT*(*mpMatrix);
-    Vec tempVec = matrixT*(*mpStoredObjectives);
-    int* order = new int[size_t(m)];
-    ludcmp(tempMatrix, order);
-    solvlu(tempMatrix,tempVec,(*mpSurrogateModelCoefficients),order);
 
-    mSurrogateModelExist = true;
+//! @brief Creates the default surrogate model if none is set, and scales it to the parameter limits of the worker
+//! @returns False if there are no parameters
+bool Evaluator::prepareSurrogateModel()
+{
+    if(mSurrogateModelPrepared) {
+        return true;
+    }
+    size_t npars = mpWorker->getNumberOfParameters();
+    if(npars == 0) {
+        return false;
+    }
+    if(mpSurrogateModel == nullptr) {
+        mpSurrogateModel = createSurrogateModel(SurrogateQuadratic);
+    }
+    std::vector<double> minValues(npars), maxValues(npars);
+    for(size_t i=0; i<npars; ++i) {
+        mpWorker->getParameterLimits(i, minValues[i], maxValues[i]);
+    }
+    mpSurrogateModel->setParameterLimits(minValues, maxValues);
+    mNumPredictionsSinceRefresh = 0;
+    mSurrogateModelPrepared = true;
+    return true;
 }
 
+
+//! @brief Returns the largest finite objective value among the current points, or NaN if there is none
+double Evaluator::getWorstObjective() const
+{
+    double worst = std::numeric_limits<double>::quiet_NaN();
+    for(double objective : mpWorker->mObjectives) {
+        if(std::isfinite(objective) && (std::isnan(worst) || objective > worst)) {
+            worst = objective;
+        }
+    }
+    return worst;
+}
@@ -0,0 +1,376 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+//!
+//! @file   OpsExperimentDesign.cpp
+//!
+//! @brief Contains generators for design of experiments sampling plans
+//!
+//$Id$
+
+#include <random>
+#include <limits>
+#include <algorithm>
+
+#include "OpsExperimentDesign.h"
+
+using namespace Ops;
+
+namespace {
+
+//! @brief Sobol direction numbers for dimensions 2 and up (Joe & Kuo, new-joe-kuo-6.21201)
+//! @details Each row contains the degree s of the primitive polynomial, its coefficients a and the initial direction
+//! numbers m_1 to m_s. Dimension 1 uses m_k = 1 for all k.
+const unsigned int gSobolTable[][10] = {
+    {1,  0, 1},
+    {2,  1, 1, 3},
+    {3,  1, 1, 3, 1},
+    {3,  2, 1, 1, 1},
+    {4,  1, 1, 1, 3, 3},
+    {4,  4, 1, 3, 5, 13},
+    {5,  2, 1, 1, 5, 5, 17},
+    {5,  4, 1, 1, 5, 5, 5},
+    {5,  7, 1, 1, 7, 11, 19},
+    {5, 11, 1, 1, 5, 1, 1},
+    {5, 13, 1, 1, 1, 3, 11},
+    {5, 14, 1, 3, 5, 5, 31},
+    {6,  1, 1, 3, 3, 9, 7, 49},
+    {6, 13, 1, 1, 1, 15, 21, 21},
+    {6, 16, 1, 3, 1, 13, 27, 49},
+    {6, 19, 1, 1, 1, 15, 7, 5},
+    {6, 22, 1, 3, 1, 15, 13, 25},
+    {6, 25, 1, 1, 5, 5, 19, 61},
+    {7,  1, 1, 3, 7, 11, 23, 15, 103},
+    {7,  4, 1, 3, 7, 13, 13, 15, 69}
+};
+
+const size_t gNumSobolBits = 32;
+
+//! @brief Returns a uniformly distributed number in [0,1) from a generator, identical on all platforms
+double unitRand(std::mt19937 &rGenerator)
+{
+    return rGenerator()*(1.0/4294967296.0);
+}
+
+}
+
+
+ExperimentDesign::ExperimentDesign()
+{
+    mDesign = DesignSobol;
+    mNumRuns = 1;
+    mSeed = 0;
+    setNumberOfParameters(1);
+}
+
+
+void ExperimentDesign::setDesign(DesignT design)
+{
+    mDesign = design;
+}
+
+
+DesignT ExperimentDesign::getDesign() const
+{
+    return mDesign;
+}
+
+
+void ExperimentDesign::setNumberOfParameters(size_t value)
+{
+    mParameterMin.resize(value, 0.0);
+    mParameterMax.resize(value, 1.0);
+    mNumLevels.resize(value, 2);
+}
+
+
+size_t ExperimentDesign::getNumberOfParameters() const
+{
+    return mParameterMin.size();
+}
+
+
+void ExperimentDesign::setParameterLimits(size_t idx, double min, double max)
+{
+    mParameterMin[idx] = min;
+    mParameterMax[idx] = max;
+}
+
+
+void ExperimentDesign::getParameterLimits(size_t idx, double &rMin, double &rMax) const
+{
+    rMin = mParameterMin[idx];
+    rMax = mParameterMax[idx];
+}
+
+
+//! @brief Sets the number of equally spaced levels of a parameter in full factorial designs (default 2)
+void ExperimentDesign::setNumberOfLevels(size_t idx, size_t levels)
+{
+    mNumLevels[idx] = std::max<size_t>(levels, 1);
+}
+
+
+size_t ExperimentDesign::getNumberOfLevels(size_t idx) const
+{
+    return mNumLevels[idx];
+}
+
+
+//! @brief Sets the number of runs, not used by full factorial designs where it is given by the number of levels
+void ExperimentDesign::setNumberOfRuns(size_t value)
+{
+    mNumRuns = value;
+}
+
+
+size_t ExperimentDesign::getNumberOfRuns() const
+{
+    if(mDesign == DesignFullFactorial)
+    {
+        size_t numRuns = 1;
+        for(size_t levels : mNumLevels)
+        {
+            numRuns *= levels;
+        }
+        return numRuns;
+    }
+    return mNumRuns;
+}
+
+
+//! @brief Sets the seed for randomized designs (Latin hypercube and random), default is 0 so that runs are reproducible
+void ExperimentDesign::setRandomSeed(unsigned int seed)
+{
+    mSeed = seed;
+}
+
+
+unsigned int ExperimentDesign::getRandomSeed() const
+{
+    return mSeed;
+}
+
+
+//! @brief Prepares the design for point generation, must be called after changing any settings
+//! @param [out] rErrorMessage Describes the problem if the design can not be generated
+//! @returns False if the settings are invalid
+bool ExperimentDesign::prepare(std::string &rErrorMessage)
+{
+    const size_t numParameters = getNumberOfParameters();
+    mPermutations.clear();
+    mDirectionNumbers.clear();
+    mPrimes.clear();
+
+    if(numParameters == 0)
+    {
+        rErrorMessage = "Design of experiments requires at least one parameter.";
+        return false;
+    }
+
+    if(mDesign == DesignFullFactorial)
+    {
+        size_t numRuns = 1;
+        for(size_t levels : mNumLevels)
+        {
+            if(numRuns > std::numeric_limits<size_t>::max()/levels)
+            {
+                rErrorMessage = "Too many runs in full factorial design.";
+                return false;
+            }
+            numRuns *= levels;
+        }
+    }
+    else if(mDesign == DesignLatinHypercube)
+    {
+        //One random permutation of the strata per dimension
+        mPermutations.resize(numParameters);
+        for(size_t d=0; d<numParameters; ++d)
+        {
+            std::seed_seq sequence{mSeed, static_cast<unsigned int>(d)};
+            std::mt19937 generator(sequence);
+            std::vector<size_t> &rPermutation = mPermutations[d];
+            rPermutation.resize(mNumRuns);
+            for(size_t i=0; i<mNumRuns; ++i)
+            {
+                rPermutation[i] = i;
+            }
+            for(size_t i=mNumRuns; i>1; --i)
+            {
+                std::swap(rPermutation[i-1], rPermutation[size_t(unitRand(generator)*i)]);
+            }
+        }
+    }
+    else if(mDesign == DesignSobol)
+    {
+        if(numParameters > getMaxNumberOfSobolDimensions())
+        {
+            rErrorMessage = "Sobol design supports at most "+std::to_string(getMaxNumberOfSobolDimensions())+" parameters, use Halton or Latin hypercube instead.";
+            return false;
+        }
+        if(mNumRuns > (size_t(1) << gNumSobolBits))
+        {
+            rErrorMessage = "Too many runs in Sobol design.";
+            return false;
+        }
+
+        mDirectionNumbers.resize(numParameters, std::vector<unsigned int>(gNumSobolBits));
+        for(size_t k=0; k<gNumSobolBits; ++k)
+        {
+            mDirectionNumbers[0][k] = 1u << (gNumSobolBits-1-k);
+        }
+        for(size_t d=1; d<numParameters; ++d)
+        {
+            const unsigned int *pRow = gSobolTable[d-1];
+            const size_t s = pRow[0];
+            const unsigned int a = pRow[1];
+            std::vector<unsigned int> &v = mDirectionNumbers[d];
+            for(size_t k=0; k<s; ++k)
+            {
+                v[k] = pRow[2+k] << (gNumSobolBits-1-k);
+            }
+            for(size_t k=s; k<gNumSobolBits; ++k)
+            {
+                v[k] = v[k-s] ^ (v[k-s] >> s);
+                for(size_t i=1; i<s; ++i)
+                {
+                    if((a >> (s-1-i)) & 1)
+                    {
+                        v[k] ^= v[k-i];
+                    }
+                }
+            }
+        }
+    }
+    else if(mDesign == DesignHalton)
+    {
+        //One prime base per dimension
+        for(unsigned int candidate=2; mPrimes.size()<numParameters; ++candidate)
+        {
+            bool isPrime = true;
+            for(size_t i=0; i<mPrimes.size() && mPrimes[i]*mPrimes[i]<=candidate; ++i)
+            {
+                if(candidate % mPrimes[i] == 0)
+                {
+                    isPrime = false;
+                    break;
+                }
+            }
+            if(isPrime)
+            {
+                mPrimes.push_back(candidate);
+            }
+        }
+    }
+    return true;
+}
+
+
+//! @brief Computes the parameter values of a run, thread safe after prepare()
+//! @param [in] run Run index, from 0 to getNumberOfRuns()-1
+//! @param [out] rPoint Parameter values
+void ExperimentDesign::getPoint(size_t run, std::vector<double> &rPoint) const
+{
+    const size_t numParameters = getNumberOfParameters();
+    rPoint.resize(numParameters);
+
+    if(mDesign == DesignFullFactorial)
+    {
+        //Mixed radix decomposition of the run index, the first parameter varies fastest
+        for(size_t d=0; d<numParameters; ++d)
+        {
+            const size_t level = run % mNumLevels[d];
+            run /= mNumLevels[d];
+            const double x = (mNumLevels[d] > 1) ? double(level)/double(mNumLevels[d]-1) : 0.5;
+            rPoint[d] = mParameterMin[d] + x*(mParameterMax[d]-mParameterMin[d]);
+        }
+        return;
+    }
+
+    std::vector<double> jitter;
+    if(mDesign == DesignLatinHypercube || mDesign == DesignRandom)
+    {
+        std::seed_seq sequence{mSeed, static_cast<unsigned int>(run), static_cast<unsigned int>(run >> 16 >> 16)};
+        std::mt19937 generator(sequence);
+        jitter.resize(numParameters);
+        for(size_t d=0; d<numParameters; ++d)
+        {
+            jitter[d] = unitRand(generator);
+        }
+    }
+
+    for(size_t d=0; d<numParameters; ++d)
+    {
+        double x;
+        if(mDesign == DesignLatinHypercube)
+        {
+            x = (mPermutations[d][run] + jitter[d])/mNumRuns;
+        }
+        else if(mDesign == DesignRandom)
+        {
+            x = jitter[d];
+        }
+        else
+        {
+            x = getUnitCoordinate(run, d);
+        }
+        rPoint[d] = mParameterMin[d] + x*(mParameterMax[d]-mParameterMin[d]);
+    }
+}
+
+
+//! @brief Returns the largest number of parameters supported by Sobol designs
+size_t ExperimentDesign::getMaxNumberOfSobolDimensions()
+{
+    return 1+sizeof(gSobolTable)/sizeof(gSobolTable[0]);
+}
+
+
+//! @brief Returns the coordinate in [0,1) of a low-discrepancy sequence (Sobol or Halton)
+double ExperimentDesign::getUnitCoordinate(size_t run, size_t dim) const
+{
+    if(mDesign == DesignSobol)
+    {
+        const std::vector<unsigned int> &v = mDirectionNumbers[dim];
+        unsigned int x = 0;
+        for(size_t k=0; run != 0; ++k, run >>= 1)
+        {
+            if(run & 1)
+            {
+                x ^= v[k];
+            }
+        }
+        return x*(1.0/4294967296.0);
+    }
+
+    //Radical inverse of the run index in the prime base of the dimension, index 0 is skipped
+    const unsigned int base = mPrimes[dim];
+    double x = 0;
+    double factor = 1.0/base;
+    for(size_t i=run+1; i>0; i/=base)
+    {
+        x += (i % base)*factor;
+        factor /= base;
+    }
+    return x;
+}
@@ -0,0 +1,513 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   OpsParallelEvaluator.cpp
+//!
+//! @brief Contains the parallel optimization evaluator base class
+//!
+//$Id$
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <algorithm>
+
+#include "OpsParallelEvaluator.h"
+#include "OpsWorker.h"
+
+namespace Ops {
+
+//! @brief Persistent threads that evaluate submitted parameter sets in the order they were submitted
+//! @details Thread i always evaluates in context i, so a context is never used by two threads at the same time.
+//! Results are returned in the order they finish, so a thread that finishes early continues with the next job.
+class ParallelEvaluatorPool
+{
+public:
+    struct Result
+    {
+        size_t id;
+        std::vector<double> parameters;
+        double objective;
+        bool evaluated;     //False if skipped because the worker was aborted
+        bool cached;        //True if posted with postResult() instead of evaluated
+    };
+
+    ParallelEvaluatorPool(ParallelEvaluator *pEvaluator, size_t numThreads);
+    ~ParallelEvaluatorPool();
+
+    void submit(size_t id, const std::vector<double> &rParameters, Worker *pWorker);
+    void postResult(size_t id, double objective);
+    bool waitForResult(Result &rResult);
+    size_t getNumberOfPending() const;
+
+private:
+    struct Job
+    {
+        size_t id;
+        std::vector<double> parameters;
+        Worker *pWorker;
+    };
+
+    void threadLoop(size_t context);
+
+    ParallelEvaluator *mpEvaluator;
+    std::vector<std::thread> mThreads;
+    mutable std::mutex mMutex;
+    std::condition_variable mJobCondition;
+    std::condition_variable mResultCondition;
+    std::deque<Job> mJobs;
+    std::deque<Result> mResults;
+    size_t mNumPending;
+    bool mStop;
+    std::exception_ptr mException;
+};
+
+}
+
+using namespace Ops;
+
+
+ParallelEvaluatorPool::ParallelEvaluatorPool(ParallelEvaluator *pEvaluator, size_t numThreads)
+{
+    mpEvaluator = pEvaluator;
+    mNumPending = 0;
+    mStop = false;
+
+    for(size_t t=0; t<numThreads; ++t)
+    {
+        mThreads.emplace_back(&ParallelEvaluatorPool::threadLoop, this, t);
+    }
+}
+
+
+ParallelEvaluatorPool::~ParallelEvaluatorPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mJobCondition.notify_all();
+    for(std::thread &thread : mThreads)
+    {
+        thread.join();
+    }
+}
+
+
+//! @brief Queues a parameter set for evaluation and returns immediately
+//! @param [in] id Identifier returned together with the objective value by waitForResult()
+//! @param [in] rParameters Parameter values (copied)
+//! @param [in] pWorker Worker to check for abort requests, jobs are skipped if it has been aborted
+void ParallelEvaluatorPool::submit(size_t id, const std::vector<double> &rParameters, Worker *pWorker)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mJobs.push_back(Job{id, rParameters, pWorker});
+        ++mNumPending;
+    }
+    mJobCondition.notify_one();
+}
+
+
+//! @brief Queues an already known result, it is returned by waitForResult() in order with the evaluated results
+void ParallelEvaluatorPool::postResult(size_t id, double objective)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mResults.push_back(Result{id, std::vector<double>(), objective, true, true});
+        ++mNumPending;
+    }
+    mResultCondition.notify_all();
+}
+
+
+//! @brief Blocks until any submitted evaluation has finished
+//! @details If an evaluation threw an exception, all remaining jobs are discarded and the exception is re-thrown here
+//! @param [out] rResult Identifier given to submit(), parameters and objective value
+//! @returns False if there were no pending evaluations
+bool ParallelEvaluatorPool::waitForResult(Result &rResult)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if(mNumPending == 0)
+    {
+        return false;
+    }
+    mResultCondition.wait(lock, [this]{ return !mResults.empty(); });
+
+    if(mException)
+    {
+        mNumPending -= mJobs.size();
+        mJobs.clear();
+        mResultCondition.wait(lock, [this]{ return mResults.size() == mNumPending; });
+        mResults.clear();
+        mNumPending = 0;
+        std::exception_ptr pException = mException;
+        mException = nullptr;
+        std::rethrow_exception(pException);
+    }
+
+    rResult = std::move(mResults.front());
+    mResults.pop_front();
+    --mNumPending;
+    return true;
+}
+
+
+//! @brief Returns the number of submitted evaluations whose results have not yet been collected
+size_t ParallelEvaluatorPool::getNumberOfPending() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mNumPending;
+}
+
+
+void ParallelEvaluatorPool::threadLoop(size_t context)
+{
+    while(true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mJobCondition.wait(lock, [this]{ return mStop || !mJobs.empty(); });
+            if(mStop)
+            {
+                return;
+            }
+            job = std::move(mJobs.front());
+            mJobs.pop_front();
+        }
+
+        Result result{job.id, std::move(job.parameters), 0.0, false, false};
+        if(!job.pWorker->aborted())
+        {
+            try
+            {
+                result.objective = mpEvaluator->evaluateTimed(result.parameters, context);
+                result.evaluated = true;
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if(!mException)
+                {
+                    mException = std::current_exception();
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mResults.push_back(std::move(result));
+        }
+        mResultCondition.notify_all();
+    }
+}
+
+
+//! @brief Constructor
+//! @param numContexts Number of model contexts that can be evaluated concurrently, this limits the number of threads
+ParallelEvaluator::ParallelEvaluator(size_t numContexts)
+    : Evaluator()
+{
+    mNumContexts = std::max<size_t>(numContexts, 1);
+    mNumThreads = mNumContexts;
+    mpPool = nullptr;
+    mContextGenerators.resize(mNumContexts);
+    setRandomSeed(std::random_device{}());
+    resetStatistics();
+}
+
+
+ParallelEvaluator::~ParallelEvaluator()
+{
+    delete mpPool;
+}
+
+
+size_t ParallelEvaluator::getNumberOfContexts() const
+{
+    return mNumContexts;
+}
+
+
+//! @brief Sets the number of evaluation threads
+//! @param numThreads Number of threads, 0 means one per processor core. Can not be larger than the number of contexts.
+//! @note Must not be called while asynchronous evaluations are pending
+void ParallelEvaluator::setNumberOfThreads(size_t numThreads)
+{
+    if(numThreads == 0)
+    {
+        numThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    numThreads = std::min(numThreads, mNumContexts);
+    if(numThreads != mNumThreads)
+    {
+        delete mpPool;
+        mpPool = nullptr;
+        mNumThreads = numThreads;
+    }
+}
+
+
+size_t ParallelEvaluator::getNumberOfThreads() const
+{
+    return mNumThreads;
+}
+
+
+//! @brief Seeds the random number generators of all contexts, use a fixed seed to make stochastic evaluations reproducible
+//! @param seed Seed value, each context is seeded with a combination of this value and its index
+void ParallelEvaluator::setRandomSeed(unsigned int seed)
+{
+    for(size_t c=0; c<mContextGenerators.size(); ++c)
+    {
+        std::seed_seq sequence{seed, static_cast<unsigned int>(c)};
+        mContextGenerators[c].seed(sequence);
+    }
+}
+
+
+void ParallelEvaluator::evaluateAllPoints()
+{
+    std::vector<std::vector<double> > &rPoints = mpWorker->getPoints();
+    std::vector<double> &rObjectives = mpWorker->getObjectiveValues();
+    evaluateInParallel(rPoints, rObjectives);
+
+    if(mpWorker->getNumberOfCandidates() == mpWorker->getNumberOfPoints())
+    {
+        mpWorker->getCandidatePoints() = rPoints;
+        for(size_t i=0; i<rObjectives.size(); ++i)
+        {
+            mpWorker->setCandidateObjectiveValue(i, rObjectives[i]);
+        }
+    }
+}
+
+
+void ParallelEvaluator::evaluateCandidate(size_t idx)
+{
+    const std::vector<double> &rParameters = mpWorker->getCandidatePoints()[idx];
+    double objective;
+    if(!lookupCachedObjective(rParameters, objective))
+    {
+        objective = evaluateTimed(rParameters, 0);
+        storeCachedObjective(rParameters, objective);
+    }
+    mpWorker->setCandidateObjectiveValue(idx, objective);
+}
+
+
+void ParallelEvaluator::evaluateAllCandidates()
+{
+    std::vector<std::vector<double> > &rCandidates = mpWorker->getCandidatePoints();
+    std::vector<double> objectives(rCandidates.size());
+    for(size_t i=0; i<objectives.size(); ++i)
+    {
+        objectives[i] = mpWorker->getCandidateObjectiveValue(i);
+    }
+    evaluateInParallel(rCandidates, objectives);
+    for(size_t i=0; i<objectives.size(); ++i)
+    {
+        mpWorker->setCandidateObjectiveValue(i, objectives[i]);
+    }
+}
+
+
+void ParallelEvaluator::evaluateCandidates(const std::vector<size_t> &rIndices)
+{
+    std::vector<std::vector<double> > points(rIndices.size());
+    std::vector<double> objectives(rIndices.size());
+    for(size_t i=0; i<rIndices.size(); ++i)
+    {
+        points[i] = mpWorker->getCandidatePoints()[rIndices[i]];
+        objectives[i] = mpWorker->getCandidateObjectiveValue(rIndices[i]);
+    }
+    evaluateInParallel(points, objectives);
+    for(size_t i=0; i<rIndices.size(); ++i)
+    {
+        mpWorker->setCandidateObjectiveValue(rIndices[i], objectives[i]);
+    }
+}
+
+
+//! @brief Starts evaluating a parameter set in the background and returns immediately
+//! @details Use this for asynchronous (steady-state) algorithms. Do not mix with the evaluateAll...() functions while
+//! evaluations are pending.
+//! @param [in] id Identifier returned together with the objective value by waitForEvaluation(), for example a point index
+//! @param [in] rParameters Parameter values (copied)
+void ParallelEvaluator::submitEvaluation(size_t id, const std::vector<double> &rParameters)
+{
+    double objective;
+    if(lookupCachedObjective(rParameters, objective))
+    {
+        getPool()->postResult(id, objective);
+    }
+    else
+    {
+        getPool()->submit(id, rParameters, mpWorker);
+    }
+}
+
+
+//! @brief Blocks until any evaluation started with submitEvaluation() has finished
+//! @param [out] rId Identifier given to submitEvaluation()
+//! @param [out] rObjective Objective value
+//! @returns False if no evaluations are pending. Evaluations skipped because the worker was aborted are not returned.
+bool ParallelEvaluator::waitForEvaluation(size_t &rId, double &rObjective)
+{
+    if(!mpPool)
+    {
+        return false;
+    }
+    ParallelEvaluatorPool::Result result;
+    do
+    {
+        if(!mpPool->waitForResult(result))
+        {
+            return false;
+        }
+    } while(!result.evaluated);
+
+    if(!result.cached)
+    {
+        storeCachedObjective(result.parameters, result.objective);
+    }
+    rId = result.id;
+    rObjective = result.objective;
+    return true;
+}
+
+
+//! @brief Returns the number of evaluations started with submitEvaluation() whose results have not yet been collected
+size_t ParallelEvaluator::getNumberOfPendingEvaluations() const
+{
+    return mpPool ? mpPool->getNumberOfPending() : 0;
+}
+
+
+//! @brief Resets the evaluation counter, busy time and elapsed time used for throughput and utilization
+void ParallelEvaluator::resetStatistics()
+{
+    mNumCompletedEvaluations = 0;
+    mBusyNanoseconds = 0;
+    mStatisticsStartTime = std::chrono::steady_clock::now();
+}
+
+
+//! @brief Returns the number of evaluations completed since the statistics were reset
+size_t ParallelEvaluator::getNumberOfCompletedEvaluations() const
+{
+    return mNumCompletedEvaluations;
+}
+
+
+//! @brief Returns the wall clock time in seconds since the statistics were reset
+double ParallelEvaluator::getElapsedTime() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()-mStatisticsStartTime).count();
+}
+
+
+//! @brief Returns the number of completed evaluations per second since the statistics were reset
+double ParallelEvaluator::getThroughput() const
+{
+    const double elapsed = getElapsedTime();
+    return (elapsed > 0) ? mNumCompletedEvaluations/elapsed : 0;
+}
+
+
+//! @brief Returns the fraction of the available thread time (0-1) that was spent evaluating since the statistics were reset
+double ParallelEvaluator::getUtilization() const
+{
+    const double available = getElapsedTime()*mNumThreads;
+    return (available > 0) ? std::min(1e-9*mBusyNanoseconds/available, 1.0) : 0;
+}
+
+
+//! @brief Returns a uniformly distributed random number between 0 and 1 from the generator of a context
+//! @param context Context index, only call this from the thread evaluating that context
+double ParallelEvaluator::contextRand(size_t context)
+{
+    std::uniform_real_distribution<> distribution(0.0, 1.0);
+    return distribution(mContextGenerators[context]);
+}
+
+
+//! @brief Evaluates a parameter set and updates the statistics, called from the evaluation threads
+double ParallelEvaluator::evaluateTimed(const std::vector<double> &rParameters, size_t context)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const double objective = evaluateParameters(rParameters, context);
+    mBusyNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start).count();
+    ++mNumCompletedEvaluations;
+    return objective;
+}
+
+
+ParallelEvaluatorPool *ParallelEvaluator::getPool()
+{
+    if(!mpPool)
+    {
+        mpPool = new ParallelEvaluatorPool(this, mNumThreads);
+    }
+    return mpPool;
+}
+
+
+void ParallelEvaluator::evaluateInParallel(const std::vector<std::vector<double> > &rPoints, std::vector<double> &rObjectives)
+{
+    if(mNumThreads < 2 || rPoints.size() < 2)
+    {
+        for(size_t i=0; i<rPoints.size() && !mpWorker->aborted(); ++i)
+        {
+            if(!lookupCachedObjective(rPoints[i], rObjectives[i]))
+            {
+                rObjectives[i] = evaluateTimed(rPoints[i], 0);
+                storeCachedObjective(rPoints[i], rObjectives[i]);
+            }
+        }
+        return;
+    }
+
+    ParallelEvaluatorPool *pPool = getPool();
+    for(size_t i=0; i<rPoints.size(); ++i)
+    {
+        if(!lookupCachedObjective(rPoints[i], rObjectives[i]))
+        {
+            pPool->submit(i, rPoints[i], mpWorker);
+        }
+    }
+    ParallelEvaluatorPool::Result result;
+    while(pPool->waitForResult(result))
+    {
+        if(result.evaluated)
+        {
+            rObjectives[result.id] = result.objective;
+            storeCachedObjective(result.parameters, result.objective);
+        }
+    }
+}
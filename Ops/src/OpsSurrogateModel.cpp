@@ -0,0 +1,527 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+//!
+//! @file   OpsSurrogateModel.cpp
+//!
+//! @brief Contains surrogate models used for pre-screening candidates before they are simulated
+//!
+//$Id$
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "OpsSurrogateModel.h"
+#include "ludcmp.h"
+#include "matrix.h"
+
+using namespace Ops;
+
+namespace {
+
+//! @brief Solves a dense linear system with LU decomposition
+//! @param [in] rA Row-major n x n matrix
+//! @param [in] rB Right hand side
+//! @param [out] rX Solution
+//! @returns False if the matrix is singular
+bool solveDense(const std::vector<double> &rA, const std::vector<double> &rB, std::vector<double> &rX)
+{
+    int n = int(rB.size());
+    Matrix a(n, n);
+    Vec b(n), x(n);
+    for(int i=0; i<n; ++i)
+    {
+        for(int j=0; j<n; ++j)
+        {
+            a[i][j] = rA[size_t(i*n+j)];
+        }
+        b[i] = rB[size_t(i)];
+    }
+
+    std::vector<int> order(rB.size());
+    if(!ludcmp(a, order.data()))
+    {
+        return false;
+    }
+    solvlu(a, b, x, order.data());
+
+    rX.resize(size_t(n));
+    for(int i=0; i<n; ++i)
+    {
+        if(!std::isfinite(x[i]))
+        {
+            return false;
+        }
+        rX[size_t(i)] = x[i];
+    }
+    return true;
+}
+
+}
+
+
+SurrogateModel::SurrogateModel()
+{
+    mMaxNumSamples = 0;
+    mReady = false;
+}
+
+
+SurrogateModel::~SurrogateModel()
+{
+}
+
+
+//! @brief Sets the parameter limits used for scaling, this also removes all samples
+void SurrogateModel::setParameterLimits(const std::vector<double> &rMin, const std::vector<double> &rMax)
+{
+    clear();
+    mOffset.resize(rMin.size());
+    mScale.resize(rMin.size());
+    for(size_t i=0; i<rMin.size(); ++i)
+    {
+        double range = rMax[i]-rMin[i];
+        mOffset[i] = 0.5*(rMin[i]+rMax[i]);
+        mScale[i] = (range > 0) ? 2.0/range : 1.0;
+    }
+}
+
+
+size_t SurrogateModel::getNumberOfParameters() const
+{
+    return mOffset.size();
+}
+
+
+//! @brief Sets how many of the most recent samples are used for fitting, 0 means a model specific default
+void SurrogateModel::setMaxNumberOfSamples(size_t value)
+{
+    mMaxNumSamples = value;
+    while(mSamples.size() > getMaxNumberOfSamples())
+    {
+        sampleRemoved();
+        mSamples.pop_front();
+        mSampleObjectives.pop_front();
+    }
+}
+
+
+size_t SurrogateModel::getMaxNumberOfSamples() const
+{
+    if(mMaxNumSamples == 0)
+    {
+        return getDefaultMaxNumberOfSamples();
+    }
+    return std::max(mMaxNumSamples, getMinNumberOfSamples());
+}
+
+
+size_t SurrogateModel::getNumberOfSamples() const
+{
+    return mSamples.size();
+}
+
+
+//! @brief Adds an evaluated sample, the oldest sample is removed if the sample window is full
+//! @details Non-finite objective values and exact duplicates of existing samples are ignored. Call update() to refit.
+void SurrogateModel::addSample(const std::vector<double> &rParameters, double objective)
+{
+    if(!std::isfinite(objective) || rParameters.size() != mOffset.size())
+    {
+        return;
+    }
+
+    std::vector<double> scaled(rParameters.size());
+    for(size_t i=0; i<scaled.size(); ++i)
+    {
+        scaled[i] = (rParameters[i]-mOffset[i])*mScale[i];
+    }
+    for(const std::vector<double> &rSample : mSamples)
+    {
+        if(rSample == scaled)
+        {
+            return;
+        }
+    }
+
+    if(mSamples.size() >= getMaxNumberOfSamples())
+    {
+        sampleRemoved();
+        mSamples.pop_front();
+        mSampleObjectives.pop_front();
+    }
+    mSamples.push_back(scaled);
+    mSampleObjectives.push_back(objective);
+    sampleAdded();
+}
+
+
+void SurrogateModel::clear()
+{
+    mSamples.clear();
+    mSampleObjectives.clear();
+    samplesCleared();
+    mReady = false;
+}
+
+
+//! @brief Refits the model to the current samples
+//! @returns True if the model can be used for predictions
+bool SurrogateModel::update()
+{
+    mReady = (mSamples.size() >= getMinNumberOfSamples()) && fit();
+    return mReady;
+}
+
+
+bool SurrogateModel::isReady() const
+{
+    return mReady;
+}
+
+
+double SurrogateModel::predict(const std::vector<double> &rParameters) const
+{
+    std::vector<double> predictions;
+    predict(std::vector<std::vector<double> >(1, rParameters), predictions);
+    return predictions[0];
+}
+
+
+//! @brief Predicts objective values for a batch of points
+//! @details Predictions are NaN if the model is not ready. Thread safe as long as the model is not modified.
+//! @param [in] rPoints Parameter values for each point
+//! @param [out] rPredictions Predicted objective value for each point
+void SurrogateModel::predict(const std::vector<std::vector<double> > &rPoints, std::vector<double> &rPredictions) const
+{
+    rPredictions.assign(rPoints.size(), std::numeric_limits<double>::quiet_NaN());
+    if(!mReady || rPoints.empty())
+    {
+        return;
+    }
+
+    //Scale all points into one contiguous buffer, so that the models can run tight loops over the whole batch
+    size_t n = mOffset.size();
+    std::vector<double> scaled(rPoints.size()*n);
+    for(size_t p=0; p<rPoints.size(); ++p)
+    {
+        for(size_t i=0; i<n; ++i)
+        {
+            scaled[p*n+i] = (rPoints[p][i]-mOffset[i])*mScale[i];
+        }
+    }
+    predictScaled(scaled.data(), rPoints.size(), rPredictions.data());
+}
+
+
+
+QuadraticSurrogateModel::QuadraticSurrogateModel()
+    : SurrogateModel()
+{
+    mNumDowndates = 0;
+}
+
+
+size_t QuadraticSurrogateModel::getMinNumberOfSamples() const
+{
+    return getNumberOfCoefficients();
+}
+
+
+size_t QuadraticSurrogateModel::getDefaultMaxNumberOfSamples() const
+{
+    return 3*getNumberOfCoefficients();
+}
+
+
+void QuadraticSurrogateModel::sampleAdded()
+{
+    accumulate(mSamples.back(), mSampleObjectives.back(), 1.0);
+}
+
+
+void QuadraticSurrogateModel::sampleRemoved()
+{
+    accumulate(mSamples.front(), mSampleObjectives.front(), -1.0);
+    ++mNumDowndates;
+}
+
+
+void QuadraticSurrogateModel::samplesCleared()
+{
+    mNormalMatrix.clear();
+    mNormalVector.clear();
+    mCoefficients.clear();
+    mNumDowndates = 0;
+}
+
+
+bool QuadraticSurrogateModel::fit()
+{
+    //Removing samples from the normal equations accumulates round-off errors, so start over once in a while
+    if(mNumDowndates >= getMaxNumberOfSamples())
+    {
+        rebuild();
+    }
+
+    //Small ridge term keeps the system solvable when samples are (almost) degenerate
+    size_t m = getNumberOfCoefficients();
+    std::vector<double> a = mNormalMatrix;
+    double trace = 0;
+    for(size_t i=0; i<m; ++i)
+    {
+        trace += a[i*m+i];
+    }
+    double ridge = 1e-10*trace/double(m);
+    for(size_t i=0; i<m; ++i)
+    {
+        a[i*m+i] += ridge;
+    }
+
+    return solveDense(a, mNormalVector, mCoefficients);
+}
+
+
+void QuadraticSurrogateModel::predictScaled(const double *pPoints, size_t numPoints, double *pPredictions) const
+{
+    size_t n = getNumberOfParameters();
+    size_t m = mCoefficients.size();
+    std::vector<double> features(m);
+    for(size_t p=0; p<numPoints; ++p)
+    {
+        calculateFeatures(pPoints+p*n, features.data());
+        double sum = 0;
+        for(size_t i=0; i<m; ++i)
+        {
+            sum += mCoefficients[i]*features[i];
+        }
+        pPredictions[p] = sum;
+    }
+}
+
+
+size_t QuadraticSurrogateModel::getNumberOfCoefficients() const
+{
+    size_t n = getNumberOfParameters();
+    return (n+1)*(n+2)/2;
+}
+
+
+//! @brief Calculates the regression features (1, x_i, x_i*x_j for i<=j) for a scaled point
+void QuadraticSurrogateModel::calculateFeatures(const double *pPoint, double *pFeatures) const
+{
+    size_t n = getNumberOfParameters();
+    size_t col = 0;
+    pFeatures[col++] = 1.0;
+    for(size_t i=0; i<n; ++i)
+    {
+        pFeatures[col++] = pPoint[i];
+    }
+    for(size_t i=0; i<n; ++i)
+    {
+        for(size_t j=i; j<n; ++j)
+        {
+            pFeatures[col++] = pPoint[i]*pPoint[j];
+        }
+    }
+}
+
+
+//! @brief Adds (sign = 1) or removes (sign = -1) a sample from the normal equations
+void QuadraticSurrogateModel::accumulate(const std::vector<double> &rPoint, double objective, double sign)
+{
+    size_t m = getNumberOfCoefficients();
+    if(mNormalMatrix.size() != m*m)
+    {
+        mNormalMatrix.assign(m*m, 0.0);
+        mNormalVector.assign(m, 0.0);
+    }
+    mFeatures.resize(m);
+    calculateFeatures(rPoint.data(), mFeatures.data());
+    for(size_t i=0; i<m; ++i)
+    {
+        double fi = sign*mFeatures[i];
+        for(size_t j=0; j<m; ++j)
+        {
+            mNormalMatrix[i*m+j] += fi*mFeatures[j];
+        }
+        mNormalVector[i] += fi*objective;
+    }
+}
+
+
+void QuadraticSurrogateModel::rebuild()
+{
+    mNormalMatrix.clear();
+    mNormalVector.clear();
+    for(size_t s=0; s<mSamples.size(); ++s)
+    {
+        accumulate(mSamples[s], mSampleObjectives[s], 1.0);
+    }
+    mNumDowndates = 0;
+}
+
+
+
+RadialBasisSurrogateModel::RadialBasisSurrogateModel()
+    : SurrogateModel()
+{
+}
+
+
+size_t RadialBasisSurrogateModel::getMinNumberOfSamples() const
+{
+    return getNumberOfParameters()+2;
+}
+
+
+size_t RadialBasisSurrogateModel::getDefaultMaxNumberOfSamples() const
+{
+    return std::max(size_t(100), 10*getMinNumberOfSamples());
+}
+
+
+void RadialBasisSurrogateModel::sampleAdded()
+{
+    const std::vector<double> &rNew = mSamples.back();
+    size_t last = mSamples.size()-1;
+    std::vector<double> row(mSamples.size(), 0.0);
+    for(size_t s=0; s<last; ++s)
+    {
+        double r2 = 0;
+        for(size_t i=0; i<rNew.size(); ++i)
+        {
+            double d = rNew[i]-mSamples[s][i];
+            r2 += d*d;
+        }
+        double r = std::sqrt(r2);
+        row[s] = r*r*r;
+        mKernel[s].push_back(row[s]);
+    }
+    mKernel.push_back(row);
+}
+
+
+void RadialBasisSurrogateModel::sampleRemoved()
+{
+    mKernel.pop_front();
+    for(std::vector<double> &rRow : mKernel)
+    {
+        rRow.erase(rRow.begin());
+    }
+}
+
+
+void RadialBasisSurrogateModel::samplesCleared()
+{
+    mKernel.clear();
+    mCenters.clear();
+    mWeights.clear();
+    mTail.clear();
+}
+
+
+//! @brief Solves the interpolation system [Phi P; P^T 0][w; c] = [f; 0]
+bool RadialBasisSurrogateModel::fit()
+{
+    size_t ns = mSamples.size();
+    size_t n = getNumberOfParameters();
+    size_t m = ns+n+1;
+
+    std::vector<double> a(m*m, 0.0), b(m, 0.0), x;
+    for(size_t i=0; i<ns; ++i)
+    {
+        for(size_t j=0; j<ns; ++j)
+        {
+            a[i*m+j] = mKernel[i][j];
+        }
+        a[i*m+ns] = 1.0;
+        a[ns*m+i] = 1.0;
+        for(size_t k=0; k<n; ++k)
+        {
+            a[i*m+ns+1+k] = mSamples[i][k];
+            a[(ns+1+k)*m+i] = mSamples[i][k];
+        }
+        b[i] = mSampleObjectives[i];
+    }
+
+    if(!solveDense(a, b, x))
+    {
+        return false;
+    }
+
+    mCenters.resize(ns*n);
+    for(size_t i=0; i<ns; ++i)
+    {
+        std::copy(mSamples[i].begin(), mSamples[i].end(), mCenters.begin()+long(i*n));
+    }
+    mWeights.assign(x.begin(), x.begin()+long(ns));
+    mTail.assign(x.begin()+long(ns), x.end());
+    return true;
+}
+
+
+void RadialBasisSurrogateModel::predictScaled(const double *pPoints, size_t numPoints, double *pPredictions) const
+{
+    size_t n = getNumberOfParameters();
+    size_t ns = mWeights.size();
+    const double *pCenters = mCenters.data();
+    for(size_t p=0; p<numPoints; ++p)
+    {
+        const double *pPoint = pPoints+p*n;
+        double sum = mTail[0];
+        for(size_t k=0; k<n; ++k)
+        {
+            sum += mTail[k+1]*pPoint[k];
+        }
+        for(size_t s=0; s<ns; ++s)
+        {
+            const double *pCenter = pCenters+s*n;
+            double r2 = 0;
+            for(size_t k=0; k<n; ++k)
+            {
+                double d = pPoint[k]-pCenter[k];
+                r2 += d*d;
+            }
+            double r = std::sqrt(r2);
+            sum += mWeights[s]*r*r*r;
+        }
+        pPredictions[p] = sum;
+    }
+}
+
+
+
+//! @brief Creates a surrogate model of specified type, the caller takes ownership
+SurrogateModel *Ops::createSurrogateModel(SurrogateModelT type)
+{
+    switch(type)
+    {
+    case SurrogateRadialBasis:
+        return new RadialBasisSurrogateModel();
+    case SurrogateQuadratic:
+    default:
+        return new QuadraticSurrogateModel();
+    }
+}
@@ -0,0 +1,425 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+//!
+//! @file   OpsSweepRunner.cpp
+//!
+//! @brief Contains the design of experiments sweep engine
+//!
+//$Id$
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <limits>
+#include <algorithm>
+#include <exception>
+
+#include "OpsSweepRunner.h"
+#include "OpsMessageHandler.h"
+
+using namespace Ops;
+
+namespace {
+
+struct SweepResult
+{
+    size_t run;
+    std::vector<double> parameters;
+    std::vector<double> outputs;
+    bool ok;
+    std::string error;
+};
+
+const char *gDesignNames[] = {"fullfactorial", "latinhypercube", "sobol", "halton", "random"};
+
+}
+
+
+//! @brief Constructor
+//! @param pEvaluator Evaluator for the runs, the number of threads is limited by its number of contexts
+//! @param pMessageHandler Message handler for progress, messages and abort requests
+SweepRunner::SweepRunner(SweepEvaluator *pEvaluator, MessageHandler *pMessageHandler)
+{
+    mpEvaluator = pEvaluator;
+    mpMessageHandler = pMessageHandler;
+    mNumThreads = std::max<size_t>(mpEvaluator->getNumberOfContexts(), 1);
+    mResume = true;
+    mNumCompletedRuns = 0;
+    mNumResumedRuns = 0;
+    mNumFailedRuns = 0;
+}
+
+
+ExperimentDesign &SweepRunner::getDesign()
+{
+    return mDesign;
+}
+
+
+//! @brief Sets the parameter names used as column headers in the result file
+void SweepRunner::setParameterNames(const std::vector<std::string> &names)
+{
+    mParameterNames = names;
+}
+
+
+//! @brief Sets the number of concurrent runs
+//! @param numThreads Number of threads, 0 means one per processor core. Can not be larger than the number of contexts.
+void SweepRunner::setNumberOfThreads(size_t numThreads)
+{
+    if(numThreads == 0)
+    {
+        numThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    mNumThreads = std::max<size_t>(std::min(numThreads, mpEvaluator->getNumberOfContexts()), 1);
+}
+
+
+size_t SweepRunner::getNumberOfThreads() const
+{
+    return mNumThreads;
+}
+
+
+//! @brief Sets the CSV file that results are streamed to, without a file results are only counted
+void SweepRunner::setResultFile(const std::string &filePath)
+{
+    mResultFile = filePath;
+}
+
+
+//! @brief Sets whether runs already present in the result file shall be skipped (default), otherwise the file is overwritten
+void SweepRunner::setResume(bool value)
+{
+    mResume = value;
+}
+
+
+//! @brief Executes all runs that are not already present in the result file
+//! @returns False if the design is invalid or the result file can not be used, failed runs do not make this return false
+bool SweepRunner::run()
+{
+    mNumCompletedRuns = 0;
+    mNumResumedRuns = 0;
+    mNumFailedRuns = 0;
+
+    std::string errorMessage;
+    if(!mDesign.prepare(errorMessage))
+    {
+        mpMessageHandler->printMessage("Error: "+errorMessage);
+        return false;
+    }
+    const size_t numRuns = mDesign.getNumberOfRuns();
+    const size_t numOutputs = mpEvaluator->getOutputNames().size();
+
+    //Find runs that remain, and open result file
+    std::set<size_t> completedRuns;
+    std::ofstream file;
+    if(!mResultFile.empty())
+    {
+        if(mResume && !readCompletedRuns(completedRuns))
+        {
+            return false;
+        }
+        if(completedRuns.empty())
+        {
+            file.open(mResultFile.c_str(), std::ios::trunc);
+            file << "# " << createSignature() << "\n" << createHeader() << "\n";
+        }
+        else
+        {
+            file.open(mResultFile.c_str(), std::ios::app);
+        }
+        if(!file.good())
+        {
+            mpMessageHandler->printMessage("Error: Could not open sweep result file: "+mResultFile);
+            return false;
+        }
+        file.precision(std::numeric_limits<double>::max_digits10);
+    }
+    std::vector<size_t> pendingRuns;
+    pendingRuns.reserve(numRuns-std::min(numRuns, completedRuns.size()));
+    for(size_t r=0; r<numRuns; ++r)
+    {
+        if(completedRuns.count(r) == 0)
+        {
+            pendingRuns.push_back(r);
+        }
+    }
+    mNumResumedRuns = numRuns-pendingRuns.size();
+
+    mpMessageHandler->printMessage("Running sweep with "+std::to_string(numRuns)+" runs ("+std::to_string(mNumResumedRuns)+
+                                   " already completed) using "+std::to_string(mNumThreads)+" threads.");
+
+    //Evaluation threads take runs in order and queue the results, only this thread writes the file and reports progress
+    std::mutex mutex;
+    std::condition_variable resultCondition;
+    std::deque<SweepResult> results;
+    std::atomic<size_t> nextIdx(0);
+    std::atomic<bool> stop(false);
+    size_t numFinishedThreads = 0;
+
+    std::vector<std::thread> threads;
+    for(size_t t=0; t<mNumThreads; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            while(!stop)
+            {
+                const size_t idx = nextIdx++;
+                if(idx >= pendingRuns.size())
+                {
+                    break;
+                }
+                SweepResult result;
+                result.run = pendingRuns[idx];
+                mDesign.getPoint(result.run, result.parameters);
+                result.outputs.resize(numOutputs);
+                try
+                {
+                    result.ok = mpEvaluator->evaluateRun(result.parameters, t, result.outputs) && (result.outputs.size() == numOutputs);
+                }
+                catch(std::exception &e)
+                {
+                    result.ok = false;
+                    result.error = e.what();
+                }
+                catch(...)
+                {
+                    result.ok = false;
+                    result.error = "Unknown exception";
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                results.push_back(std::move(result));
+                resultCondition.notify_one();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            ++numFinishedThreads;
+            resultCondition.notify_one();
+        });
+    }
+
+    std::deque<SweepResult> newResults;
+    bool finished = false;
+    while(!finished)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            resultCondition.wait(lock, [&]{ return !results.empty() || numFinishedThreads == mNumThreads; });
+            newResults.swap(results);
+            finished = results.empty() && newResults.empty() && numFinishedThreads == mNumThreads;
+        }
+
+        for(const SweepResult &rResult : newResults)
+        {
+            if(!rResult.ok)
+            {
+                ++mNumFailedRuns;
+                mpMessageHandler->printMessage("Warning: Sweep run "+std::to_string(rResult.run)+" failed"+
+                                               (rResult.error.empty() ? std::string(".") : ": "+rResult.error));
+                continue;
+            }
+            ++mNumCompletedRuns;
+            if(file.is_open())
+            {
+                file << rResult.run;
+                for(double value : rResult.parameters)
+                {
+                    file << "," << value;
+                }
+                for(double value : rResult.outputs)
+                {
+                    file << "," << value;
+                }
+                file << std::endl;
+            }
+        }
+        if(!newResults.empty())
+        {
+            newResults.clear();
+            mpMessageHandler->stepCompleted(mNumResumedRuns+mNumCompletedRuns+mNumFailedRuns);
+        }
+        if(mpMessageHandler->aborted())
+        {
+            stop = true;
+        }
+    }
+
+    for(std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    if(mpMessageHandler->aborted())
+    {
+        mpMessageHandler->printMessage("Sweep was aborted after "+std::to_string(mNumCompletedRuns)+" runs, run it again to resume.");
+    }
+    else
+    {
+        mpMessageHandler->printMessage("Sweep finished: "+std::to_string(mNumCompletedRuns)+" runs completed, "+
+                                       std::to_string(mNumFailedRuns)+" failed.");
+    }
+    return true;
+}
+
+
+//! @brief Returns the number of runs completed by the last call to run()
+size_t SweepRunner::getNumberOfCompletedRuns() const
+{
+    return mNumCompletedRuns;
+}
+
+
+//! @brief Returns the number of runs that were skipped by the last call to run() because they were already in the result file
+size_t SweepRunner::getNumberOfResumedRuns() const
+{
+    return mNumResumedRuns;
+}
+
+
+//! @brief Returns the number of runs that failed in the last call to run()
+size_t SweepRunner::getNumberOfFailedRuns() const
+{
+    return mNumFailedRuns;
+}
+
+
+//! @brief Describes everything that affects the parameter values of a run, results can only be resumed if it is unchanged
+//! @details The number of runs is only included for designs where it affects the points, so that Sobol, Halton and
+//! random sweeps can be extended with more runs.
+std::string SweepRunner::createSignature() const
+{
+    std::stringstream ss;
+    ss.precision(std::numeric_limits<double>::max_digits10);
+    const DesignT design = mDesign.getDesign();
+    ss << "design " << gDesignNames[design];
+    if(design == DesignLatinHypercube || design == DesignRandom)
+    {
+        ss << " seed " << mDesign.getRandomSeed();
+    }
+    if(design == DesignLatinHypercube)
+    {
+        ss << " runs " << mDesign.getNumberOfRuns();
+    }
+    ss << " limits";
+    for(size_t i=0; i<mDesign.getNumberOfParameters(); ++i)
+    {
+        double min, max;
+        mDesign.getParameterLimits(i, min, max);
+        ss << " " << min << " " << max;
+        if(design == DesignFullFactorial)
+        {
+            ss << " " << mDesign.getNumberOfLevels(i);
+        }
+    }
+    return ss.str();
+}
+
+
+std::string SweepRunner::createHeader() const
+{
+    std::string header = "run";
+    for(size_t i=0; i<mDesign.getNumberOfParameters(); ++i)
+    {
+        header += ","+((i < mParameterNames.size()) ? mParameterNames[i] : "par"+std::to_string(i));
+    }
+    for(const std::string &rName : mpEvaluator->getOutputNames())
+    {
+        header += ","+rName;
+    }
+    return header;
+}
+
+
+//! @brief Reads the indices of runs already in the result file
+//! @details Incomplete rows, for example from a sweep that was killed while writing, are removed from the file.
+//! @param [out] rCompletedRuns Run indices found in the file
+//! @returns False if the file belongs to a different sweep
+bool SweepRunner::readCompletedRuns(std::set<size_t> &rCompletedRuns)
+{
+    std::ifstream file(mResultFile.c_str());
+    if(!file.good())
+    {
+        return true;
+    }
+
+    std::string signatureLine, headerLine;
+    std::getline(file, signatureLine);
+    std::getline(file, headerLine);
+    if(signatureLine.empty() && headerLine.empty())
+    {
+        return true;
+    }
+    if(signatureLine != "# "+createSignature() || headerLine != createHeader())
+    {
+        mpMessageHandler->printMessage("Error: Sweep result file "+mResultFile+" belongs to a different sweep, remove it or disable resume.");
+        return false;
+    }
+
+    const size_t numFields = std::count(headerLine.begin(), headerLine.end(), ',')+1;
+    const size_t numRuns = mDesign.getNumberOfRuns();
+    std::vector<std::string> validLines;
+    bool foundInvalid = false;
+    std::string line;
+    while(std::getline(file, line))
+    {
+        const bool complete = !file.eof();
+        size_t run;
+        std::istringstream lineStream(line);
+        if(complete && !line.empty() && size_t(std::count(line.begin(), line.end(), ','))+1 == numFields && (lineStream >> run))
+        {
+            //Runs beyond the current number of runs are kept in the file, they are used if the sweep is extended again
+            if(run < numRuns)
+            {
+                rCompletedRuns.insert(run);
+            }
+            validLines.push_back(line);
+        }
+        else
+        {
+            foundInvalid = true;
+        }
+    }
+    file.close();
+
+    if(foundInvalid)
+    {
+        std::ofstream rewrittenFile(mResultFile.c_str(), std::ios::trunc);
+        rewrittenFile << signatureLine << "\n" << headerLine << "\n";
+        for(const std::string &rLine : validLines)
+        {
+            rewrittenFile << rLine << "\n";
+        }
+        if(!rewrittenFile.good())
+        {
+            mpMessageHandler->printMessage("Error: Could not repair sweep result file: "+mResultFile);
+            return false;
+        }
+    }
+    return true;
+}
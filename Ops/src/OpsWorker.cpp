@@ -39,10 +39,12 @@
 #include <algorithm>
 #include <random>
 #include <chrono>
+#include <sstream>
 
 //#include <QDebug>
 #include "OpsWorker.h"
 #include "OpsEvaluator.h"
+#include "OpsParallelEvaluator.h"
 #include "OpsMessageHandler.h"
 
 
@@ -67,6 +69,14 @@ Worker::Worker(Evaluator *pEvaluator, MessageHandler *pMessageHandler)
     mDistribution = SamplingRandom;
     mUseSurrogateModel = false;
     mNumSurrogateModelUpdateInterval = 20;
+    mAsynchronous = false;
+
+#ifdef __MINGW32__
+    // "Bug" in MinGW (using constant seed) supposedly fixed in GCC 9.2, using current time as seed instead
+    setRandomSeed(static_cast<unsigned int>(std::chrono::high_resolution_clock::now().time_since_epoch().count()));
+#else
+    setRandomSeed(std::random_device{}());
+#endif
 
     mpEvaluator->setWorker(this);
 }
@@ -348,6 +358,14 @@ void Worker::setUseSurrogateModel(size_t interval)
     mNumSurrogateModelUpdateInterval = interval;
 }
 
+//! @brief Enables asynchronous (steady-state) evaluation, where a new candidate is generated as soon as any evaluation finishes
+//! @details Only supported by algorithms that evaluate independent candidates (differential evolution and particle swarm),
+//! and only if the evaluator is a ParallelEvaluator. This avoids idle threads when evaluation times vary.
+void Worker::setAsynchronous(bool value)
+{
+    mAsynchronous = value;
+}
+
 size_t Worker::getNumberOfCandidates()
 {
     return mNumCandidates;
@@ -373,16 +391,19 @@ size_t Worker::getCurrentNumberOfIterations()
     return mIterationCounter;
 }
 
+//! @brief Returns a uniformly distributed random number between 0 and 1
+//! @details Each worker has its own generator, so workers running in different threads do not share state
 double Worker::opsRand()
 {
-#ifdef __MINGW32__
-    // "Bug" in MinGW (using constant seed) supposedly fixed in GCC 9.2, using current time as seed instead
-    static std::mt19937 generator(static_cast<long unsigned int>(std::chrono::high_resolution_clock::now().time_since_epoch().count()));
-#else
-    static std::mt19937 generator(std::random_device{}());
-#endif
-    static std::uniform_real_distribution<> distribution(0.0, 1.0);
-    return distribution(generator);
+    std::uniform_real_distribution<> distribution(0.0, 1.0);
+    return distribution(mRandomGenerator);
+}
+
+//! @brief Seeds the random number generator, use a fixed seed to make runs reproducible
+//! @param seed Seed value
+void Worker::setRandomSeed(unsigned int seed)
+{
+    mRandomGenerator.seed(seed);
 }
 
 bool Worker::aborted()
@@ -390,6 +411,32 @@ bool Worker::aborted()
     return mpMessageHandler->aborted();
 }
 
+//! @brief Returns the evaluator to use for asynchronous evaluation, or nullptr if the algorithm shall run synchronously
+ParallelEvaluator *Worker::getAsynchronousEvaluator()
+{
+    if(!mAsynchronous)
+    {
+        return nullptr;
+    }
+    ParallelEvaluator *pParallelEvaluator = dynamic_cast<ParallelEvaluator*>(mpEvaluator);
+    if(!pParallelEvaluator)
+    {
+        mpMessageHandler->printMessage("Warning: Asynchronous evaluation requires a parallel evaluator, using synchronous evaluation instead.");
+    }
+    return pParallelEvaluator;
+}
+
+//! @brief Prints evaluation throughput and core utilization since the statistics of the evaluator were reset
+void Worker::printEvaluationStatistics(const ParallelEvaluator *pEvaluator)
+{
+    std::stringstream ss;
+    ss.precision(3);
+    ss << "Evaluated " << pEvaluator->getNumberOfCompletedEvaluations() << " points in " << pEvaluator->getElapsedTime() << " s ("
+       << pEvaluator->getThroughput() << " evaluations/s), core utilization " << 100.0*pEvaluator->getUtilization() << "% of "
+       << pEvaluator->getNumberOfThreads() << " threads.";
+    mpMessageHandler->printMessage(ss.str());
+}
+
 void Worker::setParameterLimits(size_t idx, double min, double max)
 {
     mParameterMin[idx] = min;
@@ -413,6 +460,16 @@ void Worker::setCandidateObjectiveValue(size_t idx, double value)
 }
 
 
+double Worker::getCandidateObjectiveValue(size_t idx) const
+{
+    if(idx > mCandidateObjectives.size()-1)
+    {
+        return 0;
+    }
+    return mCandidateObjectives[idx];
+}
+
+
 double Worker::getObjectiveValue(size_t idx) const
 {
     if(idx > mObjectives.size()-1)
@@ -58,8 +58,10 @@
 
 #include "OpsWorkerDifferentialEvolution.h"
 #include "OpsEvaluator.h"
+#include "OpsParallelEvaluator.h"
 #include "OpsMessageHandler.h"
 #include <math.h>
+#include <algorithm>
 
 using namespace Ops;
 
@@ -88,6 +90,14 @@ void WorkerDifferentialEvolution::run()
         mpMessageHandler->printMessage("Error: Differential evolution algorithm requires more than 4 candidates.");
         return;
     }
+
+    ParallelEvaluator *pParallelEvaluator = getAsynchronousEvaluator();
+    if(pParallelEvaluator)
+    {
+        runAsynchronous(pParallelEvaluator);
+        return;
+    }
+
     mpMessageHandler->printMessage("Running optimization with differential evolution algorithm.");
 
     distributePoints();
@@ -101,26 +111,7 @@ void WorkerDifferentialEvolution::run()
     {
         for(size_t p=0; p<mNumPoints; ++p)
         {
-            bool feasible=false;
-            while(!feasible)
-            {
-                size_t a,b,c,R;
-                getRandomIds(p,a,b,c,R);
-
-                mCandidatePoints[p] = mPoints[p];
-                for(size_t i=0; i<mNumParameters; ++i)
-                {
-                    double r = opsRand();
-                    if(r < mCR || i == R)
-                    {
-                        double A = mPoints[a][i];
-                        double B = mPoints[b][i];
-                        double C = mPoints[c][i];
-                        mCandidatePoints[p][i] = A + mF * (B - C);
-                    }
-                }
-                feasible = isCandidateFeasible(p);
-            }
+            generateTrial(p);
         }
 
         mpEvaluator->evaluateAllCandidatesWithSurrogateModel();
@@ -163,6 +154,96 @@ void WorkerDifferentialEvolution::run()
 }
 
 
+//! @brief Executes a steady-state differential evolution algorithm
+//! @details Instead of waiting for a whole generation, a new trial vector is generated and submitted as soon as any
+//! evaluation finishes, so threads never wait for slow evaluations of other candidates. Each target point has at most one
+//! trial in flight. One iteration corresponds to as many evaluations as there are points.
+void WorkerDifferentialEvolution::runAsynchronous(ParallelEvaluator *pEvaluator)
+{
+    mpMessageHandler->printMessage("Running optimization with asynchronous differential evolution algorithm.");
+
+    pEvaluator->resetStatistics();
+    distributePoints();
+
+    //Evaluate initial objective values
+    mpEvaluator->evaluateAllPoints();
+    mpMessageHandler->objectivesChanged();
+
+    const size_t maxInFlight = std::min(pEvaluator->getNumberOfThreads(), mNumPoints);
+    const size_t maxEvaluations = mnMaxIterations*mNumPoints;
+    std::vector<bool> inFlight(mNumPoints, false);
+    size_t numInFlight=0, numSubmitted=0, numCompleted=0, nextTarget=0;
+    bool converged=false;
+
+    mIterationCounter=0;
+    while(true)
+    {
+        //Keep all threads busy with trials for targets that are not already being evaluated
+        while(!converged && !mpMessageHandler->aborted() && numInFlight < maxInFlight && numSubmitted < maxEvaluations)
+        {
+            while(inFlight[nextTarget])
+            {
+                nextTarget = (nextTarget+1) % mNumPoints;
+            }
+            generateTrial(nextTarget);
+            pEvaluator->submitEvaluation(nextTarget, mCandidatePoints[nextTarget]);
+            inFlight[nextTarget] = true;
+            ++numInFlight;
+            ++numSubmitted;
+            nextTarget = (nextTarget+1) % mNumPoints;
+        }
+
+        size_t p;
+        double objective;
+        if(!pEvaluator->waitForEvaluation(p, objective))
+        {
+            break;
+        }
+        inFlight[p] = false;
+        --numInFlight;
+        ++numCompleted;
+
+        mCandidateObjectives[p] = objective;
+        if(objective < mObjectives[p])
+        {
+            mPoints[p] = mCandidatePoints[p];
+            mObjectives[p] = objective;
+        }
+
+        if(!converged && numCompleted % mNumPoints == 0)
+        {
+            mpMessageHandler->pointsChanged();
+            mpMessageHandler->objectivesChanged();
+
+            //Check convergence
+            converged = checkForConvergence();
+            if(!converged)
+            {
+                mpMessageHandler->stepCompleted(mIterationCounter);
+                ++mIterationCounter;
+            }
+        }
+    }
+
+    if(mpMessageHandler->aborted())
+    {
+        mpMessageHandler->printMessage("Optimization was aborted after "+std::to_string(mIterationCounter)+" iterations.");
+    }
+    else if(!converged)
+    {
+        mpMessageHandler->printMessage("Optimization failed to converge after "+std::to_string(mIterationCounter)+" iterations");
+    }
+    else
+    {
+        mpMessageHandler->printMessage("Optimization converged in parameter values after "+std::to_string(mIterationCounter)+" iterations.");
+    }
+    printEvaluationStatistics(pEvaluator);
+
+    // Clean up
+    finalize();
+}
+
+
 void WorkerDifferentialEvolution::setCrossoverProbability(double value)
 {
     mCR = value;
@@ -199,6 +280,31 @@ void WorkerDifferentialEvolution::getRandomIds(size_t notId, size_t &id1, size_t
     }
 }
 
+//! @brief Generates a feasible trial vector for a target point by mutation and crossover, stored as candidate point p
+void WorkerDifferentialEvolution::generateTrial(size_t p)
+{
+    bool feasible=false;
+    while(!feasible)
+    {
+        size_t a,b,c,R;
+        getRandomIds(p,a,b,c,R);
+
+        mCandidatePoints[p] = mPoints[p];
+        for(size_t i=0; i<mNumParameters; ++i)
+        {
+            double r = opsRand();
+            if(r < mCR || i == R)
+            {
+                double A = mPoints[a][i];
+                double B = mPoints[b][i];
+                double C = mPoints[c][i];
+                mCandidatePoints[p][i] = A + mF * (B - C);
+            }
+        }
+        feasible = isCandidateFeasible(p);
+    }
+}
+
 bool WorkerDifferentialEvolution::isCandidateFeasible(int id)
 {
     for(size_t p=0; p<mNumParameters; ++p)
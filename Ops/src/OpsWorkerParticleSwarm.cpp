@@ -33,6 +33,7 @@
 
 #include "OpsWorkerParticleSwarm.h"
 #include "OpsEvaluator.h"
+#include "OpsParallelEvaluator.h"
 #include "OpsMessageHandler.h"
 #include <math.h>
 #include <algorithm>
@@ -80,6 +81,14 @@ void WorkerParticleSwarm::run()
         return;
     }
 
+
+    ParallelEvaluator *pParallelEvaluator = getAsynchronousEvaluator();
+    if(pParallelEvaluator)
+    {
+        runAsynchronous(pParallelEvaluator);
+        return;
+    }
+
     mpMessageHandler->printMessage("Running optimization with particle swarm algorithm.");
 
     distributePoints();
@@ -105,17 +114,8 @@ void WorkerParticleSwarm::run()
     for(; mIterationCounter<mnMaxIterations && !mpMessageHandler->aborted(); ++mIterationCounter)
     {
         //Update weight (linearly decreasing)
-        if(mInertiaStrategy == InertiaConstant)
-        {
-            mOmega = mOmega1;
-        }
-        else if(mInertiaStrategy == InertiaLinearDecreasing)
-        {
-            mOmega = mOmega1 + (mOmega2-mOmega1)*mIterationCounter/mnMaxIterations;
-        }
-        else
+        if(!updateInertia())
         {
-            mpMessageHandler->printMessage("Unknown inertia strategy, aborting.");
             return;
         }
 
@@ -124,27 +124,25 @@ void WorkerParticleSwarm::run()
         mpMessageHandler->pointsChanged();
 
         //Evaluate objective values
-        bool usedSurrogateModel = mpEvaluator->evaluateAllCandidatesWithSurrogateModel();
+        mpEvaluator->evaluateAllCandidatesWithSurrogateModel();
         mpMessageHandler->objectivesChanged();
 
-        if(!usedSurrogateModel) {
-            //Calculate best known positions
-            for(size_t p=0; p<mNumPoints; ++p)
+        //Calculate best known positions (candidates screened out by the surrogate model are never better than any point)
+        for(size_t p=0; p<mNumPoints; ++p)
+        {
+            if(mCandidateObjectives[p] < mObjectives[p])
             {
-                if(mCandidateObjectives[p] < mObjectives[p])
-                {
-                    mPoints[p] = mCandidatePoints[p];
-                    mObjectives[p] = mCandidateObjectives[p];
-                }
+                mPoints[p] = mCandidatePoints[p];
+                mObjectives[p] = mCandidateObjectives[p];
             }
+        }
 
-            //Calculate best known global position
-            calculateBestAndWorstId();
-            if(mObjectives[mBestId] < mBestObjective)
-            {
-                mBestObjective = mObjectives[mBestId];
-                mBestPoint = mPoints[mBestId];
-            }
+        //Calculate best known global position
+        calculateBestAndWorstId();
+        if(mObjectives[mBestId] < mBestObjective)
+        {
+            mBestObjective = mObjectives[mBestId];
+            mBestPoint = mPoints[mBestId];
         }
 
         //Check convergence
@@ -173,6 +171,141 @@ void WorkerParticleSwarm::run()
 }
 
 
+//! @brief Executes an asynchronous particle swarm algorithm
+//! @details Each particle is moved and re-submitted as soon as its previous evaluation has finished, using the best
+//! global position known at that time. Threads therefore never wait for slow evaluations of other particles.
+//! One iteration corresponds to as many evaluations as there are particles.
+void WorkerParticleSwarm::runAsynchronous(ParallelEvaluator *pEvaluator)
+{
+    mpMessageHandler->printMessage("Running optimization with asynchronous particle swarm algorithm.");
+
+    pEvaluator->resetStatistics();
+    distributePoints();
+
+    //Evaluate initial objective values
+    mpEvaluator->evaluateAllPoints();
+    mpMessageHandler->objectivesChanged();
+
+    //Initialize best known point for each point
+    for(size_t i=0; i<mNumPoints; ++i)
+    {
+        mLocalBestPoints[i] = mPoints[i];
+        mLocalBestObjectives[i] = mObjectives[i];
+    }
+
+    //Calculate best known global position
+    calculateBestAndWorstId();
+    mBestObjective = mObjectives[mBestId];
+    mBestPoint = mPoints[mBestId];
+
+    mIterationCounter=0;
+    if(!updateInertia())
+    {
+        return;
+    }
+
+    const size_t maxInFlight = std::min(pEvaluator->getNumberOfThreads(), mNumPoints);
+    const size_t maxEvaluations = mnMaxIterations*mNumPoints;
+    std::vector<bool> inFlight(mNumPoints, false);
+    size_t numInFlight=0, numSubmitted=0, numCompleted=0, nextParticle=0;
+    bool converged=false;
+
+    while(true)
+    {
+        //Keep all threads busy with particles that are not already being evaluated
+        while(!converged && !mpMessageHandler->aborted() && numInFlight < maxInFlight && numSubmitted < maxEvaluations)
+        {
+            while(inFlight[nextParticle])
+            {
+                nextParticle = (nextParticle+1) % mNumPoints;
+            }
+            moveParticle(nextParticle);
+            pEvaluator->submitEvaluation(nextParticle, mCandidatePoints[nextParticle]);
+            inFlight[nextParticle] = true;
+            ++numInFlight;
+            ++numSubmitted;
+            nextParticle = (nextParticle+1) % mNumPoints;
+        }
+
+        size_t p;
+        double objective;
+        if(!pEvaluator->waitForEvaluation(p, objective))
+        {
+            break;
+        }
+        inFlight[p] = false;
+        --numInFlight;
+        ++numCompleted;
+
+        //Update best known position of the particle and the swarm
+        mCandidateObjectives[p] = objective;
+        if(objective < mObjectives[p])
+        {
+            mPoints[p] = mCandidatePoints[p];
+            mObjectives[p] = objective;
+        }
+        if(objective < mBestObjective)
+        {
+            mBestObjective = objective;
+            mBestPoint = mCandidatePoints[p];
+        }
+
+        if(!converged && numCompleted % mNumPoints == 0)
+        {
+            mpMessageHandler->pointsChanged();
+            mpMessageHandler->objectivesChanged();
+
+            //Check convergence
+            converged = checkForConvergence();
+            if(!converged)
+            {
+                mpMessageHandler->stepCompleted(mIterationCounter);
+                ++mIterationCounter;
+                updateInertia();
+            }
+        }
+    }
+
+    if(mpMessageHandler->aborted())
+    {
+        mpMessageHandler->printMessage("Optimization was aborted after "+std::to_string(mIterationCounter)+" iterations.");
+    }
+    else if(!converged)
+    {
+        mpMessageHandler->printMessage("Optimization failed to converge after "+std::to_string(mIterationCounter)+" iterations");
+    }
+    else
+    {
+        mpMessageHandler->printMessage("Optimization converged in parameter values after "+std::to_string(mIterationCounter)+" iterations.");
+    }
+    printEvaluationStatistics(pEvaluator);
+
+    // Clean up
+    finalize();
+}
+
+
+//! @brief Updates the inertia weight according to the inertia strategy and the current iteration
+//! @returns False if the inertia strategy is unknown
+bool WorkerParticleSwarm::updateInertia()
+{
+    if(mInertiaStrategy == InertiaConstant)
+    {
+        mOmega = mOmega1;
+    }
+    else if(mInertiaStrategy == InertiaLinearDecreasing)
+    {
+        mOmega = mOmega1 + (mOmega2-mOmega1)*mIterationCounter/mnMaxIterations;
+    }
+    else
+    {
+        mpMessageHandler->printMessage("Unknown inertia strategy, aborting.");
+        return false;
+    }
+    return true;
+}
+
+
 void WorkerParticleSwarm::setNumberOfPoints(size_t value)
 {
     Worker::setNumberOfPoints(value);
@@ -182,8 +315,8 @@ void WorkerParticleSwarm::setNumberOfPoints(size_t value)
     mLocalBestObjectives.resize(value);
     for(size_t i=0; i<value; ++i)
     {
-        mVelocities[i].resize(mNumPoints);
-        mLocalBestPoints[i].resize(mNumPoints);
+        mVelocities[i].resize(mNumParameters);
+        mLocalBestPoints[i].resize(mNumParameters);
     }
 }
 
@@ -193,10 +326,10 @@ void WorkerParticleSwarm::setNumberOfParameters(size_t value)
     Worker::setNumberOfParameters(value);
 
     mBestPoint.resize(value);
-    for(size_t i=0; i<mNumPoints; ++i)
+    for(size_t i=0; i<mVelocities.size(); ++i)
     {
-        mVelocities[i].resize(mNumPoints);
-        mLocalBestPoints[i].resize(mNumPoints);
+        mVelocities[i].resize(value);
+        mLocalBestPoints[i].resize(value);
     }
 }
 
@@ -0,0 +1,30 @@
+#!/bin/bash
+
+# Starts an address server and several local hopsanservers with different number of slots,
+# then asks the address server how to place a batch of jobs on them
+# Example execution (from the Hopsan bin directory):
+# ../Scripts/remote/testJobPlacement.sh 20
+
+numjobs=${1:-20}
+addressport=50000
+
+./hopsanaddressserver -p $addressport --refreshtime 0.1 &
+pids=$!
+sleep 1
+
+port=50100
+for slots in 1 2 4; do
+    ./hopsanserver -p $port -n $slots --addresserver localhost:$addressport --description "local${slots}slots" &
+    pids="$pids $!"
+    port=$((port+100))
+done
+
+# Wait for status refresh and benchmarks
+sleep 30
+
+./hopsanremoteclient --addressserver localhost:$addressport --placejobs $numjobs
+rc=$?
+
+kill $pids
+wait
+exit $rc
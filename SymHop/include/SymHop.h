@@ -37,6 +37,7 @@
 #include <QString>
 #include <QList>
 #include <QStringList>
+#include <QVector>
 #include <QDebug>
 #include "symhop_win32dll.h"
 
@@ -105,6 +106,7 @@ public:
     void addBy(Expression const term);
     void subtractBy(Expression const term);
     QString toString() const;
+    QString toCodeString() const;
     QString toLaTeX() const;
     void toDelayForm(QList<Expression> &rDelayTerms, QStringList &rDelaySteps);
     double toDouble(bool *ok=0) const;
@@ -190,10 +192,73 @@ public:
     Expression *mpDividend;   //Used in modulo
 
 private:
+    Expression derivativeUncached(const Expression x, bool &ok) const;
+    void simplifyUncached(ExpressionSimplificationT type, const ExpressionRecursiveT recursive);
+    void simplifyMemoized(const ExpressionSimplificationT type, const int id, const quint64 idGeneration);
+    QString toStringHelper(const bool reducePowers) const;
     bool splitAtSeparator(const QString sep, const QStringList subSymbols, const ExpressionSimplificationT simplifications);
     QStringList reservedSymbols;
 };
 
+//! @brief Number of arithmetic operations and function calls needed to evaluate an expression
+class SYMHOP_DLLAPI OperationCount
+{
+public:
+    OperationCount();
+    int total() const;
+    QString toString() const;
+    OperationCount &operator+=(const OperationCount &other);
+
+    int additions;
+    int multiplications;
+    int divisions;
+    int functionCalls;
+};
+
+OperationCount SYMHOP_DLLAPI countOperations(const Expression &expr, const bool reducePowers=false);
+void SYMHOP_DLLAPI eliminateCommonSubexpressions(QList<Expression> &rExpressions, QList<Expression> &rTemporaries, const QString &tempPrefix, const bool reducePowers=true);
+
+//! @brief Flat instruction tape for fast repeated evaluation of an expression
+//! @details Variables are resolved to slots when compiling, so evaluation does not need any string lookups.
+//! Only built-in functions are supported, use Expression::evaluate() for expressions with custom functions.
+class SYMHOP_DLLAPI EvaluationTape
+{
+public:
+    EvaluationTape();
+    bool compile(const Expression &expr, const QStringList &variableNames, const QMap<QString, double> &constants=QMap<QString, double>());
+    bool isCompiled() const;
+    QStringList getVariableNames() const;
+    int getNumInstructions() const;
+
+    double evaluate(const double *pVariables) const;
+    void evaluate(const double * const *pColumns, double *pResult, const size_t n) const;
+
+private:
+    enum OpCodeT {PushConstant, PushVariable, Add, Multiply, Divide, Power, Equal, Function1, Function2, Limit};
+    struct Instruction
+    {
+        OpCodeT op;
+        int arg;
+        double value;
+    };
+
+    bool compileNode(const Expression &expr, int depth);
+    void append(const OpCodeT op, const int arg, const double value, const int depth);
+    void evaluateBlock(const double * const *pColumns, const size_t offset, const size_t length, double *pStack, double *pResult) const;
+
+    QVector<Instruction> mInstructions;
+    QStringList mVariableNames;
+    QMap<QString, double> mConstants;
+    int mMaxDepth;
+    bool mCompiled;
+};
+
+int SYMHOP_DLLAPI internExpression(const Expression &expr);
+void SYMHOP_DLLAPI setMemoizationEnabled(const bool enabled);
+bool SYMHOP_DLLAPI isMemoizationEnabled();
+void SYMHOP_DLLAPI clearMemoization();
+void SYMHOP_DLLAPI getMemoizationStatistics(int &rNumNodes, qint64 &rNumHits, qint64 &rNumMisses);
+
 QString SYMHOP_DLLAPI getFunctionDerivative(const QString &key);
 QStringList SYMHOP_DLLAPI getSupportedFunctionsList();
 QStringList SYMHOP_DLLAPI getCustomFunctionList();
@@ -35,6 +35,10 @@
 #define _USE_MATH_DEFINES
 #include <cmath>
 
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
 #include "SymHop.h"
 
 using namespace std;
@@ -98,14 +102,27 @@ Expression::Expression(const Expression &other)
 //! @param simplifications Specifies the degree of simplification
 Expression::Expression(const QString indata, bool *ok, const ExpressionSimplificationT simplifications)
 {
-    bool isDouble;
-    QString temp = QString::number(indata.toDouble(&isDouble), 'f', 20);
-
+    bool dummy;
     if(!ok)
     {
-        ok = new bool;
+        ok = &dummy;
+    }
+
+    //Empty expressions are created for every temporary and child node, so do not parse them
+    if(indata.isEmpty())
+    {
+        mpLeft = nullptr;
+        mpRight = nullptr;
+        mpBase = nullptr;
+        mpPower = nullptr;
+        mpDividend = nullptr;
+        *ok = false;
+        return;
     }
 
+    bool isDouble;
+    QString temp = QString::number(indata.toDouble(&isDouble), 'f', 20);
+
     //If it is a number, make sure it has correct precision and remove extra zeros at end. Otherwise use original string.
     if(isDouble)
     {
@@ -1135,6 +1152,22 @@ void Expression::subtractBy(const Expression term)
 
 //! @brief Returns the expression converted to a string
 QString Expression::toString() const
+{
+    return toStringHelper(false);
+}
+
+
+//! @brief Returns the expression as C++ code, where small integer powers are replaced by multiplications
+//! @details pow(x,2), pow(x,3) and pow(x,4) are written as products when x is a symbol, and pow(x,0.5) as sqrt(x)
+QString Expression::toCodeString() const
+{
+    return toStringHelper(true);
+}
+
+
+//! @brief Help function for toString() and toCodeString()
+//! @param reducePowers Replace small integer powers and square roots by cheaper operations
+QString Expression::toStringHelper(const bool reducePowers) const
 {
     QString ret;
 
@@ -1145,7 +1178,7 @@ QString Expression::toString() const
         ret = mFunction+"(";
         for(int i=0; i<mArguments.size(); ++i)
         {
-            ret.append(mArguments[i].toString()+",");
+            ret.append(mArguments[i].toStringHelper(reducePowers)+",");
         }
         if(!mArguments.isEmpty()) {
             ret.chop(1);
@@ -1153,8 +1186,8 @@ QString Expression::toString() const
         ret.append(")");
     }
     else if(this->isEquation()) {
-        QString leftStr =mpLeft->toString();
-        QString rightStr = mpRight->toString();
+        QString leftStr =mpLeft->toStringHelper(reducePowers);
+        QString rightStr = mpRight->toStringHelper(reducePowers);
         ret = leftStr + "=" + rightStr;
     }
     else if(this->isAdd()) {
@@ -1170,7 +1203,7 @@ QString Expression::toString() const
                 }
                 ret.append("-");
             }
-            termString = tempTerm.toString();
+            termString = tempTerm.toStringHelper(reducePowers);
             ret.append(termString);
             ret.append("+");
         }
@@ -1181,7 +1214,7 @@ QString Expression::toString() const
         bool isOdd = (numMinus%2 != 0);
 
         for(const Expression &factor : mFactors) {
-            QString factString = factor.toString();
+            QString factString = factor.toStringHelper(reducePowers);
             if(factor.isAdd())
             {
                 factString.prepend("(");
@@ -1199,7 +1232,7 @@ QString Expression::toString() const
         if(!mDivisors.isEmpty()) { ret.append("/"); }
         if(mDivisors.size() > 1) { ret.append("("); }
         for(const Expression &divisor : mDivisors) {
-            QString divString = divisor.toString();
+            QString divString = divisor.toStringHelper(reducePowers);
             if(divisor.isAdd())
             {
                 divString.prepend("(");
@@ -1219,19 +1252,36 @@ QString Expression::toString() const
     }
     else if(this->isPower())
     {
-        QString baseStr = mpBase->toString();
+        QString baseStr = mpBase->toStringHelper(reducePowers);
         if(mpBase->isAdd() || mpBase->isMultiplyOrDivide())
         {
             baseStr.prepend("(");
             baseStr.append(")");
         }
-        QString powerStr = mpPower->toString();
+        QString powerStr = mpPower->toStringHelper(reducePowers);
         if(mpPower->isAdd() || mpBase->isMultiplyOrDivide())
         {
             powerStr.prepend("(");
             powerStr.append(")");
         }
-        ret = "pow("+baseStr+","+powerStr+")";
+        const double power = mpPower->isNumericalSymbol() ? mpPower->toDouble() : 0;
+        if(reducePowers && power == 0.5)
+        {
+            ret = "sqrt("+mpBase->toStringHelper(reducePowers)+")";
+        }
+        else if(reducePowers && mpBase->isSymbol() && (power == 2 || power == 3 || power == 4))
+        {
+            ret = "("+baseStr;
+            for(int i=1; i<int(power); ++i)
+            {
+                ret.append("*"+baseStr);
+            }
+            ret.append(")");
+        }
+        else
+        {
+            ret = "pow("+baseStr+","+powerStr+")";
+        }
     }
 
     //Simplify output
@@ -1688,10 +1738,329 @@ void Expression::changeSign()
 }
 
 
+// Memoization of derivatives and simplifications
+namespace {
+
+//! @brief Key of an interned node, its own symbol and function name and the ids of its children
+//! @details Each child list is stored as its size followed by the ids, each child pointer as its id or -1 if not set
+struct NodeKey
+{
+    QString string;
+    QString function;
+    QVector<int> childIds;
+
+    bool operator==(const NodeKey &other) const
+    {
+        return (childIds == other.childIds && string == other.string && function == other.function);
+    }
+};
+
+inline uint qHash(const NodeKey &key, uint seed=0)
+{
+    uint hash = qHash(key.string, seed) ^ (qHash(key.function, seed) << 1);
+    for(int i=0; i<key.childIds.size(); ++i)
+    {
+        hash = hash*31 + uint(key.childIds[i]);
+    }
+    return hash;
+}
+
+//! @brief Ids of the nodes of an expression that is not modified while the ids are used
+//! @details Only nodes of the expression passed to the recording lookup are remembered, by address, so that nested lookups
+//! on its subexpressions find their ids without interning the subtrees again. The ids belong to one generation of the tables.
+struct KnownNodeIds
+{
+    KnownNodeIds() : generation(0) {}
+
+    quint64 generation;
+    QHash<const Expression*, int> ids;
+};
+
+//! @brief Interns expression nodes and remembers derivatives and recursive simplifications of interned nodes
+//! @details Each structurally unique node is given an id, computed from its own symbol or function name and the ids
+//! of its children, so that shared subexpressions are only ever differentiated or simplified once. All tables are
+//! cleared when the number of nodes exceeds a limit. This is only done when a lookup begins, never while a node is interned, so that
+//! all ids in a key belong to the same generation. The generation counter then tells callers that ids they hold are stale.
+class ExpressionMemo
+{
+public:
+    ExpressionMemo() : mEnabled(false), mGeneration(0), mNumHits(0), mNumMisses(0) {}
+
+    bool isEnabled()
+    {
+        QMutexLocker locker(&mMutex);
+        return mEnabled;
+    }
+
+    void setEnabled(const bool enabled)
+    {
+        QMutexLocker locker(&mMutex);
+        mEnabled = enabled;
+        clearTables();
+    }
+
+    void clear()
+    {
+        QMutexLocker locker(&mMutex);
+        clearTables();
+        mNumHits = 0;
+        mNumMisses = 0;
+    }
+
+    int intern(const Expression &expr)
+    {
+        QMutexLocker locker(&mMutex);
+        limitTableSize();
+        return internNode(expr, nullptr, false);
+    }
+
+    void getStatistics(int &rNumNodes, qint64 &rNumHits, qint64 &rNumMisses)
+    {
+        QMutexLocker locker(&mMutex);
+        rNumNodes = mNodeIds.size();
+        rNumHits = mNumHits;
+        rNumMisses = mNumMisses;
+    }
+
+    //! @brief Looks up a derivative, if not found rKey and rGeneration shall be passed to storeDerivative()
+    //! @param rKnownIds Ids of nodes interned earlier, used to avoid interning subexpressions again
+    //! @param record True to remember the ids of all nodes in expr, expr must then not be modified while rKnownIds is used
+    bool lookupDerivative(const Expression &expr, const Expression &x, KnownNodeIds &rKnownIds, const bool record, quint64 &rKey, quint64 &rGeneration, Expression &rResult)
+    {
+        QMutexLocker locker(&mMutex);
+        limitTableSize();
+        if(rKnownIds.generation != mGeneration)
+        {
+            rKnownIds.ids.clear();
+            rKnownIds.generation = mGeneration;
+        }
+        const quint64 exprId = internNode(expr, &rKnownIds, record);
+        const quint64 xId = internNode(x, nullptr, false);
+        rKey = (exprId << 32) | xId;
+        rGeneration = mGeneration;
+        return lookup(mDerivatives, rKey, rResult);
+    }
+
+    void storeDerivative(const quint64 key, const quint64 generation, const Expression &result)
+    {
+        QMutexLocker locker(&mMutex);
+        if(generation == mGeneration)
+        {
+            mDerivatives.insert(key, result);
+        }
+    }
+
+    //! @brief Looks up a recursive simplification, if not found rKey and rGeneration shall be passed to storeSimplification()
+    //! @param id Id of expr if known, it is only used if idGeneration is the current generation, otherwise expr is interned
+    //! @param [out] rChildIds Child ids in the key of expr, see NodeKey, they belong to rGeneration
+    bool lookupSimplification(const Expression &expr, const Expression::ExpressionSimplificationT type, const int id, const quint64 idGeneration,
+                              QVector<int> &rChildIds, quint64 &rKey, quint64 &rGeneration, Expression &rResult)
+    {
+        QMutexLocker locker(&mMutex);
+        limitTableSize();
+        const int exprId = (id >= 0 && idGeneration == mGeneration) ? id : internNode(expr, nullptr, false);
+        rChildIds = mChildIds[exprId];
+        rKey = (quint64(exprId) << 2) | quint64(type);
+        rGeneration = mGeneration;
+        return lookup(mSimplifications, rKey, rResult);
+    }
+
+    void storeSimplification(const quint64 key, const quint64 generation, const Expression &result)
+    {
+        QMutexLocker locker(&mMutex);
+        if(generation == mGeneration)
+        {
+            mSimplifications.insert(key, result);
+        }
+    }
+
+private:
+    //! @brief Maximum number of interned nodes before all tables are cleared
+    static const int mMaxNumNodes = 1000000;
+
+    //! @brief Clears all tables if they have grown too large, must only be called before interning the nodes of a lookup
+    void limitTableSize()
+    {
+        if(mNodeIds.size() >= mMaxNumNodes)
+        {
+            clearTables();
+        }
+    }
+
+    void clearTables()
+    {
+        mNodeIds.clear();
+        mChildIds.clear();
+        mDerivatives.clear();
+        mSimplifications.clear();
+        ++mGeneration;
+    }
+
+    bool lookup(const QHash<quint64, Expression> &table, const quint64 key, Expression &rResult)
+    {
+        QHash<quint64, Expression>::const_iterator it = table.constFind(key);
+        if(it == table.constEnd())
+        {
+            ++mNumMisses;
+            return false;
+        }
+        ++mNumHits;
+        rResult = it.value();
+        return true;
+    }
+
+    void appendChildIds(NodeKey &rKey, const QList<Expression> &children, KnownNodeIds *pKnownIds, const bool record)
+    {
+        rKey.childIds.append(children.size());
+        for(int i=0; i<children.size(); ++i)
+        {
+            rKey.childIds.append(internNode(children[i], pKnownIds, record));
+        }
+    }
+
+    void appendChildId(NodeKey &rKey, const Expression *pChild, KnownNodeIds *pKnownIds, const bool record)
+    {
+        rKey.childIds.append(pChild ? internNode(*pChild, pKnownIds, record) : -1);
+    }
+
+    //! @brief Returns the id of a node, children are interned first so that the key of a node only holds their ids
+    //! @param pKnownIds Ids of nodes interned earlier, or nullptr
+    //! @param record True to add the ids of this node and its children to pKnownIds
+    int internNode(const Expression &expr, KnownNodeIds *pKnownIds, const bool record)
+    {
+        if(pKnownIds)
+        {
+            QHash<const Expression*, int>::const_iterator known = pKnownIds->ids.constFind(&expr);
+            if(known != pKnownIds->ids.constEnd())
+            {
+                return known.value();
+            }
+        }
+
+        NodeKey key;
+        key.string = expr.mString;
+        key.function = expr.mFunction;
+        appendChildIds(key, expr.mArguments, pKnownIds, record);
+        appendChildIds(key, expr.mTerms, pKnownIds, record);
+        appendChildIds(key, expr.mFactors, pKnownIds, record);
+        appendChildIds(key, expr.mDivisors, pKnownIds, record);
+        appendChildId(key, expr.mpBase, pKnownIds, record);
+        appendChildId(key, expr.mpPower, pKnownIds, record);
+        appendChildId(key, expr.mpLeft, pKnownIds, record);
+        appendChildId(key, expr.mpRight, pKnownIds, record);
+        appendChildId(key, expr.mpDividend, pKnownIds, record);
+
+        int id;
+        QHash<NodeKey, int>::const_iterator it = mNodeIds.constFind(key);
+        if(it != mNodeIds.constEnd())
+        {
+            id = it.value();
+        }
+        else
+        {
+            id = mNodeIds.size();
+            mNodeIds.insert(key, id);
+            mChildIds.append(key.childIds);
+        }
+        if(record)
+        {
+            pKnownIds->ids.insert(&expr, id);
+        }
+        return id;
+    }
+
+    QMutex mMutex;
+    bool mEnabled;
+    quint64 mGeneration;
+    QHash<NodeKey, int> mNodeIds;
+    QVector<QVector<int> > mChildIds;
+    QHash<quint64, Expression> mDerivatives;
+    QHash<quint64, Expression> mSimplifications;
+    qint64 mNumHits;
+    qint64 mNumMisses;
+};
+
+ExpressionMemo &expressionMemo()
+{
+    static ExpressionMemo memo;
+    return memo;
+}
+
+//! @brief Known node ids of the outermost memoized derivative() call on this thread, or nullptr
+thread_local KnownNodeIds *tpDerivativeKnownIds = nullptr;
+
+//! @brief Lets the nested derivative() calls on a thread use the node ids of the expression in the outermost call
+//! @details The expression in the outermost call is const and outlives the nested calls, so its nodes keep their addresses and ids
+class DerivativeScope
+{
+public:
+    DerivativeScope() : mIsOutermost(tpDerivativeKnownIds == nullptr)
+    {
+        if(mIsOutermost)
+        {
+            tpDerivativeKnownIds = &mKnownIds;
+        }
+    }
+
+    ~DerivativeScope()
+    {
+        if(mIsOutermost)
+        {
+            tpDerivativeKnownIds = nullptr;
+        }
+    }
+
+    bool isOutermost() const
+    {
+        return mIsOutermost;
+    }
+
+    KnownNodeIds &knownIds()
+    {
+        return *tpDerivativeKnownIds;
+    }
+
+private:
+    bool mIsOutermost;
+    KnownNodeIds mKnownIds;
+};
+
+}
+
+
 //! @brief Returns the derivative of the expression
 //! @param x Expression to differentiate with
 //! @param ok True if successful, otherwise false
+//! @details Derivatives are memoized per interned (expression, x) pair, see setMemoizationEnabled()
 Expression Expression::derivative(const Expression x, bool &ok) const
+{
+    if(this->isSymbol() || !expressionMemo().isEnabled())
+    {
+        return derivativeUncached(x, ok);
+    }
+
+    DerivativeScope scope;
+    quint64 key, generation;
+    Expression ret;
+    if(expressionMemo().lookupDerivative(*this, x, scope.knownIds(), scope.isOutermost(), key, generation, ret))
+    {
+        ok = true;
+        return ret;
+    }
+
+    ret = derivativeUncached(x, ok);
+    if(ok)
+    {
+        expressionMemo().storeDerivative(key, generation, ret);
+    }
+    return ret;
+}
+
+
+//! @brief Computes the derivative of the expression without looking in the memoization tables
+//! @param x Expression to differentiate with
+//! @param ok True if successful, otherwise false
+Expression Expression::derivativeUncached(const Expression x, bool &ok) const
 {
     ok = true;
     Expression ret;
@@ -2886,6 +3255,7 @@ bool Expression::_verifyFunctions() const
 //! @param type Tells the degree of simplification to perform
 //! @param recursive Tells whether or not children are to be recursively simplified
 //! @note Recursion is not needed when creating new expressions, since the creator recurses all children anyway.
+//! @details Recursive simplifications are memoized per interned expression, see setMemoizationEnabled()
 //FIXED
 void Expression::_simplify(ExpressionSimplificationT type, const ExpressionRecursiveT recursive)
 {
@@ -2899,6 +3269,68 @@ void Expression::_simplify(ExpressionSimplificationT type, const ExpressionRecur
         return;
     }
 
+    if(recursive != Recursive || !expressionMemo().isEnabled())
+    {
+        simplifyUncached(type, recursive);
+        return;
+    }
+
+    simplifyMemoized(type, -1, 0);
+}
+
+
+//! @brief Recursively simplifies the expression, looking in the memoization tables first
+//! @param type Tells the degree of simplification to perform
+//! @param id Id of the expression from the key of its parent, or -1 if not known
+//! @param idGeneration Generation of the memoization tables that id belongs to
+//! @details Children are simplified in the same order as in simplifyUncached(), using the child ids in the key of this node
+//! so that each node is only interned once
+void Expression::simplifyMemoized(const ExpressionSimplificationT type, const int id, const quint64 idGeneration)
+{
+    quint64 key, generation;
+    QVector<int> childIds;
+    Expression result;
+    if(expressionMemo().lookupSimplification(*this, type, id, idGeneration, childIds, key, generation, result))
+    {
+        this->replaceBy(result);
+        return;
+    }
+
+    int idx = 0;
+    QList<Expression> *childLists[] = {&mArguments, &mTerms, &mFactors, &mDivisors};
+    for(QList<Expression> *pChildren : childLists)
+    {
+        const int nChildren = childIds[idx++];
+        for(int i=0; i<nChildren; ++i, ++idx)
+        {
+            Expression &child = (*pChildren)[i];
+            if(!child.isSymbol() && !child.isVariable())
+            {
+                child.simplifyMemoized(type, childIds[idx], generation);
+            }
+        }
+    }
+    Expression *childPointers[] = {mpBase, mpPower, mpLeft, mpRight};
+    for(Expression *pChild : childPointers)
+    {
+        if(pChild && !pChild->isSymbol() && !pChild->isVariable())
+        {
+            pChild->simplifyMemoized(type, childIds[idx], generation);
+        }
+        ++idx;
+    }
+
+    simplifyUncached(type, NonRecursive);
+    expressionMemo().storeSimplification(key, generation, *this);
+}
+
+
+//! @brief Simplifies the expression without looking in the memoization tables
+//! @param type Tells the degree of simplification to perform
+//! @param recursive Tells whether or not children are to be recursively simplified
+void Expression::simplifyUncached(ExpressionSimplificationT type, const ExpressionRecursiveT recursive)
+{
+
     if(recursive == Recursive)
     {
         for(int i=0; i<mArguments.size(); ++i)
@@ -3712,6 +4144,49 @@ double Expression::getNumericalFactor() const
 }
 
 
+//! @brief Returns the id of an expression in the memoization tables, structurally identical expressions get the same id
+//! @param expr Expression to intern
+//! @note Ids are only valid until the tables are cleared, either explicitly or when they grow too large
+int SymHop::internExpression(const Expression &expr)
+{
+    return expressionMemo().intern(expr);
+}
+
+
+//! @brief Enables or disables memoization of derivatives and recursive simplifications, tables are cleared in both cases
+//! @param enabled True to enable memoization, false to disable it (default)
+//! @note Enable memoization for a large task, such as generating a Jacobian, and disable it afterwards to release the tables
+void SymHop::setMemoizationEnabled(const bool enabled)
+{
+    expressionMemo().setEnabled(enabled);
+}
+
+
+//! @brief Tells whether or not derivatives and recursive simplifications are memoized
+bool SymHop::isMemoizationEnabled()
+{
+    return expressionMemo().isEnabled();
+}
+
+
+//! @brief Clears all interned expressions, memoized results and statistics
+//! @note Call this after a large generation task to release memory
+void SymHop::clearMemoization()
+{
+    expressionMemo().clear();
+}
+
+
+//! @brief Returns statistics for the memoization tables
+//! @param [out] rNumNodes Number of interned expression nodes
+//! @param [out] rNumHits Number of lookups that found a memoized result since last clear
+//! @param [out] rNumMisses Number of lookups that did not find a memoized result since last clear
+void SymHop::getMemoizationStatistics(int &rNumNodes, qint64 &rNumHits, qint64 &rNumMisses)
+{
+    expressionMemo().getStatistics(rNumNodes, rNumHits, rNumMisses);
+}
+
+
 //! @brief Returns derivative to specified function, or an empty string if function is not supported
 QString SymHop::getFunctionDerivative(const QString &key)
 {
@@ -3886,6 +4361,685 @@ void SymHop::removeDuplicates(QList<Expression> &rSet)
 }
 
 
+//! @brief Constructor for operation count, all counters are zero
+OperationCount::OperationCount()
+    : additions(0), multiplications(0), divisions(0), functionCalls(0)
+{
+}
+
+
+//! @brief Returns the total number of operations
+int OperationCount::total() const
+{
+    return additions+multiplications+divisions+functionCalls;
+}
+
+
+//! @brief Returns a human readable summary of the operation count
+QString OperationCount::toString() const
+{
+    return QString("%1 operations (%2 add/sub, %3 mul, %4 div, %5 function calls)").arg(total()).arg(additions).arg(multiplications).arg(divisions).arg(functionCalls);
+}
+
+
+//! @brief Adds the counters from another operation count
+//! @param other Operation count to add
+OperationCount &OperationCount::operator+=(const OperationCount &other)
+{
+    additions += other.additions;
+    multiplications += other.multiplications;
+    divisions += other.divisions;
+    functionCalls += other.functionCalls;
+    return *this;
+}
+
+
+//! @brief Counts the number of operations needed to evaluate an expression
+//! @param expr Expression to count operations in
+//! @param reducePowers Count powers the way they are written by Expression::toCodeString()
+OperationCount SymHop::countOperations(const Expression &expr, const bool reducePowers)
+{
+    OperationCount count;
+    if(expr.isFunction())
+    {
+        ++count.functionCalls;
+        for(const Expression &arg : expr.mArguments)
+        {
+            count += countOperations(arg, reducePowers);
+        }
+    }
+    else if(expr.isEquation())
+    {
+        count += countOperations(*expr.mpLeft, reducePowers);
+        count += countOperations(*expr.mpRight, reducePowers);
+    }
+    else if(expr.isAdd())
+    {
+        count.additions += expr.mTerms.size()-1;
+        for(const Expression &term : expr.mTerms)
+        {
+            count += countOperations(term, reducePowers);
+        }
+    }
+    else if(expr.isMultiplyOrDivide())
+    {
+        const int nFactors = expr.mFactors.size()-expr.mFactors.count(Expression("-1"));
+        const int nDivisors = expr.mDivisors.size()-expr.mDivisors.count(Expression("-1"));
+        count.multiplications += qMax(nFactors-1, 0) + qMax(nDivisors-1, 0);
+        count.divisions += (nDivisors > 0) ? 1 : 0;
+        for(const Expression &factor : expr.mFactors)
+        {
+            count += countOperations(factor, reducePowers);
+        }
+        for(const Expression &divisor : expr.mDivisors)
+        {
+            count += countOperations(divisor, reducePowers);
+        }
+    }
+    else if(expr.isPower())
+    {
+        const double power = expr.mpPower->isNumericalSymbol() ? expr.mpPower->toDouble() : 0;
+        if(reducePowers && expr.mpBase->isSymbol() && (power == 2 || power == 3 || power == 4))
+        {
+            count.multiplications += int(power)-1;
+        }
+        else
+        {
+            ++count.functionCalls;
+            count += countOperations(*expr.mpBase, reducePowers);
+            count += countOperations(*expr.mpPower, reducePowers);
+        }
+    }
+    return count;
+}
+
+
+// Help functions for common subexpression elimination
+namespace {
+
+//! @brief Tells whether or not an expression is worth storing in a temporary variable if it is used more than once
+bool isCseCandidate(const Expression &expr)
+{
+    if(expr.isFunction() || expr.isPower() || expr.isAdd())
+    {
+        return true;
+    }
+    else if(expr.isMultiplyOrDivide())
+    {
+        const int nOperands = expr.mFactors.size()+expr.mDivisors.size()-expr.mFactors.count(Expression("-1"))-expr.mDivisors.count(Expression("-1"));
+        return (nOperands > 1);
+    }
+    return false;
+}
+
+//! @brief Tells whether or not a power will be written as a product by Expression::toCodeString() if its base is a symbol
+bool isReduciblePower(const Expression &expr)
+{
+    if(!expr.isPower() || !expr.mpPower->isNumericalSymbol())
+    {
+        return false;
+    }
+    const double power = expr.mpPower->toDouble();
+    return (power == 2 || power == 3 || power == 4);
+}
+
+//! @brief Calls a function for all direct sub-expressions of an expression
+template<typename ExprT, typename FuncT>
+void forEachChild(ExprT &rExpr, FuncT func)
+{
+    for(auto &arg : rExpr.mArguments) { func(arg); }
+    for(auto &term : rExpr.mTerms) { func(term); }
+    for(auto &factor : rExpr.mFactors) { func(factor); }
+    for(auto &divisor : rExpr.mDivisors) { func(divisor); }
+    if(rExpr.mpBase) { func(*rExpr.mpBase); }
+    if(rExpr.mpPower) { func(*rExpr.mpPower); }
+    if(rExpr.mpLeft) { func(*rExpr.mpLeft); }
+    if(rExpr.mpRight) { func(*rExpr.mpRight); }
+}
+
+//! @brief Counts how many times each candidate sub-expression occurs
+void countSubexpressions(const Expression &expr, QMap<QString, int> &rCounts)
+{
+    if(isCseCandidate(expr))
+    {
+        rCounts[expr.toString()] += 1;
+    }
+    forEachChild(expr, [&rCounts](const Expression &child) { countSubexpressions(child, rCounts); });
+}
+
+//! @brief Counts how many times a symbol is used in an expression
+int countSymbol(const Expression &expr, const QString &symbol)
+{
+    if(expr.isSymbol())
+    {
+        return (expr.mString == symbol) ? 1 : 0;
+    }
+    int count=0;
+    forEachChild(expr, [&count, &symbol](const Expression &child) { count += countSymbol(child, symbol); });
+    return count;
+}
+
+//! @brief Replaces sub-expressions that occur more than once by temporary variables
+class CommonSubexpressionEliminator
+{
+public:
+    CommonSubexpressionEliminator(const QMap<QString, int> &counts, const QString &prefix, const bool reducePowers)
+        : mCounts(counts), mPrefix(prefix), mReducePowers(reducePowers) {}
+
+    Expression rewrite(const Expression &expr)
+    {
+        Expression ret = expr;
+        forEachChild(ret, [this](Expression &child) { child = rewrite(child); });
+
+        // Powers of non-symbols must use a temporary base to be written as products
+        if(mReducePowers && isReduciblePower(ret))
+        {
+            if(!ret.mpBase->isSymbol())
+            {
+                *ret.mpBase = hoist(expr.mpBase->toString(), *ret.mpBase, true);
+            }
+            else if(mIndexBySymbol.contains(ret.mpBase->mString))
+            {
+                mForced[mIndexBySymbol.value(ret.mpBase->mString)] = true;
+            }
+        }
+
+        if(isCseCandidate(expr) && mCounts.value(expr.toString()) > 1)
+        {
+            return hoist(expr.toString(), ret, false);
+        }
+        return ret;
+    }
+
+    QList<Expression> mTemporaries;     //Assignments to temporary variables, in evaluation order
+    QList<bool> mForced;                //Tells if a temporary is required for power reduction
+
+private:
+    Expression hoist(const QString &key, const Expression &expr, const bool forced)
+    {
+        int idx = mIndexByKey.value(key, -1);
+        if(idx < 0)
+        {
+            idx = mTemporaries.size();
+            const QString symbol = mPrefix+QString::number(idx);
+            mTemporaries.append(Expression::fromEquation(Expression(symbol), expr));
+            mForced.append(false);
+            mIndexByKey.insert(key, idx);
+            mIndexBySymbol.insert(symbol, idx);
+        }
+        mForced[idx] = mForced[idx] || forced;
+        return *mTemporaries[idx].mpLeft;
+    }
+
+    const QMap<QString, int> &mCounts;
+    QString mPrefix;
+    bool mReducePowers;
+    QMap<QString, int> mIndexByKey;
+    QMap<QString, int> mIndexBySymbol;
+};
+
+}
+
+
+//! @brief Replaces sub-expressions used more than once in a set of expressions by temporary variables
+//! @details Temporaries are returned as assignment equations in evaluation order (later temporaries may use earlier ones).
+//! Temporaries that end up being used only once are substituted back. The expressions are not simplified.
+//! @param rExpressions Expressions to optimize, will be rewritten to use the temporaries
+//! @param rTemporaries Reference to list where the temporary assignments are appended
+//! @param tempPrefix Name prefix for temporary variables, must not collide with any existing symbol
+//! @param reducePowers Also store non-symbol bases of small integer powers in temporaries, so that they can be written as products
+void SymHop::eliminateCommonSubexpressions(QList<Expression> &rExpressions, QList<Expression> &rTemporaries, const QString &tempPrefix, const bool reducePowers)
+{
+    QMap<QString, int> counts;
+    for(const Expression &expr : rExpressions)
+    {
+        countSubexpressions(expr, counts);
+    }
+
+    CommonSubexpressionEliminator cse(counts, tempPrefix+"Tmp", reducePowers);
+    for(int e=0; e<rExpressions.size(); ++e)
+    {
+        rExpressions[e] = cse.rewrite(rExpressions[e]);
+    }
+
+    // Substitute back temporaries that are only used once (nested candidates inside other temporaries)
+    QList<Expression> temps = cse.mTemporaries;
+    QList<bool> keep;
+    for(int t=0; t<temps.size(); ++t)
+    {
+        keep.append(true);
+    }
+    for(int t=temps.size()-1; t>=0; --t)
+    {
+        if(cse.mForced[t])
+        {
+            continue;
+        }
+        const QString name = temps[t].mpLeft->toString();
+        int uses = 0;
+        Expression *pUser = nullptr;
+        for(int u=t+1; u<temps.size(); ++u)
+        {
+            const int n = keep[u] ? countSymbol(*temps[u].mpRight, name) : 0;
+            uses += n;
+            pUser = (n > 0) ? temps[u].mpRight : pUser;
+        }
+        for(Expression &expr : rExpressions)
+        {
+            const int n = countSymbol(expr, name);
+            uses += n;
+            pUser = (n > 0) ? &expr : pUser;
+        }
+        if(uses == 1)
+        {
+            pUser->replace(*temps[t].mpLeft, *temps[t].mpRight);
+            keep[t] = false;
+        }
+    }
+
+    // Rename the remaining temporaries to consecutive numbers
+    int nextIdx = 0;
+    for(int t=0; t<temps.size(); ++t)
+    {
+        if(!keep[t])
+        {
+            continue;
+        }
+        Expression newSymbol = Expression(tempPrefix+QString::number(nextIdx++));
+        for(int u=t+1; u<temps.size(); ++u)
+        {
+            temps[u].mpRight->replace(*temps[t].mpLeft, newSymbol);
+        }
+        for(Expression &expr : rExpressions)
+        {
+            expr.replace(*temps[t].mpLeft, newSymbol);
+        }
+        rTemporaries.append(Expression::fromEquation(newSymbol, *temps[t].mpRight));
+    }
+}
+
+
+// Help functions and tables for evaluation tapes
+namespace {
+
+//! @brief Number of values evaluated at a time by evaluation tapes, each stack slot holds this many values
+const size_t gTapeBlockSize = 256;
+
+//! @brief Built-in functions with one argument supported by evaluation tapes, index is used as instruction argument
+const char *gTapeFunctions1[] = {"sin", "cos", "tan", "asin", "acos", "atan", "sinh", "cosh", "tanh", "log", "exp",
+                                 "sqrt", "abs", "integer", "floor", "ceil", "round", "sign"};
+
+//! @brief Built-in functions with two arguments supported by evaluation tapes, index is used as instruction argument
+const char *gTapeFunctions2[] = {"min", "max", "rem", "mod", "div", "atan2", "pow", "equal", "eq", "notEqual",
+                                 "logicalOr", "logicalAnd", "greaterThan", "greaterThanOrEqual", "smallerThan", "smallerThanOrEqual"};
+
+//! @brief Returns the index of a function name in a table, or -1 if not found
+template<size_t N>
+int findTapeFunction(const char *(&table)[N], const QString &name)
+{
+    for(size_t i=0; i<N; ++i)
+    {
+        if(name == table[i])
+        {
+            return int(i);
+        }
+    }
+    return -1;
+}
+
+template<typename FuncT>
+inline void applyUnary(double *pX, const size_t length, FuncT func)
+{
+    for(size_t i=0; i<length; ++i)
+    {
+        pX[i] = func(pX[i]);
+    }
+}
+
+template<typename FuncT>
+inline void applyBinary(double *pX, const double *pY, const size_t length, FuncT func)
+{
+    for(size_t i=0; i<length; ++i)
+    {
+        pX[i] = func(pX[i], pY[i]);
+    }
+}
+
+}
+
+
+//! @class SymHop::EvaluationTape
+//! @brief Flat instruction tape for fast repeated evaluation of an expression
+//!
+//! The expression tree is compiled to a stack machine program. Each stack slot holds a block of values,
+//! so that every instruction is applied to a whole block of data points in a tight loop.
+//! Evaluation gives the same results as Expression::evaluate() with the same variable values.
+//!
+
+
+//! @brief Constructor for an empty evaluation tape
+EvaluationTape::EvaluationTape()
+    : mMaxDepth(0), mCompiled(false)
+{
+}
+
+
+//! @brief Compiles an expression to an evaluation tape
+//! @param expr Expression to compile
+//! @param variableNames Names of the variables, the index in this list is the slot used when evaluating
+//! @param constants Names of variables with fixed values, the values are stored in the tape exactly as given
+//! @returns True if successful, false if the expression contains unknown variables or unsupported functions
+bool EvaluationTape::compile(const Expression &expr, const QStringList &variableNames, const QMap<QString, double> &constants)
+{
+    mInstructions.clear();
+    mVariableNames = variableNames;
+    mConstants = constants;
+    mMaxDepth = 0;
+    mCompiled = compileNode(expr, 0);
+    mConstants.clear();
+    if(!mCompiled)
+    {
+        mInstructions.clear();
+    }
+    return mCompiled;
+}
+
+
+//! @brief Tells whether or not the tape contains a successfully compiled expression
+bool EvaluationTape::isCompiled() const
+{
+    return mCompiled;
+}
+
+
+//! @brief Returns the variable names, in slot order
+QStringList EvaluationTape::getVariableNames() const
+{
+    return mVariableNames;
+}
+
+
+//! @brief Returns the number of instructions in the tape
+int EvaluationTape::getNumInstructions() const
+{
+    return mInstructions.size();
+}
+
+
+//! @brief Evaluates the tape for a single set of variable values
+//! @param pVariables Array with one value per variable slot
+//! @returns Value of the expression
+double EvaluationTape::evaluate(const double *pVariables) const
+{
+    QVector<const double*> columns(mVariableNames.size());
+    for(int v=0; v<mVariableNames.size(); ++v)
+    {
+        columns[v] = pVariables+v;
+    }
+    double result = 0;
+    evaluate(columns.constData(), &result, 1);
+    return result;
+}
+
+
+//! @brief Evaluates the tape for many data points
+//! @param pColumns Array with one data array (of length n) per variable slot
+//! @param pResult Array of length n where the results are written
+//! @param n Number of data points
+void EvaluationTape::evaluate(const double * const *pColumns, double *pResult, const size_t n) const
+{
+    if(!mCompiled)
+    {
+        for(size_t i=0; i<n; ++i)
+        {
+            pResult[i] = 0;
+        }
+        return;
+    }
+
+    QVector<double> stack(int(qMax(mMaxDepth, 1)*qMin(n, gTapeBlockSize)));
+    for(size_t offset=0; offset<n; offset+=gTapeBlockSize)
+    {
+        evaluateBlock(pColumns, offset, qMin(gTapeBlockSize, n-offset), stack.data(), pResult+offset);
+    }
+}
+
+
+//! @brief Compiles an expression node (recursively)
+//! @param expr Expression node to compile
+//! @param depth Current stack depth, before the value of this node is pushed
+//! @returns True if successful
+bool EvaluationTape::compileNode(const Expression &expr, int depth)
+{
+    if(expr.isAdd())
+    {
+        for(int t=0; t<expr.mTerms.size(); ++t)
+        {
+            if(!compileNode(expr.mTerms[t], depth+qMin(t,1))) { return false; }
+            if(t > 0) { append(Add, 0, 0, depth); }
+        }
+        return true;
+    }
+    else if(expr.isMultiplyOrDivide())
+    {
+        for(int f=0; f<expr.mFactors.size(); ++f)
+        {
+            if(!compileNode(expr.mFactors[f], depth+qMin(f,1))) { return false; }
+            if(f > 0) { append(Multiply, 0, 0, depth); }
+        }
+        for(const Expression &divisor : expr.mDivisors)
+        {
+            if(!compileNode(divisor, depth+1)) { return false; }
+            append(Divide, 0, 0, depth);
+        }
+        return true;
+    }
+    else if(expr.isPower())
+    {
+        if(!compileNode(*expr.mpBase, depth) || !compileNode(*expr.mpPower, depth+1)) { return false; }
+        append(Power, 0, 0, depth);
+        return true;
+    }
+    else if(expr.isEquation())
+    {
+        if(!compileNode(*expr.mpLeft, depth) || !compileNode(*expr.mpRight, depth+1)) { return false; }
+        append(Equal, 0, 0, depth);
+        return true;
+    }
+    else if(expr.isFunction())
+    {
+        const QList<Expression> &args = expr.mArguments;
+        int funcIdx = -1;
+        if(expr.mFunction == "der")
+        {
+            append(PushConstant, 0, 0, depth);
+            return true;
+        }
+        else if(args.isEmpty() && expr.mFunction == "pi")
+        {
+            append(PushConstant, 0, M_PI, depth);
+            return true;
+        }
+        else if(args.size() == 1 && (funcIdx = findTapeFunction(gTapeFunctions1, expr.mFunction)) >= 0)
+        {
+            if(!compileNode(args[0], depth)) { return false; }
+            append(Function1, funcIdx, 0, depth);
+            return true;
+        }
+        else if(args.size() == 2 && (funcIdx = findTapeFunction(gTapeFunctions2, expr.mFunction)) >= 0)
+        {
+            if(!compileNode(args[0], depth) || !compileNode(args[1], depth+1)) { return false; }
+            append(Function2, funcIdx, 0, depth);
+            return true;
+        }
+        else if(args.size() == 3 && expr.mFunction == "limit")
+        {
+            if(!compileNode(args[0], depth) || !compileNode(args[1], depth+1) || !compileNode(args[2], depth+2)) { return false; }
+            append(Limit, 0, 0, depth);
+            return true;
+        }
+        else if(!args.isEmpty() && mVariableNames.contains(expr.toString()))
+        {
+            // Same as Expression::evaluate(), unknown functions may be given as variables
+            append(PushVariable, mVariableNames.indexOf(expr.toString()), 0, depth);
+            return true;
+        }
+        else if(!args.isEmpty() && mConstants.contains(expr.toString()))
+        {
+            append(PushConstant, 0, mConstants.value(expr.toString()), depth);
+            return true;
+        }
+        return false;
+    }
+    else if(expr.isNumericalSymbol())
+    {
+        append(PushConstant, 0, expr.toDouble(), depth);
+        return true;
+    }
+    else if(expr.isVariable() && mVariableNames.contains(expr.mString))
+    {
+        append(PushVariable, mVariableNames.indexOf(expr.mString), 0, depth);
+        return true;
+    }
+    else if(expr.isVariable() && mConstants.contains(expr.mString))
+    {
+        append(PushConstant, 0, mConstants.value(expr.mString), depth);
+        return true;
+    }
+    return false;
+}
+
+
+//! @brief Appends an instruction to the tape
+//! @param op Operation code
+//! @param arg Integer argument (variable slot or function index)
+//! @param value Constant value
+//! @param depth Stack depth where the result of the instruction is stored
+void EvaluationTape::append(const OpCodeT op, const int arg, const double value, const int depth)
+{
+    Instruction instruction;
+    instruction.op = op;
+    instruction.arg = arg;
+    instruction.value = value;
+    mInstructions.append(instruction);
+    mMaxDepth = qMax(mMaxDepth, depth+1);
+}
+
+
+//! @brief Evaluates the tape for one block of data points
+//! @param pColumns Array with one data array per variable slot
+//! @param offset Index of the first data point in the block
+//! @param length Number of data points in the block
+//! @param pStack Stack memory, must hold mMaxDepth*length values
+//! @param pResult Where to write the results for the block
+void EvaluationTape::evaluateBlock(const double * const *pColumns, const size_t offset, const size_t length, double *pStack, double *pResult) const
+{
+    double *pTop = pStack - length;
+    for(const Instruction &instruction : mInstructions)
+    {
+        switch(instruction.op)
+        {
+        case PushConstant:
+            pTop += length;
+            for(size_t i=0; i<length; ++i) { pTop[i] = instruction.value; }
+            break;
+        case PushVariable:
+        {
+            pTop += length;
+            const double *pVar = pColumns[instruction.arg]+offset;
+            for(size_t i=0; i<length; ++i) { pTop[i] = pVar[i]; }
+            break;
+        }
+        case Add:
+            pTop -= length;
+            applyBinary(pTop, pTop+length, length, [](double x, double y) { return x+y; });
+            break;
+        case Multiply:
+            pTop -= length;
+            applyBinary(pTop, pTop+length, length, [](double x, double y) { return x*y; });
+            break;
+        case Divide:
+            pTop -= length;
+            applyBinary(pTop, pTop+length, length, [](double x, double y) { return x/y; });
+            break;
+        case Power:
+            pTop -= length;
+            applyBinary(pTop, pTop+length, length, [](double x, double y) { return pow(x, y); });
+            break;
+        case Equal:
+            pTop -= length;
+            applyBinary(pTop, pTop+length, length, [](double x, double y) { return (x == y) ? 1.0 : 0.0; });
+            break;
+        case Function1:
+            switch(instruction.arg)
+            {
+            case 0: applyUnary(pTop, length, [](double x) { return sin(x); }); break;
+            case 1: applyUnary(pTop, length, [](double x) { return cos(x); }); break;
+            case 2: applyUnary(pTop, length, [](double x) { return tan(x); }); break;
+            case 3: applyUnary(pTop, length, [](double x) { return asin(x); }); break;
+            case 4: applyUnary(pTop, length, [](double x) { return acos(x); }); break;
+            case 5: applyUnary(pTop, length, [](double x) { return atan(x); }); break;
+            case 6: applyUnary(pTop, length, [](double x) { return sinh(x); }); break;
+            case 7: applyUnary(pTop, length, [](double x) { return cosh(x); }); break;
+            case 8: applyUnary(pTop, length, [](double x) { return tanh(x); }); break;
+            case 9: applyUnary(pTop, length, [](double x) { return log(x); }); break;
+            case 10: applyUnary(pTop, length, [](double x) { return exp(x); }); break;
+            case 11: applyUnary(pTop, length, [](double x) { return sqrt(x); }); break;
+            case 12: applyUnary(pTop, length, [](double x) { return fabs(x); }); break;
+            case 13: applyUnary(pTop, length, [](double x) { return double(int(x)); }); break;
+            case 14: applyUnary(pTop, length, [](double x) { return floor(x); }); break;
+            case 15: applyUnary(pTop, length, [](double x) { return ceil(x); }); break;
+            case 16: applyUnary(pTop, length, [](double x) { return round(x); }); break;
+            case 17: applyUnary(pTop, length, [](double x) { return (x >= 0.0) ? 1.0 : -1.0; }); break;
+            }
+            break;
+        case Function2:
+        {
+            pTop -= length;
+            const double *pY = pTop+length;
+            switch(instruction.arg)
+            {
+            case 0: applyBinary(pTop, pY, length, [](double x, double y) { return fmin(x, y); }); break;
+            case 1: applyBinary(pTop, pY, length, [](double x, double y) { return fmax(x, y); }); break;
+            case 2:
+            case 3: applyBinary(pTop, pY, length, [](double x, double y) { return fmod(x, y); }); break;
+            case 4: applyBinary(pTop, pY, length, [](double x, double y) { return x/y; }); break;
+            case 5: applyBinary(pTop, pY, length, [](double x, double y) { return atan2(x, y); }); break;
+            case 6: applyBinary(pTop, pY, length, [](double x, double y) { return pow(x, y); }); break;
+            case 7:
+            case 8: applyBinary(pTop, pY, length, [](double x, double y) { return (x == y) ? 1.0 : 0.0; }); break;
+            case 9: applyBinary(pTop, pY, length, [](double x, double y) { return (x == y) ? 0.0 : 1.0; }); break;
+            case 10: applyBinary(pTop, pY, length, [](double x, double y) { return (x != 0.0 || y != 0.0) ? 1.0 : 0.0; }); break;
+            case 11: applyBinary(pTop, pY, length, [](double x, double y) { return (x != 0.0 && y != 0.0) ? 1.0 : 0.0; }); break;
+            case 12: applyBinary(pTop, pY, length, [](double x, double y) { return (x > y) ? 1.0 : 0.0; }); break;
+            case 13: applyBinary(pTop, pY, length, [](double x, double y) { return (x >= y) ? 1.0 : 0.0; }); break;
+            case 14: applyBinary(pTop, pY, length, [](double x, double y) { return (x < y) ? 1.0 : 0.0; }); break;
+            case 15: applyBinary(pTop, pY, length, [](double x, double y) { return (x <= y) ? 1.0 : 0.0; }); break;
+            }
+            break;
+        }
+        case Limit:
+        {
+            pTop -= 2*length;
+            const double *pMin = pTop+length;
+            const double *pMax = pTop+2*length;
+            for(size_t i=0; i<length; ++i)
+            {
+                const double val = pTop[i];
+                pTop[i] = (val > pMax[i]) ? pMax[i] : ((val < pMin[i]) ? pMin[i] : val);
+            }
+            break;
+        }
+        }
+    }
+
+    for(size_t i=0; i<length; ++i)
+    {
+        pResult[i] = pStack[i];
+    }
+}
+
+
 bool SymHop::isWhole(const double value)
 {
     return (static_cast<int>(value) == value);
@@ -24,6 +24,7 @@
 
 #include <QString>
 #include <QtTest>
+#include <algorithm>
 
 #include "ComponentUtilities.h"
 
@@ -615,6 +616,313 @@ private Q_SLOTS:
         QTest::newRow("plo2 4") << ploData2 << "notExist" << "y" << true << -1 << 2 << 40.0;
 
     }
+
+    void csvParserMapped()
+    {
+        QFETCH( QString, csvData);
+        QFETCH( QChar, separator);
+        QFETCH( int, linesToSkip);
+        QFETCH( bool, expectParseOK);
+        QFETCH( int, expectedNumRows);
+        QFETCH( int, expectedNumCols);
+        QFETCH( bool, expectLastColumnOK);
+        QFETCH( double, expectedLastValue);
+
+        CSVParserNG parser(separator.toLatin1(), size_t(linesToSkip));
+        parser.setCommentChar('#');
+        QVERIFY(parser.mapText(qPrintable(csvData)));
+        CSVColumnData data;
+        bool parsedOK = parser.parseMappedData(data, 2);
+        QCOMPARE(parsedOK, expectParseOK);
+        if (parsedOK) {
+            QCOMPARE(int(data.getNumRows()), expectedNumRows);
+            QCOMPARE(int(data.getNumCols()), expectedNumCols);
+            std::vector<double> values;
+            QCOMPARE(data.isColumnOK(data.getNumCols()-1), expectLastColumnOK);
+            QCOMPARE(data.takeColumn(data.getNumCols()-1, values), expectLastColumnOK);
+            if (expectLastColumnOK) {
+                QCOMPARE(values.back(), expectedLastValue);
+                QVERIFY(data.getColumn(data.getNumCols()-1).empty());
+            }
+        }
+    }
+
+    void csvParserMapped_data()
+    {
+        QTest::addColumn< QString >("csvData");
+        QTest::addColumn< QChar >("separator");
+        QTest::addColumn< int >("linesToSkip");
+        QTest::addColumn< bool >("expectParseOK");
+        QTest::addColumn< int >("expectedNumRows");
+        QTest::addColumn< int >("expectedNumCols");
+        QTest::addColumn< bool >("expectLastColumnOK");
+        QTest::addColumn< double >("expectedLastValue");
+
+        QTest::newRow("csv 0") << "0,10\n1,20\n2,30" << QChar(',') << 0 << true << 3 << 2 << true << 30.0;
+        QTest::newRow("csv 1") << "time,x,y\n#comment\n0,1,2\n\n1,3,-4.5e2\n" << QChar(',') << 1 << true << 2 << 3 << true << -450.0;
+        QTest::newRow("csv 2") << "0;1,5\n1;2,25\n" << QChar(';') << 0 << true << 2 << 2 << true << 2.25;
+        QTest::newRow("csv 3") << "0,10\n1\n2,30" << QChar(',') << 0 << true << 3 << 2 << false << 0.0;
+        QTest::newRow("csv 4") << "0,10\n1,abc\n" << QChar(',') << 0 << true << 2 << 2 << false << 0.0;
+        QTest::newRow("csv 5") << "header\n" << QChar(',') << 1 << false << 0 << 0 << false << 0.0;
+        QTest::newRow("csv 6") << "0,10,\n#comment\n1,20,\n" << QChar(',') << 0 << true << 2 << 2 << true << 20.0;
+        QTest::newRow("csv 7") << "0,10\n1,20,300\n" << QChar(',') << 0 << true << 2 << 3 << false << 0.0;
+    }
+
+    void csvParserMappedMixedColumns()
+    {
+        // Unused columns may be non-numeric and rows ragged, as long as the selected columns are numeric
+        const char *csvData = "time,name,x,y\n"
+                              "0,a,1,\n"
+                              "# comment in the middle\n"
+                              "1,b,2,3,\n"
+                              "2,c,4\n";
+        CSVParserNG parser(',', 1);
+        parser.setCommentChar('#');
+        QVERIFY(parser.mapText(csvData));
+        CSVColumnData data;
+        QVERIFY2(parser.parseMappedData(data), parser.getErrorString().c_str());
+        QCOMPARE(int(data.getNumRows()), 3);
+        QCOMPARE(int(data.getNumCols()), 4);
+        QVERIFY(!data.isColumnOK(1));
+        QVERIFY(!data.isColumnOK(3));
+
+        std::vector<double> time, x, y;
+        QVERIFY(data.takeColumn(0, time));
+        QVERIFY(data.takeColumn(2, x));
+        QVERIFY(!data.takeColumn(3, y));
+        QCOMPARE(time, std::vector<double>({0, 1, 2}));
+        QCOMPARE(x, std::vector<double>({1, 2, 4}));
+    }
+
+    void fixedMatrixLU()
+    {
+        QFETCH( int, seed);
+
+        // Compare the fixed-size LU solver with the heap allocated Matrix/Vec solver
+        const int n = 5;
+        Matrix A(n,n);
+        Vec b(n), x(n);
+        FixedMatrix<n> fA;
+        FixedVec<n> fb, fx;
+        for (int r=0; r<n; ++r)
+        {
+            for (int c=0; c<n; ++c)
+            {
+                const double v = ((r*7+c*3+seed)%11) - 5.0 + ((r==c) ? 3.0*seed : 0.0);
+                A[r][c] = v;
+                fA[r][c] = v;
+            }
+            b[r] = r - 2.0*seed;
+            fb[r] = b[r];
+        }
+
+        int order[n], fOrder[n];
+        bool ok = ludcmp(A, order);
+        bool fOk = ludcmp(fA, fOrder);
+        QCOMPARE(fOk, ok);
+        if (ok)
+        {
+            solvlu(A, b, x, order);
+            solvlu(fA, fb, fx, fOrder);
+            for (int i=0; i<n; ++i)
+            {
+                QCOMPARE(fOrder[i], order[i]);
+                QCOMPARE(fx[i], x[i]);
+            }
+        }
+    }
+
+    void fixedMatrixLU_data()
+    {
+        QTest::addColumn< int >("seed");
+        QTest::newRow("0") << 0;
+        QTest::newRow("1") << 1;
+        QTest::newRow("2") << 2;
+        QTest::newRow("5") << 5;
+    }
+
+    void equationSystemSolverReuse()
+    {
+        QFETCH( bool, reuseJacobian);
+
+        // Solve x0^2 + x1 - 3 = 0, x0 - x1^3 + 1 = 0, solution is (1.296.., 1.319..)
+        FixedMatrix<2> jacobian;
+        FixedVec<2> equations, variables;
+        variables[0] = 1;
+        variables[1] = 1;
+        EquationSystemSolver solver(0, 2);
+        solver.setJacobianReuse(reuseJacobian);
+        solver.setResidualTolerance(1e-12);
+        bool converged = false;
+        for (int i=0; i<50 && !converged; ++i)
+        {
+            equations[0] = variables[0]*variables[0] + variables[1] - 3;
+            equations[1] = variables[0] - variables[1]*variables[1]*variables[1] + 1;
+            jacobian[0][0] = 2*variables[0];
+            jacobian[0][1] = 1;
+            jacobian[1][0] = 1;
+            jacobian[1][1] = -3*variables[1]*variables[1];
+            converged = solver.solve(jacobian, equations, variables);
+        }
+
+        QVERIFY(converged);
+        QVERIFY(fuzzyEqual(variables[0]*variables[0] + variables[1], 3.0));
+        QVERIFY(fuzzyEqual(variables[1]*variables[1]*variables[1] - variables[0], 1.0));
+        QCOMPARE(solver.getNumEarlyExits(), size_t(1));
+        if (reuseJacobian)
+        {
+            QVERIFY(solver.getNumFactorizations() < solver.getNumIterations()-1);
+        }
+        else
+        {
+            QCOMPARE(solver.getNumFactorizations(), solver.getNumIterations()-1);
+        }
+    }
+
+    void equationSystemSolverReuse_data()
+    {
+        QTest::addColumn< bool >("reuseJacobian");
+        QTest::newRow("full Newton") << false;
+        QTest::newRow("modified Newton") << true;
+    }
+
+    void realFFT()
+    {
+        QFETCH( int, n);
+
+        // Compare with a direct evaluation of the discrete Fourier transform
+        std::vector<double> x(n);
+        for (int i=0; i<n; ++i)
+        {
+            x[i] = sin(0.37*i*i) + 0.5*cos(1.3*i);
+        }
+        std::shared_ptr<const RealFFTPlan> pPlan = RealFFTPlan::get(size_t(n));
+        QCOMPARE(pPlan->getNumBins(), size_t(n/2+1));
+        QVERIFY(RealFFTPlan::get(size_t(n)) == pPlan);
+        std::vector< std::complex<double> > bins(pPlan->getNumBins());
+        pPlan->forward(x.data(), bins.data());
+        for (int k=0; k<int(bins.size()); ++k)
+        {
+            std::complex<double> expected = 0;
+            for (int i=0; i<n; ++i)
+            {
+                expected += x[i]*std::polar(1.0, -2.0*M_PI*double((k*i)%n)/double(n));
+            }
+            QVERIFY(std::abs(bins[k]-expected) < 1e-9*n);
+        }
+    }
+
+    void realFFT_data()
+    {
+        QTest::addColumn< int >("n");
+        QTest::newRow("1") << 1;
+        QTest::newRow("2") << 2;
+        QTest::newRow("15") << 15;
+        QTest::newRow("64") << 64;
+        QTest::newRow("98") << 98;
+        QTest::newRow("360") << 360;
+        QTest::newRow("1000") << 1000;
+        QTest::newRow("prime 211") << 211;
+    }
+
+    void welchPSD()
+    {
+        QFETCH( int, window);
+        QFETCH( int, numThreads);
+
+        // A sine with amplitude 2 at 50 Hz, the area under the density should equal its power (A^2/2)
+        const double fs = 1000;
+        std::vector<double> x(100000);
+        for (size_t i=0; i<x.size(); ++i)
+        {
+            x[i] = 1.0 + 2.0*sin(2.0*M_PI*50.0*double(i)/fs);
+        }
+        std::vector<double> freq, psd;
+        QVERIFY(welchPowerSpectralDensity(x, fs, 1000, 0.5, SpectralWindowT(window), freq, psd, size_t(numThreads)));
+        QCOMPARE(psd.size(), size_t(501));
+        QCOMPARE(freq.back(), fs/2.0);
+        double power = 0;
+        size_t peakIdx = 0;
+        for (size_t k=0; k<psd.size(); ++k)
+        {
+            power += psd[k]*fs/1000.0;
+            peakIdx = (psd[k] > psd[peakIdx]) ? k : peakIdx;
+        }
+        QCOMPARE(freq[peakIdx], 50.0);
+        QVERIFY(fabs(power-2.0) < 1e-3);
+    }
+
+    void welchPSD_data()
+    {
+        QTest::addColumn< int >("window");
+        QTest::addColumn< int >("numThreads");
+        QTest::newRow("rectangular") << int(RectangularSpectralWindow) << 1;
+        QTest::newRow("hann") << int(HannSpectralWindow) << 1;
+        QTest::newRow("flattop") << int(FlatTopSpectralWindow) << 1;
+        QTest::newRow("hann threaded") << int(HannSpectralWindow) << 4;
+    }
+
+    void signalStatistics()
+    {
+        // A ramp y=t for t in [0,10], statistics over [2,4]
+        std::vector<double> time(1001), data(1001);
+        for (size_t i=0; i<time.size(); ++i)
+        {
+            time[i] = data[i] = 0.01*double(i);
+        }
+        SignalStatistics statistics;
+        QVERIFY(computeSignalStatistics(time.data(), data.data(), time.size(), 2.0, 4.0, statistics));
+        QCOMPARE(statistics.firstIndex, size_t(200));
+        QCOMPARE(statistics.numSamples, size_t(201));
+        QCOMPARE(statistics.mean, 3.0);
+        QCOMPARE(statistics.min, 2.0);
+        QCOMPARE(statistics.maxIndex, size_t(400));
+        QCOMPARE(statistics.integral, 6.0);
+        QVERIFY(fabs(statistics.rms-sqrt(9.0+(201.0*201.0-1.0)/12.0*1e-4)) < 1e-9);
+        QVERIFY(!computeSignalStatistics(time.data(), data.data(), time.size(), 11.0, 12.0, statistics));
+    }
+
+    void steadyState()
+    {
+        QFETCH( int, method);
+        QFETCH( double, tolerance);
+
+        // A first order step response with a little noise, steady-state is reached after about 7 time constants
+        std::vector<double> time(20000), data(20000);
+        unsigned int seed = 1;
+        for (size_t i=0; i<time.size(); ++i)
+        {
+            seed = seed*1103515245u+12345u;
+            time[i] = 1e-3*double(i);
+            data[i] = 1.0-exp(-time[i]) + 1e-4*(double((seed>>8) & 0xffff)/65536.0-0.5);
+        }
+        std::vector<double> steadyState;
+        QVERIFY(identifySteadyState(SteadyStateMethodT(method), time.data(), data.data(), time.size(), tolerance, 1.0, 1e-3, 0.1, 0.1, 0.1, steadyState));
+        QCOMPARE(steadyState.size(), time.size());
+        QCOMPARE(steadyState.front(), 0.0);
+        QCOMPARE(steadyState.back(), 1.0);
+
+        // The rectangular window test must agree with a direct evaluation of max-min over the previous window
+        if (method == RectangularWindowSteadyState)
+        {
+            const size_t nw = 1000;
+            for (size_t i=nw; i<time.size(); i+=97)
+            {
+                const double range = *std::max_element(&data[i-nw], &data[i]) - *std::min_element(&data[i-nw], &data[i]);
+                QCOMPARE(steadyState[i], (range < tolerance) ? 1.0 : 0.0);
+            }
+            QVERIFY(time[steadyStateStartIndex(steadyState)] > 5.0);
+        }
+    }
+
+    void steadyState_data()
+    {
+        QTest::addColumn< int >("method");
+        QTest::addColumn< double >("tolerance");
+        QTest::newRow("rectangular window") << int(RectangularWindowSteadyState) << 1e-3;
+        QTest::newRow("variance ratio") << int(VarianceRatioSteadyState) << 2.0;
+        QTest::newRow("moving average variance ratio") << int(MovingAverageVarianceRatioSteadyState) << 2.0;
+    }
 };
 
 
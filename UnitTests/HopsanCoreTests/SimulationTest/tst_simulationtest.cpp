@@ -295,6 +295,30 @@ private slots:
         QTest::newRow("3") << "TestStep" << "t_step#Value" << "apa";
     }
 
+    void Load_From_Model_Cache()
+    {
+        QTemporaryDir cacheDir;
+        QVERIFY(cacheDir.isValid());
+        mHopsanCore.setModelCacheDirectory(qPrintable(cacheDir.path()));
+
+        // The first load writes the cache, the second one replays it
+        for (int i=0; i<2; ++i) {
+            double startT, stopT;
+            ComponentSystem *pSystem = mHopsanCore.loadHMFModelFile(TEST_DATA_ROOT "unittestmodel.hmf", startT, stopT);
+            QVERIFY2(pSystem, "Could not load system from model cache");
+            QCOMPARE(QDir(cacheDir.path()).entryList(QStringList() << "*.hmfc").size(), 1);
+            QVERIFY(pSystem->haveSubComponent("TestStep"));
+            QVERIFY(pSystem->haveSubComponent("TestGain"));
+            QVERIFY(pSystem->getSubComponent("TestStep")->getPort("out")->isConnectedTo(pSystem->getSubComponent("TestGain")->getPort("in")));
+            QCOMPARE(pSystem->getSubComponentNames().size(), mpSystemFromFile->getSubComponentNames().size());
+            HString value;
+            pSystem->getSubComponent("TestStep")->getParameterValue("y_0#Value", value);
+            QCOMPARE(QString(value.c_str()), QString("-5"));
+            mHopsanCore.removeComponent(pSystem);
+        }
+        mHopsanCore.setModelCacheDirectory("");
+    }
+
     void System_Set_Parameter()
     {
         QFETCH(HString, subSystemName);
@@ -0,0 +1,29 @@
+#-------------------------------------------------
+#
+# Unit tests for the Ops optimization library
+#
+#-------------------------------------------------
+QT       += testlib
+QT       -= gui
+
+#Determine debug extension
+include( ../../Common.prf )
+
+TARGET = tst_opstest$${DEBUG_EXT}
+CONFIG   += console
+CONFIG   -= app_bundle
+DESTDIR = $${PWD}/../../bin
+
+
+TEMPLATE = app
+
+INCLUDEPATH += $${PWD}/../../Ops/include/
+LIBS += -L$${PWD}/../../bin -lops$${DEBUG_EXT}
+
+unix{
+QMAKE_LFLAGS *= -Wl,-rpath,\'\$$ORIGIN/./\'
+
+}
+
+SOURCES += \
+    tst_opstest.cpp
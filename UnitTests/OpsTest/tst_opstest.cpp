@@ -0,0 +1,620 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+#include <QtTest>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <random>
+
+#include "OpsParallelEvaluator.h"
+#include "OpsEvaluationCache.h"
+#include "OpsExperimentDesign.h"
+#include "OpsSweepRunner.h"
+#include "OpsSurrogateModel.h"
+#include "OpsMessageHandler.h"
+#include "OpsWorkerDifferentialEvolution.h"
+#include "OpsWorkerParticleSwarm.h"
+
+//! @brief Evaluates a shifted sphere function and checks that no context is used by two threads at once
+//! @details Each evaluation sleeps sleepMs, except one in ten that sleeps slowSleepMs (if non-zero)
+class SphereEvaluator : public Ops::ParallelEvaluator
+{
+public:
+    SphereEvaluator(size_t numContexts, int sleepMs=0, int slowSleepMs=0)
+        : Ops::ParallelEvaluator(numContexts), mBusy(numContexts), mSleepMs(sleepMs), mSlowSleepMs(slowSleepMs)
+    {
+        mNumEvaluations = 0;
+        mContextCollisions = 0;
+    }
+
+    double evaluateParameters(const std::vector<double> &rParameters, size_t context)
+    {
+        if(mBusy[context].exchange(true))
+        {
+            ++mContextCollisions;
+        }
+        const int sleepMs = (mSlowSleepMs > 0 && contextRand(context) < 0.1) ? mSlowSleepMs : mSleepMs;
+        if(sleepMs > 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(sleepMs));
+        }
+        double obj = 0;
+        for(size_t i=0; i<rParameters.size(); ++i)
+        {
+            obj += (rParameters[i]-0.5*i)*(rParameters[i]-0.5*i);
+        }
+        ++mNumEvaluations;
+        mBusy[context] = false;
+        return obj;
+    }
+
+    std::atomic<size_t> mNumEvaluations;
+    std::atomic<size_t> mContextCollisions;
+
+private:
+    std::vector<std::atomic<bool> > mBusy;
+    int mSleepMs;
+    int mSlowSleepMs;
+};
+
+//! @brief Sweep evaluator with two outputs that counts the number of evaluations
+class CountingSweepEvaluator : public Ops::SweepEvaluator
+{
+public:
+    CountingSweepEvaluator(size_t numContexts)
+        : mNumContexts(numContexts) {}
+
+    size_t getNumberOfContexts() const { return mNumContexts; }
+    std::vector<std::string> getOutputNames() const { return {"sum", "product"}; }
+
+    bool evaluateRun(const std::vector<double> &rParameters, size_t context, std::vector<double> &rOutputs)
+    {
+        (void)context;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        rOutputs[0] = rParameters[0]+rParameters[1];
+        rOutputs[1] = rParameters[0]*rParameters[1];
+        ++mNumEvaluations;
+        return true;
+    }
+
+    size_t mNumContexts;
+    std::atomic<size_t> mNumEvaluations{0};
+};
+
+//! @brief Message handler that aborts after a given number of completed steps
+class AbortingMessageHandler : public Ops::MessageHandler
+{
+public:
+    AbortingMessageHandler(size_t abortAfter) : mAbortAfter(abortAfter) {}
+    void stepCompleted(size_t step) { if(step >= mAbortAfter) { setAborted(true); } }
+
+private:
+    size_t mAbortAfter;
+};
+
+class OpsTests : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void Ops_Parallel_Evaluation()
+    {
+        QFETCH(size_t, numThreads);
+
+        const size_t numPoints = 12;
+        const size_t numParameters = 3;
+
+        //Reference run with one thread
+        SphereEvaluator serialEvaluator(numPoints);
+        serialEvaluator.setNumberOfThreads(1);
+        Ops::MessageHandler serialMessages;
+        Ops::WorkerDifferentialEvolution serialWorker(&serialEvaluator, &serialMessages);
+        setupWorker(serialWorker, numPoints, numParameters);
+        serialWorker.initialize();
+        serialWorker.run();
+
+        SphereEvaluator evaluator(numPoints);
+        evaluator.setNumberOfThreads(numThreads);
+        Ops::MessageHandler messages;
+        Ops::WorkerDifferentialEvolution worker(&evaluator, &messages);
+        setupWorker(worker, numPoints, numParameters);
+        worker.initialize();
+        worker.run();
+
+        QCOMPARE(evaluator.getNumberOfThreads(), numThreads);
+        QCOMPARE(size_t(evaluator.mContextCollisions), size_t(0));
+        QCOMPARE(size_t(evaluator.mNumEvaluations), size_t(serialEvaluator.mNumEvaluations));
+        QCOMPARE(worker.getCurrentNumberOfIterations(), serialWorker.getCurrentNumberOfIterations());
+        for(size_t p=0; p<numPoints; ++p) {
+            QCOMPARE(worker.getObjectiveValue(p), serialWorker.getObjectiveValue(p));
+        }
+        worker.calculateBestAndWorstId();
+        QVERIFY(worker.getObjectiveValue(worker.getBestId()) < 1e-2);
+    }
+
+    void Ops_Parallel_Evaluation_data()
+    {
+        QTest::addColumn<size_t>("numThreads");
+        QTest::newRow("1 thread") << size_t(1);
+        QTest::newRow("2 threads") << size_t(2);
+        QTest::newRow("4 threads") << size_t(4);
+        QTest::newRow("12 threads") << size_t(12);
+    }
+
+    void Ops_Parallel_Sweep_Speedup()
+    {
+        //Evaluations only sleep, so the speedup does not depend on the number of processor cores
+        const size_t numThreads = 4;
+        SphereEvaluator evaluator(numThreads, 20);
+        evaluator.setNumberOfThreads(numThreads);
+        Ops::MessageHandler messages;
+        Ops::Worker worker(&evaluator, &messages);
+        worker.setNumberOfParameters(2);
+        worker.setNumberOfPoints(16);
+        worker.setParameterLimits(0, -1, 1);
+        worker.setParameterLimits(1, -1, 1);
+        worker.distributePoints();
+
+        QElapsedTimer timer;
+        timer.start();
+        evaluator.evaluateAllPoints();
+        const qint64 elapsed = timer.elapsed();
+
+        QCOMPARE(size_t(evaluator.mNumEvaluations), size_t(16));
+        QVERIFY2(elapsed < 16*20/2, "Four threads shall evaluate sixteen points in less than half the serial time");
+    }
+
+    void Ops_Asynchronous_Convergence()
+    {
+        QFETCH(int, algorithm);
+
+        const size_t numPoints = 12;
+        const size_t numParameters = 3;
+
+        SphereEvaluator evaluator(numPoints);
+        evaluator.setNumberOfThreads(4);
+        Ops::MessageHandler messages;
+        std::unique_ptr<Ops::Worker> pWorker;
+        if(algorithm == Ops::DifferentialEvolution)
+        {
+            Ops::WorkerDifferentialEvolution *pDEWorker = new Ops::WorkerDifferentialEvolution(&evaluator, &messages);
+            setupWorker(*pDEWorker, numPoints, numParameters);
+            pWorker.reset(pDEWorker);
+        }
+        else
+        {
+            Ops::WorkerParticleSwarm *pPSOWorker = new Ops::WorkerParticleSwarm(&evaluator, &messages);
+            setupWorker(*pPSOWorker, numPoints, numParameters);
+            pWorker.reset(pPSOWorker);
+        }
+        pWorker->setAsynchronous(true);
+        pWorker->initialize();
+        pWorker->run();
+
+        QCOMPARE(size_t(evaluator.mContextCollisions), size_t(0));
+        QCOMPARE(evaluator.getNumberOfPendingEvaluations(), size_t(0));
+        QCOMPARE(evaluator.getNumberOfCompletedEvaluations(), size_t(evaluator.mNumEvaluations));
+        QVERIFY(evaluator.mNumEvaluations <= numPoints*(pWorker->getMaxNumberOfIterations()+1));
+        pWorker->calculateBestAndWorstId();
+        QVERIFY(pWorker->getObjectiveValue(pWorker->getBestId()) < 1e-2);
+    }
+
+    void Ops_Asynchronous_Convergence_data()
+    {
+        QTest::addColumn<int>("algorithm");
+        QTest::newRow("differential evolution") << int(Ops::DifferentialEvolution);
+        QTest::newRow("particle swarm") << int(Ops::ParticleSwarm);
+    }
+
+    void Ops_Asynchronous_Throughput()
+    {
+        //Most evaluations take 2 ms but some take 40 ms, so generational evaluation leaves threads idle at the end of
+        //each generation while steady-state evaluation keeps them busy
+        const size_t numThreads = 4;
+        const size_t numPoints = 8;
+        const size_t numParameters = 3;
+        const size_t numIterations = 20;
+
+        double throughput[2];
+        double utilization[2];
+        for(int asynchronous=0; asynchronous<2; ++asynchronous)
+        {
+            SphereEvaluator evaluator(numPoints, 2, 40);
+            evaluator.setNumberOfThreads(numThreads);
+            evaluator.setRandomSeed(1);
+            Ops::MessageHandler messages;
+            Ops::WorkerDifferentialEvolution worker(&evaluator, &messages);
+            setupWorker(worker, numPoints, numParameters);
+            worker.setMaxNumberOfIterations(numIterations);
+            worker.setTolerance(0);
+            worker.setAsynchronous(asynchronous);
+            evaluator.resetStatistics();
+            worker.initialize();
+            worker.run();
+
+            QCOMPARE(size_t(evaluator.mNumEvaluations), numPoints*(numIterations+1));
+            throughput[asynchronous] = evaluator.getThroughput();
+            utilization[asynchronous] = evaluator.getUtilization();
+        }
+        QVERIFY2(throughput[1] > 1.3*throughput[0], "Steady-state evaluation shall have higher throughput than generational");
+        QVERIFY(utilization[1] > utilization[0]);
+    }
+
+    void Ops_Evaluation_Cache()
+    {
+        Ops::EvaluationCache cache;
+        cache.setModelHash(Ops::EvaluationCache::computeHash("model A"));
+        cache.store({1.0, -2.0, 0.0}, 3.0);
+
+        double objective = 0;
+        QVERIFY(cache.lookup({1.0+1e-13, -2.0, 0.0}, objective));
+        QCOMPARE(objective, 3.0);
+        QVERIFY(!cache.lookup({1.0+1e-6, -2.0, 0.0}, objective));
+        QVERIFY(!cache.lookup({1.0, -2.0}, objective));
+
+        //Entries for other models in the same file shall be kept but not used
+        QTemporaryDir dir;
+        const std::string filePath = dir.filePath("ops.cache").toStdString();
+        Ops::EvaluationCache otherCache;
+        otherCache.setModelHash(Ops::EvaluationCache::computeHash("model B"));
+        otherCache.store({1.0, -2.0, 0.0}, 5.0);
+        QVERIFY(otherCache.save(filePath));
+        QVERIFY(cache.load(filePath));
+        QVERIFY(cache.save(filePath));
+
+        Ops::EvaluationCache loadedCache;
+        loadedCache.setModelHash(Ops::EvaluationCache::computeHash("model A"));
+        QVERIFY(loadedCache.load(filePath));
+        QCOMPARE(loadedCache.size(), size_t(1));
+        QVERIFY(loadedCache.lookup({1.0, -2.0, 0.0}, objective));
+        QCOMPARE(objective, 3.0);
+        QVERIFY(otherCache.load(filePath));
+        QVERIFY(otherCache.lookup({1.0, -2.0, 0.0}, objective));
+        QCOMPARE(objective, 5.0);
+    }
+
+    void Ops_Evaluation_Cache_Reuse()
+    {
+        QFETCH(size_t, numThreads);
+
+        const size_t numPoints = 16;
+        SphereEvaluator evaluator(numPoints);
+        evaluator.setNumberOfThreads(numThreads);
+        evaluator.setUseCache(true);
+        Ops::MessageHandler messages;
+        Ops::Worker worker(&evaluator, &messages);
+        worker.setNumberOfParameters(2);
+        worker.setNumberOfPoints(numPoints);
+        worker.setParameterLimits(0, -1, 1);
+        worker.setParameterLimits(1, -1, 1);
+        worker.distributePoints();
+
+        evaluator.evaluateAllPoints();
+        const std::vector<double> objectives = worker.getObjectiveValues();
+        QCOMPARE(size_t(evaluator.mNumEvaluations), numPoints);
+        QCOMPARE(messages.getNumberOfCacheMisses(), numPoints);
+
+        //Evaluating the same points again shall not run any evaluations
+        std::fill(worker.getObjectiveValues().begin(), worker.getObjectiveValues().end(), 0.0);
+        evaluator.evaluateAllPoints();
+        QCOMPARE(size_t(evaluator.mNumEvaluations), numPoints);
+        QCOMPARE(messages.getNumberOfCacheHits(), numPoints);
+        QVERIFY(worker.getObjectiveValues() == objectives);
+
+        //Cached results shall also be returned by asynchronous evaluation
+        evaluator.submitEvaluation(7, worker.getPoints()[3]);
+        size_t id;
+        double objective;
+        QVERIFY(evaluator.waitForEvaluation(id, objective));
+        QCOMPARE(id, size_t(7));
+        QCOMPARE(objective, objectives[3]);
+        QVERIFY(!evaluator.waitForEvaluation(id, objective));
+        QCOMPARE(size_t(evaluator.mNumEvaluations), numPoints);
+        QCOMPARE(messages.getNumberOfCacheHits(), numPoints+1);
+    }
+
+    void Ops_Evaluation_Cache_Reuse_data()
+    {
+        QTest::addColumn<size_t>("numThreads");
+        QTest::newRow("1 thread") << size_t(1);
+        QTest::newRow("4 threads") << size_t(4);
+    }
+
+    void Ops_Experiment_Design()
+    {
+        QFETCH(int, design);
+        QFETCH(size_t, numParameters);
+
+        const size_t numRuns = 64;
+        Ops::ExperimentDesign doe;
+        doe.setDesign(Ops::DesignT(design));
+        doe.setNumberOfParameters(numParameters);
+        for(size_t d=0; d<numParameters; ++d)
+        {
+            doe.setParameterLimits(d, -1.0, 3.0);
+            doe.setNumberOfLevels(d, 2);
+        }
+        doe.setNumberOfRuns(numRuns);
+        std::string errorMessage;
+        QVERIFY(doe.prepare(errorMessage));
+
+        //Count the points in each of numRuns equally sized intervals per dimension
+        std::vector<std::vector<size_t> > counts(numParameters, std::vector<size_t>(numRuns, 0));
+        std::vector<double> point;
+        for(size_t r=0; r<doe.getNumberOfRuns(); ++r)
+        {
+            doe.getPoint(r, point);
+            QCOMPARE(point.size(), numParameters);
+            for(size_t d=0; d<numParameters; ++d)
+            {
+                QVERIFY(point[d] >= -1.0 && point[d] <= 3.0);
+                ++counts[d][std::min(size_t((point[d]+1.0)/4.0*numRuns), numRuns-1)];
+            }
+        }
+
+        if(design == Ops::DesignFullFactorial)
+        {
+            QCOMPARE(doe.getNumberOfRuns(), size_t(1) << numParameters);
+            QCOMPARE(counts[0][0], doe.getNumberOfRuns()/2);
+            QCOMPARE(counts[0][numRuns-1], doe.getNumberOfRuns()/2);
+        }
+        else if(design == Ops::DesignLatinHypercube || design == Ops::DesignSobol)
+        {
+            //Latin hypercube and the first 2^k Sobol points have exactly one point per interval in each dimension
+            for(size_t d=0; d<numParameters; ++d)
+            {
+                QVERIFY(std::count(counts[d].begin(), counts[d].end(), size_t(1)) == std::ptrdiff_t(numRuns));
+            }
+        }
+        else if(design == Ops::DesignHalton)
+        {
+            doe.getPoint(0, point);
+            QCOMPARE(point[0], 1.0);
+        }
+    }
+
+    void Ops_Experiment_Design_data()
+    {
+        QTest::addColumn<int>("design");
+        QTest::addColumn<size_t>("numParameters");
+        QTest::newRow("full factorial") << int(Ops::DesignFullFactorial) << size_t(4);
+        QTest::newRow("latin hypercube") << int(Ops::DesignLatinHypercube) << size_t(5);
+        QTest::newRow("sobol") << int(Ops::DesignSobol) << Ops::ExperimentDesign::getMaxNumberOfSobolDimensions();
+        QTest::newRow("halton") << int(Ops::DesignHalton) << size_t(5);
+        QTest::newRow("random") << int(Ops::DesignRandom) << size_t(5);
+    }
+
+    void Ops_Sweep_Resume()
+    {
+        const size_t numRuns = 200;
+        QTemporaryDir dir;
+        const std::string filePath = dir.filePath("sweep.csv").toStdString();
+        CountingSweepEvaluator evaluator(4);
+
+        //Abort the first sweep part way through
+        AbortingMessageHandler abortingMessages(50);
+        Ops::SweepRunner firstRunner(&evaluator, &abortingMessages);
+        firstRunner.getDesign().setDesign(Ops::DesignSobol);
+        firstRunner.getDesign().setNumberOfParameters(2);
+        firstRunner.getDesign().setNumberOfRuns(numRuns);
+        firstRunner.setParameterNames({"x", "y"});
+        firstRunner.setResultFile(filePath);
+        QVERIFY(firstRunner.run());
+        QVERIFY(firstRunner.getNumberOfCompletedRuns() >= 50);
+        QVERIFY(firstRunner.getNumberOfCompletedRuns() < numRuns);
+
+        //Simulate a row that was only partially written when the process was killed
+        {
+            std::ofstream file(filePath.c_str(), std::ios::app);
+            file << "199,0.5";
+        }
+
+        Ops::MessageHandler messages;
+        Ops::SweepRunner secondRunner(&evaluator, &messages);
+        secondRunner.getDesign().setDesign(Ops::DesignSobol);
+        secondRunner.getDesign().setNumberOfParameters(2);
+        secondRunner.getDesign().setNumberOfRuns(numRuns);
+        secondRunner.setParameterNames({"x", "y"});
+        secondRunner.setResultFile(filePath);
+        QVERIFY(secondRunner.run());
+        QCOMPARE(secondRunner.getNumberOfResumedRuns(), firstRunner.getNumberOfCompletedRuns());
+        QCOMPARE(secondRunner.getNumberOfResumedRuns()+secondRunner.getNumberOfCompletedRuns(), numRuns);
+        QCOMPARE(size_t(evaluator.mNumEvaluations), numRuns);
+
+        //Every run shall be in the file exactly once, with outputs matching the parameters
+        std::ifstream file(filePath.c_str());
+        std::string line;
+        std::getline(file, line);
+        std::getline(file, line);
+        QCOMPARE(line, std::string("run,x,y,sum,product"));
+        std::vector<int> rowsPerRun(numRuns, 0);
+        while(std::getline(file, line))
+        {
+            std::replace(line.begin(), line.end(), ',', ' ');
+            std::istringstream lineStream(line);
+            size_t run;
+            double x, y, sum, product;
+            QVERIFY(lineStream >> run >> x >> y >> sum >> product);
+            QVERIFY(run < numRuns);
+            ++rowsPerRun[run];
+            QCOMPARE(sum, x+y);
+            QCOMPARE(product, x*y);
+        }
+        QVERIFY(std::count(rowsPerRun.begin(), rowsPerRun.end(), 1) == std::ptrdiff_t(numRuns));
+
+        //A different design shall not be appended to the file
+        Ops::SweepRunner otherRunner(&evaluator, &messages);
+        otherRunner.getDesign().setDesign(Ops::DesignHalton);
+        otherRunner.getDesign().setNumberOfParameters(2);
+        otherRunner.setParameterNames({"x", "y"});
+        otherRunner.setResultFile(filePath);
+        QVERIFY(!otherRunner.run());
+    }
+
+    void Ops_Surrogate_Model()
+    {
+        QFETCH(int, surrogate);
+
+        //Both models shall reproduce a quadratic function from a window of recent samples
+        std::unique_ptr<Ops::SurrogateModel> pModel(Ops::createSurrogateModel(Ops::SurrogateModelT(surrogate)));
+        pModel->setParameterLimits({-5, -5, -5}, {5, 5, 5});
+        pModel->setMaxNumberOfSamples(60);
+        auto function = [](const std::vector<double> &x) {
+            return 1.0+x[0]-2.0*x[1]+0.5*x[0]*x[0]+x[1]*x[1]+2.0*x[2]*x[2]-0.3*x[0]*x[2];
+        };
+
+        std::mt19937 generator(5);
+        std::uniform_real_distribution<double> distribution(-5, 5);
+        auto randomPoint = [&]() {
+            return std::vector<double>{distribution(generator), distribution(generator), distribution(generator)};
+        };
+        for(size_t i=0; i<100; ++i)
+        {
+            std::vector<double> x = randomPoint();
+            pModel->addSample(x, function(x));
+            if(i+1 < pModel->getMinNumberOfSamples())
+            {
+                QVERIFY(!pModel->update());
+            }
+        }
+        QCOMPARE(pModel->getNumberOfSamples(), size_t(60));
+        QVERIFY(pModel->update());
+
+        std::vector<std::vector<double> > points;
+        for(size_t i=0; i<50; ++i)
+        {
+            std::vector<double> x = randomPoint();
+            for(double &rValue : x)
+            {
+                rValue *= 0.8;
+            }
+            points.push_back(x);
+        }
+        std::vector<double> predictions;
+        pModel->predict(points, predictions);
+        QCOMPARE(predictions.size(), points.size());
+        double sumSquaredErrors = 0;
+        double sumSquaredValues = 0;
+        for(size_t i=0; i<points.size(); ++i)
+        {
+            double exact = function(points[i]);
+            sumSquaredErrors += (predictions[i]-exact)*(predictions[i]-exact);
+            sumSquaredValues += exact*exact;
+            QCOMPARE(pModel->predict(points[i]), predictions[i]);
+        }
+        const double tolerance = (surrogate == Ops::SurrogateQuadratic) ? 1e-6 : 0.05;
+        QVERIFY(std::sqrt(sumSquaredErrors) < tolerance*std::sqrt(sumSquaredValues));
+    }
+
+    void Ops_Surrogate_Model_data()
+    {
+        QTest::addColumn<int>("surrogate");
+        QTest::newRow("quadratic") << int(Ops::SurrogateQuadratic);
+        QTest::newRow("radial basis") << int(Ops::SurrogateRadialBasis);
+    }
+
+    void Ops_Surrogate_Screening()
+    {
+        QFETCH(int, surrogate);
+
+        //Pre-screening shall reduce the number of simulations while still finding the optimum
+        const size_t numPoints = 16;
+        const size_t numParameters = 3;
+        const size_t numIterations = 60;
+        size_t numEvaluations[2];
+        for(int screening=0; screening<2; ++screening)
+        {
+            SphereEvaluator evaluator(numPoints);
+            evaluator.setNumberOfThreads(4);
+            evaluator.setSurrogateModel(Ops::SurrogateModelT(surrogate));
+            evaluator.setScreeningFraction(0.25);
+            Ops::MessageHandler messages;
+            Ops::WorkerDifferentialEvolution worker(&evaluator, &messages);
+            setupWorker(worker, numPoints, numParameters);
+            worker.setMaxNumberOfIterations(numIterations);
+            worker.setTolerance(0);
+            if(screening)
+            {
+                worker.setUseSurrogateModel(10);
+            }
+            worker.initialize();
+            worker.run();
+
+            numEvaluations[screening] = evaluator.mNumEvaluations;
+            QCOMPARE(numEvaluations[screening]+evaluator.getNumberOfScreenedCandidates(), numPoints*(numIterations+1));
+            worker.calculateBestAndWorstId();
+            QVERIFY(worker.getObjectiveValue(worker.getBestId()) < 1e-2);
+        }
+        QVERIFY2(numEvaluations[1] < numEvaluations[0]/2, "Pre-screening shall avoid most simulations");
+    }
+
+    void Ops_Surrogate_Screening_data()
+    {
+        QTest::addColumn<int>("surrogate");
+        QTest::newRow("quadratic") << int(Ops::SurrogateQuadratic);
+        QTest::newRow("radial basis") << int(Ops::SurrogateRadialBasis);
+    }
+
+private:
+    void setupWorker(Ops::Worker &rWorker, size_t numPoints, size_t numParameters)
+    {
+        rWorker.setRandomSeed(12345);
+        rWorker.setNumberOfParameters(numParameters);
+        rWorker.setNumberOfCandidates(numPoints);
+        rWorker.setNumberOfPoints(numPoints);
+        for(size_t p=0; p<numParameters; ++p) {
+            rWorker.setParameterLimits(p, -5, 5);
+        }
+        rWorker.setSamplingMethod(Ops::SamplingRandom);
+        rWorker.setMaxNumberOfIterations(500);
+        rWorker.setTolerance(1e-3);
+    }
+
+    void setupWorker(Ops::WorkerParticleSwarm &rWorker, size_t numPoints, size_t numParameters)
+    {
+        setupWorker(static_cast<Ops::Worker&>(rWorker), numPoints, numParameters);
+        rWorker.setOmega1(1.0);
+        rWorker.setOmega2(0.4);
+        rWorker.setC1(2.0);
+        rWorker.setC2(2.0);
+        rWorker.setVmax(2.0);
+    }
+
+    void setupWorker(Ops::WorkerDifferentialEvolution &rWorker, size_t numPoints, size_t numParameters)
+    {
+        setupWorker(static_cast<Ops::Worker&>(rWorker), numPoints, numParameters);
+        rWorker.setCrossoverProbability(0.9);
+        rWorker.setDifferentialWeight(0.8);
+    }
+};
+
+QTEST_APPLESS_MAIN(OpsTests)
+
+#include "tst_opstest.moc"
@@ -926,6 +926,243 @@ private Q_SLOTS:
         QTest::newRow("1") << "5*(3-1))" << false;
         QTest::newRow("2") << "" << false;
     }
+
+    void SymHop_Common_Subexpressions()
+    {
+        QFETCH(QStringList, strs);
+        QFETCH(stringDoubleMap, variables);
+        QFETCH(int, numTemporaries);
+
+        QList<Expression> originals, exprs, temporaries;
+        for(const QString &str : strs) {
+            originals.append(Expression(str));
+        }
+        exprs = originals;
+        eliminateCommonSubexpressions(exprs, temporaries, "tmp");
+        QCOMPARE(temporaries.size(), numTemporaries);
+
+        // Evaluate temporaries in order, then compare with the original expressions
+        for(const Expression &temp : temporaries) {
+            QVERIFY(temp.isAssignment());
+            variables.insert(temp.getLeft()->toString(), temp.getRight()->evaluate(variables));
+        }
+        OperationCount opsBefore, opsAfter;
+        for(int i=0; i<exprs.size(); ++i) {
+            QVERIFY(fabs(exprs[i].evaluate(variables)-originals[i].evaluate(variables)) < 1e-12);
+            QVERIFY(!exprs[i].toCodeString().contains("pow("));
+            opsBefore += countOperations(originals[i]);
+            opsAfter += countOperations(exprs[i], true);
+        }
+        for(const Expression &temp : temporaries) {
+            opsAfter += countOperations(*temp.getRight(), true);
+        }
+        QVERIFY(opsAfter.functionCalls < opsBefore.functionCalls);
+    }
+
+    void SymHop_Common_Subexpressions_data()
+    {
+        QTest::addColumn<QStringList>("strs");
+        QTest::addColumn<stringDoubleMap>("variables");
+        QTest::addColumn<int>("numTemporaries");
+        stringDoubleMap variables;
+        variables.insert("x", 0.7);
+        variables.insert("y", 1.1);
+        variables.insert("p1", 5);
+        variables.insert("p2", 2);
+        QTest::newRow("0") << (QStringList() << "sin(x*y)+x^2" << "cos(x)*sin(x*y)") << variables << 1;
+        QTest::newRow("1") << (QStringList() << "(x+y)^2*sin(p1-p2)" << "sin(p1-p2)/(x+y)^2") << variables << 3;
+        QTest::newRow("2") << (QStringList() << "dxSignedSquareL(p1-p2,x)*y" << "y*dxSignedSquareL(p1-p2,x)+x^3") << variables << 1;
+    }
+
+    void SymHop_Evaluation_Tape()
+    {
+        QFETCH(QString, str);
+        QFETCH(bool, compileOk);
+
+        Expression expr(str);
+        EvaluationTape tape;
+        QCOMPARE(tape.compile(expr, QStringList() << "x" << "y"), compileOk);
+        if(!compileOk) {
+            return;
+        }
+
+        // Compare with the tree walking evaluation, for a single point and for data vectors
+        const int n = 1000;
+        QVector<double> xData(n), yData(n), result(n);
+        for(int i=0; i<n; ++i) {
+            xData[i] = 3.0*sin(0.37*i);
+            yData[i] = 2.0*cos(0.11*i);
+        }
+        const double *columns[] = {xData.constData(), yData.constData()};
+        tape.evaluate(columns, result.data(), n);
+
+        QMap<QString, double> variables;
+        for(int i=0; i<n; ++i) {
+            variables.insert("x", xData[i]);
+            variables.insert("y", yData[i]);
+            const double expected = expr.evaluate(variables);
+            QCOMPARE(result[i], expected);
+        }
+        const double point[] = {xData[5], yData[5]};
+        QCOMPARE(tape.evaluate(point), result[5]);
+    }
+
+    void SymHop_Evaluation_Tape_data()
+    {
+        QTest::addColumn<QString>("str");
+        QTest::addColumn<bool>("compileOk");
+        QTest::newRow("0") << "x*y+sin(x)/(1+y^2)" << true;
+        QTest::newRow("1") << "limit(x-y,-0.5,0.5)*exp(-x)+max(x,y)" << true;
+        QTest::newRow("2") << "sqrt(abs(x))+atan2(y,x)-pi()*sign(y-x)" << true;
+        QTest::newRow("3") << "(x-y)^2-(2*y+23)^2" << true;
+        QTest::newRow("4") << "greaterThan(x,y)*x+smallerThanOrEqual(x,y)*y" << true;
+        QTest::newRow("5") << "integer(x*10)/10-round(y)" << true;
+        QTest::newRow("6") << "x+z" << false;
+        QTest::newRow("7") << "customFunction(x)" << false;
+    }
+
+    void SymHop_Evaluation_Tape_Constants()
+    {
+        // Constants are bound by value, they must not lose precision as they would if formatted into the expression
+        Expression expr("x*k+c");
+        QMap<QString, double> constants;
+        constants.insert("k", 1.234567890123456e-25);
+        constants.insert("c", 1.0/3.0);
+        EvaluationTape tape;
+        QVERIFY(tape.compile(expr, QStringList() << "x", constants));
+        QCOMPARE(tape.getVariableNames(), QStringList() << "x");
+        const double x = 7.0;
+        QCOMPARE(tape.evaluate(&x), x*1.234567890123456e-25+1.0/3.0);
+
+        // Constants are only bound for the compile call they were given to
+        QVERIFY(!tape.compile(expr, QStringList() << "x"));
+    }
+
+    void SymHop_Evaluate_Benchmark()
+    {
+        QFETCH(bool, useTape);
+
+        Expression expr("x*y+sin(x)/(1+y^2)-limit(x-y,-0.5,0.5)*exp(-x)");
+        const int n = 10000;
+        QVector<double> xData(n), yData(n), result(n);
+        for(int i=0; i<n; ++i) {
+            xData[i] = 3.0*sin(0.37*i);
+            yData[i] = 2.0*cos(0.11*i);
+        }
+
+        if(useTape) {
+            QBENCHMARK {
+                EvaluationTape tape;
+                tape.compile(expr, QStringList() << "x" << "y");
+                const double *columns[] = {xData.constData(), yData.constData()};
+                tape.evaluate(columns, result.data(), n);
+            }
+        }
+        else {
+            QBENCHMARK {
+                QMap<QString, double> variables;
+                for(int i=0; i<n; ++i) {
+                    variables.insert("x", xData[i]);
+                    variables.insert("y", yData[i]);
+                    result[i] = expr.evaluate(variables);
+                }
+            }
+        }
+    }
+
+    void SymHop_Evaluate_Benchmark_data()
+    {
+        QTest::addColumn<bool>("useTape");
+        QTest::newRow("tree") << false;
+        QTest::newRow("tape") << true;
+    }
+
+    void SymHop_Memoization()
+    {
+        QFETCH(QString, equation);
+        QFETCH(QStringList, variables);
+
+        Expression expr(equation);
+        QStringList plain, memoized;
+
+        QVERIFY2(!isMemoizationEnabled(), "Memoization shall be disabled unless a caller enables it");
+        setMemoizationEnabled(false);
+        for(const QString &var : variables) {
+            bool ok;
+            plain << expr.derivative(Expression(var), ok).toString();
+            QVERIFY(ok);
+        }
+        Expression plainSimplified(expr);
+        plainSimplified._simplify(Expression::FullSimplification, Expression::Recursive);
+
+        setMemoizationEnabled(true);
+        for(int pass=0; pass<2; ++pass) {
+            memoized.clear();
+            for(const QString &var : variables) {
+                bool ok;
+                memoized << expr.derivative(Expression(var), ok).toString();
+                QVERIFY(ok);
+            }
+            QCOMPARE(memoized, plain);
+
+            Expression memoizedSimplified(expr);
+            memoizedSimplified._simplify(Expression::FullSimplification, Expression::Recursive);
+            QCOMPARE(memoizedSimplified.toString(), plainSimplified.toString());
+        }
+
+        int nNodes;
+        qint64 nHits, nMisses;
+        getMemoizationStatistics(nNodes, nHits, nMisses);
+        QVERIFY2(nHits >= variables.size(), "Second pass shall be answered from the memoization tables");
+        QCOMPARE(internExpression(Expression(equation)), internExpression(expr));
+
+        clearMemoization();
+        getMemoizationStatistics(nNodes, nHits, nMisses);
+        QCOMPARE(nNodes, 0);
+        setMemoizationEnabled(false);
+    }
+
+    void SymHop_Memoization_data()
+    {
+        QTest::addColumn<QString>("equation");
+        QTest::addColumn<QStringList>("variables");
+        QTest::newRow("0") << "x*y+sin(x*y)/(1+x*y)" << (QStringList() << "x" << "y" << "z");
+        QTest::newRow("1") << "(p1-p2)*Kleak*betae/(V1+A1*x)-(p1-p2)*Kleak*betae/(V2-A2*x)" << (QStringList() << "p1" << "p2" << "x");
+        QTest::newRow("2") << "Ks*sqrt(abs(c1-c2))*sign(c1-c2)/(1+Ks*Ks*(Zc1+Zc2)*(Zc1+Zc2))" << (QStringList() << "Ks" << "c1" << "Zc1");
+        QTest::newRow("3") << "pa*pow((SL-x)*Ap,kappa)-p0*pow(SL*Ap,kappa)" << (QStringList() << "pa" << "x");
+    }
+
+    void SymHop_Jacobian_Benchmark()
+    {
+        QFETCH(bool, memoize);
+
+        QList<Expression> residuals;
+        residuals << Expression("v*m*2/Ts + x*B*2/Ts + x*k - (p1*A1 - p2*A2 - c3 - Zc3*v)")
+                  << Expression("(p1-p1Old)*2/Ts - (-(p1-c1)/Zc1-(p1-p2)*Kleak-A1*v)*betae/(V1+A1*x)")
+                  << Expression("(p2-p2Old)*2/Ts - (-(p2-c2)/Zc2+(p1-p2)*Kleak+A2*v)*betae/(V2-A2*x)")
+                  << Expression("q2 - Ks*sqrt(abs(p1-p2))*sign(p1-p2)/(1+Ks*Ks*(Zc1+Zc2)*(Zc1+Zc2))");
+        QList<Expression> unknowns;
+        unknowns << Expression("v") << Expression("x") << Expression("p1") << Expression("p2") << Expression("q2");
+
+        setMemoizationEnabled(memoize);
+        QBENCHMARK {
+            clearMemoization();
+            for(const Expression &residual : residuals) {
+                for(const Expression &unknown : unknowns) {
+                    bool ok;
+                    residual.derivative(unknown, ok);
+                }
+            }
+        }
+        setMemoizationEnabled(false);
+    }
+
+    void SymHop_Jacobian_Benchmark_data()
+    {
+        QTest::addColumn<bool>("memoize");
+        QTest::newRow("plain") << false;
+        QTest::newRow("memoized") << true;
+    }
 };
 
 QTEST_APPLESS_MAIN(SymHopTests)
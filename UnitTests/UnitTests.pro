@@ -1,3 +1,3 @@
 TEMPLATE = subdirs
 
-SUBDIRS = HopsanCoreTests SymHopTest GeneratorTest DefaultLibraryXMLTest hopsanclitest
+SUBDIRS = HopsanCoreTests SymHopTest OpsTest GeneratorTest DefaultLibraryXMLTest hopsanclitest
@@ -59,9 +59,9 @@ private:
      double delayParts2[9];
      double delayParts3[9];
      double delayParts4[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<4> jacobianMatrix;
+     FixedVec<4> systemEquations;
+     FixedMatrix<5,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -120,9 +120,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(4,4);
-        systemEquations.create(4);
-        delayedPart.create(5,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -210,9 +207,7 @@ uel2,umin,umax));
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(4);
-        Vec stateVark(4);
-        Vec deltaStateVar(4);
+        FixedVec<4> stateVark;
 
         //Read variables from nodes
         //Port Pel1
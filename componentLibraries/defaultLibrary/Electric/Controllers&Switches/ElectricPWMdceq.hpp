@@ -58,9 +58,9 @@ private:
      double delayParts3[9];
      double delayParts4[9];
      double delayParts5[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<5> jacobianMatrix;
+     FixedVec<5> systemEquations;
+     FixedMatrix<6,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -119,9 +119,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(5,5);
-        systemEquations.create(5);
-        delayedPart.create(6,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -203,9 +200,7 @@ on)","",1.,&mptfac);
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(5);
-        Vec stateVark(5);
-        Vec deltaStateVar(5);
+        FixedVec<5> stateVark;
 
         //Read variables from nodes
         //Port Pel1
@@ -53,9 +53,9 @@ private:
      double delayParts1[9];
      double delayParts2[9];
      double delayParts3[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<3> jacobianMatrix;
+     FixedVec<3> systemEquations;
+     FixedMatrix<4,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -107,9 +107,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(3,3);
-        systemEquations.create(3);
-        delayedPart.create(4,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -179,9 +176,7 @@ mTimestep*uel2)/(2.*Induct);
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(3);
-        Vec stateVark(3);
-        Vec deltaStateVar(3);
+        FixedVec<3> stateVark;
 
         //Read variables from nodes
         //Port Pel1
@@ -64,9 +64,9 @@ private:
      double delayParts4[9];
      double delayParts5[9];
      double delayParts6[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<6> jacobianMatrix;
+     FixedVec<6> systemEquations;
+     FixedMatrix<7,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -152,9 +152,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(6,6);
-        systemEquations.create(6);
-        delayedPart.create(7,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -292,9 +289,7 @@ Bm*Power(freq,2)*Power(gmax,2)*mTimestep + 2*freq*gmax*iel2*Ke*mTimestep*Np - \
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(6);
-        Vec stateVark(6);
-        Vec deltaStateVar(6);
+        FixedVec<6> stateVark;
 
         //Read variables from nodes
         //Port Pel1
@@ -61,9 +61,9 @@ private:
      double delayParts2[9];
      double delayParts3[9];
      double delayParts4[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<4> jacobianMatrix;
+     FixedVec<4> systemEquations;
+     FixedMatrix<5,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -140,9 +140,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(4,4);
-        systemEquations.create(4);
-        delayedPart.create(5,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -177,6 +174,9 @@ public:
 //==This code has been autogenerated using Compgen==
         //Add constantParameters
         mpSolver = new EquationSystemSolver(this,4);
+        //Factorize in the first iteration of each time step and reuse it in the following, stop when converged
+        mpSolver->setJacobianReuse(true);
+        mpSolver->setResidualTolerance(1e-10);
      }
 
     void initialize()
@@ -244,9 +244,7 @@ public:
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(4);
-        Vec stateVark(4);
-        Vec deltaStateVar(4);
+        FixedVec<4> stateVark;
 
         //Read variables from nodes
         //Port P1
@@ -280,6 +278,7 @@ public:
         stateVark[3] = p2;
 
         //Iterative solution using Newton-Rapshson
+        mpSolver->invalidateJacobian();
         for(iter=1;iter<=mNoiter;iter++)
         {
          //CentrifugalPump
@@ -333,7 +332,7 @@ onPositive(p1),0,1))/(b*kl);
 //==This code has been autogenerated using Compgen==
 
           //Solving equation using LU-faktorisation
-          mpSolver->solve(jacobianMatrix, systemEquations, stateVark, iter);
+          const bool converged = mpSolver->solve(jacobianMatrix, systemEquations, stateVark, iter);
           q2=stateVark[0];
           torp=stateVark[1];
           p1=stateVark[2];
@@ -342,6 +341,11 @@ onPositive(p1),0,1))/(b*kl);
           q1 = -q2;
           Pin = omegap*torp;
           Pout = (-p1 + p2)*q2;
+          //Stop iterating when the residual was already within tolerance
+          if(converged)
+          {
+            break;
+          }
         }
 
         //Calculate the delayed parts
@@ -64,9 +64,9 @@ private:
      double delayParts3[9];
      double delayParts4[9];
      double delayParts5[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<5> jacobianMatrix;
+     FixedVec<5> systemEquations;
+     FixedMatrix<6,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -155,9 +155,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(5,5);
-        systemEquations.create(5);
-        delayedPart.create(6,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -193,6 +190,9 @@ public:
 //==This code has been autogenerated using Compgen==
         //Add constantParameters
         mpSolver = new EquationSystemSolver(this,5);
+        //Factorize in the first iteration of each time step and reuse it in the following, stop when converged
+        mpSolver->setJacobianReuse(true);
+        mpSolver->setResidualTolerance(1e-10);
      }
 
     void initialize()
@@ -292,9 +292,7 @@ NodeMechanicRotational::EquivalentInertia);
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(5);
-        Vec stateVark(5);
-        Vec deltaStateVar(5);
+        FixedVec<5> stateVark;
 
         //Read variables from nodes
         //Port P1
@@ -332,6 +330,7 @@ NodeMechanicRotational::EquivalentInertia);
         stateVark[4] = tormr1;
 
         //Iterative solution using Newton-Rapshson
+        mpSolver->invalidateJacobian();
         for(iter=1;iter<=mNoiter;iter++)
         {
          //CentrifugalPumpJ
@@ -412,7 +411,7 @@ onPositive(p1),0,1))/(kl*rho);
 //==This code has been autogenerated using Compgen==
 
           //Solving equation using LU-faktorisation
-          mpSolver->solve(jacobianMatrix, systemEquations, stateVark, iter);
+          const bool converged = mpSolver->solve(jacobianMatrix, systemEquations, stateVark, iter);
           q2e=stateVark[0];
           wmr1=stateVark[1];
           p1=stateVark[2];
@@ -423,6 +422,11 @@ onPositive(p1),0,1))/(kl*rho);
           q1 = -q2;
           Pin = -(tormr1*wmr1);
           Pout = (-p1 + p2)*q2;
+          //Stop iterating when the residual was already within tolerance
+          if(converged)
+          {
+            break;
+          }
         }
 
         //Calculate the delayed parts
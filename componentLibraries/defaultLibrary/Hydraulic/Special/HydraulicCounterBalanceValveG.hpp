@@ -66,9 +66,9 @@ private:
      double delayParts3[9];
      double delayParts4[9];
      double delayParts5[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<5> jacobianMatrix;
+     FixedVec<5> systemEquations;
+     FixedMatrix<6,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -160,9 +160,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(5,5);
-        systemEquations.create(5);
-        delayedPart.create(6,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -290,9 +287,7 @@ ks*mTimestep + 2*Cq*mTimestep*p1*w*Cos(phi) - 2*Cq*mTimestep*p2*w*Cos(phi));
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(5);
-        Vec stateVark(5);
-        Vec deltaStateVar(5);
+        FixedVec<5> stateVark;
 
         //Read variables from nodes
         //Port P1
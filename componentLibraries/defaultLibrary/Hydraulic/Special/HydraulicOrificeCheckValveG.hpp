@@ -59,9 +59,9 @@ private:
      double delayParts1[9];
      double delayParts2[9];
      double delayParts3[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<3> jacobianMatrix;
+     FixedVec<3> systemEquations;
+     FixedMatrix<4,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -137,9 +137,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(3,3);
-        systemEquations.create(3);
-        delayedPart.create(4,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -242,9 +239,7 @@ diameter","m",0.3,&mpdh);
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(3);
-        Vec stateVark(3);
-        Vec deltaStateVar(3);
+        FixedVec<3> stateVark;
 
         //Read variables from nodes
         //Port Pp
@@ -69,9 +69,9 @@ private:
      double delayParts5[9];
      double delayParts6[9];
      double delayParts7[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<7> jacobianMatrix;
+     FixedVec<7> systemEquations;
+     FixedMatrix<8,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -160,9 +160,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(7,7);
-        systemEquations.create(7);
-        delayedPart.create(8,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -303,9 +300,7 @@ bp*mTimestep);
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(7);
-        Vec stateVark(7);
-        Vec deltaStateVar(7);
+        FixedVec<7> stateVark;
 
         //Read variables from nodes
         //Port P1
@@ -65,9 +65,9 @@ private:
      double delayParts2[9];
      double delayParts3[9];
      double delayParts4[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<4> jacobianMatrix;
+     FixedVec<4> systemEquations;
+     FixedMatrix<5,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -158,9 +158,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(4,4);
-        systemEquations.create(4);
-        delayedPart.create(5,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -283,9 +280,7 @@ p2)*Cos(phi))/(2*Bv + ks*mTimestep + 2*Cq*mTimestep*w*Abs(p1 - p2)*Cos(phi));
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(4);
-        Vec stateVark(4);
-        Vec deltaStateVar(4);
+        FixedVec<4> stateVark;
 
         //Read variables from nodes
         //Port P1
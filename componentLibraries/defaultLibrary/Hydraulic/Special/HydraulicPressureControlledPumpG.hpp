@@ -69,9 +69,9 @@ private:
      double delayParts3[9];
      double delayParts4[9];
      double delayParts5[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<5> jacobianMatrix;
+     FixedVec<5> systemEquations;
+     FixedMatrix<6,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -179,9 +179,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(5,5);
-        systemEquations.create(5);
-        delayedPart.create(6,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -226,6 +223,9 @@ change","m^3/s^2",0.,&mpdqp);
 //==This code has been autogenerated using Compgen==
         //Add constantParameters
         mpSolver = new EquationSystemSolver(this,5);
+        //Factorize in the first iteration of each time step and reuse it in the following, stop when converged
+        mpSolver->setJacobianReuse(true);
+        mpSolver->setResidualTolerance(1e-10);
      }
 
     void initialize()
@@ -338,9 +338,7 @@ Power(mTimestep,2)*Rpe*wp1e + 4*Lpe*tauv*wp1e + 2*mTimestep*Rpe*tauv*wp1e);
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(5);
-        Vec stateVark(5);
-        Vec deltaStateVar(5);
+        FixedVec<5> stateVark;
 
         //Read variables from nodes
         //Port P1
@@ -392,6 +390,7 @@ Power(mTimestep,2)*Rpe*wp1e + 4*Lpe*tauv*wp1e + 2*mTimestep*Rpe*tauv*wp1e);
         stateVark[4] = p2;
 
         //Iterative solution using Newton-Rapshson
+        mpSolver->invalidateJacobian();
         for(iter=1;iter<=mNoiter;iter++)
         {
          //PressureControlledPumpG
@@ -440,7 +439,7 @@ delayedPart[2][1],qmine,qmaxe))/2.;
 //==This code has been autogenerated using Compgen==
 
           //Solving equation using LU-faktorisation
-          mpSolver->solve(jacobianMatrix, systemEquations, stateVark, iter);
+          const bool converged = mpSolver->solve(jacobianMatrix, systemEquations, stateVark, iter);
           dqp=stateVark[0];
           qp=stateVark[1];
           q2=stateVark[2];
@@ -451,6 +450,11 @@ delayedPart[2][1],qmine,qmaxe))/2.;
           p3 = c3;
           q3 = 0.;
           eps = qp/qmaxe;
+          //Stop iterating when the residual was already within tolerance
+          if(converged)
+          {
+            break;
+          }
         }
 
         //Calculate the delayed parts
@@ -80,9 +80,9 @@ private:
      double delayParts8[9];
      double delayParts9[9];
      double delayParts10[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<10> jacobianMatrix;
+     FixedVec<10> systemEquations;
+     FixedMatrix<11,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -214,9 +214,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(10,10);
-        systemEquations.create(10);
-        delayedPart.create(11,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -396,9 +393,7 @@ public:
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(10);
-        Vec stateVark(10);
-        Vec deltaStateVar(10);
+        FixedVec<10> stateVark;
 
         //Read variables from nodes
         //Port Pp
@@ -79,9 +79,9 @@ private:
      double delayParts9[9];
      double delayParts10[9];
      double delayParts11[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<11> jacobianMatrix;
+     FixedVec<11> systemEquations;
+     FixedMatrix<12,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -223,9 +223,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(11,11);
-        systemEquations.create(11);
-        delayedPart.create(12,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -411,9 +408,7 @@ public:
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(11);
-        Vec stateVark(11);
-        Vec deltaStateVar(11);
+        FixedVec<11> stateVark;
 
         //Read variables from nodes
         //Port Pp
@@ -64,9 +64,9 @@ private:
      double delayParts6[9];
      double delayParts7[9];
      double delayParts8[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<8> jacobianMatrix;
+     FixedVec<8> systemEquations;
+     FixedMatrix<9,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -153,9 +153,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(8,8);
-        systemEquations.create(8);
-        delayedPart.create(9,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -283,9 +280,7 @@ Bm*mTimestep*wmr1)/(2.*Jm + Bm*mTimestep);
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(8);
-        Vec stateVark(8);
-        Vec deltaStateVar(8);
+        FixedVec<8> stateVark;
 
         //Read variables from nodes
         //Port Pp1
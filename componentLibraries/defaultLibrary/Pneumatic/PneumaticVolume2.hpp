@@ -57,9 +57,9 @@ private:
      Port *mpPp2;
      double delayParts1[9];
      double delayParts2[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<1> jacobianMatrix;
+     FixedVec<1> systemEquations;
+     FixedMatrix<2,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -135,9 +135,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(1,1);
-        systemEquations.create(1);
-        delayedPart.create(2,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -238,9 +235,7 @@ pp2))/2.;
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(1);
-        Vec stateVark(1);
-        Vec deltaStateVar(1);
+        FixedVec<1> stateVark;
 
         //Read variables from nodes
         //Port Pp1
@@ -59,6 +59,7 @@ namespace hopsan {
         HString mSeparatorChar;
         HString mCommentChar;
         CSVParserNG mCSVParser;
+        CSVColumnData mCSVData;
         LookupTable1D mLookupTable;
 
     public:
@@ -80,7 +81,7 @@ namespace hopsan {
             addConstant("inid", "csv file index column (0-based index)", "", 0, mInDataId);
             addConstant("outid", "csv file value column (0-based index)", "", 1, mOutDataId);
             addConstant("numlineskip", "The number of lines to skip (from the top)", "", 0, mNumLinesToSkip);
-            addConstant("comment", "Skip initial lines starting with character", "", "", mCommentChar);
+            addConstant("comment", "Skip lines starting with character", "", "", mCommentChar);
             addConstant("reload","Reload csv file in initialize", "", true, mReloadCSV);
         }
 
@@ -95,10 +96,10 @@ namespace hopsan {
                 mLookupTable.clear();
 
                 if (mUseTextInput) {
-                    isOK = mCSVParser.openText(mTextInput);
+                    isOK = mCSVParser.mapText(mTextInput);
                 }
                 else {
-                    isOK = mCSVParser.openFile(findFilePath(mFileName));
+                    isOK = mCSVParser.mapFile(findFilePath(mFileName));
                 }
 
                 if (isOK)
@@ -118,8 +119,8 @@ namespace hopsan {
                         if (mSeparatorChar.size() == 1) {
                             mCSVParser.setLinesToSkip(mNumLinesToSkip);
                             mCSVParser.setFieldSeparator(mSeparatorChar[0]);
-                            mCSVParser.indexFile();
-                            isOK = true;
+                            // Parse all columns in parallel directly from the mapped data
+                            isOK = mCSVParser.parseMappedData(mCSVData);
                         }
                         else {
                             addErrorMessage("Separator character must be ONE character");
@@ -138,23 +139,30 @@ namespace hopsan {
                 }
                 else
                 {
+                    // The data is now parsed and we can unmap the csv file
+                    mCSVParser.closeFile();
+
                     // Make sure that selected data vector is in range
-                    size_t minCols, maxCols;
-                    mCSVParser.getMinMaxNumCols(minCols, maxCols);
-                    if ( mInDataId >= int(maxCols) || mOutDataId >= int(maxCols) )
+                    const size_t numCols = mCSVData.getNumCols();
+                    if ( mInDataId < 0 || mOutDataId < 0 || mInDataId >= int(numCols) || mOutDataId >= int(numCols) )
                     {
                         HString ss;
                         ss = "inid: "+to_hstring(mInDataId)+" or outid:"+to_hstring(mOutDataId)+" is out of range!";
                         addErrorMessage(ss);
                         stopSimulation();
-                        mCSVParser.closeFile();
+                        mCSVData.clear();
                         return;
                     }
 
-                    isOK = mCSVParser.copyColumn(mInDataId, mLookupTable.getIndexDataRef());
-                    isOK = isOK && mCSVParser.copyColumn(mOutDataId, mLookupTable.getValueDataRef());
-                    // Now the data is in the lookuptable and we can close the csv file and clear the index
-                    mCSVParser.closeFile();
+                    // Move the parsed columns into the lookup table without copying
+                    isOK = mCSVData.takeColumn(mOutDataId, mLookupTable.getValueDataRef());
+                    if (mInDataId == mOutDataId) {
+                        mLookupTable.getIndexDataRef() = mLookupTable.getValueDataRef();
+                    }
+                    else {
+                        isOK = isOK && mCSVData.takeColumn(mInDataId, mLookupTable.getIndexDataRef());
+                    }
+                    mCSVData.clear();
 
                     if (!isOK)
                     {
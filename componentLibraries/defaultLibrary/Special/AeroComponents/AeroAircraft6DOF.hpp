@@ -144,9 +144,9 @@ private:
      double delayParts11[9];
      double delayParts12[9];
      double delayParts13[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<13> jacobianMatrix;
+     FixedVec<13> systemEquations;
+     FixedMatrix<14,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -440,9 +440,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(13,13);
-        systemEquations.create(13);
-        delayedPart.create(14,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -1012,9 +1009,7 @@ mTimestep*Power(q3,2)*Wb - 2*zcg)/2.;
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(13);
-        Vec stateVark(13);
-        Vec deltaStateVar(13);
+        FixedVec<13> stateVark;
 
         //Read variables from nodes
         //Port Pal1
@@ -49,9 +49,9 @@ private:
      double massfuel0;
      double delayParts1[9];
      double delayParts2[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<1> jacobianMatrix;
+     FixedVec<1> systemEquations;
+     FixedMatrix<2,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -89,9 +89,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(1,1);
-        systemEquations.create(1);
-        delayedPart.create(2,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -144,9 +141,7 @@ mass","kg",0.,&mpconsfuel);
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(1);
-        Vec stateVark(1);
-        Vec deltaStateVar(1);
+        FixedVec<1> stateVark;
 
         //Read variables from nodes
 
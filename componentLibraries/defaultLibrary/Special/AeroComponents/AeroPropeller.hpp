@@ -59,9 +59,9 @@ private:
      double delayParts1[9];
      double delayParts2[9];
      double delayParts3[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<2> jacobianMatrix;
+     FixedVec<2> systemEquations;
+     FixedMatrix<3,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -128,9 +128,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(2,2);
-        systemEquations.create(2);
-        delayedPart.create(3,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -169,6 +166,9 @@ public:
 //==This code has been autogenerated using Compgen==
         //Add constantParameters
         mpSolver = new EquationSystemSolver(this,2);
+        //Factorize in the first iteration of each time step and reuse it in the following, stop when converged
+        mpSolver->setJacobianReuse(true);
+        mpSolver->setResidualTolerance(1e-10);
      }
 
     void initialize()
@@ -228,9 +228,7 @@ NodeMechanicRotational::EquivalentInertia);
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(2);
-        Vec stateVark(2);
-        Vec deltaStateVar(2);
+        FixedVec<2> stateVark;
 
         //Read variables from nodes
         //Port Pmr1
@@ -260,6 +258,7 @@ NodeMechanicRotational::EquivalentInertia);
         stateVark[1] = cmr1;
 
         //Iterative solution using Newton-Rapshson
+        mpSolver->invalidateJacobian();
         for(iter=1;iter<=mNoiter;iter++)
         {
          //Propeller
@@ -293,7 +292,7 @@ Power(Abs(g1 - (1.*g2*Up)/(0.00001*dp + \
 //==This code has been autogenerated using Compgen==
 
           //Solving equation using LU-faktorisation
-          mpSolver->solve(jacobianMatrix, systemEquations, stateVark, iter);
+          const bool converged = mpSolver->solve(jacobianMatrix, systemEquations, stateVark, iter);
           thrust=stateVark[0];
           cmr1=stateVark[1];
           //Expressions
@@ -305,6 +304,11 @@ Power(Abs(g1 - (g2*Up)/(dp*(0.00001 + 0.159155*wmr1))),-k)),1/k))/Abs(g1 - \
           Pin = cmr1*wmr1;
           Pout = thrust*Up;
           Jp = Up/(dp*(0.00001 + 0.159155*wmr1));
+          //Stop iterating when the residual was already within tolerance
+          if(converged)
+          {
+            break;
+          }
         }
 
         //Calculate the delayed parts
@@ -69,9 +69,9 @@ private:
      double delayParts5[9];
      double delayParts6[9];
      double delayParts7[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<7> jacobianMatrix;
+     FixedVec<7> systemEquations;
+     FixedMatrix<8,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -161,9 +161,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(7,7);
-        systemEquations.create(7);
-        delayedPart.create(8,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -198,6 +195,9 @@ public:
 //==This code has been autogenerated using Compgen==
         //Add constantParameters
         mpSolver = new EquationSystemSolver(this,7);
+        //Factorize in the first iteration of each time step and reuse it in the following, stop when converged
+        mpSolver->setJacobianReuse(true);
+        mpSolver->setResidualTolerance(1e-10);
      }
 
     void initialize()
@@ -431,9 +431,7 @@ gn(qmp2) - \
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(7);
-        Vec stateVark(7);
-        Vec deltaStateVar(7);
+        FixedVec<7> stateVark;
 
         //Read variables from nodes
         //Port Pp1
@@ -462,6 +460,7 @@ gn(qmp2) - \
         stateVark[6] = tormr1;
 
         //Iterative solution using Newton-Rapshson
+        mpSolver->invalidateJacobian();
         for(iter=1;iter<=mNoiter;iter++)
         {
          //TurboMachineJ
@@ -976,7 +975,7 @@ pp2 + (cv + R)*Tp1)*onPositive(qmp2);
 //==This code has been autogenerated using Compgen==
 
           //Solving equation using LU-faktorisation
-          mpSolver->solve(jacobianMatrix, systemEquations, stateVark, iter);
+          const bool converged = mpSolver->solve(jacobianMatrix, systemEquations, stateVark, iter);
           qmp2=stateVark[0];
           wmr1=stateVark[1];
           dEp1=stateVark[2];
@@ -987,6 +986,11 @@ pp2 + (cv + R)*Tp1)*onPositive(qmp2);
           //Expressions
           qmp1 = -qmp2;
           q2 = (qmp2*R*(1. + Tp2))/pp2;
+          //Stop iterating when the residual was already within tolerance
+          if(converged)
+          {
+            break;
+          }
         }
 
         //Calculate the delayed parts
@@ -81,9 +81,9 @@ private:
      double delayParts7[9];
      double delayParts8[9];
      double delayParts9[9];
-     Matrix jacobianMatrix;
-     Vec systemEquations;
-     Matrix delayedPart;
+     FixedMatrix<9> jacobianMatrix;
+     FixedVec<9> systemEquations;
+     FixedMatrix<10,6> delayedPart;
      int i;
      int iter;
      int mNoiter;
@@ -219,9 +219,6 @@ public:
 //==This code has been autogenerated using Compgen==
 
         mNstep=9;
-        jacobianMatrix.create(9,9);
-        systemEquations.create(9);
-        delayedPart.create(10,6);
         mNoiter=2;
         jsyseqnweight[0]=1;
         jsyseqnweight[1]=0.67;
@@ -465,9 +462,7 @@ m3FrictionViscousCoeff*mTimestep);
      }
     void simulateOneTimestep()
      {
-        Vec stateVar(9);
-        Vec stateVark(9);
-        Vec deltaStateVar(9);
+        FixedVec<9> stateVark;
 
         //Read variables from nodes
         //Port Pm1
@@ -34,6 +34,9 @@
 #include <thread>
 #include <fstream>
 #include <sstream>
+#include <queue>
+#include <cmath>
+#include <algorithm>
 
 using namespace std;
 using namespace std::chrono;
@@ -307,6 +310,113 @@ ServerHandler::idlist_t ServerHandler::getServers(double maxTime, int minNumThre
     return ids;
 }
 
+//! @brief Distribute a batch of jobs over the available servers
+//! @details Each server is modeled as numTotalSlots/numThreadsPerJob parallel lanes, where the work ahead of the new jobs is
+//! the busy slots, the queued batch runs and the jobs placed since the last status check. Jobs are assigned one by one (greedily)
+//! to the server that would complete its share first, using the benchmark time as the time per job.
+//! The placed jobs are remembered until the next status check so that consecutive requests do not pile up on the same servers.
+//! @param[in] numJobs The number of jobs to place
+//! @param[in] numThreadsPerJob The number of slots each job needs
+//! @param[in] maxTime The maximum allowed benchmark time, (negative means no limit)
+//! @param[out] rEstimatedTimes The estimated completion time for the jobs on each server, (same order as returned)
+//! @returns A list of server id and number of jobs placed on that server
+std::vector<std::pair<int,int>> ServerHandler::placeJobs(int numJobs, int numThreadsPerJob, double maxTime, std::vector<double> &rEstimatedTimes)
+{
+    numThreadsPerJob = std::max(numThreadsPerJob, 1);
+    if (maxTime < 0)
+    {
+        maxTime = 1e200;
+    }
+
+    struct Candidate
+    {
+        int id;
+        int numLanes;
+        double workAhead;
+        double timePerJob;
+        int numJobs;
+        double finishTime(int numAdditional) const
+        {
+            return timePerJob*std::ceil((workAhead+numJobs+numAdditional)/double(numLanes));
+        }
+    };
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // Servers that have not yet been benchmarked are assumed to be as slow as the slowest known server
+    double slowestBenchmark = 0;
+    for (auto &item : mServerMap)
+    {
+        if (item.second.benchmarkTime < 1e99)
+        {
+            slowestBenchmark = std::max(slowestBenchmark, item.second.benchmarkTime);
+        }
+    }
+    if (slowestBenchmark <= 0)
+    {
+        slowestBenchmark = 1;
+    }
+
+    std::vector<Candidate> candidates;
+    for (auto &item : mServerMap)
+    {
+        const ServerInfo &si = item.second;
+        const double timePerJob = (si.benchmarkTime < 1e99) ? si.benchmarkTime : slowestBenchmark;
+        if (si.isReady && si.numTotalSlots >= numThreadsPerJob && timePerJob < maxTime)
+        {
+            const int numBusySlots = std::max(si.numTotalSlots-si.numFreeSlots, 0);
+            candidates.push_back({item.first, si.numTotalSlots/numThreadsPerJob,
+                                  double(numBusySlots)/numThreadsPerJob + si.numQueuedRuns + si.numPlacedJobs, timePerJob, 0});
+        }
+    }
+
+    // Min-heap on the finish time if one more job would be added
+    auto later = [&candidates](size_t a, size_t b) { return candidates[a].finishTime(1) > candidates[b].finishTime(1); };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(later)> queue(later);
+    for (size_t c=0; c<candidates.size(); ++c)
+    {
+        queue.push(c);
+    }
+    for (int j=0; j<numJobs && !queue.empty(); ++j)
+    {
+        size_t c = queue.top();
+        queue.pop();
+        candidates[c].numJobs++;
+        queue.push(c);
+    }
+
+    std::vector<std::pair<int,int>> placement;
+    rEstimatedTimes.clear();
+    for (const Candidate &rCandidate : candidates)
+    {
+        if (rCandidate.numJobs > 0)
+        {
+            placement.push_back({rCandidate.id, rCandidate.numJobs});
+            rEstimatedTimes.push_back(rCandidate.finishTime(0));
+            mServerMap.at(rCandidate.id).numPlacedJobs += rCandidate.numJobs;
+        }
+    }
+    return placement;
+}
+
+//! @brief Check if a server has never been benchmarked, or if it is idle and the benchmark is older than the given age
+bool ServerHandler::needsBenchmark(int id, double maxBenchmarkAgeSeconds)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mServerMap.find(id);
+    if (it == mServerMap.end())
+    {
+        return false;
+    }
+    const ServerInfo &si = it->second;
+    if (si.benchmarkTime > 1e99)
+    {
+        return true;
+    }
+    const bool isIdle = (si.numFreeSlots == si.numTotalSlots) && (si.numQueuedRuns == 0);
+    return isIdle && (duration_cast<duration<double>>(steady_clock::now() - si.lastBenchmarkTime).count() > maxBenchmarkAgeSeconds);
+}
+
 void ServerHandler::getOldestServer(int &rID, std::chrono::steady_clock::time_point &rTime)
 {
     mMutex.lock();
@@ -373,6 +483,10 @@ void ServerHandler::refreshServerStatusThread(int serverId)
                     server2.lastCheckTime = steady_clock::now();
                     server2.isReady = status.isReady;
                     server2.numTotalSlots = status.numTotalSlots;
+                    server2.numFreeSlots = status.numFreeSlots;
+                    server2.numQueuedRuns = status.numQueuedRuns;
+                    // Jobs placed before this check are now included in the reported status
+                    server2.numPlacedJobs = 0;
                     updateServerInfoNoLock(server2);
                 }
                 mMutex.unlock();
@@ -425,7 +539,16 @@ void ServerHandler::refreshServerBenchmarkThread(int serverId)
                         server2.benchmarkTimes.resize(nThreads);
                     }
                     server2.benchmarkTimes[nThreads-1] = benchmarkTime;
-                    server2.benchmarkTime = server2.benchmarkTimes.front();
+                    // Track recent throughput, but smooth out occasional disturbances
+                    if (server2.benchmarkTime > 1e99)
+                    {
+                        server2.benchmarkTime = server2.benchmarkTimes.front();
+                    }
+                    else
+                    {
+                        server2.benchmarkTime = 0.7*server2.benchmarkTime + 0.3*server2.benchmarkTimes.front();
+                    }
+                    server2.lastBenchmarkTime = steady_clock::now();
                     updateServerInfoNoLock(server2);
                 }
                 mMutex.unlock();
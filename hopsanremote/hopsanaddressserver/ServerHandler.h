@@ -121,9 +121,13 @@ public:
     std::string description;
     std::string mRelayBaseIdentity;
     int numTotalSlots = 0;
-    double benchmarkTime=1e100;
+    int numFreeSlots = 0;
+    int numQueuedRuns = 0;   //!< Batch runs waiting on the server, as of the last status check
+    int numPlacedJobs = 0;   //!< Jobs placed on the server since the last status check
+    double benchmarkTime=1e100; //!< Moving average of recent benchmark times
     std::vector<double> benchmarkTimes;
     std::chrono::steady_clock::time_point lastCheckTime;
+    std::chrono::steady_clock::time_point lastBenchmarkTime;
     bool bussyProcessing=false;
     bool isReady=false;
     Range mRelaySubIdentities;
@@ -183,6 +187,8 @@ public :
     void removeRelay(const std::string &rRelayIdentiy);
 
     idlist_t getServers(double maxTime, int minNumThreads=0, int maxNum=-1);
+    std::vector<std::pair<int,int>> placeJobs(int numJobs, int numThreadsPerJob, double maxTime, std::vector<double> &rEstimatedTimes);
+    bool needsBenchmark(int id, double maxBenchmarkAgeSeconds);
     void getOldestServer(int &rID, std::chrono::steady_clock::time_point &rTime);
     int getOldestServer();
 
@@ -71,6 +71,7 @@ zmq::context_t gContext(1);
 
 ServerHandler gServerHandler;
 double gMaxAgeSeconds = 60*5;
+double gMaxBenchmarkAgeSeconds = 60*60;
 
 static int s_interrupted = 0;
 #ifdef _WIN32
@@ -183,7 +184,7 @@ void refreshServerThread()
                 std::chrono::milliseconds ms{50};
                 std::this_thread::sleep_for(ms);
 
-                if (gServerHandler.getServer(id).benchmarkTime > 1e99)
+                if (gServerHandler.needsBenchmark(id, gMaxBenchmarkAgeSeconds))
                 {
                     gServerHandler.refreshServerBenchmark(id);
                 }
@@ -306,6 +307,7 @@ int main(int argc, char* argv[])
     TCLAP::ValueArg<std::string> argListenPort("p","port","The server listen port",true,"","Port number", cmd);
     TCLAP::ValueArg<std::string> argExternalIP("", "externalip", "The IP address to use for external connections if behind firewall", false, "", "ip address", cmd);
     TCLAP::ValueArg<std::string> argRelayPort("","relayport","The server relay port",false,"","Port number", cmd);
+    TCLAP::ValueArg<double> argBenchmarkAge("","benchmarkage","The minimum time between benchmarks of idle servers",false,60,"minutes", cmd);
     TCLAP::ValueArg<std::string> argSubnetMatch("", "subnetmatch", "Subnet match filter", false, "", "", cmd);
 
     // Parse the argv array.
@@ -340,6 +342,10 @@ int main(int argc, char* argv[])
         gMaxAgeSeconds = argRefreshTime.getValue() * 60.0;
     }
     cout << PRINTSERVER << nowDateTime() << " Server refresh time: " << gMaxAgeSeconds << " seconds" << endl;
+    if (argBenchmarkAge.isSet())
+    {
+        gMaxBenchmarkAgeSeconds = argBenchmarkAge.getValue() * 60.0;
+    }
 
     try
     {
@@ -474,6 +480,38 @@ int main(int argc, char* argv[])
                     cout << PRINTSERVER << nowDateTime() << " Responds with: " << reply.size() << " servers" << endl;
                     sendMessage(socket, ReplyServerMachines, reply);
                 }
+                else if (msg_id == RequestJobPlacement)
+                {
+                    bool parseOK;
+                    ReqmsgRequestJobPlacement req = unpackMessage<ReqmsgRequestJobPlacement>(message,offset,parseOK);
+                    cout << PRINTSERVER << nowDateTime() << " Got job placement request for: " << req.numJobs << " jobs" << endl;
+
+                    std::vector<double> estimatedTimes;
+                    auto placement = gServerHandler.placeJobs(req.numJobs, req.numThreadsPerJob, req.maxBenchmarkTime, estimatedTimes);
+
+                    std::vector<ReplymsgReplyJobPlacement> reply;
+                    reply.reserve(placement.size());
+                    for (size_t i=0; i<placement.size(); ++i)
+                    {
+                        ServerInfo server = gServerHandler.getServer(placement[i].first);
+                        if (server.isValid())
+                        {
+                            ReplymsgReplyJobPlacement repl;
+                            if (server.needsRelay())
+                            {
+                                repl.relayaddress = myExternalIP+":"+myRelayPort+":"+server.mRelayBaseIdentity;
+                            }
+                            repl.address = server.address;
+                            repl.description = server.description;
+                            repl.numjobs = placement[i].second;
+                            repl.estimatedTime = estimatedTimes[i];
+                            reply.push_back(repl);
+                        }
+                    }
+
+                    cout << PRINTSERVER << nowDateTime() << " Placed jobs on: " << reply.size() << " servers" << endl;
+                    sendMessage(socket, ReplyJobPlacement, reply);
+                }
                 else if (msg_id == RequestRelaySlot)
                 {
                     bool parseOK;
@@ -77,10 +77,14 @@ int main(int argc, char* argv[])
         TCLAP::ValueArg<int> numSlotsOption("","numslots", "The number of slots to request",false,1,"Integer (default 1)",cmd);
         TCLAP::SwitchArg nonBlockingShell("", "nonblockingshell", "Don't wait for shell script to finish", cmd);
         TCLAP::MultiArg<std::string> shellOptions("", "shellexec", "Command to execute in shell", false, "string", cmd);
+        TCLAP::MultiArg<std::string> resultVarOptions("", "resultvar", "Simulation result variable to request (default all), a trailing * matches any suffix", false, "string", cmd);
+        TCLAP::SwitchArg noCompressOption("", "nocompress", "Do not compress simulation results during transfer", cmd);
         TCLAP::MultiArg<std::string> requestOptions("", "request", "Request file (only from WD)", false, "string", cmd);
         TCLAP::MultiArg<std::string> assetsOptions("a", "asset", "Model assets (files)", false, "string (filepath)", cmd);
         TCLAP::ValueArg<std::string> userOption("u","user","The user identification string",false,"","user:password or user", cmd);
         TCLAP::ValueArg<std::string> hmfPathOption("m","hmf","The Hopsan model file to load",false,"","Path to file", cmd);
+        TCLAP::ValueArg<int> placeJobsOption("", "placejobs", "Ask the address server how to place this many single slot jobs, print the placement and exit", false, 0, "Integer", cmd);
+        TCLAP::ValueArg<std::string> addressServerOption("", "addressserver", "Address server IP address and port", false, "", "IP address", cmd);
         TCLAP::ValueArg<std::string> serverAddrOption("s", "serverip", "Server IP address and port (default is localhost:45050)", false, "localhost:45050", "IP address", cmd);
 
         // Parse the argv array.
@@ -103,6 +107,24 @@ int main(int argc, char* argv[])
             rhopsan.setLongReceiveTimeout(longTOOption.getValue()*1000);
         }
 
+        if (placeJobsOption.isSet())
+        {
+            std::vector<ServerJobPlacementT> placements;
+            bool rc = rhopsan.connectToAddressServer(addressServerOption.getValue()) &&
+                      rhopsan.requestJobPlacement(placeJobsOption.getValue(), 1, -1, placements);
+            if (!rc)
+            {
+                cout << PRINTCLIENT << "Could not get job placement: " << rhopsan.getLastErrorMessage() << endl;
+                return 1;
+            }
+            for (const ServerJobPlacementT &rPlacement : placements)
+            {
+                cout << PRINTCLIENT << rPlacement.address << " (" << rPlacement.description << ") Jobs: " << rPlacement.numjobs
+                     << " Estimated time: " << rPlacement.estimatedTime << endl;
+            }
+            return 0;
+        }
+
         cout << PRINTCLIENT << "Connecting to: " << serverAddrOption.getValue() << endl;
         rhopsan.connectToServer(serverAddrOption.getValue());
         cout << PRINTCLIENT << "Connected: " << rhopsan.serverConnected() << endl;
@@ -188,8 +210,8 @@ int main(int argc, char* argv[])
                         if (rc)
                         {
                             vector<ResultVariableT> vars;
-                            rc = rhopsan.requestSimulationResults(vars);
-                            cout << PRINTCLIENT << "Results: " << rc << endl;
+                            rc = rhopsan.requestSimulationResults(resultVarOptions.getValue(), vars, !noCompressOption.getValue());
+                            cout << PRINTCLIENT << "Results: " << rc << " Num variables: " << vars.size() << endl;
                         }
                         else
                         {
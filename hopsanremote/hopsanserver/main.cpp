@@ -31,7 +31,12 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <deque>
 #include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
 
 #include "hopsanremotecommon/Messages.h"
 #include "hopsanremotecommon/MessageUtilities.h"
@@ -92,6 +97,7 @@ public:
     string mExternalIP;
     string mAddressServerIPandPort;
     double mAddressReportAge = 60*10;
+    double mBatchResultsMaxAge = 60*60;
 };
 
 ServerConfig gServerConfig;
@@ -276,6 +282,328 @@ static void s_catch_signals(void)
 
 map<int, WorkerInfo> workerMap;
 
+//! @brief Find the lowest port above the control port that is not used by a running worker
+//! @details Workers (batch job workers in particular) may finish in any order, so the port can not be computed from the number of taken slots
+size_t findFreeWorkerPort()
+{
+    size_t port = size_t(gServerConfig.mControlPort)+1;
+    bool isTaken = true;
+    while (isTaken)
+    {
+        isTaken = false;
+        for (auto &rWorker : workerMap)
+        {
+            if (rWorker.second.mWorkerPort == port)
+            {
+                isTaken = true;
+                ++port;
+                break;
+            }
+        }
+    }
+    return port;
+}
+
+//! @brief Launch a new worker process that will listen on its own port
+//! @param[in] numThreads The number of slots (simulation threads) the worker may use
+//! @param[in] userid The user that the worker is started for
+//! @param[out] rWorkerPort The port that the worker will listen on
+//! @returns True if the process was launched
+bool launchWorkerProcess(int numThreads, const string &userid, size_t &rWorkerPort)
+{
+    size_t workerPort = findFreeWorkerPort();
+    rWorkerPort = workerPort;
+
+    // Generate unique worker Id
+    int uid = rand();
+    while (workerMap.count(uid) != 0)
+    {
+        uid = rand();
+    }
+
+#ifdef _WIN32
+    PROCESS_INFORMATION processInformation;
+    STARTUPINFO startupInfo;
+    memset(&processInformation, 0, sizeof(processInformation));
+    memset(&startupInfo, 0, sizeof(startupInfo));
+    startupInfo.cb = sizeof(startupInfo);
+
+    string scport = to_string(gServerConfig.mControlPort);
+    string swport = to_string(workerPort);
+    string nthreads = to_string(numThreads);
+    string uidstr = to_string(uid);
+
+    std::string appName("hopsanserverworker.exe");
+    std::string cmdLine("hopsanserverworker "+uidstr+" "+scport+" "+swport+" "+nthreads);
+    TCHAR* pTCharCmdLineBuff = new TCHAR[cmdLine.size()+1];
+    strcpy_s(pTCharCmdLineBuff, cmdLine.size()+1, cmdLine.c_str());
+
+    BOOL result = CreateProcess(appName.c_str(), pTCharCmdLineBuff, NULL, NULL, FALSE, NORMAL_PRIORITY_CLASS, NULL, NULL, &startupInfo, &processInformation);
+    delete pTCharCmdLineBuff;
+    if (result == 0)
+    {
+        std::cout << PRINTSERVER << "Error: Failed to launch worker process!"<<endl;
+        return false;
+    }
+    std::cout << PRINTSERVER << "Launched Worker Process, pid: "<< processInformation.dwProcessId << " port: " << workerPort << " uid: " << uid << " nThreads: " << numThreads  << endl;
+    workerMap.insert({uid, WorkerInfo(numThreads, workerPort, userid, processInformation)});
+#else
+    char name_buff[64], sport_buff[64], wport_buff[64], thread_buff[64], uid_buff[64];
+    // Write name
+    sprintf(name_buff, "%s", "hopsanserverworker");
+    // Write port as char in buffer
+    sprintf(sport_buff, "%d", gServerConfig.mControlPort);
+    sprintf(wport_buff, "%d", int(workerPort));
+    // Write num threads as char in buffer
+    sprintf(thread_buff, "%d", numThreads);
+    // Write id as char in buffer
+    sprintf(uid_buff, "%d", uid);
+
+    char *argv[] = {name_buff, uid_buff, sport_buff, wport_buff, thread_buff, nullptr};
+
+    pid_t pid;
+    int status = posix_spawn(&pid,"./hopsanserverworker",nullptr,nullptr,argv,environ);
+    if(status != 0)
+    {
+        std::cout << PRINTSERVER << nowDateTime() << " Error: Failed to launch worker process!"<<endl;
+        return false;
+    }
+    std::cout << PRINTSERVER << nowDateTime() << " Launched Worker Process, pid: "<< pid << " port: " << workerPort << " uid: " << uid << " nThreads: " << numThreads << endl;
+    workerMap.insert({uid, WorkerInfo(numThreads, workerPort, userid, pid)});
+#endif
+    gNumTakenSlots+=numThreads;
+    std::cout << PRINTSERVER << nowDateTime() << " Remaining slots: " << gServerConfig.mMaxNumSlots-gNumTakenSlots << endl;
+    return true;
+}
+
+//! @brief A batch of simulations of one model with different parameter sets
+//! @details The model is loaded once in each of the workers assigned to the job, the workers are then kept
+//! alive and are fed runs from the queue until it is empty. Only the final values of the requested outputs are kept.
+class BatchJob
+{
+public:
+    CmdmsgSubmitBatchJob mJob;
+    bool mIsStarted = false;
+    int mNumWorkers = 0;      //!< The number of workers launched for this job
+    std::atomic<int> mNumActiveWorkers{0};
+
+    //! @brief Take the index of the next run to simulate, or -1 if the queue is empty
+    int takeNextRun()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mNextRun < mJob.parametersets.size())
+        {
+            return int(mNextRun++);
+        }
+        return -1;
+    }
+
+    void addResult(int run, bool success, const vector<double> &rValues)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mResults.push_back(ReplymsgBatchRunResult());
+        mResults.back().run = run;
+        mResults.back().success = success;
+        mResults.back().values = rValues;
+        if (mResults.size() == mJob.parametersets.size())
+        {
+            mFinishedTime = steady_clock::now();
+        }
+    }
+
+    //! @brief Check if the job finished more than maxAge seconds ago, its results are then assumed to be abandoned
+    bool hasExpired(double maxAge)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return (mResults.size() == mJob.parametersets.size()) &&
+               (duration_cast<duration<double>>(steady_clock::now() - mFinishedTime).count() > maxAge);
+    }
+
+    //! @brief Mark all runs that have not been taken as failed, used when no worker remains to simulate them
+    void failRemainingRuns()
+    {
+        int run = takeNextRun();
+        while (run >= 0)
+        {
+            addResult(run, false, vector<double>());
+            run = takeNextRun();
+        }
+    }
+
+    //! @brief The number of runs that have not yet been taken by a worker
+    int numQueuedRuns()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return int(mJob.parametersets.size()-mNextRun);
+    }
+
+    //! @brief Copy the results completed after offset
+    void getResults(size_t offset, ReplymsgReplyBatchResults &rReply)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (offset < mResults.size())
+        {
+            rReply.results.assign(mResults.begin()+offset, mResults.end());
+        }
+        rReply.numtotal = int(mJob.parametersets.size());
+        rReply.isfinished = (mResults.size() == mJob.parametersets.size());
+    }
+
+private:
+    std::mutex mMutex;
+    size_t mNextRun = 0;
+    vector<ReplymsgBatchRunResult> mResults;
+    steady_clock::time_point mFinishedTime = steady_clock::now();
+};
+
+//! @brief Feeds runs from a batch job to one worker until the job queue is empty
+//! @details The worker is told to close when the queue is empty, it will then report WorkerFinished to the server and its slot is released
+void batchWorkerThread(std::shared_ptr<BatchJob> pJob, size_t workerPort)
+{
+    const long timeout = 60000;
+    try
+    {
+        zmq::socket_t workerSocket (gContext, ZMQ_REQ);
+        int linger_ms = 1000;
+        workerSocket.setsockopt(ZMQ_LINGER, &linger_ms, sizeof(int));
+        workerSocket.connect(makeZMQAddress("127.0.0.1", workerPort).c_str());
+
+        string err;
+        sendMessage(workerSocket, SetModel, pJob->mJob.model);
+        bool workerOK = receiveAckNackMessage(workerSocket, timeout, err);
+        if (!workerOK)
+        {
+            cout << PRINTSERVER << nowDateTime() << " Error: Batch worker at port: " << workerPort << " could not load model: " << err << endl;
+        }
+
+        int run = workerOK ? pJob->takeNextRun() : -1;
+        while (run >= 0)
+        {
+            CmdmsgSimulateWithParameters simmsg {pJob->mJob.parameternames, pJob->mJob.parametersets[size_t(run)]};
+            sendMessage(workerSocket, SimulateWithParameters, simmsg);
+            bool simOK = receiveAckNackMessage(workerSocket, timeout, err);
+
+            // Wait for simulation to finish, poll often at first since batch runs are usually short
+            int pollDelay_ms = 1;
+            while (simOK)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(pollDelay_ms));
+                pollDelay_ms = std::min(2*pollDelay_ms, 100);
+                sendShortMessage(workerSocket, RequestWorkerStatus);
+                zmq::message_t response;
+                if (!receiveWithTimeout(workerSocket, timeout, response))
+                {
+                    workerOK = simOK = false;
+                    break;
+                }
+                size_t offset=0; bool parseOK;
+                size_t id = getMessageId(response, offset, parseOK);
+                ReplymsgReplyWorkerStatus status = unpackMessage<ReplymsgReplyWorkerStatus>(response, offset, parseOK);
+                if (id != ReplyWorkerStatus || !parseOK)
+                {
+                    simOK = false;
+                }
+                else if (status.simulation_finished)
+                {
+                    simOK = status.simualtion_success;
+                    break;
+                }
+            }
+
+            vector<double> values;
+            if (simOK)
+            {
+                sendMessage(workerSocket, RequestFinalValues, pJob->mJob.outputs);
+                zmq::message_t response;
+                if (receiveWithTimeout(workerSocket, timeout, response))
+                {
+                    size_t offset=0; bool parseOK;
+                    size_t id = getMessageId(response, offset, parseOK);
+                    if (id == ReplyFinalValues)
+                    {
+                        values = unpackMessage<vector<double>>(response, offset, parseOK);
+                    }
+                    simOK = (id == ReplyFinalValues) && parseOK;
+                }
+                else
+                {
+                    workerOK = simOK = false;
+                }
+            }
+            pJob->addResult(run, simOK, values);
+
+            // A REQ socket that timed out can not be used again, give up on this worker
+            run = workerOK ? pJob->takeNextRun() : -1;
+        }
+
+        if (workerOK)
+        {
+            sendShortMessage(workerSocket, ClientClosing);
+            receiveAckNackMessage(workerSocket, timeout, err);
+        }
+        workerSocket.disconnect(makeZMQAddress("127.0.0.1", workerPort).c_str());
+    }
+    catch(zmq::error_t e)
+    {
+        cout << PRINTSERVER << nowDateTime() << " Error: Contacting batch worker: " << e.what() << endl;
+    }
+
+    // The last worker to quit fails the runs that could not be simulated, so that the job always finishes
+    if (--pJob->mNumActiveWorkers == 0)
+    {
+        pJob->failRemainingRuns();
+    }
+}
+
+map<int, std::shared_ptr<BatchJob>> gBatchJobs;
+deque<int> gQueuedBatchJobIds;
+
+//! @brief Launch workers for queued batch jobs, as many as there are free slots
+void startQueuedBatchJobs()
+{
+    while (!gQueuedBatchJobIds.empty())
+    {
+        auto it = gBatchJobs.find(gQueuedBatchJobIds.front());
+        if (it == gBatchJobs.end())
+        {
+            gQueuedBatchJobIds.pop_front();
+            continue;
+        }
+        std::shared_ptr<BatchJob> pJob = it->second;
+
+        int numFreeSlots = gServerConfig.mMaxNumSlots-gNumTakenSlots;
+        int numWorkers = std::min(std::min(std::max(pJob->mJob.numworkers, 1), numFreeSlots), int(pJob->mJob.parametersets.size()));
+        if (numWorkers <= 0)
+        {
+            // Jobs are started in submission order, a job that does not fit waits for free slots
+            break;
+        }
+        gQueuedBatchJobIds.pop_front();
+
+        vector<size_t> workerPorts;
+        for (int w=0; w<numWorkers; ++w)
+        {
+            size_t workerPort;
+            if (launchWorkerProcess(1, pJob->mJob.userid, workerPort))
+            {
+                workerPorts.push_back(workerPort);
+            }
+        }
+        cout << PRINTSERVER << nowDateTime() << " Starting batch job: " << it->first << " with: " << workerPorts.size() << " workers" << endl;
+        pJob->mIsStarted = true;
+        pJob->mNumWorkers = int(workerPorts.size());
+        pJob->mNumActiveWorkers = int(workerPorts.size());
+        for (size_t workerPort : workerPorts)
+        {
+            std::thread(batchWorkerThread, pJob, workerPort).detach();
+        }
+        if (workerPorts.empty())
+        {
+            pJob->failRemainingRuns();
+        }
+    }
+}
+
 int main(int argc, char* argv[])
 {
     TCLAP::CmdLine cmd("HopsanServer", ' ', "0.1");
@@ -348,81 +676,16 @@ int main(int argc, char* argv[])
                     cout << PRINTSERVER << nowDateTime() << " Client (" << requestuserid << ") is requesting: " << requestNumThreads << " slots... " << endl;
                     if (gNumTakenSlots+requestNumThreads <= gServerConfig.mMaxNumSlots)
                     {
-                        size_t workerPort = gServerConfig.mControlPort+gNumTakenSlots+1;
-
-                        // Generate unique worker Id
-                        int uid = rand();
-                        while (workerMap.count(uid) != 0)
-                        {
-                            uid = rand();
-                        }
-
-#ifdef _WIN32
-                        PROCESS_INFORMATION processInformation;
-                        STARTUPINFO startupInfo;
-                        memset(&processInformation, 0, sizeof(processInformation));
-                        memset(&startupInfo, 0, sizeof(startupInfo));
-                        startupInfo.cb = sizeof(startupInfo);
-
-                        string scport = to_string(gServerConfig.mControlPort);
-                        string swport = to_string(workerPort);
-                        string nthreads = to_string(requestNumThreads);
-                        string uidstr = to_string(uid);
-
-                        std::string appName("hopsanserverworker.exe");
-                        std::string cmdLine("hopsanserverworker "+uidstr+" "+scport+" "+swport+" "+nthreads);
-                        TCHAR* pTCharCmdLineBuff = new TCHAR[cmdLine.size()+1];
-                        strcpy_s(pTCharCmdLineBuff, cmdLine.size()+1, cmdLine.c_str());
-
-                        BOOL result = CreateProcess(appName.c_str(), pTCharCmdLineBuff, NULL, NULL, FALSE, NORMAL_PRIORITY_CLASS, NULL, NULL, &startupInfo, &processInformation);
-                        if (result == 0)
-                        {
-                            std::cout << PRINTSERVER << "Error: Failed to launch worker process!"<<endl;
-                            sendMessage(socket, NotAck, "Failed to launch worker process!");
-                        }
-                        else
+                        size_t workerPort;
+                        if (launchWorkerProcess(requestNumThreads, requestuserid, workerPort))
                         {
-                            std::cout << PRINTSERVER << "Launched Worker Process, pid: "<< processInformation.dwProcessId << " port: " << workerPort << " uid: " << uid << " nThreads: " << requestNumThreads  << endl;
-                            workerMap.insert({uid, WorkerInfo(requestNumThreads, workerPort, requestuserid, processInformation)});
-
-                            ReplymsgReplyServerSlots msg = {workerPort};
-                            sendMessage<ReplymsgReplyServerSlots>(socket, ReplyServerSlots, msg);
-                            gNumTakenSlots++;
-                        }
-                        delete pTCharCmdLineBuff;
-
-#else
-                        char name_buff[64], sport_buff[64], wport_buff[64], thread_buff[64], uid_buff[64];
-                        // Write name
-                        sprintf(name_buff, "%s", "hopsanserverworker");
-                        // Write port as char in buffer
-                        sprintf(sport_buff, "%d", gServerConfig.mControlPort);
-                        sprintf(wport_buff, "%d", int(workerPort));
-                        // Write num threads as char in buffer
-                        sprintf(thread_buff, "%d", requestNumThreads);
-                        // Write id as char in buffer
-                        sprintf(uid_buff, "%d", uid);
-
-                        char *argv[] = {name_buff, uid_buff, sport_buff, wport_buff, thread_buff, nullptr};
-
-                        pid_t pid;
-                        int status = posix_spawn(&pid,"./hopsanserverworker",nullptr,nullptr,argv,environ);
-                        if(status == 0)
-                        {
-                            std::cout << PRINTSERVER << nowDateTime() << " Launched Worker Process, pid: "<< pid << " port: " << workerPort << " uid: " << uid << " nThreads: " << requestNumThreads << endl;
-                            workerMap.insert({uid, WorkerInfo(requestNumThreads, workerPort, requestuserid, pid)});
-
                             ReplymsgReplyServerSlots msg = {int(workerPort)};
                             sendMessage(socket, ReplyServerSlots, msg);
-                            gNumTakenSlots+=requestNumThreads;
-                            std::cout << PRINTSERVER << nowDateTime() << " Remaining slots: " << gServerConfig.mMaxNumSlots-gNumTakenSlots << endl;
                         }
                         else
                         {
-                            std::cout << PRINTSERVER << nowDateTime() << " Error: Failed to launch worker process!"<<endl;
                             sendMessage(socket, NotAck, "Failed to launch worker process!");
                         }
-#endif
                     }
                     else if (gNumTakenSlots == gServerConfig.mMaxNumSlots)
                     {
@@ -435,6 +698,63 @@ int main(int argc, char* argv[])
                         cout << PRINTSERVER << nowDateTime() << " Denied! To few free slots." << endl;
                     }
                 }
+                else if (msg_id == SubmitBatchJob)
+                {
+                    bool parseOK;
+                    CmdmsgSubmitBatchJob msg = unpackMessage<CmdmsgSubmitBatchJob>(request, offset, parseOK);
+                    bool setsOK = parseOK;
+                    for (const vector<string> &rSet : msg.parametersets)
+                    {
+                        setsOK = setsOK && (rSet.size() == msg.parameternames.size());
+                    }
+                    if (!setsOK || msg.model.empty() || msg.parametersets.empty())
+                    {
+                        sendMessage(socket, NotAck, "Could not parse batch job, or job is empty");
+                    }
+                    else
+                    {
+                        if (msg.userid.empty())
+                        {
+                            msg.userid = "anonymous";
+                        }
+                        int jobid = rand();
+                        while (gBatchJobs.count(jobid) != 0)
+                        {
+                            jobid = rand();
+                        }
+                        cout << PRINTSERVER << nowDateTime() << " Client (" << msg.userid << ") submitted batch job: " << jobid << " with: " << msg.parametersets.size() << " runs" << endl;
+                        std::shared_ptr<BatchJob> pJob = std::make_shared<BatchJob>();
+                        pJob->mJob = std::move(msg);
+                        gBatchJobs.insert({jobid, pJob});
+                        gQueuedBatchJobIds.push_back(jobid);
+                        startQueuedBatchJobs();
+
+                        ReplymsgReplyBatchJob reply {jobid, pJob->mNumWorkers};
+                        sendMessage(socket, ReplyBatchJob, reply);
+                    }
+                }
+                else if (msg_id == RequestBatchResults)
+                {
+                    bool parseOK;
+                    ReqmsgRequestBatchResults msg = unpackMessage<ReqmsgRequestBatchResults>(request, offset, parseOK);
+                    auto it = gBatchJobs.find(msg.jobid);
+                    if (!parseOK || it == gBatchJobs.end() || msg.offset < 0)
+                    {
+                        sendMessage(socket, NotAck, "Unknown batch job");
+                    }
+                    else
+                    {
+                        ReplymsgReplyBatchResults reply;
+                        it->second->getResults(size_t(msg.offset), reply);
+                        sendMessage(socket, ReplyBatchResults, reply);
+                        // Forget the job once all results have been delivered
+                        if (reply.isfinished)
+                        {
+                            cout << PRINTSERVER << nowDateTime() << " Batch job: " << msg.jobid << " finished and delivered" << endl;
+                            gBatchJobs.erase(it);
+                        }
+                    }
+                }
                 else if (msg_id == WorkerFinished)
                 {
                     bool parseOK;
@@ -508,6 +828,10 @@ int main(int argc, char* argv[])
                     status.numTotalSlots = gServerConfig.mMaxNumSlots;
                     status.numFreeSlots = gServerConfig.mMaxNumSlots-gNumTakenSlots;
                     status.isReady = true;
+                    for (auto &rJob : gBatchJobs)
+                    {
+                        status.numQueuedRuns += rJob.second->numQueuedRuns();
+                    }
                     for (auto it=workerMap.begin(); it!=workerMap.end(); ++it)
                     {
                         status.users += it->second.mUserid+", ";
@@ -543,6 +867,23 @@ int main(int argc, char* argv[])
                 // Handle timeout / exception
             }
 
+            // Start queued batch jobs if slots have been released
+            startQueuedBatchJobs();
+
+            // Forget finished batch jobs whose results have not been fetched in a long time
+            for (auto it=gBatchJobs.begin(); it!=gBatchJobs.end();)
+            {
+                if (it->second->hasExpired(gServerConfig.mBatchResultsMaxAge))
+                {
+                    cout << PRINTSERVER << nowDateTime() << " Batch job: " << it->first << " expired, results were never fetched" << endl;
+                    it = gBatchJobs.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
             // Check if we should report back to address server, if no status requests have been made in some time
             if (argAddressServerIP.isSet())
             {
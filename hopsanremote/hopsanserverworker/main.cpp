@@ -34,6 +34,8 @@
 #include <thread>
 #include <atomic>
 #include <array>
+#include <algorithm>
+#include <limits>
 
 #include "zmq.hpp"
 
@@ -41,6 +43,7 @@
 #include "hopsanremotecommon/MessageUtilities.h"
 #include "hopsanremotecommon/FileAccess.h"
 #include "hopsanremotecommon/FileReceiver.hpp"
+#include "hopsanremotecommon/DataEncoding.hpp"
 
 #include "HopsanEssentials.h"
 #include "CoreUtilities/HopsanCoreMessageHandler.h"
@@ -158,6 +161,60 @@ void collectAllModelVariables(ComponentSystem *pSys, vector<ModelVariableInfo_t>
     }
 }
 
+//! @brief Check if a variable name matches any of the requested names
+//! @details An empty filter list or "*" matches everything, a name ending with * matches any variable with that prefix
+bool matchesVariableFilter(const string &rName, const vector<string> &rFilters)
+{
+    if (rFilters.empty())
+    {
+        return true;
+    }
+    for (const string &rFilter : rFilters)
+    {
+        if (!rFilter.empty() && rFilter.back() == '*')
+        {
+            if (rName.compare(0, rFilter.size()-1, rFilter, 0, rFilter.size()-1) == 0)
+            {
+                return true;
+            }
+        }
+        else if (rName == rFilter)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+//! @brief Collect the model variables that match the given name filters
+void collectModelVariables(ComponentSystem *pSys, const vector<string> &rFilters, vector<ModelVariableInfo_t> &rvMVI)
+{
+    vector<ModelVariableInfo_t> allMVI;
+    collectAllModelVariables(pSys, allMVI, "");
+    rvMVI.clear();
+    for (ModelVariableInfo_t &rMvi : allMVI)
+    {
+        if (matchesVariableFilter(rMvi.fullName, rFilters))
+        {
+            rvMVI.push_back(rMvi);
+        }
+    }
+}
+
+//! @brief Get logged sample t of a model variable directly from the log storage
+inline double getLoggedValue(const ModelVariableInfo_t &rMvi, size_t t)
+{
+    if (rMvi.pData)
+    {
+        return (*rMvi.pData)[t][rMvi.dataId];
+    }
+    else if (rMvi.pTimeData)
+    {
+        return (*rMvi.pTimeData)[t];
+    }
+    return 0;
+}
+
 void splitStringOnDelimiter(const std::string &rString, const char delim, std::vector<std::string> &rSplitVector)
 {
     rSplitVector.clear();
@@ -766,6 +823,84 @@ int main(int argc, char* argv[])
                         }
                     }
                 }
+                else if (msg_id == SimulateWithParameters)
+                {
+                    bool parseOK;
+                    CmdmsgSimulateWithParameters msg = unpackMessage<CmdmsgSimulateWithParameters>(request, offset, parseOK);
+                    if (gIsSimulating)
+                    {
+                        sendMessage(socket, NotAck, "Simulation is already in progress!");
+                    }
+                    else if (!gpRootSystem)
+                    {
+                        sendMessage(socket, NotAck, "No model loaded!");
+                    }
+                    else if (!parseOK || msg.names.size() != msg.values.size())
+                    {
+                        sendMessage(socket, NotAck, "Failed to parse simulation message");
+                    }
+                    else
+                    {
+                        // Set all parameters, then initialize and start the simulation, the model stays loaded between runs
+                        string failedParameter;
+                        for (size_t i=0; i<msg.names.size(); ++i)
+                        {
+                            HString fullName = msg.names[i].c_str();
+                            if (!setParameter(gpRootSystem, fullName, msg.values[i].c_str()))
+                            {
+                                failedParameter = msg.names[i];
+                                break;
+                            }
+                        }
+
+                        if (!failedParameter.empty())
+                        {
+                            sendMessage(socket, NotAck, "Failed to set parameter: "+failedParameter);
+                        }
+                        else if (gSimulator.initializeSystem(gSimStartTime, gSimStopTime, gpRootSystem))
+                        {
+                            startSimulation(&gWasSimulationOK);
+                            sendShortMessage(socket, Ack);
+                        }
+                        else
+                        {
+                            cout  << PRINTWORKER << nowDateTime() << " Model Init failed"  << endl;
+                            sendMessage(socket, NotAck, "Could not initialize system");
+                        }
+                    }
+                }
+                else if (msg_id == RequestFinalValues)
+                {
+                    bool parseOK;
+                    vector<string> names = unpackMessage<vector<string>>(request, offset, parseOK);
+                    if (gIsSimulating)
+                    {
+                        sendMessage(socket, NotAck, "Simulation is still in progress!");
+                    }
+                    else if (!gpRootSystem || !parseOK)
+                    {
+                        sendMessage(socket, NotAck, "Could not get final values");
+                    }
+                    else
+                    {
+                        // Variables that do not exist or have no logged samples are returned as NaN
+                        vector<ModelVariableInfo_t> vMVI;
+                        collectModelVariables(gpRootSystem, names, vMVI);
+                        vector<double> values(names.size(), std::numeric_limits<double>::quiet_NaN());
+                        for (size_t n=0; n<names.size(); ++n)
+                        {
+                            for (const ModelVariableInfo_t &rMvi : vMVI)
+                            {
+                                if (rMvi.fullName == names[n] && rMvi.dataLength > 0)
+                                {
+                                    values[n] = getLoggedValue(rMvi, rMvi.dataLength-1);
+                                    break;
+                                }
+                            }
+                        }
+                        sendMessage(socket, ReplyFinalValues, values);
+                    }
+                }
                 else if (msg_id == ExecuteInShell)
                 {
                     bool parseOK;
@@ -887,12 +1022,21 @@ int main(int argc, char* argv[])
                     {
                         sendMessage(socket, NotAck, "Simulation is still in progress!");
                     }
+                    else if (!gpRootSystem)
+                    {
+                        sendMessage(socket, NotAck, "No model loaded!");
+                    }
                     else
                     {
                         bool parseOK;
                         string varName = unpackMessage<string>(request, offset, parseOK);
+                        vector<string> filters;
+                        if (varName != "*")
+                        {
+                            filters.push_back(varName);
+                        }
                         vector<ModelVariableInfo_t> vMVI;
-                        collectAllModelVariables(gpRootSystem, vMVI, "");
+                        collectModelVariables(gpRootSystem, filters, vMVI);
                         cout << PRINTWORKER << nowDateTime() << " Client requests variable: " << varName << " Sending: " << vMVI.size() << " variables!" << endl;
 
                         //! @todo Check if simulation finished, ACK Nack
@@ -907,25 +1051,87 @@ int main(int argc, char* argv[])
                             vars.back().quantity = rMvi.quantity;
                             vars.back().unit = rMvi.unit.c_str();
                             vars.back().data.reserve(rMvi.dataLength);
-                            // Copy if a data variable
-                            if (rMvi.pData)
+                            for (size_t t=0; t<rMvi.dataLength; ++t)
                             {
-                                for (size_t t=0; t<rMvi.dataLength; ++t)
-                                {
-                                    vars.back().data.push_back((*rMvi.pData)[t][rMvi.dataId]);
-                                }
+                                vars.back().data.push_back(getLoggedValue(rMvi, t));
                             }
-                            // Copy if a time data variable
-                            else if (rMvi.pTimeData)
+                        }
+
+                        sendMessage(socket,ReplyResults,vars);
+                    }
+                }
+                else if (msg_id == RequestResultsChunk)
+                {
+                    bool parseOK;
+                    ReqmsgRequestResultsChunk msg = unpackMessage<ReqmsgRequestResultsChunk>(request, offset, parseOK);
+                    if (gIsSimulating)
+                    {
+                        sendMessage(socket, NotAck, "Simulation is still in progress!");
+                    }
+                    else if (!gpRootSystem)
+                    {
+                        sendMessage(socket, NotAck, "No model loaded!");
+                    }
+                    else if (!parseOK || msg.varoffset < 0 || msg.sampleoffset < 0 ||
+                             (msg.encoding != RawDoubles && msg.encoding != XorDeltaDoubles))
+                    {
+                        sendMessage(socket, NotAck, "Could not parse results request");
+                    }
+                    else
+                    {
+                        if (msg.names.size() == 1 && msg.names.front() == "*")
+                        {
+                            msg.names.clear();
+                        }
+                        vector<ModelVariableInfo_t> vMVI;
+                        collectModelVariables(gpRootSystem, msg.names, vMVI);
+
+                        // Encode variables (or parts of variables) directly from the log storage until the chunk is full
+                        // At least one sample is always sent so that the client is guaranteed to make progress
+                        const size_t maxChunkSize = size_t(std::max(msg.maxchunksize, int(sizeof(double))));
+                        ReplymsgResultsChunk reply;
+                        size_t v = size_t(msg.varoffset);
+                        size_t s = size_t(msg.sampleoffset);
+                        size_t numBytes = 0;
+                        while (v < vMVI.size() && numBytes < maxChunkSize)
+                        {
+                            const ModelVariableInfo_t &rMvi = vMVI[v];
+                            const size_t numRemaining = (s < rMvi.dataLength) ? rMvi.dataLength-s : 0;
+                            const size_t numSamples = std::min(numRemaining, std::max(size_t(1), (maxChunkSize-numBytes)/sizeof(double)));
+
+                            reply.variables.push_back(ReplymsgResultsChunkVariable());
+                            ReplymsgResultsChunkVariable &rVar = reply.variables.back();
+                            rVar.name = rMvi.fullName;
+                            rVar.alias = rMvi.alias;
+                            rVar.quantity = rMvi.quantity;
+                            rVar.unit = rMvi.unit;
+                            rVar.totalsamples = int(rMvi.dataLength);
+                            rVar.sampleoffset = int(s);
+                            rVar.numsamples = int(numSamples);
+                            rVar.encoding = msg.encoding;
+
+                            DoubleEncoder encoder(rVar.data, ResultDataEncodingT(msg.encoding));
+                            encoder.reserve(numSamples);
+                            for (size_t t=s; t<s+numSamples; ++t)
                             {
-                                for (size_t t=0; t<vMVI[mvi].dataLength; ++t)
-                                {
-                                    vars.back().data.push_back((*rMvi.pTimeData)[t]);
-                                }
+                                encoder.add(getLoggedValue(rMvi, t));
+                            }
+                            numBytes += rVar.data.size();
+
+                            s += numSamples;
+                            if (s >= rMvi.dataLength)
+                            {
+                                ++v;
+                                s = 0;
                             }
                         }
+                        reply.nextvaroffset = int(v);
+                        reply.nextsampleoffset = int(s);
+                        reply.islastpart = (v >= vMVI.size());
 
-                        sendMessage(socket,ReplyResults,vars);
+                        cout << PRINTWORKER << nowDateTime() << " Client requests results chunk at: " << msg.varoffset << ":" << msg.sampleoffset
+                             << " Sending: " << reply.variables.size() << " variable parts, " << numBytes << " bytes" << endl;
+                        sendMessage(socket, ReplyResultsChunk, reply);
                     }
                 }
                 else if (msg_id == RequestMessages)
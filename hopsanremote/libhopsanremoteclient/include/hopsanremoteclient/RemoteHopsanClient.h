@@ -93,12 +93,21 @@ public:
     bool requestWorkerStatus(WorkerStatusT &rWorkerStatus);
     bool requestServerStatus(ServerStatusT &rServerStatus);
     bool requestSimulationResults(std::vector<ResultVariableT> &rResultVariables);
+    bool requestSimulationResults(const std::vector<std::string> &rNames, std::vector<ResultVariableT> &rResultVariables,
+                                  bool compress=true, int maxChunkSize=4000000);
     bool requestMessages();
     bool requestMessages(std::vector<char> &rTypes, std::vector<std::string> &rTags, std::vector<std::string> &rMessages);
     bool requestShellOutput(std::string &rOutput);
 
+    // Server batch job requests
+    bool submitBatchJob(const std::string &rModel, const std::vector<std::string> &rParameterNames,
+                        const std::vector<std::vector<std::string> > &rParameterSets, const std::vector<std::string> &rOutputs,
+                        int numWorkers, int &rJobId, const std::string userid="");
+    bool requestBatchResults(int jobId, std::vector<BatchRunResultT> &rResults, bool &rIsFinished);
+
     // Address server requests
     bool requestServerMachines(int nMachines, double maxBenchmarkTime, std::vector<ServerMachineInfoT> &rMachines);
+    bool requestJobPlacement(int numJobs, int numThreadsPerJob, double maxBenchmarkTime, std::vector<ServerJobPlacementT> &rPlacements);
     bool requestRelaySlot(const std::string &rBaseRelayIdentity, const int port, std::string &rRelayIdentityFull);
     bool releaseRelaySlot(const std::string &rRelayIdentityFull);
 
@@ -111,6 +120,7 @@ private:
     void deleteServerSocket();
     void deleteWorkerSocket();
     void requestWorkerStatusThread(double *pProgress, bool *pAlive);
+    bool requestAllSimulationResults(const std::vector<std::string> &rNames, std::vector<ResultVariableT> &rResultVariables);
     void setLastError(const std::string &rError);
 
     double mMaxWorkerStatusRequestWaitTime = 30; //!< The maximum delay between worker status requests in seconds
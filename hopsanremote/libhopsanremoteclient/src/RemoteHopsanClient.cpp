@@ -28,6 +28,7 @@
 #include "hopsanremotecommon/Messages.h"
 #include "hopsanremotecommon/MessageUtilities.h"
 #include "hopsanremotecommon/FileReceiver.hpp"
+#include "hopsanremotecommon/DataEncoding.hpp"
 
 #include "zmq.hpp"
 #include "msgpack.hpp"
@@ -520,10 +521,105 @@ bool RemoteHopsanClient::requestServerStatus(ServerStatusT &rServerStatus)
 }
 
 bool RemoteHopsanClient::requestSimulationResults(std::vector<ResultVariableT> &rResultVariables)
+{
+    return requestSimulationResults(std::vector<std::string>(), rResultVariables);
+}
+
+//! @brief Request logged results from the worker, in chunks, and reassemble them incrementally
+//! @param[in] rNames The names of the variables to request, empty or "*" means all, a trailing * matches any suffix
+//! @param[out] rResultVariables The received variables
+//! @param[in] compress Use XOR delta compression for the data
+//! @param[in] maxChunkSize The approximate maximum number of data bytes the worker should send in each reply
+bool RemoteHopsanClient::requestSimulationResults(const std::vector<std::string> &rNames, std::vector<ResultVariableT> &rResultVariables,
+                                                  bool compress, int maxChunkSize)
+{
+    std::unique_lock<std::mutex> lock(mWorkerMutex);
+    rResultVariables.clear();
+
+    ReqmsgRequestResultsChunk msg;
+    msg.names = rNames;
+    msg.maxchunksize = maxChunkSize;
+    msg.encoding = compress ? XorDeltaDoubles : RawDoubles;
+
+    bool isLastPart = false;
+    while (!isLastPart)
+    {
+        sendClientMessage<ReqmsgRequestResultsChunk>(mpWorkerSocket, RequestResultsChunk, msg);
+
+        zmq::message_t response;
+        if (!receiveWithTimeout(*mpWorkerSocket, response, mLongReceiveTimeout))
+        {
+            return false;
+        }
+
+        size_t offset=0;
+        bool parseOK;
+        size_t id = getMessageId(response, offset, parseOK);
+        if (id == ReplyResultsChunk)
+        {
+            ReplymsgResultsChunk chunk = unpackMessage<ReplymsgResultsChunk>(response, offset, parseOK);
+            if (!parseOK)
+            {
+                setLastError("Could not parse results chunk");
+                return false;
+            }
+            for (ReplymsgResultsChunkVariable &rPart : chunk.variables)
+            {
+                // The first part of a variable carries the meta data, the following parts are appended to it
+                if (rPart.sampleoffset == 0)
+                {
+                    rResultVariables.push_back(ResultVariableT());
+                    ResultVariableT &rVar = rResultVariables.back();
+                    rVar.name = rPart.name;
+                    rVar.alias = rPart.alias;
+                    rVar.quantity = rPart.quantity;
+                    rVar.unit = rPart.unit;
+                    rVar.data.reserve(size_t(std::max(rPart.totalsamples, 0)));
+                }
+                if (rResultVariables.empty() || rResultVariables.back().name != rPart.name ||
+                    rResultVariables.back().data.size() != size_t(rPart.sampleoffset) ||
+                    !decodeDoubles(rPart.data, rPart.encoding, size_t(std::max(rPart.numsamples, 0)), rResultVariables.back().data))
+                {
+                    setLastError("Received malformed results chunk for: "+rPart.name);
+                    return false;
+                }
+                // Release the encoded data as soon as it has been decoded
+                std::string().swap(rPart.data);
+            }
+            isLastPart = chunk.islastpart;
+            msg.varoffset = chunk.nextvaroffset;
+            msg.sampleoffset = chunk.nextsampleoffset;
+        }
+        else if (id == NotAck)
+        {
+            const string error = unpackMessage<string>(response, offset, parseOK);
+            // An older worker that does not support chunked results replies that the message id is unhandled,
+            // then fall back to requesting all at once
+            if (msg.varoffset == 0 && msg.sampleoffset == 0 && error.find("Unhandled message id") != string::npos)
+            {
+                lock.unlock();
+                return requestAllSimulationResults(rNames, rResultVariables);
+            }
+            setLastError(error);
+            return false;
+        }
+        else
+        {
+            setLastError("Got wrong reply");
+            return false;
+        }
+    }
+    return true;
+}
+
+//! @brief Request all results in one message, (the only method supported by older workers)
+bool RemoteHopsanClient::requestAllSimulationResults(const std::vector<std::string> &rNames, std::vector<ResultVariableT> &rResultVariables)
 {
     std::lock_guard<std::mutex> lock(mWorkerMutex);
 
-    sendClientMessage<string>(mpWorkerSocket, RequestResults, "*"); // Request all
+    // Older workers only support one exact name or all
+    const string name = (rNames.size() == 1) ? rNames.front() : "*";
+    sendClientMessage<string>(mpWorkerSocket, RequestResults, name);
 
     zmq::message_t response;
     if (receiveWithTimeout(*mpWorkerSocket, response, mLongReceiveTimeout))
@@ -551,6 +647,85 @@ bool RemoteHopsanClient::requestSimulationResults(std::vector<ResultVariableT> &
     return false;
 }
 
+//! @brief Submit a batch of simulations of one model to the server
+//! @details The server loads the model once in each of (at most) numWorkers workers, and simulates one run per parameter set.
+//! If no slots are free the job is queued on the server until slots become available.
+//! @param[in] rModel The model (hmf) contents
+//! @param[in] rParameterNames The names of the parameters to set in each run
+//! @param[in] rParameterSets One vector of parameter values for each run, in the same order as the names
+//! @param[in] rOutputs The names of the variables whose final values should be returned for each run
+//! @param[in] numWorkers The maximum number of slots to use
+//! @param[out] rJobId The id of the job, used to request results
+bool RemoteHopsanClient::submitBatchJob(const std::string &rModel, const std::vector<std::string> &rParameterNames,
+                                        const std::vector<std::vector<std::string> > &rParameterSets, const std::vector<std::string> &rOutputs,
+                                        int numWorkers, int &rJobId, const std::string userid)
+{
+    CmdmsgSubmitBatchJob msg {rModel, rParameterNames, rParameterSets, rOutputs, numWorkers, userid};
+    sendClientMessage<CmdmsgSubmitBatchJob>(mpServerSocket, SubmitBatchJob, msg);
+
+    zmq::message_t response;
+    if (receiveWithTimeout(*mpServerSocket, response, mLongReceiveTimeout))
+    {
+        size_t offset=0;
+        bool parseOK;
+        size_t id = getMessageId(response, offset, parseOK);
+        if (id == ReplyBatchJob)
+        {
+            ReplymsgReplyBatchJob reply = unpackMessage<ReplymsgReplyBatchJob>(response, offset, parseOK);
+            rJobId = reply.jobid;
+            return parseOK;
+        }
+        else if (id == NotAck)
+        {
+            setLastError(unpackMessage<string>(response, offset, parseOK));
+        }
+        else
+        {
+            setLastError("Got wrong reply type from server");
+        }
+    }
+    return false;
+}
+
+//! @brief Request the batch results that have been completed since the last request
+//! @param[in] jobId The id of the job
+//! @param[in,out] rResults The results received so far, new results are appended (in completion order)
+//! @param[out] rIsFinished True when all runs have been completed and received, the server forgets the job after that
+bool RemoteHopsanClient::requestBatchResults(int jobId, std::vector<BatchRunResultT> &rResults, bool &rIsFinished)
+{
+    rIsFinished = false;
+    ReqmsgRequestBatchResults msg {jobId, int(rResults.size())};
+    sendClientMessage<ReqmsgRequestBatchResults>(mpServerSocket, RequestBatchResults, msg);
+
+    zmq::message_t response;
+    if (receiveWithTimeout(*mpServerSocket, response, mLongReceiveTimeout))
+    {
+        size_t offset=0;
+        bool parseOK;
+        size_t id = getMessageId(response, offset, parseOK);
+        if (id == ReplyBatchResults)
+        {
+            ReplymsgReplyBatchResults reply = unpackMessage<ReplymsgReplyBatchResults>(response, offset, parseOK);
+            if (parseOK)
+            {
+                rResults.insert(rResults.end(), reply.results.begin(), reply.results.end());
+                rIsFinished = reply.isfinished;
+                return true;
+            }
+            setLastError("Could not parse batch results reply");
+        }
+        else if (id == NotAck)
+        {
+            setLastError(unpackMessage<string>(response, offset, parseOK));
+        }
+        else
+        {
+            setLastError("Got wrong reply type from server");
+        }
+    }
+    return false;
+}
+
 bool RemoteHopsanClient::requestSlot(int numThreads, int &rControlPort, const std::string userid)
 {
     ReqmsgReqServerSlots msg {numThreads, userid};
@@ -880,6 +1055,45 @@ bool RemoteHopsanClient::requestServerMachines(int nMachines, double maxBenchmar
     return false;
 }
 
+//! @brief Ask the address server how to distribute a number of jobs over the available servers
+//! @details The placement considers free slots, queued batch runs and benchmark times of each server
+//! @param[in] numJobs The number of jobs to place
+//! @param[in] numThreadsPerJob The number of slots needed by each job
+//! @param[in] maxBenchmarkTime Servers with a slower benchmark are not used, (negative means no limit)
+//! @param[out] rPlacements The servers to use and the number of jobs to send to each
+bool RemoteHopsanClient::requestJobPlacement(int numJobs, int numThreadsPerJob, double maxBenchmarkTime, std::vector<ServerJobPlacementT> &rPlacements)
+{
+    if (addressServerConnected())
+    {
+        ReqmsgRequestJobPlacement req {numJobs, numThreadsPerJob, maxBenchmarkTime};
+        sendClientMessage(mpAddressServerSocket, RequestJobPlacement, req);
+
+        zmq::message_t response;
+        if (receiveWithTimeout(*mpAddressServerSocket, response, mShortReceiveTimeout))
+        {
+            size_t offset=0;
+            bool parseOK;
+            size_t id = getMessageId(response, offset, parseOK);
+            if (id == ReplyJobPlacement)
+            {
+                std::vector<ReplymsgReplyJobPlacement> repl = unpackMessage<std::vector<ReplymsgReplyJobPlacement>>(response,offset,parseOK);
+                rPlacements.clear();
+                rPlacements.reserve(repl.size());
+                for (auto &rPlacement : repl)
+                {
+                    rPlacements.push_back(rPlacement);
+                }
+                return parseOK;
+            }
+            else
+            {
+                setLastError("Got wrong reply");
+            }
+        }
+    }
+    return false;
+}
+
 bool RemoteHopsanClient::requestRelaySlot(const std::string &rBaseRelayIdentity, const int port, std::string &rRelayIdentityFull)
 {
     if (addressServerConnected())
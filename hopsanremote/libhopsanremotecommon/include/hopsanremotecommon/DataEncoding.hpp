@@ -0,0 +1,143 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+
+//$Id$
+
+#ifndef DATAENCODING_HPP
+#define DATAENCODING_HPP
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+//! @brief The encodings that can be used when transferring result data
+enum ResultDataEncodingT {RawDoubles=0, XorDeltaDoubles=1};
+
+//! @brief Encodes a sequence of doubles into a byte buffer
+//! @details With XorDeltaDoubles each value is XOR:ed with the previous value,
+//! leading and trailing zero bytes of the result are dropped and the counts are stored in one control byte.
+//! Smoothly varying or constant signals compress well, noise does not compress at all but costs at most one extra byte per sample.
+//! The byte order is the native order of the sender, (all supported platforms are little-endian).
+class DoubleEncoder
+{
+public:
+    DoubleEncoder(std::string &rBuffer, ResultDataEncodingT encoding) : mrBuffer(rBuffer), mEncoding(encoding) {}
+
+    void reserve(size_t numValues)
+    {
+        mrBuffer.reserve(mrBuffer.size()+numValues*sizeof(double));
+    }
+
+    void add(const double value)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(double));
+        if (mEncoding == XorDeltaDoubles)
+        {
+            const uint64_t x = bits ^ mPrevBits;
+            mPrevBits = bits;
+            if (x == 0)
+            {
+                mrBuffer.push_back(char(8 << 4));
+                return;
+            }
+            int lead=0, trail=0;
+            while (((x >> (56-8*lead)) & 0xFF) == 0) { ++lead; }
+            while (((x >> (8*trail)) & 0xFF) == 0) { ++trail; }
+            mrBuffer.push_back(char((lead << 4) | trail));
+            for (int b=trail; b<8-lead; ++b)
+            {
+                mrBuffer.push_back(char((x >> (8*b)) & 0xFF));
+            }
+        }
+        else
+        {
+            mrBuffer.append(reinterpret_cast<const char*>(&bits), sizeof(double));
+        }
+    }
+
+private:
+    std::string &mrBuffer;
+    ResultDataEncodingT mEncoding;
+    uint64_t mPrevBits = 0;
+};
+
+//! @brief Decodes numValues doubles produced by DoubleEncoder and appends them to rOut
+//! @returns False if the buffer is malformed or of unknown encoding
+inline bool decodeDoubles(const std::string &rBuffer, int encoding, size_t numValues, std::vector<double> &rOut)
+{
+    rOut.reserve(rOut.size()+numValues);
+    if (encoding == RawDoubles)
+    {
+        if (rBuffer.size() != numValues*sizeof(double))
+        {
+            return false;
+        }
+        const size_t start = rOut.size();
+        rOut.resize(start+numValues);
+        if (numValues > 0)
+        {
+            std::memcpy(&rOut[start], rBuffer.data(), rBuffer.size());
+        }
+        return true;
+    }
+    else if (encoding == XorDeltaDoubles)
+    {
+        const unsigned char *p = reinterpret_cast<const unsigned char*>(rBuffer.data());
+        const unsigned char *pEnd = p+rBuffer.size();
+        uint64_t prevBits = 0;
+        for (size_t i=0; i<numValues; ++i)
+        {
+            if (p >= pEnd)
+            {
+                return false;
+            }
+            const int lead = (*p) >> 4;
+            const int trail = (*p) & 0x0F;
+            ++p;
+            if (lead+trail > 8 || (pEnd-p) < (8-lead-trail))
+            {
+                return false;
+            }
+            uint64_t x = 0;
+            if (lead < 8)
+            {
+                for (int b=trail; b<8-lead; ++b)
+                {
+                    x |= uint64_t(*p++) << (8*b);
+                }
+            }
+            prevBits ^= x;
+            double value;
+            std::memcpy(&value, &prevBits, sizeof(double));
+            rOut.push_back(value);
+        }
+        return (p == pEnd);
+    }
+    return false;
+}
+
+#endif // DATAENCODING_HPP
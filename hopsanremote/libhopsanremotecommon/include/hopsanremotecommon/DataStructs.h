@@ -37,4 +37,12 @@ typedef struct
     std::vector<double> data;
 }ResultVariableT;
 
+class BatchRunResultT
+{
+public:
+    int run = -1;                //!< The index of the parameter set in the batch
+    bool success = false;
+    std::vector<double> values;  //!< The final values of the requested outputs
+};
+
 #endif // DATASTRUCTS_H
@@ -79,6 +79,17 @@ enum MessageIdsEnumT {
 
     /* Work in progress (last to avoid breaking compatibility */
     WorkerAlive,
+    RequestResultsChunk,
+    ReplyResultsChunk,
+    SubmitBatchJob,
+    ReplyBatchJob,
+    RequestBatchResults,
+    ReplyBatchResults,
+    SimulateWithParameters,
+    RequestFinalValues,
+    ReplyFinalValues,
+    RequestJobPlacement,
+    ReplyJobPlacement,
 
 };
 
@@ -123,6 +134,49 @@ public:
     MSGPACK_DEFINE(name)
 };
 
+class ReqmsgRequestResultsChunk
+{
+public:
+    std::vector<std::string> names; //!< Variables to send, empty or "*" means all, a trailing * matches any suffix
+    int varoffset = 0;              //!< Index of the first variable (among the matching ones) to send
+    int sampleoffset = 0;           //!< Index of the first sample in the first variable to send
+    int maxchunksize = 4000000;     //!< The approximate maximum number of data bytes to send in one reply
+    int encoding = 0;               //!< The ResultDataEncodingT to use for the data
+
+    MSGPACK_DEFINE(names, varoffset, sampleoffset, maxchunksize, encoding)
+};
+
+class CmdmsgSubmitBatchJob
+{
+public:
+    std::string model;                                  //!< The model (hmf) to load once in each worker
+    std::vector<std::string> parameternames;            //!< The parameters to set in each run
+    std::vector< std::vector<std::string> > parametersets; //!< One vector of values (one per name) for each run
+    std::vector<std::string> outputs;                   //!< The variables whose final values should be returned
+    int numworkers;                                     //!< The maximum number of workers (slots) to use
+    std::string userid;
+
+    MSGPACK_DEFINE(model, parameternames, parametersets, outputs, numworkers, userid)
+};
+
+class ReqmsgRequestBatchResults
+{
+public:
+    int jobid;
+    int offset; //!< The number of results already received by the client
+
+    MSGPACK_DEFINE(jobid, offset)
+};
+
+class CmdmsgSimulateWithParameters
+{
+public:
+    std::vector<std::string> names;
+    std::vector<std::string> values;
+
+    MSGPACK_DEFINE(names, values)
+};
+
 class ReqmsgRequestServerMachines
 {
 public:
@@ -133,6 +187,16 @@ public:
     MSGPACK_DEFINE(numMachines, numThreads, maxBenchmarkTime)
 };
 
+class ReqmsgRequestJobPlacement
+{
+public:
+    int numJobs;
+    int numThreadsPerJob;
+    double maxBenchmarkTime;
+
+    MSGPACK_DEFINE(numJobs, numThreadsPerJob, maxBenchmarkTime)
+};
+
 class ReqmsgReqServerSlots
 {
 public:
@@ -204,7 +268,32 @@ public:
 class ReplymsgReplyServerStatus : public ServerStatusT
 {
 public:
-    MSGPACK_DEFINE(services, users, numFreeSlots, numTotalSlots, startTime, stopTime, isReady)
+    MSGPACK_DEFINE(services, users, numFreeSlots, numTotalSlots, startTime, stopTime, isReady, numQueuedRuns)
+};
+
+class ReplymsgReplyBatchJob
+{
+public:
+    int jobid;
+    int numworkers; //!< The number of workers that will be used, 0 means that the job is queued until slots become free
+
+    MSGPACK_DEFINE(jobid, numworkers)
+};
+
+class ReplymsgBatchRunResult : public BatchRunResultT
+{
+public:
+    MSGPACK_DEFINE(run, success, values)
+};
+
+class ReplymsgReplyBatchResults
+{
+public:
+    std::vector<ReplymsgBatchRunResult> results; //!< Completed runs, in completion order, starting at the requested offset
+    int numtotal;
+    bool isfinished; //!< True when all runs are completed and included in this reply
+
+    MSGPACK_DEFINE(results, numtotal, isfinished)
 };
 
 class ReplymsgReplyBenchmarkResults
@@ -236,6 +325,33 @@ public:
     MSGPACK_DEFINE(name,alias,quantity,unit,data)
 };
 
+class ReplymsgResultsChunkVariable
+{
+public:
+    std::string name;
+    std::string alias;
+    std::string quantity;
+    std::string unit;
+    int totalsamples;  //!< The total number of samples in this variable
+    int sampleoffset;  //!< The index of the first sample in this part
+    int numsamples;    //!< The number of samples in this part
+    int encoding;      //!< The ResultDataEncodingT used for data
+    std::string data;
+
+    MSGPACK_DEFINE(name,alias,quantity,unit,totalsamples,sampleoffset,numsamples,encoding,data)
+};
+
+class ReplymsgResultsChunk
+{
+public:
+    std::vector<ReplymsgResultsChunkVariable> variables;
+    int nextvaroffset;
+    int nextsampleoffset;
+    bool islastpart;
+
+    MSGPACK_DEFINE(variables,nextvaroffset,nextsampleoffset,islastpart)
+};
+
 class ReplymsgReplyMessage
 {
 public:
@@ -262,6 +378,12 @@ public:
     MSGPACK_DEFINE(address, relayaddress, description, numslots, evalTime)
 };
 
+class ReplymsgReplyJobPlacement : public ServerJobPlacementT
+{
+public:
+    MSGPACK_DEFINE(address, relayaddress, description, numjobs, estimatedTime)
+};
+
 
 
 #endif // MESSAGES_H
@@ -37,6 +37,7 @@ public:
     std::string startTime;
     std::string stopTime;
     bool isReady;
+    int numQueuedRuns = 0; //!< The number of batch runs waiting for a free worker
 };
 
 class WorkerStatusT
@@ -63,4 +64,14 @@ public:
     double evalTime;
 };
 
+class ServerJobPlacementT
+{
+public:
+    std::string address;
+    std::string relayaddress;
+    std::string description;
+    int numjobs;           //!< The number of jobs placed on this server
+    double estimatedTime;  //!< The estimated time until the placed jobs are completed, in benchmark model simulation times
+};
+
 #endif // STATUSINFOSTRUCTS_H
@@ -19,6 +19,7 @@ SOURCES += \
 
 
 HEADERS += \
+    include/hopsanremotecommon/DataEncoding.hpp \
     include/hopsanremotecommon/DataStructs.h \
     include/hopsanremotecommon/FileAccess.h \
     include/hopsanremotecommon/FileReceiver.hpp \